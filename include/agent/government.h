@@ -1,33 +1,81 @@
 #ifndef GOVERNMENT_H
 #define GOVERNMENT_H
 
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
+#include <stdexcept>
 #include "agent.h"
 #include "person.h"
 #include "../market/business.h"
+#include "../market/sector_index.h"
+
+// 政策の種類
+enum class PolicyType {
+    SUBSIDY = 0,        // 業種別補助金
+    PRICE_CONTROL = 1,  // 価格統制（1割引き下げ）
+    RELIEF = 2,         // 生活支援（所持金の少ない病気の住民への給付）
+    COUNT
+};
+
+// 文字列から一度だけコンパイルされた政策ルール
+struct PolicyRule {
+    PolicyType type;
+    std::string sector;       // 対象業種（空なら全企業）。RELIEF では対象の職業（空なら全職業）
+    int64_t subsidy_amount;   // 補助金額（SUBSIDY）・給付額（RELIEF）
+    float price_factor;       // 価格倍率（PRICE_CONTROL）
+    int64_t money_limit;      // 給付を受けられる所持金の上限（RELIEF、この額未満が対象）
+
+    PolicyRule() : type(PolicyType::SUBSIDY), subsidy_amount(0), price_factor(1.0f), money_limit(0) {}
+};
+
+// 政策の実施履歴（種類ごとの回数のみ保持し、実施のたびに増え続けることはない）
+struct PolicyHistory {
+    std::array<int64_t, static_cast<size_t>(PolicyType::COUNT)> counts{};
+
+    void record(PolicyType type, int64_t times = 1) {
+        counts[static_cast<size_t>(type)] += times;
+    }
+
+    int64_t count(PolicyType type) const { return counts[static_cast<size_t>(type)]; }
+
+    int64_t total() const {
+        int64_t sum = 0;
+        for (int64_t c : counts) sum += c;
+        return sum;
+    }
+};
 
 class Government : public Agent {
 public:
     int tax_rate;
     float approval_rating;
-    std::vector<std::string> policies;
-    std::map<std::string, float> sector_subsidies;
+    PolicyHistory policy_history;
+
+    Government() : tax_rate(10), approval_rating(50.0f), relief_amount(0), relief_threshold(100) {}
 
-    Government() : tax_rate(10), approval_rating(50.0f) {}
+    static constexpr int64_t PERSON_TAX_EXEMPTION = 100;     // 最低生存費用
+    static constexpr int64_t BUSINESS_TAX_EXEMPTION = 1000;  // 最低運営資金
+
+    // 所持金に対する税額を計算（切り捨て）。免税額以下なら0
+    int64_t assessTax(int64_t money, int64_t exemption) const {
+        if (money <= exemption) return 0;
+        return (money * tax_rate) / 100;
+    }
 
     bool collectTax(Person* citizen) {
         if (!citizen) return false;
         
-        // 税額を計算（切り捨て）
-        int64_t tax_amount = (citizen->money * tax_rate) / 100;
-        
         // 最低生存費用（100）未満の場合は徴収不可
-        if (citizen->money <= 100) {
+        if (citizen->money <= PERSON_TAX_EXEMPTION) {
             return false;
         }
         
+        // 税額を計算（切り捨て）
+        int64_t tax_amount = assessTax(citizen->money, PERSON_TAX_EXEMPTION);
+        
         citizen->addMoney(-tax_amount);
         addMoney(tax_amount);
         approval_rating -= 1.0f; // 徴税による承認率低下
@@ -37,45 +85,140 @@ public:
     bool collectTax(Business* business) {
         if (!business) return false;
         
-        // 税額を計算（切り捨て）
-        int64_t tax_amount = (business->money * tax_rate) / 100;
-        
         // 最低運営資金（1000）未満の場合は徴収不可
-        if (business->money <= 1000) {
+        if (business->money <= BUSINESS_TAX_EXEMPTION) {
             return false;
         }
         
+        // 税額を計算（切り捨て）
+        int64_t tax_amount = assessTax(business->money, BUSINESS_TAX_EXEMPTION);
+        
         business->addMoney(-tax_amount);
         addMoney(tax_amount);
         approval_rating -= 1.0f; // 徴税による承認率低下
         return true;
     }
 
-    bool implementPolicy(const std::string& policy, Business* target) {
-        if (!target) return false;
+    // 業種別の補助金額を設定する。コンパイル済みのルールは次に subsidyRules を呼んだときに作り直す
+    void setSubsidy(const std::string& sector, float amount) {
+        sector_subsidies[sector] = amount;
+        rules_stale = true;
+    }
+
+    const std::map<std::string, float>& subsidies() const { return sector_subsidies; }
 
+    // 生活支援の1人あたりの給付額（0 なら実施しない）と、給付を受けられる所持金の上限を設定する
+    void setRelief(int64_t amount, int64_t threshold) {
+        relief_amount = amount;
+        relief_threshold = threshold;
+        rules_stale = true;
+    }
+
+    int64_t reliefAmount() const { return relief_amount; }
+    int64_t reliefThreshold() const { return relief_threshold; }
+
+    // 業種ごとの補助金ルール（業種順）。設定が変わったときだけコンパイルし直し、それ以外は前回のルールを返す
+    const std::vector<PolicyRule>& subsidyRules() {
+        refreshRules();
+        return subsidy_rules;
+    }
+
+    const PolicyRule& reliefRule() {
+        refreshRules();
+        return relief_rule;
+    }
+
+    // 政策名を型付きのルールにコンパイルする（未知の政策名は例外）
+    // subsidy の金額は sector_subsidies から対象業種の値を引く
+    PolicyRule compilePolicy(const std::string& policy, const std::string& sector = "") const {
+        PolicyRule rule;
+        rule.sector = sector;
         if (policy == "subsidy") {
-            auto subsidy = sector_subsidies.find(target->sector);
-            if (subsidy != sector_subsidies.end()) {
-                int amount = static_cast<int>(subsidy->second);
-                if (money >= amount) {
-                    target->addMoney(amount);
-                    addMoney(-amount);
-                    policies.push_back(policy);
-                    approval_rating += 5.0f; // 補助金政策による即時の承認率上昇
-                    return true;
-                }
+            rule.type = PolicyType::SUBSIDY;
+            auto subsidy = sector_subsidies.find(sector);
+            if (subsidy == sector_subsidies.end()) {
+                throw std::invalid_argument("No subsidy configured for sector: " + sector);
             }
+            rule.subsidy_amount = static_cast<int>(subsidy->second);
+        } else if (policy == "price_control") {
+            rule.type = PolicyType::PRICE_CONTROL;
+            rule.price_factor = 0.9f;
+        } else if (policy == "relief") {
+            rule.type = PolicyType::RELIEF;
+            rule.subsidy_amount = relief_amount;
+            rule.money_limit = relief_threshold;
+        } else {
+            throw std::invalid_argument("Unknown policy: " + policy);
         }
-        else if (policy == "price_control") {
-            if (target->price > 0) {
-                target->price = static_cast<int>(target->price * 0.9);
-                policies.push_back(policy);
-                approval_rating += 3.0f; // 価格統制による即時の承認率上昇
-                return true;
+        return rule;
+    }
+
+    // コンパイル済みのルールを1社に適用する
+    bool applyPolicy(const PolicyRule& rule, Business& target) {
+        switch (rule.type) {
+        case PolicyType::SUBSIDY:
+            if (money < rule.subsidy_amount) return false;
+            target.addMoney(rule.subsidy_amount);
+            addMoney(-rule.subsidy_amount);
+            approval_rating += 5.0f; // 補助金政策による即時の承認率上昇
+            break;
+        case PolicyType::PRICE_CONTROL:
+            if (target.price <= 0) return false;
+            target.price = static_cast<int>(target.price * rule.price_factor);
+            approval_rating += 3.0f; // 価格統制による即時の承認率上昇
+            break;
+        default:
+            return false;
+        }
+        policy_history.record(rule.type);
+        return true;
+    }
+
+    // コンパイル済みのルールを対象業種の全企業に一括適用し、適用件数を返す
+    // 業種索引から対象企業だけを1回走査する（業種が空のルールは全企業が対象）
+    size_t applyPolicy(const PolicyRule& rule, std::vector<Business>& businesses,
+                       const SectorIndex& index) {
+        size_t applied = 0;
+        if (rule.sector.empty()) {
+            for (auto& business : businesses) {
+                if (applyPolicy(rule, business)) ++applied;
             }
+            return applied;
+        }
+        for (size_t b : index.businessesIn(rule.sector)) {
+            if (applyPolicy(rule, businesses[b])) ++applied;
+        }
+        return applied;
+    }
+
+    // 生活支援のルールを候補の住民（people の添字、昇順）に適用し、給付した人数を返す
+    // 対象は病気で所持金が上限未満の（職業の指定があればその職業の）住民。候補はそれ以外を含んでいてもよく、
+    // 大きな世界では呼び出し側（World::applyRelief）が属性索引で病気と職業の集合の積に絞ってから渡す
+    // 政府の資金が給付額を下回ったらそこで打ち切る
+    size_t grantRelief(const PolicyRule& rule, std::vector<Person>& people, const std::vector<size_t>& candidates) {
+        if (rule.type != PolicyType::RELIEF || rule.subsidy_amount <= 0) return 0;
+        size_t applied = 0;
+        for (size_t i : candidates) {
+            const Person& person = people.at(i);
+            if (person.health_status != HealthStatus::SICK || person.money >= rule.money_limit) continue;
+            if (!rule.sector.empty() && person.job != rule.sector) continue;
+            if (money < rule.subsidy_amount) break;
+            people[i].addMoney(rule.subsidy_amount);
+            addMoney(-rule.subsidy_amount);
+            approval_rating += 1.0f; // 給付による承認率上昇
+            ++applied;
+        }
+        policy_history.record(rule.type, static_cast<int64_t>(applied));
+        return applied;
+    }
+
+    bool implementPolicy(const std::string& policy, Business* target) {
+        if (!target) return false;
+        try {
+            return applyPolicy(compilePolicy(policy, target->sector), *target);
+        } catch (const std::invalid_argument&) {
+            return false;  // 未知の政策、または補助金が設定されていない業種
         }
-        return false;
     }
 
     void updateApprovalRating() {
@@ -88,6 +231,25 @@ public:
         if (approval_rating > 100.0f) approval_rating = 100.0f;
         if (approval_rating < 0.0f) approval_rating = 0.0f;
     }
+
+private:
+    std::map<std::string, float> sector_subsidies;
+    int64_t relief_amount;
+    int64_t relief_threshold;
+
+    // コンパイル済みのルール（setSubsidy・setRelief で古くなる）
+    std::vector<PolicyRule> subsidy_rules;
+    PolicyRule relief_rule;
+    bool rules_stale = true;
+
+    void refreshRules() {
+        if (!rules_stale) return;
+        subsidy_rules.clear();
+        subsidy_rules.reserve(sector_subsidies.size());
+        for (const auto& subsidy : sector_subsidies) subsidy_rules.push_back(compilePolicy("subsidy", subsidy.first));
+        relief_rule = compilePolicy("relief");
+        rules_stale = false;
+    }
 };
 
 #endif // GOVERNMENT_H
\ No newline at end of file
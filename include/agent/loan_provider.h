@@ -2,16 +2,42 @@
 #ifndef LOAN_PROVIDER_H
 #define LOAN_PROVIDER_H
 
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "agent.h"
+#include "person.h"
 #include "../market/loan.h"
 
+// 一括融資審査の結果
+struct OriginationReport {
+    size_t approved = 0;
+    size_t rejected = 0;
+    int64_t capital_lent = 0;
+    std::vector<size_t> approved_indices;  // 承認された借り手の添字（審査スコア順）
+    std::vector<int64_t> approved_loans;   // approved_indices と同じ順の融資番号
+};
+
 class LoanProvider : public Agent {
 public:
     float base_interest_rate;
+    float max_risk_premium;    // スコア0の借り手に上乗せする金利
+    float min_credit_score;    // これ未満のスコアは審査落ち（0.0 - 1.0）
+    int32_t loan_term_days;    // 融資期間（日数）
+    // 未清算の融資。満期に返済または不履行になった融資は closeLoan で取り除く（並びは保証しない）
+    // 融資は loan_id で引く。添字は取り除くたびに変わる
     std::vector<Loan> active_loans;
+    int64_t next_loan_id = 1;  // 次に振る融資番号
 
-    LoanProvider() : base_interest_rate(0.05f) {}
+    LoanProvider() :
+        base_interest_rate(0.05f),
+        max_risk_premium(0.15f),
+        min_credit_score(0.2f),
+        loan_term_days(30)
+    {}
 
     bool provideLoan(Agent* borrower, int64_t amount) {
         if (!borrower || amount <= 0) return false;
@@ -22,13 +48,137 @@ public:
         loan.borrower_id = borrower->id;
         loan.amount = amount;
         loan.interest_rate = base_interest_rate;
-        loan.days_remaining = 30;  // 30日の融資期間
+        loan.days_remaining = loan_term_days;
         loan.defaulted = false;
 
         money -= amount;
         borrower->addMoney(amount);
-        active_loans.push_back(loan);
+        openLoan(loan);
+
+        return true;
+    }
+
+    // 融資番号で未清算の融資を引く。清算済み・未発行なら nullptr
+    Loan* findLoan(int64_t loan_id) {
+        const auto it = loan_position.find(loan_id);
+        return it != loan_position.end() ? &active_loans[it->second] : nullptr;
+    }
+
+    // 融資を未清算の一覧から取り除く（末尾の融資をその位置に移す）。未清算でなければ false
+    bool closeLoan(int64_t loan_id) {
+        const auto it = loan_position.find(loan_id);
+        if (it == loan_position.end()) return false;
+        const size_t position = it->second;
+        loan_position.erase(it);
+        if (position + 1 != active_loans.size()) {
+            active_loans[position] = std::move(active_loans.back());
+            loan_position[active_loans[position].loan_id] = position;
+        }
+        active_loans.pop_back();
+        return true;
+    }
+
+    // 融資番号から位置への索引を active_loans から作り直す（保存形式から復元した後に呼ぶ）
+    void reindexLoans() {
+        loan_position.clear();
+        loan_position.reserve(active_loans.size());
+        for (size_t i = 0; i < active_loans.size(); ++i) {
+            const int64_t loan_id = active_loans[i].loan_id;
+            if (loan_id <= 0 || loan_id >= next_loan_id || !loan_position.emplace(loan_id, i).second) {
+                throw std::runtime_error("Invalid or duplicate loan id " + std::to_string(loan_id));
+            }
+        }
+    }
+
+    // 申込者全員の信用スコア（0.0 - 1.0）を一括で計算する
+    // 手元資金による返済余力、期間中の純収入による返済余力、リスク選好度の低さを加重平均する
+    // applicants は people の添字
+    std::vector<float> scoreApplicants(const std::vector<Person>& people,
+                                       const std::vector<size_t>& applicants,
+                                       int64_t amount) const {
+        const size_t n = applicants.size();
+        std::vector<float> money(n), net_income(n), risk(n), score(n);
+        for (size_t i = 0; i < n; ++i) {
+            const Person& person = people.at(applicants[i]);
+            money[i] = static_cast<float>(person.money);
+            net_income[i] = static_cast<float>(person.daily_income) -
+                            static_cast<float>(person.daily_expense);
+            risk[i] = static_cast<float>(person.risk_tolerance);
+        }
+
+        // 列ごとの単純な算術のみのループ（自動ベクトル化の対象）
+        const float inv_amount = 1.0f / static_cast<float>(std::max<int64_t>(amount, 1));
+        const float term = static_cast<float>(loan_term_days);
+        for (size_t i = 0; i < n; ++i) {
+            const float liquidity = std::min(std::max(money[i] * inv_amount, 0.0f), 1.0f);
+            const float coverage =
+                std::min(std::max(net_income[i] * term * inv_amount, 0.0f), 1.0f);
+            const float prudence = 1.0f - risk[i] * 0.01f;
+            score[i] = 0.3f * liquidity + 0.5f * coverage + 0.2f * prudence;
+        }
+        return score;
+    }
+
+    // スコアに応じたリスク調整後の金利
+    float priceRisk(float score) const {
+        const float clamped = std::min(std::max(score, 0.0f), 1.0f);
+        return base_interest_rate + max_risk_premium * (1.0f - clamped);
+    }
+
+    // 申込者を一括審査して融資する
+    // スコアの高い順に並べ、最低スコアを満たし手元資金が尽きるまで amount ずつ貸し付ける
+    OriginationReport originateLoans(std::vector<Person>& people,
+                                     const std::vector<size_t>& applicants, int64_t amount) {
+        OriginationReport report;
+        if (amount <= 0) {
+            report.rejected = applicants.size();
+            return report;
+        }
+
+        const std::vector<float> score = scoreApplicants(people, applicants, amount);
+        std::vector<size_t> order(applicants.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&score](size_t a, size_t b) { return score[a] > score[b]; });
+
+        for (size_t i : order) {
+            if (score[i] < min_credit_score || money < amount) {
+                ++report.rejected;
+                continue;
+            }
+            Person& borrower = people[applicants[i]];
+            Loan loan;
+            loan.lender_id = id;
+            loan.borrower_id = borrower.id;
+            loan.amount = amount;
+            loan.interest_rate = priceRisk(score[i]);
+            loan.days_remaining = loan_term_days;
+            loan.defaulted = false;
 
+            money -= amount;
+            borrower.addMoney(amount);
+            const int64_t loan_id = openLoan(loan);
+
+            ++report.approved;
+            report.capital_lent += amount;
+            report.approved_indices.push_back(applicants[i]);
+            report.approved_loans.push_back(loan_id);
+        }
+        return report;
+    }
+
+    // 満期を迎えた融資を清算する。元本と利息を返せなければ債務不履行とする
+    // 清算済み・不履行済みの融資には何もしない。返済されたら true
+    bool settleLoan(Loan& loan, Agent& borrower) {
+        if (loan.defaulted || loan.days_remaining <= 0) return false;
+        loan.days_remaining = 0;
+        const int64_t due = loan.amount + static_cast<int64_t>(loan.amount * loan.interest_rate);
+        if (borrower.money < due) {
+            loan.defaulted = true;
+            return false;
+        }
+        borrower.addMoney(-due);
+        addMoney(due);
         return true;
     }
 
@@ -59,6 +209,16 @@ public:
     }
 
 private:
+    std::unordered_map<int64_t, size_t> loan_position;  // 融資番号 -> active_loans の位置
+
+    // 融資番号を振って未清算の一覧に加え、その番号を返す
+    int64_t openLoan(Loan loan) {
+        loan.loan_id = next_loan_id++;
+        loan_position.emplace(loan.loan_id, active_loans.size());
+        active_loans.push_back(loan);
+        return loan.loan_id;
+    }
+
     Agent* findBorrower(int64_t /*borrower_id*/) {
         // この実装は後で適切なものに置き換える必要がある
         return nullptr;
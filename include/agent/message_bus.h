@@ -0,0 +1,202 @@
+#pragma once
+#ifndef MESSAGE_BUS_H
+#define MESSAGE_BUS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "agent.h"
+
+// エージェント間メッセージ（取引・融資・サービスの申し込み）
+struct AgentMessage {
+    enum class Kind {
+        TRADE = 0,    // sender が receiver から item を購入
+        LOAN = 1,     // sender が receiver から融資を受ける
+        SERVICE = 2   // sender が receiver にサービスを提供（receiver が支払う）
+    };
+
+    Kind kind;
+    Agent* sender;
+    Agent* receiver;
+    std::string item;
+    int32_t quantity;
+    int64_t amount;         // 取引単価・融資額・サービス料金
+    float interest_rate;
+};
+
+// 決済結果の集計
+struct SettlementReport {
+    size_t accepted = 0;
+    size_t rejected = 0;
+    int64_t volume = 0;  // 移動した金額の合計
+};
+
+// エージェント間のメッセージバス
+// ティック中は各スレッドが自分専用のレーンに申し込みを積むだけで、相手の状態には触れない。
+// settle() で全レーンを集め、(相手ID, 送信者ID, 種類, 品目, 数量, 金額, 利率) で整列してから逐次適用するため、
+// スレッド数や実行順序に関係なく結果は決定的になる（エージェントIDが一意であること）。
+// レーンの登録順や各レーンに入る申し込みはスレッドの割り当てで変わるので、投稿順は並びに使わない。
+// 並びで区別できないのは中身がすべて同じ申し込みだけで、どちらを先に適用しても結果は同じ
+class MessageBus {
+public:
+    MessageBus() : bus_id(nextBusId()) {}
+
+    MessageBus(const MessageBus&) = delete;
+    MessageBus& operator=(const MessageBus&) = delete;
+
+    // Agent::directTrade に相当する申し込み（buyer が seller に支払う）
+    void proposeTrade(Agent* buyer, Agent* seller, const std::string& item, int quantity,
+                      int64_t price) {
+        post({AgentMessage::Kind::TRADE, buyer, seller, item, quantity, price, 0.0f});
+    }
+
+    // Agent::requestLoan に相当する申し込み（lender が borrower に貸す）
+    void proposeLoan(Agent* borrower, Agent* lender, int64_t amount, float interest_rate) {
+        post({AgentMessage::Kind::LOAN, borrower, lender, "", 1, amount, interest_rate});
+    }
+
+    // Agent::provideService に相当する申し込み（client が provider に支払う）
+    void proposeService(Agent* provider, Agent* client, const std::string& service,
+                        int64_t cost) {
+        post({AgentMessage::Kind::SERVICE, provider, client, service, 1, cost, 0.0f});
+    }
+
+    // 未決済のメッセージ数（投稿中のスレッドがない時点で呼ぶこと）
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t total = 0;
+        for (const auto& lane : lanes) total += lane->messages.size();
+        return total;
+    }
+
+    // 全レーンのメッセージを決定的な順序で適用し、レーンを空にする
+    // 申し込み側のスレッドがすべて投稿を終えた後（ティックの決済フェーズ）に呼ぶこと
+    SettlementReport settle() {
+        std::vector<AgentMessage> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t total = 0;
+            for (const auto& lane : lanes) total += lane->messages.size();
+            batch.reserve(total);
+            for (auto& lane : lanes) {
+                std::move(lane->messages.begin(), lane->messages.end(), std::back_inserter(batch));
+                lane->messages.clear();
+            }
+        }
+
+        std::sort(batch.begin(), batch.end(), [](const AgentMessage& a, const AgentMessage& b) {
+            const int64_t a_counterparty = a.receiver ? a.receiver->id : -1;
+            const int64_t b_counterparty = b.receiver ? b.receiver->id : -1;
+            if (a_counterparty != b_counterparty) return a_counterparty < b_counterparty;
+            const int64_t a_sender = a.sender ? a.sender->id : -1;
+            const int64_t b_sender = b.sender ? b.sender->id : -1;
+            if (a_sender != b_sender) return a_sender < b_sender;
+            if (a.kind != b.kind) return a.kind < b.kind;
+            if (a.item != b.item) return a.item < b.item;
+            if (a.quantity != b.quantity) return a.quantity < b.quantity;
+            if (a.amount != b.amount) return a.amount < b.amount;
+            return a.interest_rate < b.interest_rate;
+        });
+
+        SettlementReport report;
+        for (const auto& message : batch) {
+            const int64_t moved = apply(message);
+            if (moved < 0) {
+                ++report.rejected;
+            } else {
+                ++report.accepted;
+                report.volume += moved;
+            }
+        }
+        return report;
+    }
+
+private:
+    struct Lane {
+        std::vector<AgentMessage> messages;
+    };
+
+    const uint64_t bus_id;
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Lane>> lanes;
+    std::unordered_map<std::thread::id, Lane*> lane_of;  // 投稿したスレッド -> レーン
+
+    static uint64_t nextBusId() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    // 呼び出しスレッド専用のレーン
+    // スレッドごとに直前に使ったバスのレーンだけを覚え、別のバスに投稿したときはロックしてバス側の表から引き直す。
+    // バスの番号は使い回さないので、破棄済みのバスのレーンを覚えていても引かれることはなく、表も増え続けない
+    Lane& localLane() {
+        struct Cached {
+            uint64_t bus_id = 0;
+            Lane* lane = nullptr;
+        };
+        thread_local Cached cached;
+        if (cached.bus_id == bus_id) return *cached.lane;
+        std::lock_guard<std::mutex> lock(mutex);
+        Lane*& lane = lane_of[std::this_thread::get_id()];
+        if (!lane) {
+            lanes.push_back(std::make_unique<Lane>());
+            lane = lanes.back().get();
+        }
+        cached = Cached{bus_id, lane};
+        return *lane;
+    }
+
+    void post(AgentMessage message) {
+        localLane().messages.push_back(std::move(message));
+    }
+
+    // 1件を適用し、移動した金額を返す（不成立なら -1）
+    static int64_t apply(const AgentMessage& message) {
+        Agent* sender = message.sender;
+        Agent* receiver = message.receiver;
+        if (!sender || !sender->canInteractWith(receiver)) return -1;
+
+        Agent* payer = nullptr;
+        Agent* payee = nullptr;
+        int64_t total = 0;
+        switch (message.kind) {
+        case AgentMessage::Kind::TRADE:
+            if (message.quantity <= 0 || message.amount < 0) return -1;
+            payer = sender;
+            payee = receiver;
+            total = message.amount * message.quantity;
+            break;
+        case AgentMessage::Kind::LOAN:
+            if (message.amount <= 0 || message.interest_rate < 0) return -1;
+            payer = receiver;
+            payee = sender;
+            total = message.amount;
+            break;
+        case AgentMessage::Kind::SERVICE:
+            if (message.amount < 0) return -1;
+            payer = receiver;
+            payee = sender;
+            total = message.amount;
+            break;
+        }
+
+        if (payer->money < total) return -1;
+        try {
+            payee->addMoney(total);
+        } catch (const std::exception&) {
+            return -1;
+        }
+        payer->addMoney(-total);
+        return total;
+    }
+};
+
+#endif // MESSAGE_BUS_H
@@ -0,0 +1,273 @@
+#pragma once
+#ifndef BUSINESS_DYNAMICS_H
+#define BUSINESS_DYNAMICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "business.h"
+#include "../system/thread_pool.h"
+
+struct PricingConfig {
+    int64_t wage = 10;            // 従業員1人1日あたりの費用
+    float target_margin = 0.2f;   // 目標利益率
+    float adjust_rate = 0.1f;     // 目標価格へ1日に寄せる割合
+    float competition = 0.05f;    // 同じ区分の平均売価へ1日に寄せる割合
+};
+
+struct BusinessTickReport {
+    int64_t revenue = 0;   // 全企業の売上合計
+    size_t segments = 0;   // 区分（業種 × 製品）の数
+};
+
+// 企業の売上・市場シェア・利益率・価格を毎ティック更新する
+// 企業を（業種, 製品）で並べ替えた順序と区分の境界を作っておき、区分ごとの集計（区分内の総和）と
+// 各企業の更新を区分単位で並列に1回で済ませる。企業どうしの総当たりの比較はしない。
+// 販売数量は allocateSales で製品ごとに安い出品から割り当て、売上は市場の約定価格で数える。
+// 各区分の中では:
+//   market_share  = 売上 / 区分の売上合計（%、売上がなければ均等割り）
+//   profit_margin = (価格 - 単位費用) / 価格（0〜1）。単位費用は人件費を ProductionGraph の産出量で割った額
+//   price         = 目標利益率の価格と区分の平均売価（売上で重み付け）へ少しずつ寄せる
+// 業種・製品が変わったときや企業数が変わったときは rebuild で並びを作り直す（企業数の変化は自動で検出する）
+class BusinessDynamics {
+public:
+    void rebuild(const std::vector<Business>& businesses) {
+        std::map<std::string, int32_t> sector_ids;
+        std::map<std::string, int32_t> product_ids;
+        for (const auto& business : businesses) {
+            sector_ids.emplace(business.sector, 0);
+            product_ids.emplace(business.product, 0);
+        }
+        int32_t next = 0;
+        for (auto& entry : sector_ids) entry.second = next++;
+        next = 0;
+        product_names.clear();
+        for (auto& entry : product_ids) {
+            entry.second = next++;
+            product_names.push_back(entry.first);
+        }
+
+        std::vector<std::pair<int64_t, uint32_t>> keys(businesses.size());
+        product_of.resize(businesses.size());
+        for (size_t b = 0; b < businesses.size(); ++b) {
+            const int32_t sector = sector_ids[businesses[b].sector];
+            const int32_t product = product_ids[businesses[b].product];
+            product_of[b] = product;
+            keys[b] = {(static_cast<int64_t>(sector) << 32) | product, static_cast<uint32_t>(b)};
+        }
+        std::sort(keys.begin(), keys.end());
+
+        order.resize(businesses.size());
+        segment_offsets.clear();
+        for (size_t k = 0; k < keys.size(); ++k) {
+            order[k] = keys[k].second;
+            if (k == 0 || keys[k].first != keys[k - 1].first) segment_offsets.push_back(k);
+        }
+        segment_offsets.push_back(keys.size());
+        revenues.assign(businesses.size(), 0);
+        indexed = businesses.size();
+    }
+
+    // 企業数が変わっていれば並びを作り直す
+    void prepare(const std::vector<Business>& businesses) {
+        if (indexed != businesses.size() || segment_offsets.empty()) rebuild(businesses);
+    }
+
+    // 製品 p のその日の販売数量 sold[p] を、その日に出品した企業（listed[b] は企業 b の出品数量）へ
+    // 売値の安い順に割り当てる。同じ売値の企業どうしは出品数量に比例して分け、端数は添字順に1つずつ配る。
+    // 出品の合計より多く売れた分は前日までの売れ残りから出たものとして誰にも割り当てない
+    std::vector<int64_t> allocateSales(const std::vector<Business>& businesses, const std::vector<int64_t>& listed,
+                                       const std::vector<int64_t>& sold) {
+        prepare(businesses);
+        if (listed.size() != businesses.size()) {
+            throw std::invalid_argument("listed size does not match businesses");
+        }
+        if (sold.size() != product_names.size()) {
+            throw std::invalid_argument("sold size does not match products");
+        }
+        std::vector<uint32_t> by_price(businesses.size());
+        for (size_t b = 0; b < by_price.size(); ++b) by_price[b] = static_cast<uint32_t>(b);
+        std::sort(by_price.begin(), by_price.end(), [&](uint32_t a, uint32_t b) {
+            if (product_of[a] != product_of[b]) return product_of[a] < product_of[b];
+            if (businesses[a].price != businesses[b].price) return businesses[a].price < businesses[b].price;
+            return a < b;
+        });
+
+        std::vector<int64_t> units(businesses.size(), 0);
+        std::vector<int64_t> left(sold.begin(), sold.end());
+        for (size_t begin = 0; begin < by_price.size();) {
+            // 同じ製品・同じ売値の企業の範囲 [begin, end)
+            const uint32_t first = by_price[begin];
+            size_t end = begin + 1;
+            int64_t offered = std::max<int64_t>(0, listed[first]);
+            while (end < by_price.size() && product_of[by_price[end]] == product_of[first] &&
+                   businesses[by_price[end]].price == businesses[first].price) {
+                offered += std::max<int64_t>(0, listed[by_price[end]]);
+                ++end;
+            }
+            int64_t& remaining = left[product_of[first]];
+            const int64_t filled = std::min(std::max<int64_t>(0, remaining), offered);
+            if (filled > 0) {
+                int64_t given = 0;
+                for (size_t k = begin; k < end; ++k) {
+                    const uint32_t b = by_price[k];
+                    units[b] = std::max<int64_t>(0, listed[b]) * filled / offered;
+                    given += units[b];
+                }
+                for (size_t k = begin; k < end && given < filled; ++k) {
+                    const uint32_t b = by_price[k];
+                    if (units[b] < listed[b]) {
+                        ++units[b];
+                        ++given;
+                    }
+                }
+                remaining -= filled;
+            }
+            begin = end;
+        }
+        return units;
+    }
+
+    // units_sold[b] は企業 b のその日の販売数量（空なら全社0）
+    // output[b] は企業 b のその日の産出量（ProductionGraph::plannedOutput など。空なら daily_production を使う）
+    // clearing_prices[p] は製品 p の市場の約定価格で、売上 = 販売数量 × 約定価格（空なら各社の売値で数える）
+    BusinessTickReport update(std::vector<Business>& businesses, const std::vector<int64_t>& units_sold,
+                              const std::vector<int32_t>& output, const PricingConfig& config = {},
+                              ThreadPool* pool = nullptr, const std::vector<int64_t>& clearing_prices = {}) {
+        if (config.target_margin < 0.0f || config.target_margin >= 1.0f) {
+            throw std::invalid_argument("Target margin must be within [0, 1)");
+        }
+        prepare(businesses);
+        if (!units_sold.empty() && units_sold.size() != businesses.size()) {
+            throw std::invalid_argument("units_sold size does not match businesses");
+        }
+        if (!output.empty() && output.size() != businesses.size()) {
+            throw std::invalid_argument("output size does not match businesses");
+        }
+        if (!clearing_prices.empty() && clearing_prices.size() != product_names.size()) {
+            throw std::invalid_argument("clearing_prices size does not match products");
+        }
+
+        // 企業数がほぼ均等になるように区分をまとめて並列の単位にする
+        const size_t segments = segmentCount();
+        const size_t parts = pool ? pool->size() * 4 : 1;
+        const size_t target = std::max<size_t>(1, (businesses.size() + parts - 1) / parts);
+        std::vector<size_t> task_starts;
+        for (size_t s = 0; s < segments; ++s) {
+            if (task_starts.empty() ||
+                segment_offsets[s] - segment_offsets[task_starts.back()] >= target) {
+                task_starts.push_back(s);
+            }
+        }
+        task_starts.push_back(segments);
+
+        std::vector<int64_t> task_revenue(task_starts.size() - 1, 0);
+        auto runTasks = [&](size_t lo, size_t hi) {
+            for (size_t t = lo; t < hi; ++t) {
+                for (size_t s = task_starts[t]; s < task_starts[t + 1]; ++s) {
+                    task_revenue[t] += updateSegment(s, businesses, units_sold, output, clearing_prices, config);
+                }
+            }
+        };
+        if (pool && task_revenue.size() > 1) {
+            pool->parallelFor(0, task_revenue.size(), runTasks, 1);
+        } else {
+            runTasks(0, task_revenue.size());
+        }
+
+        BusinessTickReport report;
+        report.segments = segments;
+        for (int64_t revenue : task_revenue) report.revenue += revenue;
+        return report;
+    }
+
+    size_t segmentCount() const { return segment_offsets.empty() ? 0 : segment_offsets.size() - 1; }
+
+    // 区分 s に属する企業の添字（業種・製品順の並びの一部）
+    std::vector<uint32_t> segment(size_t s) const {
+        return std::vector<uint32_t>(order.begin() + static_cast<std::ptrdiff_t>(segment_offsets.at(s)),
+                                     order.begin() + static_cast<std::ptrdiff_t>(segment_offsets.at(s + 1)));
+    }
+
+    // 直近の update での各企業の売上
+    const std::vector<int64_t>& revenue() const { return revenues; }
+
+    // 製品名（名前順）と各企業の製品番号
+    const std::vector<std::string>& products() const { return product_names; }
+    int32_t productOf(size_t business) const { return product_of.at(business); }
+
+private:
+    std::vector<uint32_t> order;         // (業種, 製品, 添字) の順に並べた企業
+    std::vector<size_t> segment_offsets; // order 上の区分の境界
+    std::vector<int64_t> revenues;
+    std::vector<std::string> product_names;
+    std::vector<int32_t> product_of;
+    size_t indexed = 0;
+
+    // 1単位あたりの人件費。産出量が0なら1単位とみなす
+    static double unitCost(const Business& business, int32_t output, const PricingConfig& config) {
+        return static_cast<double>(config.wage) * business.workers / std::max(output, 1);
+    }
+
+    // 産出量の列がなければ daily_production（未設定なら従業員1人1日1単位）を使う
+    static int32_t outputOf(const Business& business, size_t b, const std::vector<int32_t>& output) {
+        if (!output.empty()) return output[b];
+        return business.daily_production > 0 ? business.daily_production : business.workers;
+    }
+
+    // 区分 s の集計と更新。区分の売上合計を返す
+    int64_t updateSegment(size_t s, std::vector<Business>& businesses, const std::vector<int64_t>& units_sold,
+                          const std::vector<int32_t>& output, const std::vector<int64_t>& clearing_prices,
+                          const PricingConfig& config) {
+        const size_t begin = segment_offsets[s];
+        const size_t end = segment_offsets[s + 1];
+
+        // 区分内の総和
+        int64_t total_revenue = 0;
+        int64_t total_units = 0;
+        int64_t price_sum = 0;
+        for (size_t k = begin; k < end; ++k) {
+            const uint32_t b = order[k];
+            const int64_t units = units_sold.empty() ? 0 : units_sold[b];
+            const int64_t price = clearing_prices.empty() ? businesses[b].price : clearing_prices[product_of[b]];
+            revenues[b] = units * price;
+            total_revenue += revenues[b];
+            total_units += units;
+            price_sum += businesses[b].price;
+        }
+        const int64_t count = static_cast<int64_t>(end - begin);
+        const double mean_price = total_units > 0 ? static_cast<double>(total_revenue) / total_units
+                                                  : static_cast<double>(price_sum) / count;
+
+        // 各企業の更新
+        for (size_t k = begin; k < end; ++k) {
+            Business& business = businesses[order[k]];
+            const int64_t revenue = revenues[order[k]];
+            const int32_t share = total_revenue > 0
+                                      ? static_cast<int32_t>(std::llround(100.0 * revenue / total_revenue))
+                                      : static_cast<int32_t>(100 / count);
+            business.setMarketShare(std::min(100, std::max(0, share)));
+
+            const double cost = unitCost(business, outputOf(business, order[k], output), config);
+            const double price = static_cast<double>(business.price);
+            const double margin = price > 0.0 ? (price - cost) / price : 0.0;
+            business.setProfitMargin(static_cast<float>(std::min(1.0, std::max(0.0, margin))));
+
+            const double target = cost / (1.0 - config.target_margin);
+            const double delta = config.adjust_rate * (target - price) + config.competition * (mean_price - price);
+            int64_t step = std::llround(delta);
+            // 調整幅が1未満に丸められても、寄せ先（目標価格と平均売価の重み付き平均）が半単位より遠ければ1だけ動かす
+            const double pull = config.adjust_rate + config.competition;
+            if (step == 0 && pull > 0.0 && std::abs(delta / pull) > 0.5) step = delta > 0.0 ? 1 : -1;
+            business.setPrice(std::max<int64_t>(1, business.price + step));
+        }
+        return total_revenue;
+    }
+};
+
+#endif // BUSINESS_DYNAMICS_H
@@ -0,0 +1,166 @@
+#pragma once
+#ifndef GOODS_CATALOG_H
+#define GOODS_CATALOG_H
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using GoodId = uint16_t;
+
+// 組み込み商品の定義（名前と業種）
+struct BuiltinGood {
+    std::string_view name;
+    std::string_view sector;
+};
+
+// 組み込み商品名の完全ハッシュ（コンパイル時に衝突しない seed を探す）
+class GoodsHash {
+public:
+    static constexpr uint32_t hash(std::string_view name, uint32_t seed) {
+        uint32_t h = 2166136261u ^ seed;
+        for (char c : name) {
+            h ^= static_cast<uint8_t>(c);
+            h *= 16777619u;
+        }
+        return h ^ (h >> 15);
+    }
+
+    template <size_t N, size_t TABLE_SIZE>
+    static constexpr bool isPerfect(const std::array<BuiltinGood, N>& goods, uint32_t seed) {
+        std::array<bool, TABLE_SIZE> used{};
+        for (const auto& good : goods) {
+            const size_t slot = hash(good.name, seed) & (TABLE_SIZE - 1);
+            if (used[slot]) return false;
+            used[slot] = true;
+        }
+        return true;
+    }
+
+    template <size_t N, size_t TABLE_SIZE>
+    static constexpr uint32_t findSeed(const std::array<BuiltinGood, N>& goods) {
+        for (uint32_t seed = 0; seed < 100000; ++seed) {
+            if (isPerfect<N, TABLE_SIZE>(goods, seed)) return seed;
+        }
+        throw std::logic_error("No perfect hash seed for built-in goods");
+    }
+
+    template <size_t N, size_t TABLE_SIZE>
+    static constexpr std::array<GoodId, TABLE_SIZE> buildTable(const std::array<BuiltinGood, N>& goods,
+                                                               uint32_t seed, GoodId empty) {
+        std::array<GoodId, TABLE_SIZE> table{};
+        for (auto& slot : table) slot = empty;
+        for (size_t i = 0; i < N; ++i) {
+            table[hash(goods[i].name, seed) & (TABLE_SIZE - 1)] = static_cast<GoodId>(i);
+        }
+        return table;
+    }
+};
+
+// 組み込み商品のカタログ
+// 商品はここで一度だけ宣言し、名前から GoodId への対応はコンパイル時の完全ハッシュで引く。
+// 定数式の中で id("小麦") と書けば文字列処理はコンパイル時に済み、未知の名前はコンパイルエラーになる
+class GoodsCatalog {
+public:
+    static constexpr std::array<BuiltinGood, 5> BUILTIN = {{
+        {"小麦", "農業"},
+        {"パン", "製造業"},
+        {"鉱石", "鉱業"},
+        {"鉄", "製造業"},
+        {"道具", "製造業"},
+    }};
+    static constexpr size_t BUILTIN_COUNT = BUILTIN.size();
+    static constexpr GoodId NONE = UINT16_MAX;
+
+    static constexpr size_t TABLE_SIZE = 8;  // BUILTIN_COUNT 以上の2の冪
+    static_assert((TABLE_SIZE & (TABLE_SIZE - 1)) == 0 && TABLE_SIZE >= BUILTIN_COUNT,
+                  "TABLE_SIZE must be a power of two covering all built-in goods");
+    static constexpr uint32_t SEED = GoodsHash::findSeed<BUILTIN_COUNT, TABLE_SIZE>(BUILTIN);
+    static constexpr std::array<GoodId, TABLE_SIZE> TABLE =
+        GoodsHash::buildTable<BUILTIN_COUNT, TABLE_SIZE>(BUILTIN, SEED, NONE);
+
+    // 組み込み商品なら GoodId、そうでなければ NONE
+    static constexpr GoodId find(std::string_view name) {
+        const GoodId id = TABLE[GoodsHash::hash(name, SEED) & (TABLE_SIZE - 1)];
+        return id != NONE && BUILTIN[id].name == name ? id : NONE;
+    }
+
+    // 組み込み商品の GoodId（未知の名前は例外。定数式ではコンパイルエラー）
+    static constexpr GoodId id(std::string_view name) {
+        const GoodId found = find(name);
+        if (found == NONE) throw std::invalid_argument("Unknown built-in good");
+        return found;
+    }
+
+    static constexpr bool isBuiltin(GoodId id) { return id < BUILTIN_COUNT; }
+    static constexpr std::string_view name(GoodId id) { return BUILTIN[id].name; }
+    static constexpr std::string_view sector(GoodId id) { return BUILTIN[id].sector; }
+
+    // Market などの std::string キーとして使う名前（起動後に一度だけ作る）
+    static const std::string& key(GoodId id) {
+        static const std::array<std::string, BUILTIN_COUNT> keys = [] {
+            std::array<std::string, BUILTIN_COUNT> built;
+            for (size_t i = 0; i < BUILTIN_COUNT; ++i) built[i] = std::string(BUILTIN[i].name);
+            return built;
+        }();
+        return keys.at(id);
+    }
+};
+
+// コードから名前で参照する組み込み商品
+class Goods {
+public:
+    static constexpr GoodId WHEAT = GoodsCatalog::id("小麦");
+    static constexpr GoodId BREAD = GoodsCatalog::id("パン");
+    static constexpr GoodId ORE = GoodsCatalog::id("鉱石");
+    static constexpr GoodId IRON = GoodsCatalog::id("鉄");
+    static constexpr GoodId TOOL = GoodsCatalog::id("道具");
+};
+
+// 実行時に追加される商品も含めた登録簿
+// 組み込み商品はカタログと同じ GoodId、それ以外は登録順に BUILTIN_COUNT から番号を振る
+class GoodsRegistry {
+public:
+    GoodId intern(const std::string& name) {
+        const GoodId builtin = GoodsCatalog::find(name);
+        if (builtin != GoodsCatalog::NONE) return builtin;
+        auto it = custom_ids.find(name);
+        if (it != custom_ids.end()) return it->second;
+        if (GoodsCatalog::BUILTIN_COUNT + custom_names.size() >= GoodsCatalog::NONE) {
+            throw std::length_error("Too many goods");
+        }
+        const GoodId id = static_cast<GoodId>(GoodsCatalog::BUILTIN_COUNT + custom_names.size());
+        custom_ids.emplace(name, id);
+        custom_names.push_back(name);
+        return id;
+    }
+
+    // 登録済みなら GoodId、未登録なら NONE
+    GoodId find(const std::string& name) const {
+        const GoodId builtin = GoodsCatalog::find(name);
+        if (builtin != GoodsCatalog::NONE) return builtin;
+        auto it = custom_ids.find(name);
+        return it != custom_ids.end() ? it->second : GoodsCatalog::NONE;
+    }
+
+    const std::string& name(GoodId id) const {
+        if (GoodsCatalog::isBuiltin(id)) return GoodsCatalog::key(id);
+        const size_t custom = static_cast<size_t>(id) - GoodsCatalog::BUILTIN_COUNT;
+        if (custom >= custom_names.size()) {
+            throw std::out_of_range("Unknown good id");
+        }
+        return custom_names[custom];
+    }
+
+    size_t size() const { return GoodsCatalog::BUILTIN_COUNT + custom_names.size(); }
+
+private:
+    std::unordered_map<std::string, GoodId> custom_ids;
+    std::vector<std::string> custom_names;
+};
+
+#endif // GOODS_CATALOG_H
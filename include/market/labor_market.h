@@ -0,0 +1,251 @@
+#pragma once
+#ifndef LABOR_MARKET_H
+#define LABOR_MARKET_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "business.h"
+#include "../agent/message_bus.h"
+#include "../agent/person.h"
+#include "../system/thread_pool.h"
+
+// 労働市場
+// 求職者（Person の添字）と求人（Business の添字）を職種ごとのバケットに集め、
+// 賃金の高い求人から順に留保賃金の低い求職者と結び付ける。
+// 雇用関係は「企業 → 従業員の添字」の索引として保持し、給与はメッセージバスに積んで一括で決済する
+class LaborMarket {
+public:
+    static constexpr int64_t NO_EMPLOYER = -1;
+
+    // 求人を出す（同一企業が複数回出してもよい）
+    void postOpening(size_t business, const std::string& occupation, int64_t wage, int32_t count) {
+        if (wage <= 0) {
+            throw std::invalid_argument("Wage offer must be positive");
+        }
+        if (count <= 0) return;
+        bucket(occupation).openings.push_back({business, wage, count});
+    }
+
+    // 求職登録（既に雇用されている者は無視）
+    void seekJob(size_t person, const std::string& occupation, int64_t reservation_wage) {
+        if (reservation_wage < 0) {
+            throw std::invalid_argument("Reservation wage cannot be negative");
+        }
+        if (employerOf(person) != NO_EMPLOYER) return;
+        bucket(occupation).seekers.push_back({person, reservation_wage});
+    }
+
+    // 無職の全員を Person::job の職種で求職登録する（留保賃金は日々の支出）
+    // indices を渡せばその住民だけを登録する
+    void collectSeekers(const std::vector<Person>& people, const std::vector<size_t>* indices = nullptr) {
+        const size_t count = indices ? indices->size() : people.size();
+        for (size_t k = 0; k < count; ++k) {
+            const size_t i = indices ? (*indices)[k] : k;
+            const Person& person = people[i];
+            if (person.job.empty() || person.health_status == HealthStatus::DEAD) continue;
+            seekJob(i, person.job, person.daily_expense);
+        }
+    }
+
+    // 職種ごとに求人を賃金降順、求職者を留保賃金昇順に並べて貪欲に結び付ける
+    // 全体の計算量は O(n log n)。成立した雇用数を返し、登録済みの求人・求職は破棄する
+    size_t match(std::vector<Business>& businesses) {
+        size_t hires = 0;
+        for (auto& [occupation, b] : buckets) {
+            std::stable_sort(b.openings.begin(), b.openings.end(),
+                             [](const Opening& x, const Opening& y) { return x.wage > y.wage; });
+            std::stable_sort(b.seekers.begin(), b.seekers.end(),
+                             [](const Seeker& x, const Seeker& y) {
+                                 return x.reservation_wage < y.reservation_wage;
+                             });
+
+            size_t s = 0;
+            for (auto& opening : b.openings) {
+                while (opening.count > 0 && s < b.seekers.size()) {
+                    const Seeker& seeker = b.seekers[s];
+                    // 最も安い求職者でも折り合わなければ、これ以降の（より安い）求人も成立しない
+                    if (seeker.reservation_wage > opening.wage) break;
+                    ++s;
+                    if (employerOf(seeker.person) != NO_EMPLOYER) continue;  // 重複登録
+                    hire(seeker.person, opening.business, opening.wage, businesses);
+                    --opening.count;
+                    ++hires;
+                }
+                if (s < b.seekers.size() && b.seekers[s].reservation_wage > opening.wage) break;
+            }
+            b.openings.clear();
+            b.seekers.clear();
+        }
+        return hires;
+    }
+
+    // 雇用関係を解消する
+    void release(size_t person, std::vector<Business>& businesses) {
+        const int64_t employer = employerOf(person);
+        if (employer == NO_EMPLOYER) return;
+
+        auto& staff = employees[employer];
+        const size_t pos = position[person];
+        staff[pos] = staff.back();
+        position[staff[pos]] = pos;
+        staff.pop_back();
+
+        employer_of[person] = NO_EMPLOYER;
+        wage_of[person] = 0;
+        businesses[employer].workers = static_cast<int32_t>(staff.size());
+    }
+
+    // 全企業の給与を一括で支払う
+    // 支払い能力のない企業は支払いを行わず、その従業員を全員解雇する。支払総額を返す
+    int64_t runPayroll(std::vector<Person>& people, std::vector<Business>& businesses,
+                       ThreadPool* pool = nullptr) {
+        MessageBus bus;
+        postPayroll(bus, people, businesses, pool);
+        return bus.settle().volume;
+    }
+
+    // 給与を従業員から雇用主へのサービスの申し込みとしてバスに積む（決済は bus.settle()）
+    // 企業ごとの給与総額を並列に求め、払える企業の従業員の分だけ各スレッドのレーンに投稿する。
+    // 払えない企業の従業員はその場で全員解雇する。決済までに企業の所持金が減らなければ申し込みはすべて成立する
+    void postPayroll(MessageBus& bus, std::vector<Person>& people, std::vector<Business>& businesses,
+                     ThreadPool* pool = nullptr) {
+        employees.resize(businesses.size());
+        std::vector<char> solvent(businesses.size(), 1);
+
+        forRange(pool, businesses.size(), [&](size_t lo, size_t hi) {
+            for (size_t b = lo; b < hi; ++b) {
+                int64_t total = 0;
+                for (size_t person : employees[b]) {
+                    if (wage_of[person] > std::numeric_limits<int64_t>::max() - total) {
+                        throw std::overflow_error("Total salary would overflow");
+                    }
+                    total += wage_of[person];
+                }
+                solvent[b] = businesses[b].money >= total;
+                if (!solvent[b]) continue;
+                for (size_t person : employees[b]) {
+                    bus.proposeService(&people.at(person), &businesses[b], "労働", wage_of[person]);
+                }
+            }
+        });
+
+        for (size_t b = 0; b < businesses.size(); ++b) {
+            if (solvent[b]) continue;
+            while (!employees[b].empty()) {
+                release(employees[b].back(), businesses);
+            }
+        }
+    }
+
+    int64_t employerOf(size_t person) const {
+        return person < employer_of.size() ? employer_of[person] : NO_EMPLOYER;
+    }
+
+    int64_t wageOf(size_t person) const {
+        return person < wage_of.size() ? wage_of[person] : 0;
+    }
+
+    const std::vector<size_t>& employeesOf(size_t business) const {
+        static const std::vector<size_t> none;
+        return business < employees.size() ? employees[business] : none;
+    }
+
+    // 住民の添字で引く雇用主と賃金の列（チェックポイント用）
+    const std::vector<int64_t>& employers() const { return employer_of; }
+    const std::vector<int64_t>& wages() const { return wage_of; }
+
+    // 保存しておいた雇用主と賃金の列に置き換える。企業ごとの従業員リストは reindex で作る
+    void restore(std::vector<int64_t> employers, std::vector<int64_t> wages) {
+        if (employers.size() != wages.size()) {
+            throw std::runtime_error("Employment columns do not match");
+        }
+        employer_of = std::move(employers);
+        wage_of = std::move(wages);
+        position.assign(employer_of.size(), 0);
+        employees.clear();
+        buckets.clear();
+    }
+
+    // 企業 businesses 社に対する従業員リストを雇用主の列から作り直す（住民の添字順）
+    void reindex(size_t businesses) {
+        employees.assign(businesses, {});
+        position.assign(employer_of.size(), 0);
+        for (size_t person = 0; person < employer_of.size(); ++person) {
+            const int64_t employer = employer_of[person];
+            if (employer == NO_EMPLOYER) continue;
+            if (employer < 0 || static_cast<size_t>(employer) >= businesses) {
+                throw std::runtime_error("Employer out of range");
+            }
+            position[person] = employees[employer].size();
+            employees[employer].push_back(person);
+        }
+    }
+
+private:
+    struct Opening {
+        size_t business;
+        int64_t wage;
+        int32_t count;
+    };
+
+    struct Seeker {
+        size_t person;
+        int64_t reservation_wage;
+    };
+
+    struct Bucket {
+        std::vector<Opening> openings;
+        std::vector<Seeker> seekers;
+    };
+
+    std::map<std::string, Bucket> buckets;
+
+    // 雇用索引（Person の添字で引く列と、企業ごとの従業員リスト）
+    std::vector<int64_t> employer_of;
+    std::vector<int64_t> wage_of;
+    std::vector<size_t> position;
+    std::vector<std::vector<size_t>> employees;
+
+    Bucket& bucket(const std::string& occupation) {
+        if (occupation.empty()) {
+            throw std::invalid_argument("Occupation cannot be empty");
+        }
+        return buckets[occupation];
+    }
+
+    void hire(size_t person, size_t business, int64_t wage, std::vector<Business>& businesses) {
+        if (business >= businesses.size()) {
+            throw std::out_of_range("Opening refers to unknown business");
+        }
+        if (person >= employer_of.size()) {
+            employer_of.resize(person + 1, NO_EMPLOYER);
+            wage_of.resize(person + 1, 0);
+            position.resize(person + 1, 0);
+        }
+        if (business >= employees.size()) {
+            employees.resize(businesses.size());
+        }
+        employer_of[person] = static_cast<int64_t>(business);
+        wage_of[person] = wage;
+        position[person] = employees[business].size();
+        employees[business].push_back(person);
+        businesses[business].workers = static_cast<int32_t>(employees[business].size());
+    }
+
+    template <typename Fn>
+    static void forRange(ThreadPool* pool, size_t n, Fn&& fn) {
+        if (pool) {
+            pool->parallelFor(0, n, fn);
+        } else {
+            fn(0, n);
+        }
+    }
+};
+
+#endif // LABOR_MARKET_H
@@ -4,6 +4,7 @@
 #include <cstdint>
 
 struct Loan {
+    int64_t loan_id;         // 融資番号（貸し手が振る。他の融資が清算されても変わらない）
     int64_t lender_id;       // 貸し手のID
     int64_t borrower_id;     // 借り手のID
     int64_t amount;          // 融資額
@@ -11,15 +12,18 @@ struct Loan {
     int32_t days_remaining;  // 残り日数
     int32_t payment_schedule; // 返済スケジュール（日数）
     bool defaulted;          // デフォルト状態
+    int64_t due_day;         // 満期日（シミュレーション上の日付）
 
     Loan() :
+        loan_id(0),
         lender_id(0),
         borrower_id(0),
         amount(0),
         interest_rate(0.0f),
         days_remaining(0),
         payment_schedule(0),  // 初期値を0に変更
-        defaulted(false)
+        defaulted(false),
+        due_day(0)
     {}
 };
 
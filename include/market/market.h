@@ -1,21 +1,47 @@
 #ifndef MARKET_H
 #define MARKET_H
 
+#include <array>
 #include <string>
 #include <map>
+#include <stdexcept>
 #include <vector>
 #include <algorithm>
+#include <limits>
+#include <utility>
 #include "../agent/person.h"
 #include "../market/business.h"
+#include "goods_catalog.h"
+#include "price_history.h"
+#include "repricing.h"
+
+// 集計した需要をまとめて約定した結果
+struct BulkFill {
+    int filled = 0;    // 約定した数量（在庫の範囲）
+    int64_t cost = 0;  // 約定前の価格での代金
+};
 
 class Market {
 private:
-    std::map<std::string, int> stock;
-    std::map<std::string, int> price;
-    std::map<std::string, std::vector<int>> demand_history;
-    std::map<std::string, std::vector<int>> supply_history;
+    // 商品ごとの状態は登録順の連続配列に持ち、商品名からは index で添字を引く
+    std::map<std::string, size_t> index;
+    std::vector<std::string> names;
+    std::vector<int> price;
+    std::vector<int> stock;
+    std::vector<int> daily_demand;  // 当日の需要の合計（repriceAll の入力）
+    std::vector<int> daily_supply;  // 当日の供給の合計
+    std::vector<std::vector<int>> demand_history;  // 当日の取引ごとの需要
+    std::vector<std::vector<int>> supply_history;  // 当日の出品ごとの供給
     float price_volatility;
     
+    // 長期価格履歴（clearDaily のたびにその日の終値と出来高を記録する）
+    std::map<std::string, PriceHistory> price_archive;
+    int64_t current_day = 0;
+    
+    // 組み込み商品の添字。商品の登録時に埋めるので、const の参照は読むだけで済む（添字なのでコピー先でもそのまま使える）
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+    std::array<size_t, GoodsCatalog::BUILTIN_COUNT> builtin_slots = emptySlots();
+
     static const size_t MAX_HISTORY_SIZE = 100;  // Limit history to prevent memory leaks
     static constexpr float MAX_VOLATILITY = 2.0f;    // Cap volatility to prevent instability
 
@@ -30,47 +56,50 @@ public:
 
     // Public interface methods
     int getPrice(const std::string& product) const {
-        auto it = price.find(product);
-        return it != price.end() ? it->second : 0;
+        const size_t slot = slotOf(product);
+        return slot != NO_SLOT ? price[slot] : 0;
     }
 
     int getStock(const std::string& product) const {
-        auto it = stock.find(product);
-        return it != stock.end() ? it->second : 0;
+        const size_t slot = slotOf(product);
+        return slot != NO_SLOT ? stock[slot] : 0;
     }
 
-    void updatePrice(const std::string& product) {
-        auto& supply_hist = supply_history[product];
-        auto& demand_hist = demand_history[product];
-        
-        if (supply_hist.empty() || demand_hist.empty()) {
-            return;
-        }
+    // 組み込み商品の価格と在庫（文字列を使わずに引く）
+    int getPrice(GoodId good) const {
+        const size_t slot = builtinSlot(good);
+        return slot != NO_SLOT ? price[slot] : 0;
+    }
 
-        int current_supply = supply_hist.back();
-        int current_demand = demand_hist.back();
-        
-        if (current_supply == 0) return;
+    int getStock(GoodId good) const {
+        const size_t slot = builtinSlot(good);
+        return slot != NO_SLOT ? stock[slot] : 0;
+    }
 
-        float demand_supply_ratio = static_cast<float>(current_demand) / current_supply;
-        float price_change = (demand_supply_ratio - 1.0f) * price_volatility;
-        
-        auto& current_price = price[product];
-        current_price = static_cast<int>(current_price * (1.0f + price_change));
-        if (current_price < 1) current_price = 1;
+    // 当日の需要と供給の合計から1商品の価格を更新する（供給が0なら据え置く）
+    void updatePrice(const std::string& product) {
+        const size_t slot = slotOf(product);
+        if (slot == NO_SLOT) return;
+        repriceScalar(&daily_demand[slot], &daily_supply[slot], &price[slot], 1, price_volatility);
+    }
+
+    // 全商品の価格を一括で更新する（各商品に updatePrice を呼ぶのと同じ結果）
+    // 価格と当日の需給の合計は商品ごとの連続配列なので、そのままベクトル化カーネルに渡す
+    // 売買のたびには価格を動かさず、clearDaily で1日1回だけ呼ぶ
+    void repriceAll() {
+        repriceBatch(daily_demand.data(), daily_supply.data(), price.data(), price.size(), price_volatility);
     }
 
     bool transact(Person* buyer, Business* seller, const std::string& product, int quantity) {
         if (!buyer || !seller || quantity <= 0) return false;
         
         // 商品が市場に存在するか確認
-        auto price_it = price.find(product);
-        if (price_it == price.end()) {
-            addProduct(product, seller->price); // 新商品として登録
-            price_it = price.find(product);
+        size_t slot = slotOf(product);
+        if (slot == NO_SLOT) {
+            slot = addProduct(product, seller->price); // 新商品として登録
         }
         
-        int total_cost = price_it->second * quantity;
+        int total_cost = price[slot] * quantity;
         
         // 購入者の所持金と売り手の在庫を確認
         if (buyer->money < total_cost || seller->stock < quantity) {
@@ -78,14 +107,12 @@ public:
         }
 
         // 市場の在庫を確認と更新
-        auto& market_stock = stock[product];
-        if (market_stock < quantity) {
+        if (stock[slot] < quantity) {
             // 市場の在庫が不足している場合は、売り手から補充
-            addStock(product, seller->stock);
-            market_stock = stock[product];
+            addStock(slot, seller->stock);
         }
 
-        if (market_stock < quantity) {
+        if (stock[slot] < quantity) {
             return false;
         }
 
@@ -93,94 +120,216 @@ public:
         buyer->addMoney(-total_cost);
         seller->addMoney(total_cost);
         seller->stock -= quantity;
-        market_stock -= quantity;
+        stock[slot] -= quantity;
 
-        // 取引履歴の更新
-        addDemand(product, quantity);
-        
-        // 価格更新
-        updatePrice(product);
+        // 取引履歴の更新（価格は clearDaily でまとめて更新する）
+        addDemand(slot, quantity);
 
         return true;
     }
 
+    // 登録済みの商品名（名前順）
+    std::vector<std::string> getProducts() const {
+        std::vector<std::string> products;
+        products.reserve(index.size());
+        for (const auto& entry : index) products.push_back(entry.first);
+        return products;
+    }
+
+    // チェックポイントからの復元用（需給履歴には記録しない）
+    void restoreProduct(const std::string& product, int restored_price, int restored_stock) {
+        stock[addProduct(product, restored_price)] = restored_stock;
+    }
+
+    // 当日の需要・供給の履歴と合計（チェックポイント用。未登録なら空・0）
+    const std::vector<int>& getDemandHistory(const std::string& product) const {
+        static const std::vector<int> none;
+        const size_t slot = slotOf(product);
+        return slot != NO_SLOT ? demand_history[slot] : none;
+    }
+
+    const std::vector<int>& getSupplyHistory(const std::string& product) const {
+        static const std::vector<int> none;
+        const size_t slot = slotOf(product);
+        return slot != NO_SLOT ? supply_history[slot] : none;
+    }
+
+    int getDailyDemand(const std::string& product) const {
+        const size_t slot = slotOf(product);
+        return slot != NO_SLOT ? daily_demand[slot] : 0;
+    }
+
+    int getDailySupply(const std::string& product) const {
+        const size_t slot = slotOf(product);
+        return slot != NO_SLOT ? daily_supply[slot] : 0;
+    }
+
+    // restoreProduct した商品の当日の需給を戻す
+    void restoreHistory(const std::string& product, std::vector<int> demand, std::vector<int> supply,
+                        int demand_total, int supply_total) {
+        const size_t slot = slotOf(product);
+        if (slot == NO_SLOT) {
+            throw std::invalid_argument("Product not found in market");
+        }
+        if (demand.size() > MAX_HISTORY_SIZE || supply.size() > MAX_HISTORY_SIZE) {
+            throw std::invalid_argument("Market history is too long");
+        }
+        demand_history[slot] = std::move(demand);
+        supply_history[slot] = std::move(supply);
+        daily_demand[slot] = demand_total;
+        daily_supply[slot] = supply_total;
+    }
+
     void registerProduct(const std::string& product, int initial_price) {
         addProduct(product, initial_price);
     }
 
     bool sell(const std::string& product, int quantity, int price) {
-        if (this->price.find(product) == this->price.end()) {
-            addProduct(product, price);
+        size_t slot = slotOf(product);
+        if (slot == NO_SLOT) {
+            slot = addProduct(product, price);
         }
-        addStock(product, quantity);
+        addStock(slot, quantity);
         return true;
     }
 
     int buy(const std::string& product, int quantity) {
-        auto price_it = price.find(product);
-        if (price_it == price.end()) {
+        const size_t slot = slotOf(product);
+        if (slot == NO_SLOT) {
             throw std::invalid_argument("Product not found in market");
         }
-        if (stock[product] < quantity) {
-            throw std::invalid_argument("Insufficient stock");
+        return buyAt(slot, quantity);
+    }
+
+    // buy(const std::string&, int) の組み込み商品版
+    int buy(GoodId good, int quantity) {
+        const size_t slot = builtinSlot(good);
+        if (slot == NO_SLOT) {
+            throw std::invalid_argument("Product not found in market");
         }
-        int total_cost = price_it->second * quantity;
-        stock[product] -= quantity;
-        addDemand(product, quantity);
-        updatePrice(product);
-        return total_cost;
+        return buyAt(slot, quantity);
+    }
+
+    // 集計した需要 quantity をまとめて約定する。在庫が足りなければ在庫の分だけ約定する
+    // 需要は満たせなかった分も含めて記録する
+    BulkFill fillDemand(const std::string& product, int quantity) {
+        return fillDemandAt(slotOf(product), quantity);
+    }
+
+    BulkFill fillDemand(GoodId good, int quantity) {
+        return fillDemandAt(builtinSlot(good), quantity);
     }
 
+    // 商品の長期価格履歴（未記録なら nullptr）
+    const PriceHistory* getPriceHistory(const std::string& product) const {
+        auto it = price_archive.find(product);
+        return it != price_archive.end() ? &it->second : nullptr;
+    }
+
+    int64_t getCurrentDay() const { return current_day; }
+    void restoreCurrentDay(int64_t day) { current_day = day; }
+
+    // 1日の締め: その日の終値（その日に取引された価格）と出来高を長期履歴に記録し、
+    // 当日の需給の合計で全商品を一括で値付けし直してから日次の統計をリセットする
     void clearDaily() {
-        // 日次の統計情報をリセット
-        for (auto& [product, history] : supply_history) {
-            if (!history.empty()) {
-                history.clear();
-                history.push_back(0);
-            }
+        for (size_t slot = 0; slot < names.size(); ++slot) {
+            price_archive[names[slot]].record(current_day, price[slot], daily_demand[slot]);
         }
-        for (auto& [product, history] : demand_history) {
-            if (!history.empty()) {
-                history.clear();
-                history.push_back(0);
+        ++current_day;
+
+        repriceAll();
+
+        // 日次の統計情報をリセット
+        std::fill(daily_demand.begin(), daily_demand.end(), 0);
+        std::fill(daily_supply.begin(), daily_supply.end(), 0);
+        for (auto* histories : {&supply_history, &demand_history}) {
+            for (auto& history : *histories) {
+                if (!history.empty()) {
+                    history.clear();
+                    history.push_back(0);
+                }
             }
         }
     }
 
 private:
-    void addProduct(const std::string& product, int initial_price) {
-        price[product] = initial_price;
-        stock[product] = 0;
-        if (demand_history.find(product) == demand_history.end()) {
-            demand_history[product] = std::vector<int>();
-            demand_history[product].reserve(MAX_HISTORY_SIZE);  // Reserve space for efficiency
-            demand_history[product].push_back(0);  // 初期需要を0として記録
+    static std::array<size_t, GoodsCatalog::BUILTIN_COUNT> emptySlots() {
+        std::array<size_t, GoodsCatalog::BUILTIN_COUNT> slots;
+        slots.fill(NO_SLOT);
+        return slots;
+    }
+
+    size_t slotOf(const std::string& product) const {
+        auto it = index.find(product);
+        return it != index.end() ? it->second : NO_SLOT;
+    }
+
+    // 登録済みなら価格を設定し直して在庫を0にする。未登録なら末尾に追加する
+    size_t addProduct(const std::string& product, int initial_price) {
+        const size_t existing = slotOf(product);
+        if (existing != NO_SLOT) {
+            price[existing] = initial_price;
+            stock[existing] = 0;
+            return existing;
         }
-        if (supply_history.find(product) == supply_history.end()) {
-            supply_history[product] = std::vector<int>();
-            supply_history[product].reserve(MAX_HISTORY_SIZE);  // Reserve space for efficiency
-            supply_history[product].push_back(0);  // 初期供給を0として記録
+        const size_t slot = names.size();
+        index.emplace(product, slot);
+        const GoodId good = GoodsCatalog::find(product);
+        if (good != GoodsCatalog::NONE) builtin_slots[good] = slot;
+        names.push_back(product);
+        price.push_back(initial_price);
+        stock.push_back(0);
+        daily_demand.push_back(0);
+        daily_supply.push_back(0);
+        for (auto* histories : {&demand_history, &supply_history}) {
+            histories->emplace_back();
+            histories->back().reserve(MAX_HISTORY_SIZE);  // Reserve space for efficiency
+            histories->back().push_back(0);  // 初期需要・供給を0として記録
         }
+        return slot;
     }
 
-    void addStock(const std::string& product, int quantity) {
-        if (stock.find(product) == stock.end()) {
-            stock[product] = 0;
-        }
-        stock[product] += quantity;
-        if (supply_history.find(product) == supply_history.end()) {
-            supply_history[product] = std::vector<int>();
+    int buyAt(size_t slot, int quantity) {
+        if (stock[slot] < quantity) {
+            throw std::invalid_argument("Insufficient stock");
         }
-        supply_history[product].push_back(quantity);
+        int total_cost = price[slot] * quantity;
+        stock[slot] -= quantity;
+        addDemand(slot, quantity);
+        return total_cost;
+    }
+
+    BulkFill fillDemandAt(size_t slot, int quantity) {
+        if (slot == NO_SLOT || quantity <= 0) return {};
+        BulkFill fill;
+        fill.filled = std::min(quantity, stock[slot]);
+        fill.cost = static_cast<int64_t>(price[slot]) * fill.filled;
+        stock[slot] -= fill.filled;
+        addDemand(slot, quantity);
+        return fill;
+    }
+
+    // 当日の合計は int の範囲で頭打ちにする
+    static void accumulate(int& total, int quantity) {
+        if (quantity <= 0) return;
+        total = quantity > std::numeric_limits<int>::max() - total ? std::numeric_limits<int>::max()
+                                                                    : total + quantity;
+    }
+
+    void addStock(size_t slot, int quantity) {
+        stock[slot] += quantity;
+        accumulate(daily_supply[slot], quantity);
+        auto& supply_hist = supply_history[slot];
+        supply_hist.push_back(quantity);
         
         // Limit history size to prevent memory leaks
-        if (supply_history[product].size() > MAX_HISTORY_SIZE) {
-            supply_history[product].erase(supply_history[product].begin());
+        if (supply_hist.size() > MAX_HISTORY_SIZE) {
+            supply_hist.erase(supply_hist.begin());
         }
         
         // 需要と供給の不均衡をチェック
-        if (!demand_history[product].empty()) {
-            int latest_demand = demand_history[product].back();
+        if (!demand_history[slot].empty()) {
+            int latest_demand = demand_history[slot].back();
             if (quantity < latest_demand) {
                 // Fix: Add volatility incrementally with bounds instead of multiplication
                 price_volatility = std::min(price_volatility + 0.01f, MAX_VOLATILITY);
@@ -188,26 +337,31 @@ private:
         }
     }
 
-    void addDemand(const std::string& product, int quantity) {
-        if (demand_history.find(product) == demand_history.end()) {
-            demand_history[product] = std::vector<int>();
-        }
-        demand_history[product].push_back(quantity);
+    void addDemand(size_t slot, int quantity) {
+        accumulate(daily_demand[slot], quantity);
+        auto& demand_hist = demand_history[slot];
+        demand_hist.push_back(quantity);
 
         // Limit history size to prevent memory leaks
-        if (demand_history[product].size() > MAX_HISTORY_SIZE) {
-            demand_history[product].erase(demand_history[product].begin());
+        if (demand_hist.size() > MAX_HISTORY_SIZE) {
+            demand_hist.erase(demand_hist.begin());
         }
 
         // 需要が供給を上回る場合、価格変動性を増加
-        if (!supply_history[product].empty()) {
-            int latest_supply = supply_history[product].back();
+        const auto& supply_hist = supply_history[slot];
+        if (!supply_hist.empty()) {
+            int latest_supply = supply_hist.back();
             if (quantity > latest_supply) {
                 // Fix: Add volatility incrementally with bounds instead of multiplication
                 price_volatility = std::min(price_volatility + 0.01f, MAX_VOLATILITY);
             }
         }
     }
+
+    // 市場に登録済みの組み込み商品の添字（未登録・組み込みでない商品は NO_SLOT）
+    size_t builtinSlot(GoodId good) const {
+        return GoodsCatalog::isBuiltin(good) ? builtin_slots[good] : NO_SLOT;
+    }
 };
 
 #endif // MARKET_H
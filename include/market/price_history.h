@@ -0,0 +1,388 @@
+#pragma once
+#ifndef PRICE_HISTORY_H
+#define PRICE_HISTORY_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "../system/calendar.h"
+
+// 一定期間の四本値（始値・高値・安値・終値）と出来高
+struct OhlcBar {
+    int64_t start_day;
+    int64_t open;
+    int64_t high;
+    int64_t low;
+    int64_t close;
+    int64_t volume;
+    int64_t price_sum;   // 平均価格計算用の価格合計
+    int64_t samples;     // 価格サンプル数
+
+    OhlcBar() : start_day(0), open(0), high(0), low(0), close(0), volume(0), price_sum(0), samples(0) {}
+
+    void add(int64_t price, int64_t quantity) {
+        if (samples == 0) {
+            open = high = low = price;
+        } else {
+            high = std::max(high, price);
+            low = std::min(low, price);
+        }
+        close = price;
+        volume += quantity;
+        price_sum += price;
+        ++samples;
+    }
+
+    // 時間順で後ろに続くバーを結合する
+    void merge(const OhlcBar& later) {
+        if (later.samples == 0) return;
+        if (samples == 0) {
+            const int64_t start = start_day;
+            *this = later;
+            start_day = start;
+            return;
+        }
+        high = std::max(high, later.high);
+        low = std::min(low, later.low);
+        close = later.close;
+        volume += later.volume;
+        price_sum += later.price_sum;
+        samples += later.samples;
+    }
+
+    double average() const { return samples ? static_cast<double>(price_sum) / samples : 0.0; }
+};
+
+// ビット単位の書き込み・読み出し（圧縮ブロック用）
+class BitWriter {
+public:
+    void write(uint64_t value, int bits) {
+        for (int i = bits - 1; i >= 0; --i) {
+            if (bit_count % 8 == 0) bytes.push_back(0);
+            if ((value >> i) & 1) bytes.back() |= static_cast<uint8_t>(0x80 >> (bit_count % 8));
+            ++bit_count;
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+    size_t bit_count = 0;
+};
+
+class BitReader {
+public:
+    explicit BitReader(const std::vector<uint8_t>& data) : bytes(data) {}
+
+    uint64_t read(int bits) {
+        uint64_t value = 0;
+        for (int i = 0; i < bits; ++i) {
+            if (position / 8 >= bytes.size()) {
+                throw std::runtime_error("Compressed price history is truncated");
+            }
+            const uint8_t bit = (bytes[position / 8] >> (7 - position % 8)) & 1;
+            value = (value << 1) | bit;
+            ++position;
+        }
+        return value;
+    }
+
+private:
+    const std::vector<uint8_t>& bytes;
+    size_t position = 0;
+};
+
+// Gorilla 方式の圧縮
+// 日付は差分の差分を可変長で、各値は直前の値との XOR を有効ビットの窓だけ書き出す
+class GorillaCodec {
+public:
+    // 差分の差分（zigzag 変換後）の可変長符号
+    static void writeDeltaOfDelta(BitWriter& out, int64_t dod) {
+        const uint64_t z = zigzag(dod);
+        if (z == 0) {
+            out.write(0b0, 1);
+        } else if (z < (1u << 7)) {
+            out.write(0b10, 2);
+            out.write(z, 7);
+        } else if (z < (1u << 9)) {
+            out.write(0b110, 3);
+            out.write(z, 9);
+        } else if (z < (1u << 12)) {
+            out.write(0b1110, 4);
+            out.write(z, 12);
+        } else {
+            out.write(0b1111, 4);
+            out.write(z, 64);
+        }
+    }
+
+    static int64_t readDeltaOfDelta(BitReader& in) {
+        if (in.read(1) == 0) return 0;
+        if (in.read(1) == 0) return unzigzag(in.read(7));
+        if (in.read(1) == 0) return unzigzag(in.read(9));
+        if (in.read(1) == 0) return unzigzag(in.read(12));
+        return unzigzag(in.read(64));
+    }
+
+    // 1系列分の XOR 符号化状態
+    struct XorState {
+        uint64_t previous = 0;
+        int leading = -1;   // 直前の有効ビット窓（-1 は未設定）
+        int trailing = 0;
+    };
+
+    static void writeXor(BitWriter& out, XorState& state, int64_t value) {
+        const uint64_t bits = static_cast<uint64_t>(value);
+        const uint64_t x = bits ^ state.previous;
+        state.previous = bits;
+        if (x == 0) {
+            out.write(0b0, 1);
+            return;
+        }
+        const int leading = __builtin_clzll(x);
+        const int trailing = __builtin_ctzll(x);
+        if (state.leading >= 0 && leading >= state.leading && trailing >= state.trailing) {
+            // 直前の窓に収まる
+            out.write(0b10, 2);
+            out.write(x >> state.trailing, 64 - state.leading - state.trailing);
+            return;
+        }
+        const int length = 64 - leading - trailing;
+        out.write(0b11, 2);
+        out.write(static_cast<uint64_t>(leading), 6);
+        out.write(static_cast<uint64_t>(length - 1), 6);
+        out.write(x >> trailing, length);
+        state.leading = leading;
+        state.trailing = trailing;
+    }
+
+    static int64_t readXor(BitReader& in, XorState& state) {
+        if (in.read(1) == 0) return static_cast<int64_t>(state.previous);
+        uint64_t x;
+        if (in.read(1) == 0) {
+            x = in.read(64 - state.leading - state.trailing) << state.trailing;
+        } else {
+            const int leading = static_cast<int>(in.read(6));
+            const int length = static_cast<int>(in.read(6)) + 1;
+            const int trailing = 64 - leading - length;
+            x = in.read(length) << trailing;
+            state.leading = leading;
+            state.trailing = trailing;
+        }
+        state.previous ^= x;
+        return static_cast<int64_t>(state.previous);
+    }
+
+private:
+    static uint64_t zigzag(int64_t v) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+    static int64_t unzigzag(uint64_t z) {
+        return static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+    }
+};
+
+// 圧縮済みのバー列（古い区間）
+struct CompressedBars {
+    int64_t first_day = 0;
+    int64_t last_day = 0;
+    size_t count = 0;
+    std::vector<uint8_t> data;
+
+    static CompressedBars encode(const std::vector<OhlcBar>& bars) {
+        CompressedBars block;
+        if (bars.empty()) return block;
+        block.first_day = bars.front().start_day;
+        block.last_day = bars.back().start_day;
+        block.count = bars.size();
+
+        BitWriter out;
+        std::array<GorillaCodec::XorState, 7> states;
+        int64_t previous_day = 0;
+        int64_t previous_delta = 0;
+        for (const auto& bar : bars) {
+            const int64_t delta = bar.start_day - previous_day;
+            GorillaCodec::writeDeltaOfDelta(out, delta - previous_delta);
+            previous_delta = delta;
+            previous_day = bar.start_day;
+            const int64_t fields[7] = {bar.open, bar.high, bar.low, bar.close,
+                                       bar.volume, bar.price_sum, bar.samples};
+            for (size_t f = 0; f < 7; ++f) {
+                GorillaCodec::writeXor(out, states[f], fields[f]);
+            }
+        }
+        block.data = std::move(out.bytes);
+        return block;
+    }
+
+    std::vector<OhlcBar> decode() const {
+        std::vector<OhlcBar> bars;
+        bars.reserve(count);
+        BitReader in(data);
+        std::array<GorillaCodec::XorState, 7> states;
+        int64_t previous_day = 0;
+        int64_t previous_delta = 0;
+        for (size_t i = 0; i < count; ++i) {
+            OhlcBar bar;
+            previous_delta += GorillaCodec::readDeltaOfDelta(in);
+            previous_day += previous_delta;
+            bar.start_day = previous_day;
+            bar.open = GorillaCodec::readXor(in, states[0]);
+            bar.high = GorillaCodec::readXor(in, states[1]);
+            bar.low = GorillaCodec::readXor(in, states[2]);
+            bar.close = GorillaCodec::readXor(in, states[3]);
+            bar.volume = GorillaCodec::readXor(in, states[4]);
+            bar.price_sum = GorillaCodec::readXor(in, states[5]);
+            bar.samples = GorillaCodec::readXor(in, states[6]);
+            bars.push_back(bar);
+        }
+        return bars;
+    }
+};
+
+// 1商品の長期価格履歴
+// 直近の生サンプルを一定数だけ残し、同時に日・週・季節の各解像度の OHLC バーを逐次更新する。
+// 各解像度の古いバーは Gorilla 方式で圧縮したブロックに移す。
+// 期間クエリは範囲に完全に含まれる最も粗いバーから答え、端数だけを細かい解像度で補う
+class PriceHistory {
+public:
+    enum Resolution { DAY = 0, WEEK = 1, SEASON = 2, RESOLUTION_COUNT = 3 };
+
+    // 季節のバーは暦の季節（Calendar::DAYS_PER_SEASON 日）と同じ区切りにする
+    static constexpr int64_t RESOLUTION_DAYS[RESOLUTION_COUNT] = {1, 7, Calendar::DAYS_PER_SEASON};
+    static constexpr size_t RAW_WINDOW = 100;    // 生サンプルの保持数
+    static constexpr size_t HOT_BARS = 64;       // 非圧縮で残すバー数
+    static constexpr size_t BLOCK_BARS = 64;     // 圧縮ブロックあたりのバー数
+
+    struct Sample {
+        int64_t day;
+        int64_t price;
+        int64_t quantity;
+    };
+
+    // 価格サンプルを記録する（day は単調非減少であること）
+    void record(int64_t day, int64_t price, int64_t quantity = 0) {
+        if (day < last_day) {
+            throw std::invalid_argument("Price samples must be recorded in day order");
+        }
+        last_day = day;
+
+        raw.push_back({day, price, quantity});
+        if (raw.size() > RAW_WINDOW) raw.pop_front();
+
+        for (size_t r = 0; r < RESOLUTION_COUNT; ++r) {
+            Level& level = levels[r];
+            const int64_t start = alignDay(day, RESOLUTION_DAYS[r]);
+            if (level.has_open && level.open_bar.start_day != start) {
+                closeBar(level);
+            }
+            if (!level.has_open) {
+                level.open_bar = OhlcBar();
+                level.open_bar.start_day = start;
+                level.has_open = true;
+            }
+            level.open_bar.add(price, quantity);
+        }
+    }
+
+    // [from_day, to_day] の集計（サンプルがなければ samples == 0）
+    OhlcBar query(int64_t from_day, int64_t to_day) const {
+        OhlcBar result;
+        result.start_day = from_day;
+        if (from_day > to_day) return result;
+        queryLevel(SEASON, from_day, to_day, result);
+        return result;
+    }
+
+    double averagePrice(int64_t from_day, int64_t to_day) const {
+        return query(from_day, to_day).average();
+    }
+
+    const std::deque<Sample>& recentSamples() const { return raw; }
+
+    // 解像度ごとの保持バー数（圧縮分を含む）
+    size_t barCount(Resolution resolution) const {
+        const Level& level = levels[resolution];
+        size_t count = level.hot.size() + (level.has_open ? 1 : 0);
+        for (const auto& block : level.cold) count += block.count;
+        return count;
+    }
+
+    size_t compressedBytes() const {
+        size_t total = 0;
+        for (const auto& level : levels) {
+            for (const auto& block : level.cold) total += block.data.size();
+        }
+        return total;
+    }
+
+private:
+    struct Level {
+        std::vector<CompressedBars> cold;
+        std::vector<OhlcBar> hot;
+        OhlcBar open_bar;
+        bool has_open = false;
+    };
+
+    std::deque<Sample> raw;
+    std::array<Level, RESOLUTION_COUNT> levels;
+    int64_t last_day = std::numeric_limits<int64_t>::min();
+
+    static int64_t alignDay(int64_t day, int64_t width) {
+        const int64_t q = day / width;
+        return (day % width < 0 ? q - 1 : q) * width;
+    }
+
+    static void closeBar(Level& level) {
+        level.hot.push_back(level.open_bar);
+        level.has_open = false;
+        if (level.hot.size() >= HOT_BARS + BLOCK_BARS) {
+            std::vector<OhlcBar> oldest(level.hot.begin(), level.hot.begin() + BLOCK_BARS);
+            level.cold.push_back(CompressedBars::encode(oldest));
+            level.hot.erase(level.hot.begin(), level.hot.begin() + BLOCK_BARS);
+        }
+    }
+
+    // resolution のバーのうち [from, to] に完全に含まれるものを使い、はみ出した端は細かい解像度で補う
+    void queryLevel(size_t resolution, int64_t from, int64_t to, OhlcBar& result) const {
+        if (from > to) return;
+        const int64_t width = RESOLUTION_DAYS[resolution];
+        if (resolution == DAY) {
+            forEachBar(levels[DAY], from, to, result);
+            return;
+        }
+        // 完全に含まれるバーの範囲 [inner_from, inner_to]
+        int64_t inner_from = alignDay(from, width);
+        if (inner_from < from) inner_from += width;
+        const int64_t inner_to = alignDay(to + 1, width) - 1;
+        if (inner_from > inner_to) {
+            queryLevel(resolution - 1, from, to, result);
+            return;
+        }
+        queryLevel(resolution - 1, from, inner_from - 1, result);
+        forEachBar(levels[resolution], inner_from, inner_to, result);
+        queryLevel(resolution - 1, inner_to + 1, to, result);
+    }
+
+    // 開始日が [from, to] にあるバーを時間順に結合する
+    static void forEachBar(const Level& level, int64_t from, int64_t to, OhlcBar& result) {
+        for (const auto& block : level.cold) {
+            if (block.last_day < from || block.first_day > to) continue;
+            for (const auto& bar : block.decode()) {
+                if (bar.start_day >= from && bar.start_day <= to) result.merge(bar);
+            }
+        }
+        auto first = std::lower_bound(level.hot.begin(), level.hot.end(), from,
+                                      [](const OhlcBar& bar, int64_t day) { return bar.start_day < day; });
+        for (auto it = first; it != level.hot.end() && it->start_day <= to; ++it) {
+            result.merge(*it);
+        }
+        if (level.has_open && level.open_bar.start_day >= from && level.open_bar.start_day <= to) {
+            result.merge(level.open_bar);
+        }
+    }
+};
+
+#endif // PRICE_HISTORY_H
@@ -0,0 +1,399 @@
+#pragma once
+#ifndef PRODUCTION_H
+#define PRODUCTION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "business.h"
+#include "../system/thread_pool.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define PRODUCTION_AVX2 1
+#else
+#define PRODUCTION_AVX2 0
+#endif
+
+// 生産レシピ（投入物 → 産出物）
+// 1日の産出量は workers * output_per_worker。投入物は産出1単位あたりの必要量
+struct Recipe {
+    std::string output;
+    std::vector<std::pair<std::string, int32_t>> inputs;
+    int32_t output_per_worker;
+
+    Recipe() : output_per_worker(1) {}
+
+    Recipe(const std::string& out, std::vector<std::pair<std::string, int32_t>> in,
+           int32_t per_worker)
+        : output(out), inputs(std::move(in)), output_per_worker(per_worker) {
+        validate();
+    }
+
+    void validate() const {
+        if (output.empty()) {
+            throw std::invalid_argument("Recipe output cannot be empty");
+        }
+        if (output_per_worker < 0) {
+            throw std::invalid_argument("Output per worker cannot be negative");
+        }
+        for (const auto& input : inputs) {
+            if (input.first.empty() || input.second <= 0) {
+                throw std::invalid_argument("Recipe inputs must be named with positive quantity");
+            }
+            if (input.first == output) {
+                throw std::invalid_argument("Recipe cannot consume its own output");
+            }
+        }
+    }
+};
+
+// 製品を頂点、投入関係を辺とするサプライチェーンDAG
+// 1ティックごとにトポロジカル順の段（レベル）単位で生産を行い、
+// 同じ段の製品は互いに独立なので並列に生産する。投入物の消費は製品ごとに一括で行う
+// 企業ごとの産出倍率（季節など）を設定すると、各社の産出量にその倍率を掛けてから生産する
+class ProductionGraph {
+public:
+    // 1回の runTick の結果
+    struct TickReport {
+        int64_t total_output = 0;
+        std::map<std::string, int64_t> produced;   // 製品ごとの産出量
+        std::map<std::string, int64_t> consumed;   // 製品ごとの投入消費量
+    };
+
+    void addRecipe(const Recipe& recipe) {
+        recipe.validate();
+        recipes[recipe.output] = recipe;
+        compiled = false;
+    }
+
+    bool hasRecipe(const std::string& product) const {
+        return recipes.find(product) != recipes.end();
+    }
+
+    // トポロジカル順の段を返す（先頭は投入物を持たない一次産品）
+    const std::vector<std::vector<std::string>>& getLevels() {
+        compile();
+        return level_names;
+    }
+
+    // 企業ごとの産出倍率。businesses と同じ並びで、列が短い分の企業と空のときは1倍
+    void setOutputScale(std::vector<float> scale) {
+        for (float factor : scale) {
+            if (!(factor >= 0.0f)) {
+                throw std::invalid_argument("Output scale cannot be negative");
+            }
+        }
+        output_scale = std::move(scale);
+    }
+
+    const std::vector<float>& outputScale() const { return output_scale; }
+
+    // 投入物が足りる場合の各社の1日の産出量
+    // レシピがあれば workers * output_per_worker、なければ daily_production。どちらにも産出倍率を掛ける
+    std::vector<int32_t> plannedOutput(const std::vector<Business>& businesses) {
+        compile();
+        indexBusinesses(businesses);
+        planOutput(businesses);
+        return planned;
+    }
+
+    // 直近の runTick（または plannedOutput）で求めた各社の産出量
+    const std::vector<int32_t>& lastPlannedOutput() const { return planned; }
+
+    // 全企業の1日分の生産を行う
+    // レシピのない製品は従来通り daily_production をそのまま在庫に加える
+    TickReport runTick(std::vector<Business>& businesses, ThreadPool* pool = nullptr) {
+        compile();
+        indexBusinesses(businesses);
+        planOutput(businesses);
+
+        TickReport report;
+        std::vector<int64_t> produced(products.size(), 0);
+        std::vector<int64_t> consumed(products.size(), 0);
+
+        for (const auto& level : levels) {
+            // 1. 段内の全消費者からの投入需要を製品ごとに集計
+            std::vector<int64_t> demand(products.size(), 0);
+            for (int32_t p : level) {
+                const int64_t desired = desiredOutput(p);
+                for (const auto& input : compiled_inputs[p]) {
+                    demand[input.first] += desired * input.second;
+                }
+            }
+
+            // 2. 投入物ごとの充足率（供給 / 需要）を決め、各製品の稼働率を求める
+            std::vector<double> fill(products.size(), 1.0);
+            for (size_t i = 0; i < products.size(); ++i) {
+                if (demand[i] > 0) {
+                    const int64_t available = availableStock(static_cast<int32_t>(i), businesses);
+                    fill[i] = std::min(1.0, static_cast<double>(available) / demand[i]);
+                }
+            }
+
+            // 3. 段内の製品を並列に生産（各企業は自分の製品の在庫のみ更新する）
+            auto produceRange = [&](size_t lo, size_t hi) {
+                for (size_t k = lo; k < hi; ++k) {
+                    const int32_t p = level[k];
+                    double rate = 1.0;
+                    for (const auto& input : compiled_inputs[p]) {
+                        rate = std::min(rate, fill[input.first]);
+                    }
+                    int64_t total = 0;
+                    for (size_t b : producers[p]) {
+                        Business& business = businesses[b];
+                        const int64_t amount = static_cast<int64_t>(planned[b] * rate);
+                        if (amount <= 0) continue;
+                        if (business.stock > std::numeric_limits<int32_t>::max() - amount) {
+                            throw std::overflow_error("Production would cause stock overflow");
+                        }
+                        business.stock += static_cast<int32_t>(amount);
+                        total += amount;
+                    }
+                    produced[p] = total;
+                }
+            };
+            if (pool) {
+                pool->parallelFor(0, level.size(), produceRange, 1);
+            } else {
+                produceRange(0, level.size());
+            }
+
+            // 4. 実際の産出量に応じた投入物を製品ごとにまとめて供給元の在庫から差し引く
+            std::vector<int64_t> used(products.size(), 0);
+            for (int32_t p : level) {
+                for (const auto& input : compiled_inputs[p]) {
+                    used[input.first] += produced[p] * input.second;
+                }
+            }
+            for (size_t i = 0; i < products.size(); ++i) {
+                if (used[i] > 0) {
+                    drainStock(static_cast<int32_t>(i), used[i], businesses);
+                    consumed[i] += used[i];
+                }
+            }
+        }
+
+        for (size_t i = 0; i < products.size(); ++i) {
+            if (produced[i] > 0) report.produced[products[i]] = produced[i];
+            if (consumed[i] > 0) report.consumed[products[i]] = consumed[i];
+            report.total_output += produced[i];
+        }
+        return report;
+    }
+
+    // out[i] = base[i] × scale[i] の四捨五入（int32_t の上限で頭打ち）
+    static void scaleOutput(const int32_t* base, const float* scale, int32_t* out, size_t n) {
+#if PRODUCTION_AVX2
+        if (productionUsesAvx2()) {
+            scaleOutputAvx2(base, scale, out, n);
+            return;
+        }
+#endif
+        scaleOutputScalar(base, scale, out, n);
+    }
+
+    static void scaleOutputScalar(const int32_t* base, const float* scale, int32_t* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            const float scaled = std::min(static_cast<float>(base[i]) * scale[i] + 0.5f, MAX_OUTPUT);
+            out[i] = static_cast<int32_t>(scaled);
+        }
+    }
+
+#if PRODUCTION_AVX2
+    // 8社ずつ（演算は scaleOutputScalar と同じ順序なので結果は一致する）
+    __attribute__((target("avx2")))
+    static void scaleOutputAvx2(const int32_t* base, const float* scale, int32_t* out, size_t n) {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 limit = _mm256_set1_ps(MAX_OUTPUT);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m256 b = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i)));
+            const __m256 scaled = _mm256_add_ps(_mm256_mul_ps(b, _mm256_loadu_ps(scale + i)), half);
+            const __m256i result = _mm256_cvttps_epi32(_mm256_min_ps(scaled, limit));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+        }
+        scaleOutputScalar(base + i, scale + i, out + i, n - i);
+    }
+#endif
+
+    static bool productionUsesAvx2() {
+#if PRODUCTION_AVX2
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+private:
+    // int32_t に収まる最大の float
+    static constexpr float MAX_OUTPUT = 2147483520.0f;
+
+    std::map<std::string, Recipe> recipes;
+    bool compiled = false;
+
+    // コンパイル済みの表現（製品名 → 連番ID）
+    std::vector<std::string> products;
+    std::map<std::string, int32_t> product_ids;
+    std::vector<std::vector<std::pair<int32_t, int32_t>>> compiled_inputs;
+    std::vector<const Recipe*> compiled_recipes;
+    std::vector<std::vector<int32_t>> levels;
+    std::vector<std::vector<std::string>> level_names;
+    std::vector<std::vector<size_t>> producers;
+
+    std::vector<float> output_scale;
+    std::vector<int32_t> planned;   // 企業ごとの産出量（planOutput の結果）
+    std::vector<int32_t> raw;       // 倍率を掛ける前の産出量（planOutput の作業領域）
+    std::vector<float> scale;       // 企業ごとの倍率（planOutput の作業領域）
+
+    int32_t internProduct(const std::string& name) {
+        auto it = product_ids.find(name);
+        if (it != product_ids.end()) return it->second;
+        const int32_t id = static_cast<int32_t>(products.size());
+        products.push_back(name);
+        product_ids.emplace(name, id);
+        compiled_inputs.emplace_back();
+        compiled_recipes.push_back(nullptr);
+        return id;
+    }
+
+    // レシピからDAGを構築し、Kahn法で段に分ける（循環があれば例外）
+    void compile() {
+        if (compiled) return;
+        products.clear();
+        product_ids.clear();
+        compiled_inputs.clear();
+        compiled_recipes.clear();
+
+        for (const auto& [name, recipe] : recipes) {
+            const int32_t out = internProduct(name);
+            compiled_recipes[out] = &recipe;
+            for (const auto& input : recipe.inputs) {
+                const int32_t in = internProduct(input.first);
+                compiled_inputs[out].emplace_back(in, input.second);
+            }
+        }
+
+        std::vector<int32_t> indegree(products.size(), 0);
+        std::vector<std::vector<int32_t>> consumers(products.size());
+        for (size_t p = 0; p < products.size(); ++p) {
+            for (const auto& input : compiled_inputs[p]) {
+                consumers[input.first].push_back(static_cast<int32_t>(p));
+                ++indegree[p];
+            }
+        }
+
+        levels.clear();
+        std::vector<int32_t> frontier;
+        for (size_t p = 0; p < products.size(); ++p) {
+            if (indegree[p] == 0) frontier.push_back(static_cast<int32_t>(p));
+        }
+        size_t visited = 0;
+        while (!frontier.empty()) {
+            levels.push_back(frontier);
+            visited += frontier.size();
+            std::vector<int32_t> next;
+            for (int32_t p : frontier) {
+                for (int32_t c : consumers[p]) {
+                    if (--indegree[c] == 0) next.push_back(c);
+                }
+            }
+            frontier.swap(next);
+        }
+        if (visited != products.size()) {
+            throw std::runtime_error("Production recipes contain a cycle");
+        }
+
+        level_names.clear();
+        for (const auto& level : levels) {
+            std::vector<std::string> names;
+            for (int32_t p : level) names.push_back(products[p]);
+            level_names.push_back(std::move(names));
+        }
+        compiled = true;
+    }
+
+    // 企業を製品ごとに振り分ける。レシピにない製品は一次産品として先頭の段に加える
+    void indexBusinesses(const std::vector<Business>& businesses) {
+        producers.assign(products.size(), {});
+        for (size_t b = 0; b < businesses.size(); ++b) {
+            const std::string& product = businesses[b].product;
+            if (product.empty()) continue;
+            auto it = product_ids.find(product);
+            int32_t id;
+            if (it == product_ids.end()) {
+                id = internProduct(product);
+                producers.emplace_back();
+                if (levels.empty()) levels.emplace_back();
+                levels.front().push_back(id);
+                level_names.resize(levels.size());
+                level_names.front().push_back(product);
+            } else {
+                id = it->second;
+            }
+            producers[id].push_back(b);
+        }
+    }
+
+    int64_t businessOutput(int32_t product, const Business& business) const {
+        const Recipe* recipe = compiled_recipes[product];
+        if (!recipe) return std::max<int32_t>(business.daily_production, 0);
+        return static_cast<int64_t>(std::max<int32_t>(business.workers, 0)) *
+               recipe->output_per_worker;
+    }
+
+    // 各社の産出量に産出倍率を掛けて planned に入れる（indexBusinesses の後に呼ぶ）
+    void planOutput(const std::vector<Business>& businesses) {
+        const size_t n = businesses.size();
+        raw.assign(n, 0);
+        for (size_t p = 0; p < producers.size(); ++p) {
+            for (size_t b : producers[p]) {
+                raw[b] = static_cast<int32_t>(std::min<int64_t>(
+                    businessOutput(static_cast<int32_t>(p), businesses[b]), std::numeric_limits<int32_t>::max()));
+            }
+        }
+        if (output_scale.empty()) {
+            planned = raw;
+            return;
+        }
+        scale.assign(n, 1.0f);
+        std::copy_n(output_scale.begin(), std::min(n, output_scale.size()), scale.begin());
+        planned.resize(n);
+        scaleOutput(raw.data(), scale.data(), planned.data(), n);
+    }
+
+    int64_t desiredOutput(int32_t product) const {
+        int64_t total = 0;
+        for (size_t b : producers[product]) {
+            total += planned[b];
+        }
+        return total;
+    }
+
+    int64_t availableStock(int32_t product, const std::vector<Business>& businesses) const {
+        int64_t total = 0;
+        for (size_t b : producers[product]) {
+            total += businesses[b].stock;
+        }
+        return total;
+    }
+
+    // 供給元の在庫を登録順に取り崩す
+    void drainStock(int32_t product, int64_t amount, std::vector<Business>& businesses) const {
+        for (size_t b : producers[product]) {
+            if (amount <= 0) break;
+            Business& business = businesses[b];
+            const int64_t take = std::min<int64_t>(amount, business.stock);
+            business.stock -= static_cast<int32_t>(take);
+            amount -= take;
+        }
+    }
+};
+
+#endif // PRODUCTION_H
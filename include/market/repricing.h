@@ -0,0 +1,84 @@
+#pragma once
+#ifndef REPRICING_H
+#define REPRICING_H
+
+#include <cstddef>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MARKET_REPRICE_AVX2 1
+#else
+#define MARKET_REPRICE_AVX2 0
+#endif
+
+// 全商品の一括価格更新カーネル
+// demand / supply / price は商品ごとに連続した配列（Market が持つ当日の需給の合計と価格そのもの）で、次の規則で price を更新する:
+//   供給0の商品は据え置き、需給比から価格変化率 (比 - 1) * volatility を求め、切り捨て後に最低価格1で下限を取る
+
+// スカラー版（参照実装）
+inline void repriceScalar(const int* demand, const int* supply, int* price, size_t n,
+                          float volatility) {
+    for (size_t i = 0; i < n; ++i) {
+        if (supply[i] == 0) continue;
+        const float demand_supply_ratio = static_cast<float>(demand[i]) / supply[i];
+        const float price_change = (demand_supply_ratio - 1.0f) * volatility;
+        int updated = static_cast<int>(price[i] * (1.0f + price_change));
+        if (updated < 1) updated = 1;
+        price[i] = updated;
+    }
+}
+
+#if MARKET_REPRICE_AVX2
+// AVX2 版（8商品ずつ）。演算順はスカラー版と同一なので結果はビット単位で一致する
+__attribute__((target("avx2")))
+inline void repriceAvx2(const int* demand, const int* supply, int* price, size_t n,
+                        float volatility) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 vol = _mm256_set1_ps(volatility);
+    const __m256i min_price = _mm256_set1_epi32(1);
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(demand + i));
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(supply + i));
+        const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(price + i));
+
+        const __m256 ratio = _mm256_div_ps(_mm256_cvtepi32_ps(d), _mm256_cvtepi32_ps(s));
+        const __m256 change = _mm256_mul_ps(_mm256_sub_ps(ratio, one), vol);
+        const __m256 scaled = _mm256_mul_ps(_mm256_cvtepi32_ps(p), _mm256_add_ps(one, change));
+        __m256i updated = _mm256_cvttps_epi32(scaled);
+        updated = _mm256_max_epi32(updated, min_price);
+
+        // 供給0のレーンは元の価格を残す
+        const __m256i skip = _mm256_cmpeq_epi32(s, zero);
+        const __m256i result = _mm256_blendv_epi8(updated, p, skip);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(price + i), result);
+    }
+    repriceScalar(demand + i, supply + i, price + i, n - i, volatility);
+}
+#endif
+
+// 実行中のCPUで AVX2 版が使われるか
+inline bool repricingUsesAvx2() {
+#if MARKET_REPRICE_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+// CPU に応じて AVX2 版かスカラー版を選んで実行する
+inline void repriceBatch(const int* demand, const int* supply, int* price, size_t n,
+                         float volatility) {
+#if MARKET_REPRICE_AVX2
+    if (repricingUsesAvx2()) {
+        repriceAvx2(demand, supply, price, n, volatility);
+        return;
+    }
+#endif
+    repriceScalar(demand, supply, price, n, volatility);
+}
+
+#endif // REPRICING_H
@@ -0,0 +1,81 @@
+#pragma once
+#ifndef SEASONAL_PRODUCTION_H
+#define SEASONAL_PRODUCTION_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "business.h"
+#include "production.h"
+#include "sector_index.h"
+#include "../system/calendar.h"
+
+// 業種ごと・季節ごとの生産量の倍率
+// apply で倍率[業種][季節] を企業ごとの連続配列に集め、ProductionGraph の産出倍率に設定する。
+// 産出量（レシピなら workers * output_per_worker、なければ daily_production）は変えずに、
+// 生産のたびに ProductionGraph::scaleOutput（AVX2 / スカラー）で倍率を掛ける。
+// 季節の変わり目にだけ apply を呼べばよいので、毎日企業ごとに季節を確かめる必要はない。
+// 企業を増やしたら apply し直す（それまで新しい企業は1倍）
+class SeasonalProduction {
+public:
+    using Multipliers = std::array<float, Calendar::SEASONS>;
+
+    // 農業は秋に多く冬はほとんど取れず、鉱業は冬に落ちる。それ以外の業種は通年1倍
+    static SeasonalProduction standard() {
+        SeasonalProduction seasonal;
+        seasonal.setMultipliers("農業", {1.0f, 1.2f, 1.5f, 0.3f});
+        seasonal.setMultipliers("鉱業", {1.0f, 1.0f, 1.0f, 0.8f});
+        return seasonal;
+    }
+
+    void setMultiplier(const std::string& sector, Season season, float multiplier) {
+        validate(multiplier);
+        auto it = table.try_emplace(sector, Multipliers{1.0f, 1.0f, 1.0f, 1.0f}).first;
+        it->second[static_cast<size_t>(season)] = multiplier;
+    }
+
+    void setMultipliers(const std::string& sector, const Multipliers& multipliers) {
+        for (float multiplier : multipliers) validate(multiplier);
+        table[sector] = multipliers;
+    }
+
+    float multiplier(const std::string& sector, Season season) const {
+        auto it = table.find(sector);
+        return it != table.end() ? it->second[static_cast<size_t>(season)] : 1.0f;
+    }
+
+    // season の倍率を企業ごとの列にして production の産出倍率にする。sectors は businesses の索引
+    void apply(ProductionGraph& production, const std::vector<Business>& businesses, const SectorIndex& sectors,
+               Season season) const {
+        // 業種番号ごとの倍率を引き、企業ごとの列に集める
+        std::vector<float> by_sector(sectors.sectorCount());
+        for (size_t s = 0; s < by_sector.size(); ++s) {
+            by_sector[s] = multiplier(sectors.sectorName(static_cast<int32_t>(s)), season);
+        }
+        std::vector<float> scale(businesses.size(), 1.0f);
+        for (size_t b = 0; b < businesses.size(); ++b) {
+            const int32_t sector = sectors.sectorOf(b);
+            if (sector != SectorIndex::NO_SECTOR) scale[b] = by_sector[static_cast<size_t>(sector)];
+        }
+        production.setOutputScale(std::move(scale));
+    }
+
+    const std::map<std::string, Multipliers>& multipliers() const { return table; }
+
+private:
+    std::map<std::string, Multipliers> table;
+
+    static void validate(float multiplier) {
+        if (!(multiplier >= 0.0f) || multiplier > 1000.0f) {
+            throw std::invalid_argument("Seasonal multiplier must be within [0, 1000]");
+        }
+    }
+};
+
+#endif // SEASONAL_PRODUCTION_H
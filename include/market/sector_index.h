@@ -0,0 +1,105 @@
+#pragma once
+#ifndef SECTOR_INDEX_H
+#define SECTOR_INDEX_H
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "business.h"
+
+// 業種（Business::sector）→ 企業の添字 の索引
+// 業種単位の一括処理（政策適用・業種別集計）で全企業を走査せずに済むようにする
+class SectorIndex {
+public:
+    static constexpr int32_t NO_SECTOR = -1;
+
+    // 全企業から索引を作り直す
+    void rebuild(const std::vector<Business>& businesses) {
+        for (auto& list : sectors) list.clear();
+        sector_of.assign(businesses.size(), NO_SECTOR);
+        position.assign(businesses.size(), 0);
+        for (size_t b = 0; b < businesses.size(); ++b) {
+            insert(b, businesses[b].sector);
+        }
+    }
+
+    // 1社の業種を変更し、索引を差分更新する
+    void assign(size_t business, const std::string& sector, std::vector<Business>& businesses) {
+        if (business >= businesses.size()) {
+            throw std::out_of_range("Unknown business");
+        }
+        if (business >= sector_of.size()) {
+            sector_of.resize(businesses.size(), NO_SECTOR);
+            position.resize(businesses.size(), 0);
+        }
+        remove(business);
+        businesses[business].sector = sector;
+        insert(business, sector);
+    }
+
+    int32_t sectorId(const std::string& sector) const {
+        auto it = ids.find(sector);
+        return it != ids.end() ? it->second : NO_SECTOR;
+    }
+
+    const std::string& sectorName(int32_t id) const { return names.at(id); }
+    size_t sectorCount() const { return names.size(); }
+
+    const std::vector<size_t>& businessesIn(int32_t id) const {
+        static const std::vector<size_t> none;
+        if (id < 0 || static_cast<size_t>(id) >= sectors.size()) return none;
+        return sectors[id];
+    }
+
+    const std::vector<size_t>& businessesIn(const std::string& sector) const {
+        return businessesIn(sectorId(sector));
+    }
+
+    int32_t sectorOf(size_t business) const {
+        return business < sector_of.size() ? sector_of[business] : NO_SECTOR;
+    }
+
+private:
+    std::map<std::string, int32_t> ids;
+    std::vector<std::string> names;
+    std::vector<std::vector<size_t>> sectors;
+    std::vector<int32_t> sector_of;
+    std::vector<size_t> position;
+
+    int32_t intern(const std::string& sector) {
+        auto it = ids.find(sector);
+        if (it != ids.end()) return it->second;
+        const int32_t id = static_cast<int32_t>(names.size());
+        ids.emplace(sector, id);
+        names.push_back(sector);
+        sectors.emplace_back();
+        return id;
+    }
+
+    // 業種が空の企業は索引に載せない
+    void insert(size_t business, const std::string& sector) {
+        if (sector.empty()) {
+            sector_of[business] = NO_SECTOR;
+            return;
+        }
+        const int32_t id = intern(sector);
+        sector_of[business] = id;
+        position[business] = sectors[id].size();
+        sectors[id].push_back(business);
+    }
+
+    void remove(size_t business) {
+        const int32_t id = sector_of[business];
+        if (id == NO_SECTOR) return;
+        auto& list = sectors[id];
+        const size_t pos = position[business];
+        list[pos] = list.back();
+        position[list[pos]] = pos;
+        list.pop_back();
+        sector_of[business] = NO_SECTOR;
+    }
+};
+
+#endif // SECTOR_INDEX_H
@@ -0,0 +1,274 @@
+#pragma once
+#ifndef AGENT_COLUMNS_H
+#define AGENT_COLUMNS_H
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "agent_fields.h"
+#include "checkpoint.h"
+#include "column_store.h"
+#include "simulation.h"
+
+// World を列指向で保存する形式（ColumnStore 上）
+// 住民と企業の属性は AgentFields の表の1項目1カラム（"person.money" など）。職業・製品・業種は共通の辞書の番号、
+// 住民名と持ち物は可変長文字列カラム（"_offsets" と "_chars" の組）、
+// それ以外の状態（日付・設定・政府・融資・市場・LOD の集団など）は Checkpoint::saveState のバイト列を world.state カラムに入れる。
+// チェックポイント形式として使う。World::step は people / businesses の vector を相手に動くので load はカラムを
+// vector に展開するが、課税・収入のフェーズは ColumnarPopulation で展開せずにファイル上のカラムのまま進められる
+class AgentColumns {
+public:
+    static void save(const World& world, const std::string& path) {
+        Dictionary dictionary;
+        std::vector<ColumnSpec> specs;
+        describe("person.", world.people, AgentFields::personInts(), AgentFields::personTexts(), dictionary, specs);
+        describe("business.", world.businesses, AgentFields::businessInts(), AgentFields::businessTexts(),
+                 dictionary, specs);
+        uint64_t dictionary_bytes = 0;
+        for (const auto& text : dictionary.texts) dictionary_bytes += text.size();
+
+        std::ostringstream state_stream;
+        Checkpoint::saveState(world, state_stream);
+        const std::string state = state_stream.str();
+
+        specs.push_back({"dict.offsets", ColumnType::UINT64, dictionary.texts.size() + 1});
+        specs.push_back({"dict.chars", ColumnType::UINT8, dictionary_bytes});
+        specs.push_back({"world.state", ColumnType::UINT8, state.size()});
+        ColumnStore store = ColumnStore::create(path, specs);
+
+        write(store, "person.", world.people, AgentFields::personInts(), AgentFields::personTexts(), dictionary);
+        write(store, "business.", world.businesses, AgentFields::businessInts(), AgentFields::businessTexts(),
+              dictionary);
+        writeStrings(store, "dict.offsets", "dict.chars", dictionary.texts.size(),
+                     [&dictionary](size_t i) { return dictionary.texts[i]; });
+
+        if (!state.empty()) {
+            std::memcpy(store.data<uint8_t>("world.state"), state.data(), state.size());
+        }
+        store.flush();
+    }
+
+    // ファイルから World を組み立てる（住民・企業はメモリ上の vector に展開する）
+    static World load(const std::string& path) {
+        const ColumnStore store = ColumnStore::open(path);
+        World world;
+        const uint8_t* state_bytes = store.data<uint8_t>("world.state");
+        std::istringstream state(std::string(reinterpret_cast<const char*>(state_bytes),
+                                             store.length("world.state")));
+        Checkpoint::loadState(state, world);
+
+        const std::vector<std::string> dictionary = readStrings(store, "dict.offsets", "dict.chars");
+        read(store, "person.", world.people, AgentFields::personInts(), AgentFields::personTexts(), dictionary);
+        read(store, "business.", world.businesses, AgentFields::businessInts(), AgentFields::businessTexts(),
+             dictionary);
+
+        world.rebuildDerivedState();
+        return world;
+    }
+
+private:
+    // 職業・製品・業種の共通の辞書（出てきた順に番号を振る）
+    struct Dictionary {
+        std::vector<std::string> texts;
+        std::map<std::string, int32_t> codes;
+
+        int32_t encode(const std::string& text) {
+            auto it = codes.find(text);
+            if (it != codes.end()) return it->second;
+            const int32_t code = static_cast<int32_t>(texts.size());
+            codes.emplace(text, code);
+            texts.push_back(text);
+            return code;
+        }
+    };
+
+    // AgentFields の表から prefix の付いたカラムの定義を作る（辞書もここで埋める）
+    template <typename Agent>
+    static void describe(const std::string& prefix, const std::vector<Agent>& agents,
+                         const std::vector<IntField<Agent>>& ints, const std::vector<TextField<Agent>>& texts,
+                         Dictionary& dictionary, std::vector<ColumnSpec>& specs) {
+        const uint64_t count = agents.size();
+        for (const auto& field : ints) specs.push_back({prefix + field.name, field.type, count});
+        for (const auto& field : texts) {
+            if (field.dictionary) {
+                for (const auto& agent : agents) dictionary.encode(field.get(agent));
+                specs.push_back({prefix + field.name, ColumnType::INT32, count});
+                continue;
+            }
+            uint64_t bytes = 0;
+            for (const auto& agent : agents) bytes += field.get(agent).size();
+            specs.push_back({prefix + field.name + "_offsets", ColumnType::UINT64, count + 1});
+            specs.push_back({prefix + field.name + "_chars", ColumnType::UINT8, bytes});
+        }
+    }
+
+    template <typename Agent>
+    static void write(ColumnStore& store, const std::string& prefix, const std::vector<Agent>& agents,
+                      const std::vector<IntField<Agent>>& ints, const std::vector<TextField<Agent>>& texts,
+                      Dictionary& dictionary) {
+        for (const auto& field : ints) {
+            const std::string column = prefix + field.name;
+            if (field.type == ColumnType::INT64) {
+                int64_t* values = store.data<int64_t>(column);
+                for (size_t i = 0; i < agents.size(); ++i) values[i] = field.get(agents[i]);
+            } else if (field.type == ColumnType::FLOAT32) {
+                float* values = store.data<float>(column);
+                for (size_t i = 0; i < agents.size(); ++i) values[i] = AgentFields::bitsFloat(field.get(agents[i]));
+            } else {
+                int32_t* values = store.data<int32_t>(column);
+                for (size_t i = 0; i < agents.size(); ++i) values[i] = static_cast<int32_t>(field.get(agents[i]));
+            }
+        }
+        for (const auto& field : texts) {
+            if (field.dictionary) {
+                int32_t* codes = store.data<int32_t>(prefix + field.name);
+                for (size_t i = 0; i < agents.size(); ++i) codes[i] = dictionary.encode(field.get(agents[i]));
+                continue;
+            }
+            writeStrings(store, prefix + field.name + "_offsets", prefix + field.name + "_chars", agents.size(),
+                         [&](size_t i) { return field.get(agents[i]); });
+        }
+    }
+
+    template <typename Agent>
+    static void read(const ColumnStore& store, const std::string& prefix, std::vector<Agent>& agents,
+                     const std::vector<IntField<Agent>>& ints, const std::vector<TextField<Agent>>& texts,
+                     const std::vector<std::string>& dictionary) {
+        agents.resize(store.length(prefix + ints.front().name));
+        for (const auto& field : ints) {
+            const std::string column = prefix + field.name;
+            if (store.length(column) != agents.size()) {
+                throw std::runtime_error("Column length does not match: " + column);
+            }
+            if (field.type == ColumnType::INT64) {
+                const int64_t* values = store.data<int64_t>(column);
+                for (size_t i = 0; i < agents.size(); ++i) field.set(agents[i], values[i]);
+            } else if (field.type == ColumnType::FLOAT32) {
+                const float* values = store.data<float>(column);
+                for (size_t i = 0; i < agents.size(); ++i) field.set(agents[i], AgentFields::floatBits(values[i]));
+            } else {
+                const int32_t* values = store.data<int32_t>(column);
+                for (size_t i = 0; i < agents.size(); ++i) field.set(agents[i], values[i]);
+            }
+        }
+        for (const auto& field : texts) {
+            if (field.dictionary) {
+                const std::string column = prefix + field.name;
+                if (store.length(column) != agents.size()) {
+                    throw std::runtime_error("Column length does not match: " + column);
+                }
+                const int32_t* codes = store.data<int32_t>(column);
+                for (size_t i = 0; i < agents.size(); ++i) {
+                    if (codes[i] < 0 || static_cast<size_t>(codes[i]) >= dictionary.size()) {
+                        throw std::runtime_error("Column store dictionary code out of range");
+                    }
+                    field.set(agents[i], dictionary[codes[i]]);
+                }
+                continue;
+            }
+            std::vector<std::string> values =
+                readStrings(store, prefix + field.name + "_offsets", prefix + field.name + "_chars");
+            if (values.size() != agents.size()) {
+                throw std::runtime_error("Column length does not match: " + prefix + field.name);
+            }
+            for (size_t i = 0; i < agents.size(); ++i) field.set(agents[i], std::move(values[i]));
+        }
+    }
+
+    template <typename TextAt>
+    static void writeStrings(ColumnStore& store, const std::string& offsets_name,
+                             const std::string& chars_name, size_t count, TextAt text_at) {
+        uint64_t* offsets = store.data<uint64_t>(offsets_name);
+        uint8_t* chars = store.length(chars_name) > 0 ? store.data<uint8_t>(chars_name) : nullptr;
+        uint64_t position = 0;
+        for (size_t i = 0; i < count; ++i) {
+            offsets[i] = position;
+            const std::string text = text_at(i);
+            if (!text.empty()) std::memcpy(chars + position, text.data(), text.size());
+            position += text.size();
+        }
+        offsets[count] = position;
+    }
+
+    static std::vector<std::string> readStrings(const ColumnStore& store, const std::string& offsets_name,
+                                                const std::string& chars_name) {
+        const uint64_t* offsets = store.data<uint64_t>(offsets_name);
+        const char* chars = reinterpret_cast<const char*>(store.data<uint8_t>(chars_name));
+        const uint64_t total = store.length(chars_name);
+        const size_t count = store.length(offsets_name) - 1;
+        std::vector<std::string> texts(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > total) {
+                throw std::runtime_error("Corrupted string column: " + chars_name);
+            }
+            texts[i].assign(chars + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+        return texts;
+    }
+};
+
+// AgentColumns 形式のファイルの住民カラムを vector に展開せず、mmap 越しにチャンク単位で進める
+// World::step の課税・収入フェーズ（LOD なしの全住民）と同じ規則・順序で "person.money" を書き換える。
+// ColumnStore::streamRows で先読みと処理済みチャンクの解放を依頼するので、常駐量はチャンク数個分に収まり、
+// 物理メモリを超える人口でもディスク帯域で流れる（OS のページキャッシュがバッファになる）
+class ColumnarPopulation {
+public:
+    static ColumnarPopulation open(const std::string& path, size_t chunk_rows = 0) {
+        ColumnarPopulation population;
+        population.store = ColumnStore::open(path, true);
+        population.store.adviseHugePages();
+        population.chunk_rows = chunk_rows > 0 ? chunk_rows : ColumnStore::defaultChunkRows<int64_t>();
+        if (population.store.length("person.income") != population.size()) {
+            throw std::runtime_error("Column length does not match: person.income");
+        }
+        return population;
+    }
+
+    size_t size() const { return store.length("person.money"); }
+    const ColumnStore& columns() const { return store; }
+
+    // 課税フェーズ: World::personTax の税を各住民から government に移す。課税した人数を返す
+    int64_t collectTax(Government& government) {
+        int64_t* money = store.data<int64_t>("person.money");
+        int64_t taxed = 0;
+        int64_t collected = 0;
+        store.streamRows({"person.money"}, chunk_rows, [&](size_t begin, size_t count) {
+            for (size_t i = begin; i < begin + count; ++i) {
+                const int64_t tax = World::personTax(government, money[i]);
+                if (tax <= 0 || tax > money[i]) continue;
+                money[i] -= tax;
+                collected += tax;
+                ++taxed;
+            }
+        });
+        government.addMoney(collected);
+        government.approval_rating -= static_cast<float>(taxed);
+        return taxed;
+    }
+
+    // 収入フェーズ: 各住民の所持金に日収を足す。支払った日収の合計を返す
+    int64_t payIncome() {
+        int64_t* money = store.data<int64_t>("person.money");
+        const int32_t* income = store.data<int32_t>("person.income");
+        int64_t paid = 0;
+        store.streamRows({"person.money", "person.income"}, chunk_rows, [&](size_t begin, size_t count) {
+            for (size_t i = begin; i < begin + count; ++i) {
+                money[i] += income[i];
+                paid += income[i];
+            }
+        });
+        return paid;
+    }
+
+    void flush() { store.flush(); }
+
+private:
+    ColumnStore store;
+    size_t chunk_rows = 0;
+};
+
+#endif // AGENT_COLUMNS_H
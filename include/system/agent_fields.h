@@ -0,0 +1,155 @@
+#pragma once
+#ifndef AGENT_FIELDS_H
+#define AGENT_FIELDS_H
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "column_store.h"
+#include "../agent/person.h"
+#include "../market/business.h"
+
+// 住民・企業の保存項目の表
+// Checkpoint（バイナリ）・AgentColumns（列ファイル）・AsyncCheckpoint（圧縮チャンク）は、どれもこの表を順にたどって
+// 読み書きする。保存する属性を増やすときはここに1行足せば3つの形式すべてに入る
+//
+// 数値の項目は int64_t でやり取りし、type は保存時の幅（INT32 / INT64）を表す。FLOAT32 の項目はビット列を
+// そのまま int64_t に入れる。文字列の項目のうち dictionary のもの（職業・製品・業種）は AgentColumns では
+// 共通の辞書の番号で持つ
+template <typename Agent>
+struct IntField {
+    const char* name;
+    ColumnType type;
+    int64_t (*get)(const Agent&);
+    void (*set)(Agent&, int64_t);
+};
+
+template <typename Agent>
+struct TextField {
+    const char* name;
+    bool dictionary;
+    std::string (*get)(const Agent&);
+    void (*set)(Agent&, std::string);
+};
+
+class AgentFields {
+public:
+    static const std::vector<IntField<Person>>& personInts() {
+        static const std::vector<IntField<Person>> fields = {
+            {"id", ColumnType::INT64, [](const Person& p) -> int64_t { return p.id; },
+             [](Person& p, int64_t v) { p.id = v; }},
+            {"money", ColumnType::INT64, [](const Person& p) -> int64_t { return p.money; },
+             [](Person& p, int64_t v) { p.money = v; }},
+            {"income", ColumnType::INT32, [](const Person& p) -> int64_t { return p.daily_income; },
+             [](Person& p, int64_t v) { p.setDailyIncome(narrow(v)); }},
+            {"expense", ColumnType::INT32, [](const Person& p) -> int64_t { return p.daily_expense; },
+             [](Person& p, int64_t v) { p.setDailyExpense(narrow(v)); }},
+            {"satisfaction", ColumnType::INT32, [](const Person& p) -> int64_t { return p.satisfaction; },
+             [](Person& p, int64_t v) { p.setSatisfaction(narrow(v)); }},
+            {"risk", ColumnType::INT32, [](const Person& p) -> int64_t { return p.risk_tolerance; },
+             [](Person& p, int64_t v) { p.setRiskTolerance(narrow(v)); }},
+            {"health", ColumnType::INT32,
+             [](const Person& p) -> int64_t { return static_cast<int64_t>(p.health_status); },
+             [](Person& p, int64_t v) { p.setHealthStatus(static_cast<HealthStatus>(narrow(v))); }},
+            {"crime", ColumnType::INT32,
+             [](const Person& p) -> int64_t { return static_cast<int64_t>(p.crime_tendency); },
+             [](Person& p, int64_t v) { p.setCrimeTendency(static_cast<CrimeTendency>(narrow(v))); }},
+        };
+        return fields;
+    }
+
+    static const std::vector<TextField<Person>>& personTexts() {
+        static const std::vector<TextField<Person>> fields = {
+            {"name", false, [](const Person& p) { return p.name; },
+             [](Person& p, std::string v) { p.name = std::move(v); }},
+            {"job", true, [](const Person& p) { return p.job; },
+             [](Person& p, std::string v) { p.job = std::move(v); }},
+            {"inventory", false, [](const Person& p) { return joinInventory(p.inventory); },
+             [](Person& p, std::string v) { p.inventory = splitInventory(v); }},
+        };
+        return fields;
+    }
+
+    static const std::vector<IntField<Business>>& businessInts() {
+        static const std::vector<IntField<Business>> fields = {
+            {"id", ColumnType::INT64, [](const Business& b) -> int64_t { return b.id; },
+             [](Business& b, int64_t v) { b.id = v; }},
+            {"money", ColumnType::INT64, [](const Business& b) -> int64_t { return b.money; },
+             [](Business& b, int64_t v) { b.money = v; }},
+            {"stock", ColumnType::INT32, [](const Business& b) -> int64_t { return b.stock; },
+             [](Business& b, int64_t v) { b.stock = narrow(v); }},
+            {"price", ColumnType::INT64, [](const Business& b) -> int64_t { return b.price; },
+             [](Business& b, int64_t v) { b.price = v; }},
+            {"workers", ColumnType::INT32, [](const Business& b) -> int64_t { return b.workers; },
+             [](Business& b, int64_t v) { b.workers = narrow(v); }},
+            {"production", ColumnType::INT32, [](const Business& b) -> int64_t { return b.daily_production; },
+             [](Business& b, int64_t v) { b.daily_production = narrow(v); }},
+            {"margin", ColumnType::FLOAT32, [](const Business& b) -> int64_t { return floatBits(b.profit_margin); },
+             [](Business& b, int64_t v) { b.profit_margin = bitsFloat(v); }},
+            {"share", ColumnType::INT32, [](const Business& b) -> int64_t { return b.market_share; },
+             [](Business& b, int64_t v) { b.market_share = narrow(v); }},
+        };
+        return fields;
+    }
+
+    static const std::vector<TextField<Business>>& businessTexts() {
+        static const std::vector<TextField<Business>> fields = {
+            {"product", true, [](const Business& b) { return b.product; },
+             [](Business& b, std::string v) { b.product = std::move(v); }},
+            {"sector", true, [](const Business& b) { return b.sector; },
+             [](Business& b, std::string v) { b.sector = std::move(v); }},
+        };
+        return fields;
+    }
+
+    // 持ち物は1つの文字列にまとめる（品名に改行は含まれない前提）
+    static std::string joinInventory(const std::vector<std::string>& inventory) {
+        std::string joined;
+        for (size_t i = 0; i < inventory.size(); ++i) {
+            if (i > 0) joined += '\n';
+            joined += inventory[i];
+        }
+        return joined;
+    }
+
+    static std::vector<std::string> splitInventory(const std::string& joined) {
+        std::vector<std::string> inventory;
+        size_t begin = 0;
+        while (begin < joined.size()) {
+            size_t end = joined.find('\n', begin);
+            if (end == std::string::npos) end = joined.size();
+            inventory.push_back(joined.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        return inventory;
+    }
+
+    static int32_t narrow(int64_t value) {
+        if (value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max()) {
+            throw std::runtime_error("Checkpoint value out of range");
+        }
+        return static_cast<int32_t>(value);
+    }
+
+    static int64_t floatBits(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static float bitsFloat(int64_t bits) {
+        if (bits < 0 || bits > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("Checkpoint value out of range");
+        }
+        const uint32_t narrow_bits = static_cast<uint32_t>(bits);
+        float value;
+        std::memcpy(&value, &narrow_bits, sizeof(value));
+        return value;
+    }
+};
+
+#endif // AGENT_FIELDS_H
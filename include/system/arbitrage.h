@@ -0,0 +1,296 @@
+#pragma once
+#ifndef ARBITRAGE_H
+#define ARBITRAGE_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../agent/person.h"
+#include "route_network.h"
+#include "thread_pool.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ARBITRAGE_AVX2 1
+#else
+#define ARBITRAGE_AVX2 0
+#endif
+
+// 市場ごとの価格と在庫のスナップショット（市場 × 商品の行優先。価格0は未取引）
+struct MarketSnapshot {
+    size_t markets = 0;
+    size_t products = 0;
+    std::vector<int32_t> price;
+    std::vector<int32_t> stock;
+
+    MarketSnapshot() = default;
+    MarketSnapshot(size_t market_count, size_t product_count)
+        : markets(market_count), products(product_count),
+          price(market_count * product_count, 0), stock(market_count * product_count, 0) {}
+
+    int32_t* priceRow(size_t market) { return price.data() + market * products; }
+    const int32_t* priceRow(size_t market) const { return price.data() + market * products; }
+    int32_t* stockRow(size_t market) { return stock.data() + market * products; }
+    const int32_t* stockRow(size_t market) const { return stock.data() + market * products; }
+};
+
+// 市場から隣の市場への輸送路
+struct MarketLink {
+    uint32_t from;
+    uint32_t to;
+    int32_t travel_time;
+};
+
+struct ArbitrageConfig {
+    int32_t cargo = 10;          // 商人1人が1回に運ぶ数量
+    int32_t cost_per_day = 1;    // 1単位を1日運ぶ費用
+    size_t per_route = 4;        // 輸送路1本あたりに残す商品の数
+};
+
+// 裁定の機会（from で買って to で売る）
+struct ArbitrageOpportunity {
+    uint32_t from;
+    uint32_t to;
+    uint32_t product;
+    int32_t margin;       // 1単位あたりの利ざや（輸送費控除後）
+    int32_t travel_time;
+    int32_t capacity;     // この商品を仕入れ先から運べる商人の数（仕入れ先の在庫 / cargo。同じ仕入れ先・商品の機会で共有）
+};
+
+// 商人への割り当て（opportunity は scan の結果の市場ごとの一覧での位置）
+struct ArbitrageAssignment {
+    size_t merchant;      // merchant_markets の添字
+    uint32_t from;
+    uint32_t to;
+    uint32_t product;
+    int64_t profit;       // margin * cargo
+};
+
+// 市場間の裁定スキャナ
+// scan は出発市場ごとに（商品 × 隣の市場）を走査し、輸送路ごとに利ざやの大きい商品を per_route 個まで残して、
+// 市場ごとに利益の大きい順（同点は行き先・商品の番号順）に並べる。商品の走査は連続配列に対する AVX2 のカーネル（非対応の CPU ではスカラー版）で、
+// 出発市場ごとに独立なのでスレッドプールで並列に回せる。
+// assign は商人を番号順に見て、いる市場で容量の残っている最良の機会を割り当てる。
+// 仕入れ先の商品ごとに在庫で決まる人数までしか取れない（行き先が複数あっても在庫は共有する）ので、全員が同じ利ざやに殺到しない
+class ArbitrageScanner {
+public:
+    using MarketOpportunities = std::vector<std::vector<ArbitrageOpportunity>>;
+
+    static MarketOpportunities scan(const MarketSnapshot& snapshot, const std::vector<MarketLink>& links,
+                                    const ArbitrageConfig& config = {}, ThreadPool* pool = nullptr) {
+        if (snapshot.price.size() != snapshot.markets * snapshot.products ||
+            snapshot.stock.size() != snapshot.price.size()) {
+            throw std::invalid_argument("Market snapshot size mismatch");
+        }
+        if (config.cargo <= 0) {
+            throw std::invalid_argument("Cargo must be positive");
+        }
+
+        // 出発市場ごとの輸送路（CSR）
+        std::vector<size_t> offsets(snapshot.markets + 1, 0);
+        for (const auto& link : links) {
+            if (link.from >= snapshot.markets || link.to >= snapshot.markets) {
+                throw std::out_of_range("Market link out of range");
+            }
+            ++offsets[link.from + 1];
+        }
+        for (size_t m = 0; m < snapshot.markets; ++m) offsets[m + 1] += offsets[m];
+        std::vector<MarketLink> outgoing(links.size());
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (const auto& link : links) outgoing[cursor[link.from]++] = link;
+
+        MarketOpportunities result(snapshot.markets);
+        auto scanMarkets = [&](size_t lo, size_t hi) {
+            std::vector<int32_t> margins(snapshot.products);
+            std::vector<uint32_t> candidates;
+            for (size_t from = lo; from < hi; ++from) {
+                auto& found = result[from];
+                for (size_t k = offsets[from]; k < offsets[from + 1]; ++k) {
+                    const MarketLink& link = outgoing[k];
+                    const int32_t transport = config.cost_per_day * link.travel_time;
+                    const int32_t best = computeMargins(snapshot.priceRow(from), snapshot.stockRow(from),
+                                                        snapshot.priceRow(link.to), snapshot.products,
+                                                        transport, config.cargo, margins.data());
+                    if (best <= 0) continue;
+                    collectTop(margins, config.per_route, candidates);
+                    for (uint32_t product : candidates) {
+                        found.push_back({link.from, link.to, product, margins[product], link.travel_time,
+                                         snapshot.stockRow(from)[product] / config.cargo});
+                    }
+                }
+                std::sort(found.begin(), found.end(), [](const ArbitrageOpportunity& a, const ArbitrageOpportunity& b) {
+                    return std::make_tuple(-static_cast<int64_t>(a.margin), a.to, a.product) <
+                           std::make_tuple(-static_cast<int64_t>(b.margin), b.to, b.product);
+                });
+            }
+        };
+        if (pool) {
+            pool->parallelFor(0, snapshot.markets, scanMarkets, 1);
+        } else {
+            scanMarkets(0, snapshot.markets);
+        }
+        return result;
+    }
+
+    // merchant_markets[i] は商人 i がいる市場。割り当てられた商人だけを返す
+    static std::vector<ArbitrageAssignment> assign(const MarketOpportunities& opportunities,
+                                                   const std::vector<uint32_t>& merchant_markets,
+                                                   const ArbitrageConfig& config = {}) {
+        // 残りの容量は (仕入れ先, 商品) ごとに持つ。同じ在庫を行き先の違う機会で何度も売らないように、
+        // 機会 k は slot[m][k] 番の在庫を共有する
+        std::vector<std::vector<int32_t>> remaining(opportunities.size());
+        std::vector<std::vector<size_t>> slot(opportunities.size());
+        std::vector<size_t> next(opportunities.size(), 0);
+        for (size_t m = 0; m < opportunities.size(); ++m) {
+            std::map<uint32_t, size_t> by_product;
+            for (const auto& opportunity : opportunities[m]) {
+                auto [it, inserted] = by_product.try_emplace(opportunity.product, remaining[m].size());
+                if (inserted) remaining[m].push_back(opportunity.capacity);
+                slot[m].push_back(it->second);
+            }
+        }
+
+        std::vector<ArbitrageAssignment> assignments;
+        for (size_t merchant = 0; merchant < merchant_markets.size(); ++merchant) {
+            const uint32_t market = merchant_markets[merchant];
+            if (market >= opportunities.size()) {
+                throw std::out_of_range("Merchant market out of range");
+            }
+            // 在庫を使い切った機会は飛ばす（一覧は利益順で、使い切った在庫は戻らないので、先頭から進めるだけでよい）
+            size_t& k = next[market];
+            while (k < slot[market].size() && remaining[market][slot[market][k]] <= 0) ++k;
+            if (k == slot[market].size()) continue;
+            const ArbitrageOpportunity& opportunity = opportunities[market][k];
+            --remaining[market][slot[market][k]];
+            assignments.push_back({merchant, opportunity.from, opportunity.to, opportunity.product,
+                                   static_cast<int64_t>(opportunity.margin) * config.cargo});
+        }
+        return assignments;
+    }
+
+    // markets[i] の拠点から max_travel_time 以内で行ける他の市場への輸送路（近い順に max_neighbors 本まで）
+    static std::vector<MarketLink> linksFrom(RouteNetwork& network, const std::vector<int>& markets,
+                                             int64_t max_travel_time, size_t max_neighbors) {
+        std::vector<MarketLink> links;
+        std::vector<MarketLink> reachable;
+        for (uint32_t from = 0; from < markets.size(); ++from) {
+            if (!network.hasLocation(markets[from])) continue;
+            reachable.clear();
+            for (uint32_t to = 0; to < markets.size(); ++to) {
+                if (to == from || !network.hasLocation(markets[to])) continue;
+                const int64_t time = network.travelTime(markets[from], markets[to]);
+                if (time <= max_travel_time) {
+                    reachable.push_back({from, to, static_cast<int32_t>(time)});
+                }
+            }
+            const size_t keep = std::min(max_neighbors, reachable.size());
+            std::partial_sort(reachable.begin(), reachable.begin() + keep, reachable.end(),
+                              [](const MarketLink& a, const MarketLink& b) {
+                                  return a.travel_time != b.travel_time ? a.travel_time < b.travel_time : a.to < b.to;
+                              });
+            links.insert(links.end(), reachable.begin(), reachable.begin() + keep);
+        }
+        return links;
+    }
+
+    // 商売の住民の添字
+    static std::vector<size_t> merchants(const std::vector<Person>& people) {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < people.size(); ++i) {
+            if (people[i].job == MERCHANT_JOB) result.push_back(i);
+        }
+        return result;
+    }
+
+    static constexpr const char* MERCHANT_JOB = "商売";
+
+    // 実行中のCPUで AVX2 版の走査が使われるか
+    static bool arbitrageUsesAvx2() {
+#if ARBITRAGE_AVX2
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+private:
+    // 商品ごとの利ざや（仕入れ先に在庫が cargo 以上あり、両方で取引されている商品だけ。他は INT32_MIN）
+    // CPU が対応していれば AVX2 版で8商品ずつ計算する。最大値を返す
+    static int32_t computeMargins(const int32_t* buy, const int32_t* stock, const int32_t* sell, size_t n,
+                                  int32_t transport, int32_t cargo, int32_t* margins) {
+#if ARBITRAGE_AVX2
+        if (arbitrageUsesAvx2()) return computeMarginsAvx2(buy, stock, sell, n, transport, cargo, margins);
+#endif
+        return computeMarginsScalar(buy, stock, sell, n, transport, cargo, margins);
+    }
+
+    static int32_t computeMarginsScalar(const int32_t* buy, const int32_t* stock, const int32_t* sell, size_t n,
+                                        int32_t transport, int32_t cargo, int32_t* margins) {
+        int32_t best = INT32_MIN;
+        for (size_t p = 0; p < n; ++p) {
+            const bool valid = buy[p] > 0 && sell[p] > 0 && stock[p] >= cargo;
+            const int32_t margin = valid ? sell[p] - buy[p] - transport : INT32_MIN;
+            margins[p] = margin;
+            best = std::max(best, margin);
+        }
+        return best;
+    }
+
+#if ARBITRAGE_AVX2
+    __attribute__((target("avx2")))
+    static int32_t computeMarginsAvx2(const int32_t* buy, const int32_t* stock, const int32_t* sell, size_t n,
+                                      int32_t transport, int32_t cargo, int32_t* margins) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i invalid = _mm256_set1_epi32(INT32_MIN);
+        const __m256i cost = _mm256_set1_epi32(transport);
+        const __m256i min_stock = _mm256_set1_epi32(cargo - 1);
+        __m256i best = invalid;
+        size_t p = 0;
+        for (; p + 8 <= n; p += 8) {
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buy + p));
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sell + p));
+            const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stock + p));
+            const __m256i valid = _mm256_and_si256(
+                _mm256_and_si256(_mm256_cmpgt_epi32(b, zero), _mm256_cmpgt_epi32(s, zero)),
+                _mm256_cmpgt_epi32(k, min_stock));
+            const __m256i margin = _mm256_sub_epi32(_mm256_sub_epi32(s, b), cost);
+            const __m256i result = _mm256_blendv_epi8(invalid, margin, valid);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(margins + p), result);
+            best = _mm256_max_epi32(best, result);
+        }
+        alignas(32) int32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), best);
+        int32_t result = computeMarginsScalar(buy + p, stock + p, sell + p, n - p, transport, cargo, margins + p);
+        for (int32_t lane : lanes) result = std::max(result, lane);
+        return result;
+    }
+#endif
+
+    // 利ざやが正の商品を大きい順（同点は番号順）に limit 個まで選ぶ
+    // limit は小さいので、暫定の下位より良いものだけを挿入ソートで入れる（大半の商品は比較1回で落ちる）
+    static void collectTop(const std::vector<int32_t>& margins, size_t limit, std::vector<uint32_t>& top) {
+        top.clear();
+        if (limit == 0) return;
+        int32_t floor = 0;  // これ以下の利ざやは入らない
+        for (uint32_t p = 0; p < margins.size(); ++p) {
+            const int32_t margin = margins[p];
+            if (margin <= floor) continue;
+            // 同点は番号の小さい方が先に入っているので、後から来た同点は入れない
+            size_t position = top.size();
+            while (position > 0 && margins[top[position - 1]] < margin) --position;
+            if (position >= limit) continue;
+            if (top.size() < limit) top.push_back(p);
+            std::copy_backward(top.begin() + position, top.end() - 1, top.end());
+            top[position] = p;
+            if (top.size() == limit) floor = margins[top.back()];
+        }
+    }
+};
+
+#endif // ARBITRAGE_H
@@ -0,0 +1,521 @@
+#pragma once
+#ifndef ASYNC_CHECKPOINT_H
+#define ASYNC_CHECKPOINT_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "agent_fields.h"
+#include "checkpoint.h"
+#include "simulation.h"
+#include "thread_pool.h"
+
+struct AsyncCheckpointConfig {
+    size_t chunk_agents = 65536;  // 1チャンクに入れる住民（企業）の数
+    size_t writers = 2;           // 圧縮と書き込みを行うスレッドの数
+};
+
+// 1回の非同期チェックポイントの結果（完了時のコールバックに渡す）
+struct AsyncCheckpointResult {
+    std::string path;
+    int64_t day = 0;
+    bool ok = false;
+    std::string error;
+    uint64_t chunks = 0;
+    uint64_t raw_bytes = 0;   // ティックの境目で取り込んだスナップショットの大きさ
+    uint64_t bytes = 0;       // 書いたファイルの大きさ
+    double capture_ms = 0.0;  // シミュレーションを止めた時間（取り込み）
+    double write_ms = 0.0;    // 裏で圧縮と書き込みにかかった時間
+};
+
+// チャンクの圧縮形式
+// 数値の列は前の値との差分を zigzag 変換して可変長符号にし（ID のような連番はほぼ1バイトになる）、
+// 文字列の列は前の文字列と共通する先頭の長さと残りだけを書く（同じ職業の繰り返しや「住民N」の連番が縮む）
+class ChunkCodec {
+public:
+    // 取り込んだ列（数値は int64_t にそろえ、文字列は連結したバイト列と各要素の終端位置で持つ）
+    struct TextColumn {
+        std::string bytes;
+        std::vector<uint32_t> ends;
+
+        void push(const std::string& text) {
+            bytes += text;
+            ends.push_back(static_cast<uint32_t>(bytes.size()));
+        }
+        std::string at(size_t i) const {
+            const uint32_t begin = i == 0 ? 0 : ends[i - 1];
+            return bytes.substr(begin, ends[i] - begin);
+        }
+    };
+
+    struct Columns {
+        size_t rows = 0;
+        std::vector<std::vector<int64_t>> ints;
+        std::vector<TextColumn> texts;
+
+        uint64_t bytes() const {
+            uint64_t total = 0;
+            for (const auto& column : ints) total += column.size() * sizeof(int64_t);
+            for (const auto& column : texts) total += column.bytes.size() + column.ends.size() * sizeof(uint32_t);
+            return total;
+        }
+    };
+
+    static std::string encode(const Columns& columns) {
+        std::string out;
+        putVarint(out, columns.rows);
+        putVarint(out, columns.ints.size());
+        putVarint(out, columns.texts.size());
+        for (const auto& column : columns.ints) {
+            int64_t previous = 0;
+            for (int64_t value : column) {
+                const uint64_t delta = static_cast<uint64_t>(value) - static_cast<uint64_t>(previous);
+                putVarint(out, zigzag(static_cast<int64_t>(delta)));
+                previous = value;
+            }
+        }
+        for (const auto& column : columns.texts) {
+            std::string previous;
+            for (size_t i = 0; i < column.ends.size(); ++i) {
+                const std::string text = column.at(i);
+                size_t shared = 0;
+                const size_t limit = std::min(previous.size(), text.size());
+                while (shared < limit && previous[shared] == text[shared]) ++shared;
+                putVarint(out, shared);
+                putVarint(out, text.size() - shared);
+                out.append(text, shared, std::string::npos);
+                previous = text;
+            }
+        }
+        return out;
+    }
+
+    static Columns decode(const std::string& blob) {
+        const char* p = blob.data();
+        const char* end = p + blob.size();
+        Columns columns;
+        columns.rows = static_cast<size_t>(getVarint(p, end));
+        const uint64_t int_columns = getVarint(p, end);
+        const uint64_t text_columns = getVarint(p, end);
+        if (columns.rows > blob.size() || int_columns > 64 || text_columns > 64) {
+            throw std::runtime_error("Checkpoint chunk is corrupt");
+        }
+        columns.ints.resize(static_cast<size_t>(int_columns));
+        for (auto& column : columns.ints) {
+            column.resize(columns.rows);
+            uint64_t previous = 0;
+            for (auto& value : column) {
+                previous += static_cast<uint64_t>(unzigzag(getVarint(p, end)));
+                value = static_cast<int64_t>(previous);
+            }
+        }
+        columns.texts.resize(static_cast<size_t>(text_columns));
+        for (auto& column : columns.texts) {
+            std::string previous;
+            for (size_t i = 0; i < columns.rows; ++i) {
+                const uint64_t shared = getVarint(p, end);
+                const uint64_t rest = getVarint(p, end);
+                if (shared > previous.size() || rest > static_cast<uint64_t>(end - p)) {
+                    throw std::runtime_error("Checkpoint chunk is corrupt");
+                }
+                std::string text = previous.substr(0, static_cast<size_t>(shared));
+                text.append(p, static_cast<size_t>(rest));
+                p += rest;
+                column.push(text);
+                previous = std::move(text);
+            }
+        }
+        if (p != end) {
+            throw std::runtime_error("Checkpoint chunk is corrupt");
+        }
+        return columns;
+    }
+
+    static void putVarint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    static uint64_t getVarint(const char*& p, const char* end) {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p == end) {
+                throw std::runtime_error("Checkpoint is truncated");
+            }
+            const uint8_t byte = static_cast<uint8_t>(*p++);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        throw std::runtime_error("Checkpoint chunk is corrupt");
+    }
+
+private:
+    static uint64_t zigzag(int64_t v) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    static int64_t unzigzag(uint64_t z) {
+        return static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+    }
+};
+
+// シミュレーションを止めずに書くチェックポイント
+// start はティックの境目で呼ぶ。そこで住民・企業をチャンク単位の列に取り込み（pool があれば並列に）、
+// 以降の圧縮と書き込みは裏のスレッドで行うので、呼び出し元はすぐ次のティックに進める。
+// 取り込みは世界の写しそのものなので、裏で書いている間に世界が変わっても中身はその日の状態でそろう。
+// 余分なメモリは同時に1つのスナップショットまで: 書き込み中に次の start が来たら前の完了を待つ
+// （tryStart なら待たずに見送る）。チャンクは圧縮して書いた順に手放すので、書き込みが進むほど減る。
+// ファイルは一時ファイルに書いてから名前を変えるので、途中で止まっても古いファイルは壊れない。
+// 完了すると done(結果) を裏のスレッドから呼ぶ（done の中で start / wait は呼ばない）。保存する項目は Checkpoint と同じ（住民・企業の列は AgentFields の表の順）
+//
+// 形式: MAGIC, VERSION, チャンクの大きさ, 住民数, 企業数, Checkpoint::saveState のバイト列,
+//       チャンク（住民のチャンク、企業のチャンクの順。書き終えた順に並ぶ）, チャンクの索引（位置と長さ）, 索引の位置
+class AsyncCheckpoint {
+public:
+    static constexpr char MAGIC[8] = {'M', 'A', 'E', 'S', 'A', 'S', 'Y', 'N'};
+    static constexpr uint32_t VERSION = 5;
+
+    using Callback = std::function<void(const AsyncCheckpointResult&)>;
+
+    explicit AsyncCheckpoint(AsyncCheckpointConfig config = {}) : config(config) {
+        if (this->config.chunk_agents == 0) {
+            throw std::invalid_argument("Checkpoint chunk size must be positive");
+        }
+    }
+
+    ~AsyncCheckpoint() { wait(); }
+
+    AsyncCheckpoint(const AsyncCheckpoint&) = delete;
+    AsyncCheckpoint& operator=(const AsyncCheckpoint&) = delete;
+
+    // 書き込み中なら true
+    bool busy() const { return running.load(); }
+
+    // 世界を取り込んで裏で書き始める。前の書き込みが終わっていなければ待つ
+    void start(const World& world, const std::string& path, Callback done = nullptr, ThreadPool* pool = nullptr) {
+        wait();
+        launch(capture(world, path, pool), std::move(done));
+    }
+
+    // 前の書き込みが終わっていなければ何もせず false を返す
+    bool tryStart(const World& world, const std::string& path, Callback done = nullptr, ThreadPool* pool = nullptr) {
+        if (busy()) return false;
+        start(world, path, std::move(done), pool);
+        return true;
+    }
+
+    // 書き込み中の分の完了を待ち、直近の結果を返す
+    AsyncCheckpointResult wait() {
+        if (worker.joinable()) worker.join();
+        std::lock_guard<std::mutex> lock(result_mutex);
+        return last_result;
+    }
+
+    // 取り込みと書き込みをその場で行う
+    static AsyncCheckpointResult save(const World& world, const std::string& path, AsyncCheckpointConfig config = {},
+                                      ThreadPool* pool = nullptr) {
+        AsyncCheckpoint checkpoint(config);
+        checkpoint.start(world, path, nullptr, pool);
+        AsyncCheckpointResult result = checkpoint.wait();
+        if (!result.ok) {
+            throw std::runtime_error("Failed to write checkpoint: " + result.error);
+        }
+        return result;
+    }
+
+    // 読み込んで World を復元する（pool があればチャンクを並列に展開する）。派生状態は作り直す
+    static World load(const std::string& path, ThreadPool* pool = nullptr) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        const std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const char* p = file.data();
+        const char* end = p + file.size();
+        if (file.size() < sizeof(MAGIC) + sizeof(uint32_t) + sizeof(uint64_t) ||
+            std::memcmp(p, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("Not an async checkpoint file");
+        }
+        p += sizeof(MAGIC);
+        const uint32_t version = read<uint32_t>(p, end);
+        if (version != VERSION) {
+            throw std::runtime_error("Unsupported checkpoint version " + std::to_string(version));
+        }
+        const uint64_t chunk_agents = read<uint64_t>(p, end);
+        const uint64_t people = read<uint64_t>(p, end);
+        const uint64_t businesses = read<uint64_t>(p, end);
+        const uint64_t state_size = read<uint64_t>(p, end);
+        if (chunk_agents == 0 || state_size > static_cast<uint64_t>(end - p)) {
+            throw std::runtime_error("Checkpoint is truncated");
+        }
+
+        World world;
+        std::istringstream state(std::string(p, static_cast<size_t>(state_size)));
+        Checkpoint::loadState(state, world);
+
+        const uint64_t person_chunks = (people + chunk_agents - 1) / chunk_agents;
+        const uint64_t business_chunks = (businesses + chunk_agents - 1) / chunk_agents;
+        const uint64_t chunks = person_chunks + business_chunks;
+        const char* tail = end - sizeof(uint64_t);
+        const uint64_t index_offset = read<uint64_t>(tail, end);
+        if (index_offset > file.size() - sizeof(uint64_t) ||
+            file.size() - sizeof(uint64_t) - index_offset != chunks * 2 * sizeof(uint64_t)) {
+            throw std::runtime_error("Checkpoint index is corrupt");
+        }
+        std::vector<std::pair<uint64_t, uint64_t>> index(chunks);
+        const char* q = file.data() + index_offset;
+        for (auto& entry : index) {
+            entry.first = read<uint64_t>(q, end);
+            entry.second = read<uint64_t>(q, end);
+            if (entry.first > index_offset || entry.second > index_offset - entry.first) {
+                throw std::runtime_error("Checkpoint index is corrupt");
+            }
+        }
+
+        world.people.resize(people);
+        world.businesses.resize(businesses);
+        auto restore = [&](size_t lo, size_t hi) {
+            for (size_t c = lo; c < hi; ++c) {
+                const ChunkCodec::Columns columns =
+                    ChunkCodec::decode(file.substr(static_cast<size_t>(index[c].first), static_cast<size_t>(index[c].second)));
+                if (c < person_chunks) {
+                    restorePeople(columns, c * chunk_agents, world.people);
+                } else {
+                    restoreBusinesses(columns, (c - person_chunks) * chunk_agents, world.businesses);
+                }
+            }
+        };
+        if (pool) {
+            pool->parallelFor(0, static_cast<size_t>(chunks), restore, 1);
+        } else {
+            restore(0, static_cast<size_t>(chunks));
+        }
+
+        world.rebuildDerivedState();
+        return world;
+    }
+
+private:
+    // ティックの境目で取り込んだ世界
+    struct Snapshot {
+        std::string path;
+        int64_t day = 0;
+        uint64_t chunk_agents = 0;
+        uint64_t people = 0;
+        uint64_t businesses = 0;
+        std::string state;
+        std::vector<ChunkCodec::Columns> chunks;  // 書き終えたものから空にする
+        AsyncCheckpointResult result;
+    };
+
+    AsyncCheckpointConfig config;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::mutex result_mutex;
+    AsyncCheckpointResult last_result;
+
+    std::unique_ptr<Snapshot> capture(const World& world, const std::string& path, ThreadPool* pool) const {
+        const auto started = std::chrono::steady_clock::now();
+        auto snapshot = std::make_unique<Snapshot>();
+        snapshot->path = path;
+        snapshot->day = world.day;
+        snapshot->chunk_agents = config.chunk_agents;
+        snapshot->people = world.people.size();
+        snapshot->businesses = world.businesses.size();
+        std::ostringstream state;
+        Checkpoint::saveState(world, state);
+        snapshot->state = state.str();
+
+        const size_t chunk = config.chunk_agents;
+        const size_t person_chunks = (world.people.size() + chunk - 1) / chunk;
+        const size_t business_chunks = (world.businesses.size() + chunk - 1) / chunk;
+        snapshot->chunks.resize(person_chunks + business_chunks);
+        auto fill = [&](size_t lo, size_t hi) {
+            for (size_t c = lo; c < hi; ++c) {
+                if (c < person_chunks) {
+                    const size_t begin = c * chunk;
+                    capturePeople(world.people, begin, std::min(world.people.size(), begin + chunk), snapshot->chunks[c]);
+                } else {
+                    const size_t begin = (c - person_chunks) * chunk;
+                    captureBusinesses(world.businesses, begin, std::min(world.businesses.size(), begin + chunk),
+                                      snapshot->chunks[c]);
+                }
+            }
+        };
+        if (pool) {
+            pool->parallelFor(0, snapshot->chunks.size(), fill, 1);
+        } else {
+            fill(0, snapshot->chunks.size());
+        }
+
+        AsyncCheckpointResult& result = snapshot->result;
+        result.path = path;
+        result.day = world.day;
+        result.chunks = snapshot->chunks.size();
+        result.raw_bytes = snapshot->state.size();
+        for (const auto& columns : snapshot->chunks) result.raw_bytes += columns.bytes();
+        result.capture_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        return snapshot;
+    }
+
+    static void capturePeople(const std::vector<Person>& people, size_t begin, size_t end, ChunkCodec::Columns& out) {
+        captureRows(people, begin, end, AgentFields::personInts(), AgentFields::personTexts(), out);
+    }
+
+    static void captureBusinesses(const std::vector<Business>& businesses, size_t begin, size_t end,
+                                  ChunkCodec::Columns& out) {
+        captureRows(businesses, begin, end, AgentFields::businessInts(), AgentFields::businessTexts(), out);
+    }
+
+    static void restorePeople(const ChunkCodec::Columns& in, size_t begin, std::vector<Person>& people) {
+        restoreRows(in, begin, AgentFields::personInts(), AgentFields::personTexts(), people);
+    }
+
+    static void restoreBusinesses(const ChunkCodec::Columns& in, size_t begin, std::vector<Business>& businesses) {
+        restoreRows(in, begin, AgentFields::businessInts(), AgentFields::businessTexts(), businesses);
+    }
+
+    // AgentFields の表の1項目を1列として取り込む（数値の列が表の数値項目、文字列の列が表の文字列項目の順）
+    template <typename Agent>
+    static void captureRows(const std::vector<Agent>& agents, size_t begin, size_t end,
+                            const std::vector<IntField<Agent>>& ints, const std::vector<TextField<Agent>>& texts,
+                            ChunkCodec::Columns& out) {
+        out.rows = end - begin;
+        out.ints.assign(ints.size(), std::vector<int64_t>(out.rows));
+        out.texts.assign(texts.size(), ChunkCodec::TextColumn{});
+        for (size_t i = begin; i < end; ++i) {
+            const size_t row = i - begin;
+            for (size_t f = 0; f < ints.size(); ++f) out.ints[f][row] = ints[f].get(agents[i]);
+            for (size_t f = 0; f < texts.size(); ++f) out.texts[f].push(texts[f].get(agents[i]));
+        }
+    }
+
+    template <typename Agent>
+    static void restoreRows(const ChunkCodec::Columns& in, size_t begin, const std::vector<IntField<Agent>>& ints,
+                            const std::vector<TextField<Agent>>& texts, std::vector<Agent>& agents) {
+        if (in.ints.size() != ints.size() || in.texts.size() != texts.size() || begin > agents.size() ||
+            in.rows > agents.size() - begin) {
+            throw std::runtime_error("Checkpoint chunk does not match the header");
+        }
+        for (size_t row = 0; row < in.rows; ++row) {
+            Agent& agent = agents[begin + row];
+            for (size_t f = 0; f < ints.size(); ++f) ints[f].set(agent, in.ints[f][row]);
+            for (size_t f = 0; f < texts.size(); ++f) texts[f].set(agent, in.texts[f].at(row));
+        }
+    }
+
+    template <typename T>
+    static T read(const char*& p, const char* end) {
+        if (static_cast<size_t>(end - p) < sizeof(T)) {
+            throw std::runtime_error("Checkpoint is truncated");
+        }
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+
+    template <typename T>
+    static void write(std::ostream& out, T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void launch(std::unique_ptr<Snapshot> snapshot, Callback done) {
+        running = true;
+        const size_t writers = std::max<size_t>(config.writers, 1);
+        worker = std::thread([this, writers, snapshot = std::move(snapshot), done = std::move(done)]() mutable {
+            AsyncCheckpointResult result = writeSnapshot(*snapshot, writers);
+            snapshot.reset();
+            {
+                std::lock_guard<std::mutex> lock(result_mutex);
+                last_result = result;
+            }
+            running = false;
+            if (done) done(result);
+        });
+    }
+
+    // 裏のスレッドで圧縮して書く。失敗は例外ではなく結果の error で返す
+    static AsyncCheckpointResult writeSnapshot(Snapshot& snapshot, size_t writers) {
+        const auto started = std::chrono::steady_clock::now();
+        AsyncCheckpointResult result = snapshot.result;
+        const std::string temporary = snapshot.path + ".tmp";
+        try {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                throw std::runtime_error("Cannot open " + temporary);
+            }
+            out.write(MAGIC, sizeof(MAGIC));
+            write<uint32_t>(out, VERSION);
+            write<uint64_t>(out, snapshot.chunk_agents);
+            write<uint64_t>(out, snapshot.people);
+            write<uint64_t>(out, snapshot.businesses);
+            write<uint64_t>(out, snapshot.state.size());
+            out.write(snapshot.state.data(), static_cast<std::streamsize>(snapshot.state.size()));
+            uint64_t offset = sizeof(MAGIC) + sizeof(uint32_t) + 4 * sizeof(uint64_t) + snapshot.state.size();
+
+            // チャンクごとに圧縮し、書けた順にファイルへ足す（元の列はその場で手放す）
+            std::vector<std::pair<uint64_t, uint64_t>> index(snapshot.chunks.size());
+            std::mutex file_mutex;
+            auto compress = [&](size_t lo, size_t hi) {
+                for (size_t c = lo; c < hi; ++c) {
+                    const std::string blob = ChunkCodec::encode(snapshot.chunks[c]);
+                    snapshot.chunks[c] = ChunkCodec::Columns();
+                    std::lock_guard<std::mutex> lock(file_mutex);
+                    index[c] = {offset, blob.size()};
+                    out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+                    offset += blob.size();
+                }
+            };
+            if (writers > 1 && snapshot.chunks.size() > 1) {
+                ThreadPool pool(writers);
+                pool.parallelFor(0, snapshot.chunks.size(), compress, 1);
+            } else {
+                compress(0, snapshot.chunks.size());
+            }
+
+            const uint64_t index_offset = offset;
+            for (const auto& entry : index) {
+                write<uint64_t>(out, entry.first);
+                write<uint64_t>(out, entry.second);
+            }
+            write<uint64_t>(out, index_offset);
+            out.close();
+            if (!out) {
+                throw std::runtime_error("Failed to write " + temporary);
+            }
+            if (std::rename(temporary.c_str(), snapshot.path.c_str()) != 0) {
+                throw std::runtime_error("Cannot rename " + temporary + " to " + snapshot.path);
+            }
+            result.bytes = index_offset + index.size() * 2 * sizeof(uint64_t) + sizeof(uint64_t);
+            result.ok = true;
+        } catch (const std::exception& e) {
+            std::remove(temporary.c_str());
+            result.ok = false;
+            result.error = e.what();
+        }
+        result.write_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        return result;
+    }
+};
+
+#endif // ASYNC_CHECKPOINT_H
@@ -0,0 +1,548 @@
+#pragma once
+#ifndef BITMAP_INDEX_H
+#define BITMAP_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../agent/person.h"
+
+// 圧縮ビットマップ（Roaring 方式）
+// 32ビットの値を上位16ビットで区切り、区切りごとの下位16ビットを
+//   要素が ARRAY_LIMIT 個以下: 昇順の uint16_t 配列
+//   それより多い: 65536 ビットのビット列
+// のどちらかで持つ。集合演算は区切りごとに、配列どうしは併合、ビット列を含む組は語単位で行う
+class RoaringBitmap {
+public:
+    static constexpr size_t ARRAY_LIMIT = 4096;
+    static constexpr size_t WORDS = 1024;  // 65536 ビット
+
+    bool add(uint32_t value) {
+        Container& container = containerFor(high(value));
+        return container.add(low(value));
+    }
+
+    bool remove(uint32_t value) {
+        const size_t slot = find(high(value));
+        if (slot == keys.size() || !containers[slot].remove(low(value))) return false;
+        if (containers[slot].cardinality == 0) erase(slot);
+        return true;
+    }
+
+    bool contains(uint32_t value) const {
+        const size_t slot = find(high(value));
+        return slot != keys.size() && containers[slot].contains(low(value));
+    }
+
+    uint64_t cardinality() const {
+        uint64_t count = 0;
+        for (const auto& container : containers) count += container.cardinality;
+        return count;
+    }
+
+    bool empty() const { return containers.empty(); }
+
+    void clear() {
+        keys.clear();
+        containers.clear();
+    }
+
+    // 昇順に fn(value) を呼ぶ
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t slot = 0; slot < keys.size(); ++slot) {
+            const uint32_t base = static_cast<uint32_t>(keys[slot]) << 16;
+            const Container& container = containers[slot];
+            if (container.isBitmap()) {
+                for (size_t w = 0; w < WORDS; ++w) {
+                    uint64_t word = container.bits[w];
+                    while (word != 0) {
+                        const uint32_t bit = static_cast<uint32_t>(__builtin_ctzll(word));
+                        fn(base | static_cast<uint32_t>(w * 64 + bit));
+                        word &= word - 1;
+                    }
+                }
+            } else {
+                for (uint16_t value : container.array) fn(base | value);
+            }
+        }
+    }
+
+    std::vector<uint32_t> toVector() const {
+        std::vector<uint32_t> values;
+        values.reserve(cardinality());
+        forEach([&values](uint32_t value) { values.push_back(value); });
+        return values;
+    }
+
+    RoaringBitmap operator&(const RoaringBitmap& other) const {
+        RoaringBitmap result;
+        size_t i = 0;
+        size_t j = 0;
+        while (i < keys.size() && j < other.keys.size()) {
+            if (keys[i] < other.keys[j]) {
+                ++i;
+            } else if (other.keys[j] < keys[i]) {
+                ++j;
+            } else {
+                Container merged = Container::intersect(containers[i], other.containers[j]);
+                if (merged.cardinality > 0) result.append(keys[i], std::move(merged));
+                ++i;
+                ++j;
+            }
+        }
+        return result;
+    }
+
+    RoaringBitmap operator|(const RoaringBitmap& other) const {
+        RoaringBitmap result;
+        size_t i = 0;
+        size_t j = 0;
+        while (i < keys.size() || j < other.keys.size()) {
+            if (j == other.keys.size() || (i < keys.size() && keys[i] < other.keys[j])) {
+                result.append(keys[i], containers[i]);
+                ++i;
+            } else if (i == keys.size() || other.keys[j] < keys[i]) {
+                result.append(other.keys[j], other.containers[j]);
+                ++j;
+            } else {
+                result.append(keys[i], Container::unite(containers[i], other.containers[j]));
+                ++i;
+                ++j;
+            }
+        }
+        return result;
+    }
+
+    // 差集合（this にあって other にない値）
+    RoaringBitmap operator-(const RoaringBitmap& other) const {
+        RoaringBitmap result;
+        size_t j = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            while (j < other.keys.size() && other.keys[j] < keys[i]) ++j;
+            if (j == other.keys.size() || other.keys[j] != keys[i]) {
+                result.append(keys[i], containers[i]);
+                continue;
+            }
+            Container rest = Container::subtract(containers[i], other.containers[j]);
+            if (rest.cardinality > 0) result.append(keys[i], std::move(rest));
+        }
+        return result;
+    }
+
+    RoaringBitmap& operator&=(const RoaringBitmap& other) { return *this = *this & other; }
+    RoaringBitmap& operator|=(const RoaringBitmap& other) { return *this = *this | other; }
+    RoaringBitmap& operator-=(const RoaringBitmap& other) { return *this = *this - other; }
+
+    bool operator==(const RoaringBitmap& other) const {
+        if (keys != other.keys) return false;
+        for (size_t slot = 0; slot < keys.size(); ++slot) {
+            const uint32_t count = containers[slot].cardinality;
+            if (other.containers[slot].cardinality != count ||
+                Container::intersect(containers[slot], other.containers[slot]).cardinality != count) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const RoaringBitmap& other) const { return !(*this == other); }
+
+    // 使用中のおおよそのバイト数（集計・計測用）
+    size_t bytes() const {
+        size_t total = keys.size() * (sizeof(uint16_t) + sizeof(Container));
+        for (const auto& container : containers) {
+            total += container.isBitmap() ? WORDS * sizeof(uint64_t) : container.array.size() * sizeof(uint16_t);
+        }
+        return total;
+    }
+
+    // ビット列で持っている区切りの数（テスト・計測用）
+    size_t bitmapContainers() const {
+        size_t count = 0;
+        for (const auto& container : containers) count += container.isBitmap() ? 1 : 0;
+        return count;
+    }
+
+private:
+    struct Container {
+        std::vector<uint16_t> array;  // 配列表現（ビット列表現のときは空）
+        std::vector<uint64_t> bits;   // ビット列表現（配列表現のときは空）
+        uint32_t cardinality = 0;
+
+        bool isBitmap() const { return !bits.empty(); }
+
+        bool contains(uint16_t value) const {
+            if (isBitmap()) return (bits[value >> 6] >> (value & 63)) & 1;
+            return std::binary_search(array.begin(), array.end(), value);
+        }
+
+        bool add(uint16_t value) {
+            if (isBitmap()) {
+                uint64_t& word = bits[value >> 6];
+                const uint64_t mask = uint64_t{1} << (value & 63);
+                if (word & mask) return false;
+                word |= mask;
+                ++cardinality;
+                return true;
+            }
+            auto it = std::lower_bound(array.begin(), array.end(), value);
+            if (it != array.end() && *it == value) return false;
+            array.insert(it, value);
+            ++cardinality;
+            if (array.size() > ARRAY_LIMIT) toBitmap();
+            return true;
+        }
+
+        bool remove(uint16_t value) {
+            if (isBitmap()) {
+                uint64_t& word = bits[value >> 6];
+                const uint64_t mask = uint64_t{1} << (value & 63);
+                if (!(word & mask)) return false;
+                word &= ~mask;
+                --cardinality;
+                if (cardinality <= ARRAY_LIMIT) toArray();
+                return true;
+            }
+            auto it = std::lower_bound(array.begin(), array.end(), value);
+            if (it == array.end() || *it != value) return false;
+            array.erase(it);
+            --cardinality;
+            return true;
+        }
+
+        void toBitmap() {
+            bits.assign(WORDS, 0);
+            for (uint16_t value : array) bits[value >> 6] |= uint64_t{1} << (value & 63);
+            array.clear();
+            array.shrink_to_fit();
+        }
+
+        void toArray() {
+            array.clear();
+            array.reserve(cardinality);
+            for (size_t w = 0; w < WORDS; ++w) {
+                uint64_t word = bits[w];
+                while (word != 0) {
+                    array.push_back(static_cast<uint16_t>(w * 64 + static_cast<size_t>(__builtin_ctzll(word))));
+                    word &= word - 1;
+                }
+            }
+            bits.clear();
+            bits.shrink_to_fit();
+        }
+
+        // ビット列表現の結果を数え直し、少なければ配列表現に戻す
+        void normalize() {
+            cardinality = 0;
+            for (uint64_t word : bits) cardinality += static_cast<uint32_t>(__builtin_popcountll(word));
+            if (cardinality <= ARRAY_LIMIT) toArray();
+        }
+
+        static Container intersect(const Container& a, const Container& b) {
+            Container result;
+            if (a.isBitmap() && b.isBitmap()) {
+                result.bits.resize(WORDS);
+                for (size_t w = 0; w < WORDS; ++w) result.bits[w] = a.bits[w] & b.bits[w];
+                result.normalize();
+            } else if (a.isBitmap() || b.isBitmap()) {
+                const Container& list = a.isBitmap() ? b : a;
+                const Container& dense = a.isBitmap() ? a : b;
+                for (uint16_t value : list.array) {
+                    if (dense.contains(value)) result.array.push_back(value);
+                }
+                result.cardinality = static_cast<uint32_t>(result.array.size());
+            } else {
+                std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                      std::back_inserter(result.array));
+                result.cardinality = static_cast<uint32_t>(result.array.size());
+            }
+            return result;
+        }
+
+        static Container unite(const Container& a, const Container& b) {
+            Container result;
+            if (!a.isBitmap() && !b.isBitmap()) {
+                std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                               std::back_inserter(result.array));
+                result.cardinality = static_cast<uint32_t>(result.array.size());
+                if (result.array.size() > ARRAY_LIMIT) result.toBitmap();
+                return result;
+            }
+            const Container& dense = a.isBitmap() ? a : b;
+            const Container& other = a.isBitmap() ? b : a;
+            result.bits = dense.bits;
+            if (other.isBitmap()) {
+                for (size_t w = 0; w < WORDS; ++w) result.bits[w] |= other.bits[w];
+            } else {
+                for (uint16_t value : other.array) result.bits[value >> 6] |= uint64_t{1} << (value & 63);
+            }
+            result.normalize();
+            return result;
+        }
+
+        static Container subtract(const Container& a, const Container& b) {
+            Container result;
+            if (a.isBitmap()) {
+                result.bits = a.bits;
+                if (b.isBitmap()) {
+                    for (size_t w = 0; w < WORDS; ++w) result.bits[w] &= ~b.bits[w];
+                } else {
+                    for (uint16_t value : b.array) result.bits[value >> 6] &= ~(uint64_t{1} << (value & 63));
+                }
+                result.normalize();
+            } else if (b.isBitmap()) {
+                for (uint16_t value : a.array) {
+                    if (!b.contains(value)) result.array.push_back(value);
+                }
+                result.cardinality = static_cast<uint32_t>(result.array.size());
+            } else {
+                std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                    std::back_inserter(result.array));
+                result.cardinality = static_cast<uint32_t>(result.array.size());
+            }
+            return result;
+        }
+    };
+
+    std::vector<uint16_t> keys;           // 区切り（上位16ビット）の昇順
+    std::vector<Container> containers;
+
+    static uint16_t high(uint32_t value) { return static_cast<uint16_t>(value >> 16); }
+    static uint16_t low(uint32_t value) { return static_cast<uint16_t>(value & 0xFFFF); }
+
+    size_t find(uint16_t key) const {
+        auto it = std::lower_bound(keys.begin(), keys.end(), key);
+        return it != keys.end() && *it == key ? static_cast<size_t>(it - keys.begin()) : keys.size();
+    }
+
+    Container& containerFor(uint16_t key) {
+        auto it = std::lower_bound(keys.begin(), keys.end(), key);
+        const size_t slot = static_cast<size_t>(it - keys.begin());
+        if (it == keys.end() || *it != key) {
+            keys.insert(it, key);
+            containers.insert(containers.begin() + static_cast<std::ptrdiff_t>(slot), Container{});
+        }
+        return containers[slot];
+    }
+
+    void erase(size_t slot) {
+        keys.erase(keys.begin() + static_cast<std::ptrdiff_t>(slot));
+        containers.erase(containers.begin() + static_cast<std::ptrdiff_t>(slot));
+    }
+
+    // 区切りを昇順に末尾へ足す（集合演算の結果を組み立てる）
+    void append(uint16_t key, Container container) {
+        keys.push_back(key);
+        containers.push_back(std::move(container));
+    }
+};
+
+// 住民の属性ごとのビットマップ索引
+// 値の種類が少ない属性（健康状態・犯罪傾向・職業・収入帯）ごとに、該当する住民の添字（people 上の位置）の
+// RoaringBitmap を持つ。政策の対象や集計の部分集合はビットマップの & | - で求め、forEach で添字を列挙する。
+// 例: 病気で所持金 100 未満 → health(SICK) を列挙して money を見る
+//     犯罪傾向が高い農業従事者 → crime(HIGH) & job("農業")
+// 属性を変えたら update（1人）か sync（全員を前回の値と比べる）で差分だけ反映する
+class PopulationIndex {
+public:
+    static constexpr int32_t INCOME_BAND = 10;  // 日収の帯の幅（CohortSimulator と同じ）
+    static constexpr size_t HEALTH_KINDS = 3;
+    static constexpr size_t CRIME_KINDS = 3;
+
+    void rebuild(const std::vector<Person>& people) {
+        checkSize(people.size());
+        for (auto& bitmap : health_sets) bitmap.clear();
+        for (auto& bitmap : crime_sets) bitmap.clear();
+        for (auto& bitmap : job_sets) bitmap.clear();
+        band_sets.clear();
+        everyone.clear();
+        keys.clear();
+        keys.reserve(people.size());
+        for (size_t i = 0; i < people.size(); ++i) insert(static_cast<uint32_t>(i), people[i]);
+    }
+
+    // 住民 i の属性を反映する（i == 索引済みの人数なら末尾に追加）。変わった属性の数を返す
+    size_t update(size_t i, const Person& person) {
+        if (i > keys.size()) {
+            throw std::out_of_range("Person index " + std::to_string(i) + " is beyond the indexed population");
+        }
+        checkSize(i + 1);
+        const uint32_t handle = static_cast<uint32_t>(i);
+        if (i == keys.size()) {
+            insert(handle, person);
+            return 1;
+        }
+        const Keys next = keysOf(person);
+        Keys& current = keys[i];
+        size_t changed = 0;
+        if (next.health != current.health) {
+            health_sets[current.health].remove(handle);
+            health_sets[next.health].add(handle);
+            ++changed;
+        }
+        if (next.crime != current.crime) {
+            crime_sets[current.crime].remove(handle);
+            crime_sets[next.crime].add(handle);
+            ++changed;
+        }
+        if (next.job != current.job) {
+            job_sets[current.job].remove(handle);
+            job_sets[next.job].add(handle);
+            ++changed;
+        }
+        if (next.band != current.band) {
+            removeFromBand(current.band, handle);
+            band_sets[next.band].add(handle);
+            ++changed;
+        }
+        current = next;
+        return changed;
+    }
+
+    // 全員を前回反映した値と比べて差分だけ反映する。人数が減っていれば末尾の住民を外す
+    size_t sync(const std::vector<Person>& people) {
+        checkSize(people.size());
+        size_t changed = 0;
+        while (keys.size() > people.size()) {
+            erase(static_cast<uint32_t>(keys.size() - 1));
+            ++changed;
+        }
+        for (size_t i = 0; i < people.size(); ++i) changed += update(i, people[i]);
+        return changed;
+    }
+
+    size_t size() const { return keys.size(); }
+    const RoaringBitmap& all() const { return everyone; }
+
+    const RoaringBitmap& health(HealthStatus status) const {
+        return health_sets[static_cast<size_t>(status)];
+    }
+
+    const RoaringBitmap& crime(CrimeTendency tendency) const {
+        return crime_sets[static_cast<size_t>(tendency)];
+    }
+
+    // 職業（登録のない職業なら空）
+    const RoaringBitmap& job(const std::string& name) const {
+        auto it = job_ids.find(name);
+        return it != job_ids.end() ? job_sets[it->second] : none();
+    }
+
+    const std::vector<std::string>& jobs() const { return job_names; }
+
+    // 日収の帯（daily_income / INCOME_BAND == band）
+    const RoaringBitmap& incomeBand(int32_t band) const {
+        auto it = band_sets.find(band);
+        return it != band_sets.end() ? it->second : none();
+    }
+
+    // 日収が [low, high] を含む帯の和集合（帯単位なので端の帯の住民は範囲外のこともある）
+    RoaringBitmap incomeBands(int32_t low, int32_t high) const {
+        RoaringBitmap result;
+        if (low > high) return result;
+        for (auto it = band_sets.lower_bound(bandOf(low)); it != band_sets.end() && it->first <= bandOf(high); ++it) {
+            result |= it->second;
+        }
+        return result;
+    }
+
+    // 条件に合う住民の添字（昇順）。pred(i) で帯より細かい条件（所持金など）を足せる
+    template <typename Pred>
+    static std::vector<size_t> select(const RoaringBitmap& bitmap, Pred&& pred) {
+        std::vector<size_t> result;
+        bitmap.forEach([&](uint32_t i) {
+            if (pred(static_cast<size_t>(i))) result.push_back(i);
+        });
+        return result;
+    }
+
+    static std::vector<size_t> select(const RoaringBitmap& bitmap) {
+        return select(bitmap, [](size_t) { return true; });
+    }
+
+    static int32_t bandOf(int32_t income) {
+        return income >= 0 ? income / INCOME_BAND : -((-income + INCOME_BAND - 1) / INCOME_BAND);
+    }
+
+private:
+    struct Keys {
+        uint8_t health;
+        uint8_t crime;
+        int32_t job;
+        int32_t band;
+    };
+
+    RoaringBitmap health_sets[HEALTH_KINDS];
+    RoaringBitmap crime_sets[CRIME_KINDS];
+    std::map<std::string, int32_t> job_ids;
+    std::vector<std::string> job_names;
+    std::vector<RoaringBitmap> job_sets;
+    std::map<int32_t, RoaringBitmap> band_sets;
+    RoaringBitmap everyone;
+    std::vector<Keys> keys;  // 住民ごとに最後に反映した値
+
+    static const RoaringBitmap& none() {
+        static const RoaringBitmap empty;
+        return empty;
+    }
+
+    static void checkSize(size_t count) {
+        if (count > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("Too many people for a 32-bit bitmap index");
+        }
+    }
+
+    int32_t internJob(const std::string& name) {
+        auto [it, inserted] = job_ids.try_emplace(name, static_cast<int32_t>(job_names.size()));
+        if (inserted) {
+            job_names.push_back(name);
+            job_sets.emplace_back();
+        }
+        return it->second;
+    }
+
+    Keys keysOf(const Person& person) {
+        const size_t health = static_cast<size_t>(person.health_status);
+        const size_t crime = static_cast<size_t>(person.crime_tendency);
+        if (health >= HEALTH_KINDS || crime >= CRIME_KINDS) {
+            throw std::invalid_argument("Unknown health status or crime tendency");
+        }
+        return Keys{static_cast<uint8_t>(health), static_cast<uint8_t>(crime), internJob(person.job),
+                    bandOf(person.daily_income)};
+    }
+
+    void insert(uint32_t handle, const Person& person) {
+        const Keys entry = keysOf(person);
+        health_sets[entry.health].add(handle);
+        crime_sets[entry.crime].add(handle);
+        job_sets[entry.job].add(handle);
+        band_sets[entry.band].add(handle);
+        everyone.add(handle);
+        keys.push_back(entry);
+    }
+
+    void erase(uint32_t handle) {
+        const Keys& entry = keys[handle];
+        health_sets[entry.health].remove(handle);
+        crime_sets[entry.crime].remove(handle);
+        job_sets[entry.job].remove(handle);
+        removeFromBand(entry.band, handle);
+        everyone.remove(handle);
+        keys.pop_back();
+    }
+
+    // 空になった帯は消す
+    void removeFromBand(int32_t band, uint32_t handle) {
+        auto it = band_sets.find(band);
+        if (it == band_sets.end()) return;
+        it->second.remove(handle);
+        if (it->second.empty()) band_sets.erase(it);
+    }
+};
+
+#endif // BITMAP_INDEX_H
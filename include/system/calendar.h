@@ -0,0 +1,167 @@
+#pragma once
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "event_scheduler.h"
+
+// 季節（1年は春夏秋冬の4季）
+enum class Season {
+    SPRING = 0,
+    SUMMER = 1,
+    AUTUMN = 2,
+    WINTER = 3
+};
+
+// 通し日数（0 = 1年目 春 1日）を暦に直したもの。年・日は1始まり
+struct CalendarDate {
+    int64_t year = 1;
+    Season season = Season::SPRING;
+    int32_t day_of_season = 1;
+    int32_t day_of_year = 1;
+};
+
+// 暦の上の予定の種類
+enum class CalendarEventKind {
+    SEASON_START,  // 季節の始まり（季節による生産量の倍率を設定し直す）
+    TAX_DAY,       // 納税日（World::tax_period が2以上のとき、住民の税はこの日にだけ集める）
+};
+
+struct CalendarEvent {
+    CalendarEventKind kind;
+    uint64_t target = 0;  // 予定の対象（業種や拠点の番号など、使う側が決める）
+    int64_t day = 0;      // 期日（advanceTo が返すときに埋める）
+};
+
+// 暦と暦の上の予定
+// 予定は TimingWheel に置くので、1日の処理は期日を迎えた予定の数に比例し、
+// 「今日は納税日か」「収穫の季節か」を住民や企業ごとに毎日確かめる必要はない。
+// 周期的な予定（every）は期日を迎えるたびに次の期日へ置き直す
+class Calendar {
+public:
+    static constexpr int32_t DAYS_PER_SEASON = 30;
+    static constexpr int32_t SEASONS = 4;
+    static constexpr int32_t DAYS_PER_YEAR = DAYS_PER_SEASON * SEASONS;
+
+    using Handle = TimingWheel<CalendarEvent>::Handle;
+    using SeriesId = size_t;
+
+    static CalendarDate dateOf(int64_t day) {
+        if (day < 0) {
+            throw std::invalid_argument("Calendar day cannot be negative");
+        }
+        CalendarDate date;
+        date.year = day / DAYS_PER_YEAR + 1;
+        const int32_t in_year = static_cast<int32_t>(day % DAYS_PER_YEAR);
+        date.season = static_cast<Season>(in_year / DAYS_PER_SEASON);
+        date.day_of_season = in_year % DAYS_PER_SEASON + 1;
+        date.day_of_year = in_year + 1;
+        return date;
+    }
+
+    static Season seasonOf(int64_t day) { return dateOf(day).season; }
+
+    // year 年目の season の day_of_season 日の通し日数
+    static int64_t dayOf(int64_t year, Season season, int32_t day_of_season = 1) {
+        if (year < 1 || day_of_season < 1 || day_of_season > DAYS_PER_SEASON) {
+            throw std::invalid_argument("Invalid calendar date");
+        }
+        return (year - 1) * DAYS_PER_YEAR + static_cast<int64_t>(season) * DAYS_PER_SEASON + day_of_season - 1;
+    }
+
+    // day 以降で最初の季節の始まり（day が季節の初日ならその日）
+    static int64_t nextSeasonStart(int64_t day) {
+        return (day + DAYS_PER_SEASON - 1) / DAYS_PER_SEASON * DAYS_PER_SEASON;
+    }
+
+    static const char* seasonName(Season season) {
+        static const char* names[] = {"春", "夏", "秋", "冬"};
+        return names[static_cast<int>(season)];
+    }
+
+    // 例: "1年目 春 1日"
+    static std::string format(int64_t day) {
+        const CalendarDate date = dateOf(day);
+        return std::to_string(date.year) + "年目 " + seasonName(date.season) + " " +
+               std::to_string(date.day_of_season) + "日";
+    }
+
+    // 1回だけの予定
+    Handle schedule(int64_t day, CalendarEvent event) {
+        event.day = day;
+        return wheel.schedule(day, Entry{event, NO_SERIES});
+    }
+
+    bool cancel(Handle handle) { return wheel.cancel(handle); }
+
+    // first_day から period 日ごとの予定。stop で止める
+    SeriesId every(int64_t first_day, int64_t period, CalendarEvent event) {
+        if (period <= 0) {
+            throw std::invalid_argument("Recurring period must be positive");
+        }
+        const SeriesId id = series.size();
+        series.push_back(Series{period, 0, true});
+        event.day = first_day;
+        series[id].handle = wheel.schedule(first_day, Entry{event, id});
+        return id;
+    }
+
+    void stop(SeriesId id) {
+        Series& entry = series.at(id);
+        if (!entry.active) return;
+        entry.active = false;
+        wheel.cancel(entry.handle);
+    }
+
+    // 季節の始まりごとの予定（次の季節の初日から）
+    SeriesId everySeason(int64_t from_day, CalendarEvent event) {
+        return every(nextSeasonStart(from_day), DAYS_PER_SEASON, event);
+    }
+
+    // day までに期日を迎えた予定を (期日, 予定順) の順に返す。
+    // 周期的な予定は何日分か飛ばして進めた場合も、その間の期日ごとに1件ずつ返す
+    std::vector<CalendarEvent> advanceTo(int64_t day) {
+        std::vector<CalendarEvent> due;
+        for (Entry& entry : wheel.advanceTo(day)) {
+            due.push_back(entry.event);
+            if (entry.series == NO_SERIES) continue;
+            Series& recurring = series[entry.series];
+            CalendarEvent next = entry.event;
+            next.day += recurring.period;
+            while (next.day <= day) {
+                due.push_back(next);
+                next.day += recurring.period;
+            }
+            recurring.handle = wheel.schedule(next.day, Entry{next, entry.series});
+        }
+        std::stable_sort(due.begin(), due.end(),
+                         [](const CalendarEvent& a, const CalendarEvent& b) { return a.day < b.day; });
+        return due;
+    }
+
+    // 期日を待っている予定の数
+    size_t pending() const { return wheel.size(); }
+
+private:
+    static constexpr SeriesId NO_SERIES = static_cast<SeriesId>(-1);
+
+    struct Entry {
+        CalendarEvent event;
+        SeriesId series;
+    };
+
+    struct Series {
+        int64_t period;
+        Handle handle;  // ホイール上の次の期日の予定
+        bool active;
+    };
+
+    TimingWheel<Entry> wheel;
+    std::vector<Series> series;
+};
+
+#endif // CALENDAR_H
@@ -0,0 +1,395 @@
+#pragma once
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "agent_fields.h"
+#include "simulation.h"
+
+// World のバイナリチェックポイント
+// 先頭に MAGIC と VERSION を置き、以降は固定幅の数値と長さ付き文字列を順に並べる（リトルエンディアン前提）
+// 住民・企業の項目は AgentFields の表に従う
+// 再開後の World::step が保存しなかった場合と同じ結果になるよう、シミュレーションの進行に効く状態はすべて保存する
+// （モードの切り替え・価格設定・買い物かご・季節の倍率・貿易ルート・当日の需給履歴・LOD の集団・雇用関係を含む）
+// 保存しないのは市場の長期価格履歴（再開後に積み直す）と、季節の始まり以外の暦の予定（呼び出し側で置き直す）だけ
+// レシピ表・業種索引・属性索引・住民と借り手のハンドル・融資の満期予定・季節の予定は World::rebuildDerivedState で作り直す
+class Checkpoint {
+public:
+    static constexpr char MAGIC[8] = {'M', 'A', 'E', 'S', 'C', 'K', 'P', 'T'};
+    static constexpr uint32_t VERSION = 7;
+
+    static void save(const World& world, std::ostream& out);
+    static World load(std::istream& in);
+
+    // 住民・企業以外の状態（日付・設定・政府・融資・市場・貿易ルート・LOD の集団）だけを読み書きする
+    // 住民と企業を別の形式で持つ保存形式（AgentColumns・AsyncCheckpoint）と共有する
+    static void saveState(const World& world, std::ostream& out);
+    static void loadState(std::istream& in, World& world);
+
+private:
+    template <typename T>
+    static void put(std::ostream& out, T value) {
+        static_assert(std::is_arithmetic<T>::value, "put expects a number");
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static void putString(std::ostream& out, const std::string& value) {
+        put<uint32_t>(out, static_cast<uint32_t>(value.size()));
+        out.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    template <typename T>
+    static T get(std::istream& in) {
+        static_assert(std::is_arithmetic<T>::value, "get expects a number");
+        T value;
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+            throw std::runtime_error("Checkpoint is truncated");
+        }
+        return value;
+    }
+
+    static std::string getString(std::istream& in) {
+        const uint32_t size = get<uint32_t>(in);
+        std::string value(size, '\0');
+        if (size > 0 && !in.read(&value[0], size)) {
+            throw std::runtime_error("Checkpoint is truncated");
+        }
+        return value;
+    }
+
+    static void putAgent(std::ostream& out, const Agent& agent) {
+        put<int64_t>(out, agent.id);
+        put<int64_t>(out, agent.money);
+    }
+
+    static void getAgent(std::istream& in, Agent& agent) {
+        agent.id = get<int64_t>(in);
+        agent.money = get<int64_t>(in);
+    }
+
+    static void putInts(std::ostream& out, const std::vector<int>& values) {
+        put<uint64_t>(out, values.size());
+        for (int value : values) put<int32_t>(out, value);
+    }
+
+    static std::vector<int> getInts(std::istream& in) {
+        std::vector<int> values(get<uint64_t>(in));
+        for (int& value : values) value = get<int32_t>(in);
+        return values;
+    }
+
+    // AgentFields の表の順に、数値は保存時の幅で、文字列は長さ付きで並べる
+    template <typename Agent>
+    static void putAgents(std::ostream& out, const std::vector<Agent>& agents,
+                          const std::vector<IntField<Agent>>& ints, const std::vector<TextField<Agent>>& texts) {
+        put<uint64_t>(out, agents.size());
+        for (const auto& agent : agents) {
+            for (const auto& field : ints) {
+                const int64_t value = field.get(agent);
+                if (field.type == ColumnType::INT64) {
+                    put<int64_t>(out, value);
+                } else if (field.type == ColumnType::FLOAT32) {
+                    put<uint32_t>(out, static_cast<uint32_t>(value));
+                } else {
+                    put<int32_t>(out, static_cast<int32_t>(value));
+                }
+            }
+            for (const auto& field : texts) putString(out, field.get(agent));
+        }
+    }
+
+    template <typename Agent>
+    static void getAgents(std::istream& in, std::vector<Agent>& agents,
+                          const std::vector<IntField<Agent>>& ints, const std::vector<TextField<Agent>>& texts) {
+        agents.resize(get<uint64_t>(in));
+        for (auto& agent : agents) {
+            for (const auto& field : ints) {
+                if (field.type == ColumnType::INT64) {
+                    field.set(agent, get<int64_t>(in));
+                } else if (field.type == ColumnType::FLOAT32) {
+                    field.set(agent, get<uint32_t>(in));
+                } else {
+                    field.set(agent, get<int32_t>(in));
+                }
+            }
+            for (const auto& field : texts) field.set(agent, getString(in));
+        }
+    }
+};
+
+inline void Checkpoint::save(const World& world, std::ostream& out) {
+    out.write(MAGIC, sizeof(MAGIC));
+    put<uint32_t>(out, VERSION);
+    saveState(world, out);
+
+    putAgents(out, world.people, AgentFields::personInts(), AgentFields::personTexts());
+    putAgents(out, world.businesses, AgentFields::businessInts(), AgentFields::businessTexts());
+
+    if (!out) {
+        throw std::runtime_error("Failed to write checkpoint");
+    }
+}
+
+inline void Checkpoint::saveState(const World& world, std::ostream& out) {
+    put<int64_t>(out, world.day);
+    put<int64_t>(out, world.market.getCurrentDay());
+    putString(out, world.staple_food);
+
+    put<uint8_t>(out, world.level_of_detail ? 1 : 0);
+    put<uint8_t>(out, world.household_basket ? 1 : 0);
+    put<uint8_t>(out, world.seasons ? 1 : 0);
+    put<uint8_t>(out, world.labor_market ? 1 : 0);
+    put<int32_t>(out, world.tax_period);
+
+    put<int64_t>(out, world.pricing.wage);
+    put<float>(out, world.pricing.target_margin);
+    put<float>(out, world.pricing.adjust_rate);
+    put<float>(out, world.pricing.competition);
+
+    put<uint64_t>(out, world.basket.goods.size());
+    for (const auto& good : world.basket.goods) {
+        putString(out, good.product);
+        put<double>(out, good.share);
+        put<double>(out, good.tilt);
+    }
+    put<double>(out, world.basket.spend_rate);
+    put<int64_t>(out, world.basket.reserve);
+
+    const auto& multipliers = world.seasonal_production.multipliers();
+    put<uint64_t>(out, multipliers.size());
+    for (const auto& [sector, factors] : multipliers) {
+        putString(out, sector);
+        for (float factor : factors) put<float>(out, factor);
+    }
+
+    putAgent(out, world.government);
+    put<int32_t>(out, world.government.tax_rate);
+    put<float>(out, world.government.approval_rating);
+    put<uint64_t>(out, world.government.subsidies().size());
+    for (const auto& [sector, amount] : world.government.subsidies()) {
+        putString(out, sector);
+        put<float>(out, amount);
+    }
+    for (int64_t count : world.government.policy_history.counts) put<int64_t>(out, count);
+    put<int64_t>(out, world.government.reliefAmount());
+    put<int64_t>(out, world.government.reliefThreshold());
+
+    putAgent(out, world.loan_provider);
+    put<float>(out, world.loan_provider.base_interest_rate);
+    put<float>(out, world.loan_provider.max_risk_premium);
+    put<float>(out, world.loan_provider.min_credit_score);
+    put<int32_t>(out, world.loan_provider.loan_term_days);
+    put<int64_t>(out, world.loan_provider.next_loan_id);
+    put<uint64_t>(out, world.loan_provider.active_loans.size());
+    for (const auto& loan : world.loan_provider.active_loans) {
+        put<int64_t>(out, loan.loan_id);
+        put<int64_t>(out, loan.lender_id);
+        put<int64_t>(out, loan.borrower_id);
+        put<int64_t>(out, loan.amount);
+        put<float>(out, loan.interest_rate);
+        put<int32_t>(out, loan.days_remaining);
+        put<int32_t>(out, loan.payment_schedule);
+        put<uint8_t>(out, loan.defaulted ? 1 : 0);
+        put<int64_t>(out, loan.due_day);
+    }
+
+    put<float>(out, world.market.getPriceVolatility());
+    const auto products = world.market.getProducts();
+    put<uint64_t>(out, products.size());
+    for (const auto& product : products) {
+        putString(out, product);
+        put<int32_t>(out, world.market.getPrice(product));
+        put<int32_t>(out, world.market.getStock(product));
+        putInts(out, world.market.getDemandHistory(product));
+        putInts(out, world.market.getSupplyHistory(product));
+        put<int32_t>(out, world.market.getDailyDemand(product));
+        put<int32_t>(out, world.market.getDailySupply(product));
+    }
+
+    put<uint64_t>(out, world.trade_routes.size());
+    for (const auto& route : world.trade_routes) {
+        put<int32_t>(out, route.from_location_id);
+        put<int32_t>(out, route.to_location_id);
+        put<int32_t>(out, route.travel_time);
+        put<uint64_t>(out, route.goods.size());
+        for (const auto& [product, amount] : route.goods) {
+            putString(out, product);
+            put<int32_t>(out, amount);
+        }
+    }
+
+    put<uint64_t>(out, world.labor.employers().size());
+    for (size_t i = 0; i < world.labor.employers().size(); ++i) {
+        put<int64_t>(out, world.labor.employers()[i]);
+        put<int64_t>(out, world.labor.wages()[i]);
+    }
+
+    const auto& cohorts = world.cohorts.getCohorts();
+    put<uint64_t>(out, cohorts.size());
+    for (const auto& cohort : cohorts) {
+        putString(out, cohort.job);
+        put<int32_t>(out, cohort.income_band);
+        put<int32_t>(out, cohort.satisfaction_band);
+        put<int32_t>(out, cohort.satisfaction);
+        put<int64_t>(out, cohort.income_sum);
+        put<int64_t>(out, cohort.money_sum);
+        put<double>(out, cohort.delta_per_capita);
+        put<uint64_t>(out, cohort.size());
+        for (size_t slot = 0; slot < cohort.size(); ++slot) {
+            put<uint64_t>(out, cohort.members[slot]);
+            put<int64_t>(out, cohort.entry_money[slot]);
+            put<double>(out, cohort.entry_delta[slot]);
+        }
+    }
+}
+
+// チェックポイントから World を復元する。派生状態は rebuildDerivedState で作り直す
+inline World Checkpoint::load(std::istream& in) {
+    char magic[sizeof(MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a checkpoint file");
+    }
+    const uint32_t version = get<uint32_t>(in);
+    if (version != VERSION) {
+        throw std::runtime_error("Unsupported checkpoint version " + std::to_string(version));
+    }
+
+    World world;
+    loadState(in, world);
+
+    getAgents(in, world.people, AgentFields::personInts(), AgentFields::personTexts());
+    getAgents(in, world.businesses, AgentFields::businessInts(), AgentFields::businessTexts());
+
+    world.rebuildDerivedState();
+    return world;
+}
+
+inline void Checkpoint::loadState(std::istream& in, World& world) {
+    world.day = get<int64_t>(in);
+    world.market.restoreCurrentDay(get<int64_t>(in));
+    world.staple_food = getString(in);
+
+    world.level_of_detail = get<uint8_t>(in) != 0;
+    world.household_basket = get<uint8_t>(in) != 0;
+    world.seasons = get<uint8_t>(in) != 0;
+    world.labor_market = get<uint8_t>(in) != 0;
+    world.tax_period = get<int32_t>(in);
+    if (world.tax_period < 1) {
+        throw std::runtime_error("Checkpoint tax period must be positive");
+    }
+
+    world.pricing.wage = get<int64_t>(in);
+    world.pricing.target_margin = get<float>(in);
+    world.pricing.adjust_rate = get<float>(in);
+    world.pricing.competition = get<float>(in);
+
+    world.basket.goods.resize(get<uint64_t>(in));
+    for (auto& good : world.basket.goods) {
+        good.product = getString(in);
+        good.share = get<double>(in);
+        good.tilt = get<double>(in);
+    }
+    world.basket.spend_rate = get<double>(in);
+    world.basket.reserve = get<int64_t>(in);
+
+    world.seasonal_production = SeasonalProduction();
+    const uint64_t seasonal_sectors = get<uint64_t>(in);
+    for (uint64_t i = 0; i < seasonal_sectors; ++i) {
+        std::string sector = getString(in);
+        SeasonalProduction::Multipliers factors;
+        for (float& factor : factors) factor = get<float>(in);
+        world.seasonal_production.setMultipliers(sector, factors);
+    }
+
+    getAgent(in, world.government);
+    world.government.tax_rate = get<int32_t>(in);
+    world.government.approval_rating = get<float>(in);
+    const uint64_t subsidies = get<uint64_t>(in);
+    for (uint64_t i = 0; i < subsidies; ++i) {
+        std::string sector = getString(in);
+        world.government.setSubsidy(sector, get<float>(in));
+    }
+    for (int64_t& count : world.government.policy_history.counts) count = get<int64_t>(in);
+    const int64_t relief_amount = get<int64_t>(in);
+    world.government.setRelief(relief_amount, get<int64_t>(in));
+
+    getAgent(in, world.loan_provider);
+    world.loan_provider.base_interest_rate = get<float>(in);
+    world.loan_provider.max_risk_premium = get<float>(in);
+    world.loan_provider.min_credit_score = get<float>(in);
+    world.loan_provider.loan_term_days = get<int32_t>(in);
+    world.loan_provider.next_loan_id = get<int64_t>(in);
+    world.loan_provider.active_loans.resize(get<uint64_t>(in));
+    for (auto& loan : world.loan_provider.active_loans) {
+        loan.loan_id = get<int64_t>(in);
+        loan.lender_id = get<int64_t>(in);
+        loan.borrower_id = get<int64_t>(in);
+        loan.amount = get<int64_t>(in);
+        loan.interest_rate = get<float>(in);
+        loan.days_remaining = get<int32_t>(in);
+        loan.payment_schedule = get<int32_t>(in);
+        loan.defaulted = get<uint8_t>(in) != 0;
+        loan.due_day = get<int64_t>(in);
+    }
+
+    world.market.setPriceVolatility(get<float>(in));
+    const uint64_t products = get<uint64_t>(in);
+    for (uint64_t i = 0; i < products; ++i) {
+        std::string product = getString(in);
+        const int32_t price = get<int32_t>(in);
+        world.market.restoreProduct(product, price, get<int32_t>(in));
+        std::vector<int> demand = getInts(in);
+        std::vector<int> supply = getInts(in);
+        const int32_t demand_total = get<int32_t>(in);
+        world.market.restoreHistory(product, std::move(demand), std::move(supply), demand_total, get<int32_t>(in));
+    }
+
+    world.trade_routes.resize(get<uint64_t>(in));
+    for (auto& route : world.trade_routes) {
+        route.from_location_id = get<int32_t>(in);
+        route.to_location_id = get<int32_t>(in);
+        route.travel_time = get<int32_t>(in);
+        const uint64_t goods = get<uint64_t>(in);
+        for (uint64_t i = 0; i < goods; ++i) {
+            std::string product = getString(in);
+            route.goods[product] = get<int32_t>(in);
+        }
+    }
+
+    const uint64_t employment = get<uint64_t>(in);
+    std::vector<int64_t> employers;
+    std::vector<int64_t> wages;
+    for (uint64_t i = 0; i < employment; ++i) {
+        employers.push_back(get<int64_t>(in));
+        wages.push_back(get<int64_t>(in));
+    }
+    world.labor.restore(std::move(employers), std::move(wages));
+
+    std::vector<Cohort> cohorts(get<uint64_t>(in));
+    for (auto& cohort : cohorts) {
+        cohort.job = getString(in);
+        cohort.income_band = get<int32_t>(in);
+        cohort.satisfaction_band = get<int32_t>(in);
+        cohort.satisfaction = get<int32_t>(in);
+        cohort.income_sum = get<int64_t>(in);
+        cohort.money_sum = get<int64_t>(in);
+        cohort.delta_per_capita = get<double>(in);
+        const uint64_t members = get<uint64_t>(in);
+        for (uint64_t slot = 0; slot < members; ++slot) {
+            cohort.members.push_back(static_cast<size_t>(get<uint64_t>(in)));
+            cohort.entry_money.push_back(get<int64_t>(in));
+            cohort.entry_delta.push_back(get<double>(in));
+        }
+    }
+    world.cohorts.restore(std::move(cohorts));
+}
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,374 @@
+#pragma once
+#ifndef COHORT_H
+#define COHORT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../agent/government.h"
+#include "../agent/person.h"
+#include "../market/market.h"
+
+// 休眠中の住民の集団（同じ職業・収入帯・満足度帯）
+// 構成員は個別には動かさず、集団の所持金合計と1人あたりの純増減だけを進める
+struct Cohort {
+    std::string job;
+    int32_t income_band = 0;
+    int32_t satisfaction_band = 0;
+    int32_t satisfaction = 50;      // 構成員共通の満足度
+    int64_t income_sum = 0;         // 構成員の日収の合計
+    int64_t money_sum = 0;          // 構成員の所持金の合計
+    double delta_per_capita = 0.0;  // 集団化以降の1人あたり純増減（累積）
+
+    std::vector<size_t> members;        // people の添字
+    std::vector<int64_t> entry_money;   // 集団に入ったときの所持金
+    std::vector<double> entry_delta;    // 集団に入ったときの delta_per_capita
+    double poorest = 0.0;               // 構成員の offset の最小値（保存しない。build・reindex で求める）
+
+    size_t size() const { return members.size(); }
+
+    double meanMoney() const {
+        return members.empty() ? 0.0 : static_cast<double>(money_sum) / members.size();
+    }
+
+    // 構成員 slot の現在の所持金の推定値
+    int64_t memberMoney(size_t slot) const {
+        return entry_money[slot] + static_cast<int64_t>(std::llround(delta_per_capita - entry_delta[slot]));
+    }
+
+    // 構成員 slot の所持金の推定値から delta_per_capita を除いた部分（集団全体の増減では順位が変わらない）
+    double offset(size_t slot) const { return static_cast<double>(entry_money[slot]) - entry_delta[slot]; }
+
+    void refreshPoorest() {
+        poorest = std::numeric_limits<double>::infinity();
+        for (size_t slot = 0; slot < size(); ++slot) poorest = std::min(poorest, offset(slot));
+    }
+};
+
+// 詳細度（LOD）を切り替える住民シミュレーション
+// 同じ日課をこなすだけの住民を集団にまとめて加重集計で進め、融資・犯罪・直接取引など
+// 個別のイベントが起きた住民だけを promote で通常のエージェントに戻す
+class CohortSimulator {
+public:
+    static constexpr int32_t INCOME_BAND = 10;        // 日収の帯の幅
+    static constexpr int32_t SATISFACTION_BAND = 20;  // 満足度の帯の幅
+    static constexpr size_t MIN_COHORT_SIZE = 16;     // これより小さい集団は作らない
+    static constexpr int32_t NO_COHORT = -1;
+
+    // 住民を集団に振り分ける。個別に扱う必要がある住民と小さすぎる集団は通常のエージェントのまま
+    // 戻り値は集団に入った住民の数
+    size_t build(const std::vector<Person>& people) {
+        cohorts.clear();
+        active.clear();
+        cohort_of.assign(people.size(), NO_COHORT);
+        slot_of.assign(people.size(), 0);
+
+        std::map<std::tuple<std::string, int32_t, int32_t>, std::vector<size_t>> groups;
+        for (size_t i = 0; i < people.size(); ++i) {
+            if (!isEligible(people[i])) {
+                active.push_back(i);
+                continue;
+            }
+            groups[{people[i].job, people[i].daily_income / INCOME_BAND,
+                    people[i].satisfaction / SATISFACTION_BAND}].push_back(i);
+        }
+
+        size_t dormant = 0;
+        for (auto& [key, indices] : groups) {
+            if (indices.size() < MIN_COHORT_SIZE) {
+                active.insert(active.end(), indices.begin(), indices.end());
+                continue;
+            }
+            Cohort cohort;
+            std::tie(cohort.job, cohort.income_band, cohort.satisfaction_band) = key;
+            int64_t satisfaction_sum = 0;
+            for (size_t i : indices) satisfaction_sum += people[i].satisfaction;
+            cohort.satisfaction = static_cast<int32_t>(satisfaction_sum / static_cast<int64_t>(indices.size()));
+
+            const int32_t id = static_cast<int32_t>(cohorts.size());
+            for (size_t i : indices) {
+                cohort_of[i] = id;
+                slot_of[i] = cohort.members.size();
+                cohort.members.push_back(i);
+                cohort.entry_money.push_back(people[i].money);
+                cohort.entry_delta.push_back(0.0);
+                cohort.income_sum += people[i].daily_income;
+                cohort.money_sum += people[i].money;
+            }
+            cohort.refreshPoorest();
+            dormant += indices.size();
+            cohorts.push_back(std::move(cohort));
+        }
+        std::sort(active.begin(), active.end());
+        return dormant;
+    }
+
+    // 保存しておいた集団に置き換える。住民との対応は reindex で作る
+    void restore(std::vector<Cohort> saved) {
+        cohorts = std::move(saved);
+        active.clear();
+        cohort_of.clear();
+        slot_of.clear();
+    }
+
+    // people 人の住民と集団の対応、通常のエージェントの一覧を集団の構成員から作り直す
+    void reindex(size_t people) {
+        cohort_of.assign(people, NO_COHORT);
+        slot_of.assign(people, 0);
+        for (size_t id = 0; id < cohorts.size(); ++id) {
+            Cohort& cohort = cohorts[id];
+            if (cohort.entry_money.size() != cohort.size() || cohort.entry_delta.size() != cohort.size()) {
+                throw std::runtime_error("Cohort member columns do not match");
+            }
+            for (size_t slot = 0; slot < cohort.size(); ++slot) {
+                const size_t person = cohort.members[slot];
+                if (person >= people || cohort_of[person] != NO_COHORT) {
+                    throw std::runtime_error("Cohort member out of range");
+                }
+                cohort_of[person] = static_cast<int32_t>(id);
+                slot_of[person] = slot;
+            }
+            cohort.refreshPoorest();
+        }
+        active.clear();
+        for (size_t i = 0; i < people; ++i) {
+            if (cohort_of[i] == NO_COHORT) active.push_back(i);
+        }
+    }
+
+    // people の末尾に加わった住民 person を通常のエージェントとして加える（集団には入れない）
+    void admit(size_t person) {
+        if (person != cohort_of.size()) {
+            throw std::invalid_argument("Admitted person must be appended to the indexed people");
+        }
+        cohort_of.push_back(NO_COHORT);
+        slot_of.push_back(0);
+        active.push_back(person);
+    }
+
+    // 住民を取り除いて people を詰め直した後に呼ぶ。moved_to[i] は元の添字 i の新しい添字で、
+    // 取り除いた住民は people（詰めた後の人数）以上の値。取り除く住民は先に promote で集団から外しておく
+    void remap(const std::vector<size_t>& moved_to, size_t people) {
+        for (auto& cohort : cohorts) {
+            for (size_t& member : cohort.members) {
+                if (member >= moved_to.size() || moved_to[member] >= people) {
+                    throw std::runtime_error("Removed person is still in a cohort");
+                }
+                member = moved_to[member];
+            }
+        }
+        reindex(people);
+    }
+
+    bool isActive(size_t person) const {
+        return person >= cohort_of.size() || cohort_of[person] == NO_COHORT;
+    }
+
+    int32_t cohortOf(size_t person) const {
+        return person < cohort_of.size() ? cohort_of[person] : NO_COHORT;
+    }
+
+    const std::vector<size_t>& activePeople() const { return active; }
+    const std::vector<Cohort>& getCohorts() const { return cohorts; }
+
+    size_t dormantCount() const {
+        size_t count = 0;
+        for (const auto& cohort : cohorts) count += cohort.size();
+        return count;
+    }
+
+    // 住民を通常のエージェントに戻す（所持金と満足度を書き戻す）。すでに個別なら何もしない
+    void promote(size_t person, std::vector<Person>& people) {
+        if (person >= people.size()) {
+            throw std::out_of_range("Unknown person");
+        }
+        if (isActive(person)) return;
+        Cohort& cohort = cohorts[cohort_of[person]];
+        const size_t sorted = active.size();
+        if (detach(person, people)) cohort.refreshPoorest();
+        mergeActive(sorted);
+    }
+
+    // 集団の構成員全員を通常のエージェントに戻し、戻した住民の添字を返す
+    std::vector<size_t> promoteCohort(size_t id, std::vector<Person>& people) {
+        const size_t sorted = active.size();
+        std::vector<size_t> promoted = dissolve(cohorts.at(id), people);
+        mergeActive(sorted);
+        return promoted;
+    }
+
+    // 休眠中の住民の所持金と満足度を people に書き出す（集団からは外さない）
+    // ハッシュ計算・チェックポイント・富の分布の集計の前に呼ぶ
+    void materialize(std::vector<Person>& people) const {
+        for (const auto& cohort : cohorts) {
+            for (size_t slot = 0; slot < cohort.size(); ++slot) {
+                Person& person = people[cohort.members[slot]];
+                person.money = cohort.memberMoney(slot);
+                person.setSatisfaction(cohort.satisfaction);
+            }
+        }
+    }
+
+    // 課税（1人あたりの平均所持金に税率を掛けた額を人数分）。課税した人数を返す
+    // 平均から決めた税額を払えない構成員は集団から外し、個別の規則（Government::collectTax）で課税する
+    int64_t collectTax(Government& government, std::vector<Person>& people) {
+        const size_t sorted = active.size();
+        int64_t taxed = 0;
+        for (size_t id = 0; id < cohorts.size(); ++id) {
+            Cohort& cohort = cohorts[id];
+            if (cohort.members.empty()) continue;
+            const int64_t mean = cohort.money_sum / static_cast<int64_t>(cohort.size());
+            const int64_t tax = government.assessTax(mean, Government::PERSON_TAX_EXEMPTION);
+            if (tax <= 0) continue;
+            for (size_t person : splitPoor(id, tax, people)) {
+                if (government.collectTax(&people[person])) ++taxed;
+            }
+            if (cohort.members.empty()) continue;
+            const int64_t total = tax * static_cast<int64_t>(cohort.size());
+            adjust(cohort, -total);
+            government.addMoney(total);
+            government.approval_rating -= static_cast<float>(cohort.size());
+            taxed += static_cast<int64_t>(cohort.size());
+        }
+        mergeActive(sorted);
+        return taxed;
+    }
+
+    void payIncome() {
+        for (auto& cohort : cohorts) {
+            if (!cohort.members.empty()) adjust(cohort, cohort.income_sum);
+        }
+    }
+
+    // 平均所持金が threshold を下回った集団を解散する（融資の審査は個別に行うため）
+    std::vector<size_t> promoteNeedy(std::vector<Person>& people, int64_t threshold) {
+        const size_t sorted = active.size();
+        std::vector<size_t> promoted;
+        for (auto& cohort : cohorts) {
+            if (cohort.members.empty() || cohort.meanMoney() >= threshold) continue;
+            auto members = dissolve(cohort, people);
+            promoted.insert(promoted.end(), members.begin(), members.end());
+        }
+        mergeActive(sorted);
+        return promoted;
+    }
+
+    // 主食の購入（平均所持金で買える集団が在庫の範囲でまとめて買う）。購入件数を返す
+    // 在庫があるのに主食を買えない構成員は集団から外し、買えなかった住民として満足度を下げる
+    int64_t consume(Market& market, const std::string& food, std::vector<Person>& people) {
+        const size_t sorted = active.size();
+        int64_t trades = 0;
+        for (size_t id = 0; id < cohorts.size(); ++id) {
+            Cohort& cohort = cohorts[id];
+            if (cohort.members.empty()) continue;
+            int64_t bought = 0;
+            const int64_t stock = market.getStock(food);
+            if (stock > 0) {
+                for (size_t person : splitPoor(id, market.getPrice(food), people)) {
+                    people[person].setSatisfaction(std::max(0, people[person].satisfaction - 5));
+                }
+                if (cohort.members.empty()) continue;
+            }
+            if (stock > 0 && cohort.meanMoney() >= market.getPrice(food)) {
+                bought = std::min<int64_t>(stock, static_cast<int64_t>(cohort.size()));
+                adjust(cohort, -static_cast<int64_t>(market.buy(food, static_cast<int>(bought))));
+                trades += bought;
+            }
+            // 過半数が買えたかどうかで共通の満足度を動かす
+            if (bought * 2 >= static_cast<int64_t>(cohort.size())) {
+                cohort.satisfaction = std::min(100, cohort.satisfaction + 10);
+            } else {
+                cohort.satisfaction = std::max(0, cohort.satisfaction - 5);
+            }
+        }
+        mergeActive(sorted);
+        return trades;
+    }
+
+private:
+    std::vector<Cohort> cohorts;
+    std::vector<size_t> active;      // 通常のエージェントとして動かす住民（昇順）
+    std::vector<int32_t> cohort_of;
+    std::vector<size_t> slot_of;
+
+    // 集団に入れてよい住民か（個別のイベントが起きやすい住民は除く）
+    static bool isEligible(const Person& person) {
+        return person.health_status == HealthStatus::HEALTHY &&
+               person.crime_tendency != CrimeTendency::HIGH && person.inventory.empty();
+    }
+
+    // 住民を集団から外して所持金と満足度を書き戻す。外した住民が最も貧しい構成員だったら true
+    // （poorest は呼び出し側でまとめて求め直す）
+    // 外した住民は active の末尾に足すだけなので、呼び出し側は外し終えたら mergeActive で並べ直す
+    bool detach(size_t person, std::vector<Person>& people) {
+        Cohort& cohort = cohorts[cohort_of[person]];
+        const size_t slot = slot_of[person];
+        Person& target = people[person];
+        const int64_t money = cohort.memberMoney(slot);
+        const bool was_poorest = cohort.offset(slot) <= cohort.poorest;
+        target.money = money;
+        target.setSatisfaction(cohort.satisfaction);
+
+        cohort.money_sum -= money;
+        cohort.income_sum -= target.daily_income;
+        const size_t last = cohort.members.size() - 1;
+        if (slot != last) {
+            cohort.members[slot] = cohort.members[last];
+            cohort.entry_money[slot] = cohort.entry_money[last];
+            cohort.entry_delta[slot] = cohort.entry_delta[last];
+            slot_of[cohort.members[slot]] = slot;
+        }
+        cohort.members.pop_back();
+        cohort.entry_money.pop_back();
+        cohort.entry_delta.pop_back();
+
+        cohort_of[person] = NO_COHORT;
+        active.push_back(person);
+        return was_poorest;
+    }
+
+    // 集団の構成員全員を外し、外した住民の添字を返す（active の並べ直しは呼び出し側）
+    std::vector<size_t> dissolve(Cohort& cohort, std::vector<Person>& people) {
+        std::vector<size_t> members = cohort.members;
+        for (size_t person : members) detach(person, people);
+        cohort.refreshPoorest();
+        return members;
+    }
+
+    // active の先頭 sorted 人は昇順のまま、その後に detach で足した住民を並べて併合する
+    // 1人ずつ挿入すると1人あたり O(n) かかるので、外し終えてから1回だけ並べ直す
+    void mergeActive(size_t sorted) {
+        if (sorted == active.size()) return;
+        std::sort(active.begin() + static_cast<std::ptrdiff_t>(sorted), active.end());
+        std::inplace_merge(active.begin(), active.begin() + static_cast<std::ptrdiff_t>(sorted), active.end());
+    }
+
+    // 1人あたり per_capita を払うと所持金が負になる構成員を集団から外し、外した住民の添字を返す
+    // 最も貧しい構成員でも払えるなら構成員を1人ずつ見ることはしない
+    std::vector<size_t> splitPoor(size_t id, int64_t per_capita, std::vector<Person>& people) {
+        std::vector<size_t> poor;
+        Cohort& cohort = cohorts[id];
+        if (cohort.poorest + cohort.delta_per_capita >= static_cast<double>(per_capita)) return poor;
+        for (size_t slot = 0; slot < cohort.size(); ++slot) {
+            if (cohort.memberMoney(slot) < per_capita) poor.push_back(cohort.members[slot]);
+        }
+        if (poor.empty()) return poor;
+        for (size_t person : poor) detach(person, people);
+        cohort.refreshPoorest();
+        return poor;
+    }
+
+    static void adjust(Cohort& cohort, int64_t total) {
+        cohort.money_sum += total;
+        cohort.delta_per_capita += static_cast<double>(total) / cohort.size();
+    }
+};
+
+#endif // COHORT_H
@@ -0,0 +1,412 @@
+#pragma once
+#ifndef COLUMN_STORE_H
+#define COLUMN_STORE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define COLUMN_STORE_MMAP 1
+#else
+#define COLUMN_STORE_MMAP 0
+#endif
+
+// ファイル全体をメモリにマップする（POSIX のみ）
+// 物理メモリより大きなファイルでも、触れたページだけが OS のページキャッシュに載る
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept { swap(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~MappedFile() { close(); }
+
+    // size バイトのファイルを作成（既存なら切り詰め）して読み書き可能でマップする
+    static MappedFile create(const std::string& path, size_t size) {
+#if COLUMN_STORE_MMAP
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) fail("Cannot create " + path);
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            fail("Cannot resize " + path);
+        }
+        return map(fd, size, true, path);
+#else
+        (void)path;
+        (void)size;
+        throw std::runtime_error("Memory-mapped files are not supported on this platform");
+#endif
+    }
+
+    static MappedFile open(const std::string& path, bool writable) {
+#if COLUMN_STORE_MMAP
+        const int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0) fail("Cannot open " + path);
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            fail("Cannot stat " + path);
+        }
+        return map(fd, static_cast<size_t>(info.st_size), writable, path);
+#else
+        (void)path;
+        (void)writable;
+        throw std::runtime_error("Memory-mapped files are not supported on this platform");
+#endif
+    }
+
+    uint8_t* data() { return base; }
+    const uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+    bool writable() const { return can_write; }
+
+    // ページキャッシュへの利用予定の通知。対応していない環境では何もしない
+    void adviseSequential(size_t offset, size_t bytes) const { advise(offset, bytes, kSequential); }
+    void adviseWillNeed(size_t offset, size_t bytes) const { advise(offset, bytes, kWillNeed); }
+    void adviseDontNeed(size_t offset, size_t bytes) const { advise(offset, bytes, kDontNeed); }
+    void adviseHugePages(size_t offset, size_t bytes) const { advise(offset, bytes, kHugePage); }
+
+    // 書き込んだ内容をファイルへ反映する
+    void flush() {
+#if COLUMN_STORE_MMAP
+        if (base && can_write && ::msync(base, length, MS_SYNC) != 0) fail("msync failed");
+#endif
+    }
+
+    static size_t pageSize() {
+#if COLUMN_STORE_MMAP
+        static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        return page;
+#else
+        return 4096;
+#endif
+    }
+
+private:
+    uint8_t* base = nullptr;
+    size_t length = 0;
+    bool can_write = false;
+
+    enum Advice { kSequential, kWillNeed, kDontNeed, kHugePage };
+
+    void swap(MappedFile& other) noexcept {
+        std::swap(base, other.base);
+        std::swap(length, other.length);
+        std::swap(can_write, other.can_write);
+    }
+
+    void close() {
+#if COLUMN_STORE_MMAP
+        if (base) ::munmap(base, length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    [[noreturn]] static void fail(const std::string& message) {
+#if COLUMN_STORE_MMAP
+        throw std::runtime_error(message + ": " + std::strerror(errno));
+#else
+        throw std::runtime_error(message);
+#endif
+    }
+
+#if COLUMN_STORE_MMAP
+    static MappedFile map(int fd, size_t size, bool writable, const std::string& path) {
+        MappedFile file;
+        file.length = size;
+        file.can_write = writable;
+        if (size > 0) {
+            void* address = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                                   MAP_SHARED, fd, 0);
+            if (address == MAP_FAILED) {
+                ::close(fd);
+                fail("Cannot map " + path);
+            }
+            file.base = static_cast<uint8_t*>(address);
+        }
+        ::close(fd);  // マップはファイル記述子を閉じても残る
+        return file;
+    }
+#endif
+
+    void advise(size_t offset, size_t bytes, Advice advice) const {
+#if COLUMN_STORE_MMAP
+        if (!base || bytes == 0 || offset >= length) return;
+        // madvise の先頭はページ境界でなければならない
+        const size_t page = pageSize();
+        const size_t begin = offset / page * page;
+        const size_t end = std::min(length, offset + bytes);
+        int flag = 0;
+        switch (advice) {
+            case kSequential: flag = MADV_SEQUENTIAL; break;
+            case kWillNeed: flag = MADV_WILLNEED; break;
+            case kDontNeed: flag = MADV_DONTNEED; break;
+            case kHugePage:
+#ifdef MADV_HUGEPAGE
+                flag = MADV_HUGEPAGE;
+                break;
+#else
+                return;
+#endif
+        }
+        ::madvise(base + begin, end - begin, flag);  // ヒントなので失敗は無視する
+#else
+        (void)offset;
+        (void)bytes;
+        (void)advice;
+#endif
+    }
+};
+
+enum class ColumnType : uint32_t { INT32 = 1, INT64 = 2, FLOAT32 = 3, UINT8 = 4, UINT64 = 5 };
+
+template <typename T> struct ColumnTypeOf;
+template <> struct ColumnTypeOf<int32_t> { static constexpr ColumnType value = ColumnType::INT32; };
+template <> struct ColumnTypeOf<int64_t> { static constexpr ColumnType value = ColumnType::INT64; };
+template <> struct ColumnTypeOf<float> { static constexpr ColumnType value = ColumnType::FLOAT32; };
+template <> struct ColumnTypeOf<uint8_t> { static constexpr ColumnType value = ColumnType::UINT8; };
+template <> struct ColumnTypeOf<uint64_t> { static constexpr ColumnType value = ColumnType::UINT64; };
+
+inline size_t columnTypeSize(ColumnType type) {
+    switch (type) {
+        case ColumnType::INT32: return 4;
+        case ColumnType::INT64: return 8;
+        case ColumnType::FLOAT32: return 4;
+        case ColumnType::UINT8: return 1;
+        case ColumnType::UINT64: return 8;
+    }
+    throw std::invalid_argument("Unknown column type");
+}
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType type;
+    uint64_t length;  // 要素数
+};
+
+// 名前付きの固定幅カラムを1ファイルに並べたストア
+// 形式: ヘッダ（MAGIC, VERSION, カラム数）→ カラム目録 → 各カラムの生データ（ALIGNMENT 境界に整列）
+// 生データはそのまま配列として使えるので、開くだけで読み込みなしに再開できる
+class ColumnStore {
+public:
+    static constexpr char MAGIC[8] = {'M', 'A', 'E', 'S', 'C', 'O', 'L', 'S'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t NAME_SIZE = 40;
+    static constexpr size_t ALIGNMENT = 1 << 21;  // 2MiB（透過的ヒュージページの単位）
+    static constexpr size_t DEFAULT_CHUNK_BYTES = 8 << 20;
+
+    static ColumnStore create(const std::string& path, const std::vector<ColumnSpec>& specs) {
+        ColumnStore store;
+        size_t offset = align(HEADER_SIZE + specs.size() * ENTRY_SIZE);
+        for (const auto& spec : specs) {
+            if (spec.name.empty() || spec.name.size() >= NAME_SIZE) {
+                throw std::invalid_argument("Column name must be 1-" + std::to_string(NAME_SIZE - 1) +
+                                            " bytes: '" + spec.name + "'");
+            }
+            if (store.columns.count(spec.name)) {
+                throw std::invalid_argument("Duplicate column: " + spec.name);
+            }
+            Column column{spec.type, columnTypeSize(spec.type), spec.length, offset};
+            store.columns.emplace(spec.name, column);
+            store.order.push_back(spec.name);
+            offset = align(offset + column.elem_size * column.length);
+        }
+        store.file = MappedFile::create(path, offset);
+
+        uint8_t* header = store.file.data();
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        writeField<uint32_t>(header + 8, VERSION);
+        writeField<uint32_t>(header + 12, static_cast<uint32_t>(specs.size()));
+        for (size_t i = 0; i < store.order.size(); ++i) {
+            const Column& column = store.columns.at(store.order[i]);
+            uint8_t* entry = header + HEADER_SIZE + i * ENTRY_SIZE;
+            std::memcpy(entry, store.order[i].data(), store.order[i].size());
+            writeField<uint32_t>(entry + NAME_SIZE, static_cast<uint32_t>(column.type));
+            writeField<uint64_t>(entry + NAME_SIZE + 4, column.length);
+            writeField<uint64_t>(entry + NAME_SIZE + 12, column.offset);
+        }
+        return store;
+    }
+
+    static ColumnStore open(const std::string& path, bool writable = false) {
+        ColumnStore store;
+        store.file = MappedFile::open(path, writable);
+        const uint8_t* header = store.file.data();
+        if (store.file.size() < HEADER_SIZE || std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("Not a column store: " + path);
+        }
+        const uint32_t version = readField<uint32_t>(header + 8);
+        if (version != VERSION) {
+            throw std::runtime_error("Unsupported column store version " + std::to_string(version));
+        }
+        const uint32_t count = readField<uint32_t>(header + 12);
+        if (HEADER_SIZE + size_t{count} * ENTRY_SIZE > store.file.size()) {
+            throw std::runtime_error("Column store directory is truncated");
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint8_t* entry = header + HEADER_SIZE + i * ENTRY_SIZE;
+            const char* name = reinterpret_cast<const char*>(entry);
+            std::string column_name(name, strnlen(name, NAME_SIZE));
+            Column column;
+            column.type = static_cast<ColumnType>(readField<uint32_t>(entry + NAME_SIZE));
+            column.elem_size = columnTypeSize(column.type);
+            column.length = readField<uint64_t>(entry + NAME_SIZE + 4);
+            column.offset = readField<uint64_t>(entry + NAME_SIZE + 12);
+            if (column.offset + column.elem_size * column.length > store.file.size()) {
+                throw std::runtime_error("Column store is truncated: " + column_name);
+            }
+            store.columns.emplace(column_name, column);
+            store.order.push_back(column_name);
+        }
+        return store;
+    }
+
+    bool has(const std::string& name) const { return columns.count(name) > 0; }
+    uint64_t length(const std::string& name) const { return find(name).length; }
+    const std::vector<std::string>& names() const { return order; }
+    size_t fileSize() const { return file.size(); }
+
+    template <typename T>
+    T* data(const std::string& name) {
+        if (!file.writable()) {
+            throw std::logic_error("Column store is read-only");
+        }
+        return reinterpret_cast<T*>(file.data() + checked<T>(name).offset);
+    }
+
+    template <typename T>
+    const T* data(const std::string& name) const {
+        return reinterpret_cast<const T*>(file.data() + checked<T>(name).offset);
+    }
+
+    // カラムを chunk_rows 行ずつ先頭から順に渡す。次のチャンクの先読みを依頼し、
+    // 処理済みのチャンクはページキャッシュから手放してよいと伝えるので、常駐量はチャンク数個分に収まる
+    template <typename T, typename Visit>
+    void stream(const std::string& name, size_t chunk_rows, Visit visit) {
+        T* values = data<T>(name);
+        streamRows({name}, chunk_rows, [&](size_t begin, size_t count) { visit(values + begin, begin, count); });
+    }
+
+    template <typename T, typename Visit>
+    void stream(const std::string& name, size_t chunk_rows, Visit visit) const {
+        const T* values = data<T>(name);
+        streamRows({name}, chunk_rows, [&](size_t begin, size_t count) { visit(values + begin, begin, count); });
+    }
+
+    // 同じ行数の複数カラムを並べて chunk_rows 行ずつ走査する（visit(begin, count)）
+    template <typename Visit>
+    void streamRows(const std::vector<std::string>& names, size_t chunk_rows, Visit visit) const {
+        if (names.empty()) return;
+        std::vector<const Column*> targets;
+        for (const auto& name : names) {
+            targets.push_back(&find(name));
+            if (targets.back()->length != targets.front()->length) {
+                throw std::invalid_argument("Columns have different lengths: " + name);
+            }
+        }
+        const size_t rows = targets.front()->length;
+        chunk_rows = std::max<size_t>(1, chunk_rows);
+        for (const Column* column : targets) {
+            file.adviseSequential(column->offset, column->elem_size * column->length);
+        }
+        for (size_t begin = 0; begin < rows; begin += chunk_rows) {
+            const size_t count = std::min<size_t>(chunk_rows, rows - begin);
+            for (const Column* column : targets) {
+                file.adviseWillNeed(column->offset + (begin + count) * column->elem_size,
+                                    chunk_rows * column->elem_size);
+            }
+            visit(begin, count);
+            // 共有マップなので手放しても書き込みはページキャッシュ経由でファイルに残る
+            for (const Column* column : targets) {
+                file.adviseDontNeed(column->offset + begin * column->elem_size, count * column->elem_size);
+            }
+        }
+    }
+
+    // 既定のチャンク行数（DEFAULT_CHUNK_BYTES に収まる行数）
+    template <typename T>
+    static size_t defaultChunkRows() {
+        return std::max<size_t>(1, DEFAULT_CHUNK_BYTES / sizeof(T));
+    }
+
+    // 大きなカラムに透過的ヒュージページを使うよう依頼する（対応環境のみ）
+    void adviseHugePages() const {
+        for (const auto& entry : columns) {
+            const Column& column = entry.second;
+            if (column.elem_size * column.length >= ALIGNMENT) {
+                file.adviseHugePages(column.offset, column.elem_size * column.length);
+            }
+        }
+    }
+
+    void flush() { file.flush(); }
+
+private:
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr size_t ENTRY_SIZE = NAME_SIZE + 4 + 8 + 8;
+
+    struct Column {
+        ColumnType type;
+        size_t elem_size;
+        uint64_t length;
+        uint64_t offset;
+    };
+
+    MappedFile file;
+    std::map<std::string, Column> columns;
+    std::vector<std::string> order;
+
+    static size_t align(size_t offset) { return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; }
+
+    template <typename T>
+    static void writeField(uint8_t* at, T value) {
+        std::memcpy(at, &value, sizeof(T));
+    }
+
+    template <typename T>
+    static T readField(const uint8_t* at) {
+        T value;
+        std::memcpy(&value, at, sizeof(T));
+        return value;
+    }
+
+    const Column& find(const std::string& name) const {
+        auto it = columns.find(name);
+        if (it == columns.end()) {
+            throw std::out_of_range("Unknown column: " + name);
+        }
+        return it->second;
+    }
+
+    template <typename T>
+    const Column& checked(const std::string& name) const {
+        const Column& column = find(name);
+        if (column.type != ColumnTypeOf<T>::value) {
+            throw std::invalid_argument("Column type mismatch: " + name);
+        }
+        return column;
+    }
+};
+
+#endif // COLUMN_STORE_H
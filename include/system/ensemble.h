@@ -0,0 +1,214 @@
+#pragma once
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "simulation.h"
+#include "thread_pool.h"
+
+// オンライン集計（Welford 法）。並列集計の結果は merge で結合できる
+struct RunningStats {
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+
+    void add(double value) {
+        if (count == 0) {
+            min = max = value;
+        } else {
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+        ++count;
+        const double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+    }
+
+    void merge(const RunningStats& other) {
+        if (other.count == 0) return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        const size_t total = count + other.count;
+        const double delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * count * other.count / total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        count = total;
+    }
+
+    double variance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+};
+
+// 1回の実行のパラメータ。World::step は乱数を使わないので、実行どうしの違いはこの設定だけで決まる
+struct EnsembleParams {
+    int tax_rate = 10;
+    float price_volatility = 0.1f;
+};
+
+// 全実行で共有する読み取り専用の初期状態
+// 初期世界を、実行ごとに写して進める可変な部分（state）と、World::step が読み書きしない部分
+// （住民名・貿易ルート）に分ける。後者は shared_ptr<const EnsembleBase> 越しに全実行で1つだけ持つ
+struct EnsembleBase {
+    World state;                            // 住民名と貿易ルートを外した初期世界
+    std::vector<std::string> person_names;  // 住民名（people の添字順）
+    std::vector<TradeRoute> trade_routes;
+
+    static std::shared_ptr<const EnsembleBase> build(World initial) {
+        auto base = std::make_shared<EnsembleBase>();
+        base->person_names.reserve(initial.people.size());
+        for (auto& person : initial.people) {
+            base->person_names.push_back(std::move(person.name));
+            person.name.clear();
+        }
+        base->trade_routes = std::move(initial.trade_routes);
+        initial.trade_routes.clear();
+        base->state = std::move(initial);
+        return base;
+    }
+
+    // 実行の可変な部分に住民名と貿易ルートを戻した完全な World（保存・ハッシュの比較用）
+    World assemble(const World& run_state) const {
+        World world = run_state;
+        if (world.people.size() != person_names.size()) {
+            throw std::logic_error("Ensemble run changed the population");
+        }
+        for (size_t i = 0; i < world.people.size(); ++i) world.people[i].name = person_names[i];
+        world.trade_routes = trade_routes;
+        return world;
+    }
+};
+
+// 1回の実行。共有の初期状態の可変な部分だけを写し、税率と価格変動性を設定して World::step で進める
+class EnsembleRun {
+public:
+    EnsembleRun(std::shared_ptr<const EnsembleBase> shared, const EnsembleParams& params)
+        : base(std::move(shared)) {
+        if (!base) {
+            throw std::invalid_argument("Ensemble requires an initial world");
+        }
+        world = base->state;
+        world.government.tax_rate = params.tax_rate;
+        world.market.setPriceVolatility(params.price_volatility);
+    }
+
+    TickStats step() { return world.step(); }
+
+    int64_t totalPersonMoney() const {
+        int64_t total = 0;
+        for (const auto& person : world.people) total += person.money;
+        return total;
+    }
+
+    double meanSatisfaction() const {
+        if (world.people.empty()) return 0.0;
+        double total = 0.0;
+        for (const auto& person : world.people) total += person.satisfaction;
+        return total / world.people.size();
+    }
+
+    // 実行中の可変な部分（住民名・貿易ルートは持たない）
+    const World& getWorld() const { return world; }
+    World& getWorld() { return world; }
+    const EnsembleBase& shared() const { return *base; }
+
+    // 住民名と貿易ルートを戻した完全な World
+    World assembleWorld() const { return base->assemble(world); }
+
+private:
+    std::shared_ptr<const EnsembleBase> base;
+    World world;
+};
+
+// 全実行の最終状態の要約統計
+struct EnsembleSummary {
+    size_t runs = 0;
+    RunningStats total_person_money;
+    RunningStats government_money;
+    RunningStats approval_rating;
+    RunningStats mean_satisfaction;
+    RunningStats staple_price;
+
+    void add(const EnsembleRun& run) {
+        const World& world = run.getWorld();
+        ++runs;
+        total_person_money.add(static_cast<double>(run.totalPersonMoney()));
+        government_money.add(static_cast<double>(world.government.money));
+        approval_rating.add(world.government.approval_rating);
+        mean_satisfaction.add(run.meanSatisfaction());
+        staple_price.add(world.market.getPrice(world.staple_food));
+    }
+
+    void merge(const EnsembleSummary& other) {
+        runs += other.runs;
+        total_person_money.merge(other.total_person_money);
+        government_money.merge(other.government_money);
+        approval_rating.merge(other.approval_rating);
+        mean_satisfaction.merge(other.mean_satisfaction);
+        staple_price.merge(other.staple_price);
+    }
+};
+
+// 初期世界を1回だけ用意して全実行で共有し、各実行は params の税率と価格変動性で days 日分 World::step で進める。
+// config を渡す版はその世界を生成してから base の版を呼ぶ。実行はコア間に分配し、各チャンクが局所的に集計して最後にチャンク順で結合するため、同じ構成なら結果は再現可能
+// base は設定（季節・労働市場・LOD など）を済ませた初期世界から EnsembleBase::build で作ったもの
+inline EnsembleSummary runEnsemble(const std::shared_ptr<const EnsembleBase>& base,
+                                   const std::vector<EnsembleParams>& params, int days, ThreadPool* pool = nullptr) {
+    if (!base) {
+        throw std::invalid_argument("Ensemble requires an initial world");
+    }
+    if (days < 0) {
+        throw std::invalid_argument("Number of days cannot be negative");
+    }
+
+    std::mutex mutex;
+    std::map<size_t, EnsembleSummary> partials;
+    auto runRange = [&](size_t lo, size_t hi) {
+        EnsembleSummary local;
+        for (size_t r = lo; r < hi; ++r) {
+            EnsembleRun run(base, params[r]);
+            for (int day = 0; day < days; ++day) {
+                run.step();
+            }
+            run.getWorld().syncPeople();
+            local.add(run);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        partials[lo] = local;
+    };
+    if (pool) {
+        pool->parallelFor(0, params.size(), runRange, 1);
+    } else {
+        runRange(0, params.size());
+    }
+
+    EnsembleSummary summary;
+    for (const auto& entry : partials) {
+        summary.merge(entry.second);
+    }
+    return summary;
+}
+
+inline EnsembleSummary runEnsemble(const WorldConfig& config, const std::vector<EnsembleParams>& params, int days,
+                                   ThreadPool* pool = nullptr) {
+    if (days < 0) {
+        throw std::invalid_argument("Number of days cannot be negative");
+    }
+    return runEnsemble(EnsembleBase::build(World::generate(config)), params, days, pool);
+}
+
+#endif // ENSEMBLE_H
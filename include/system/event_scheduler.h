@@ -0,0 +1,154 @@
+#pragma once
+#ifndef EVENT_SCHEDULER_H
+#define EVENT_SCHEDULER_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// 階層型タイミングホイール
+// 1段あたり SLOTS 個のスロットを LEVELS 段重ね、期日が近い予定ほど下の段に置く。
+// 上の段のスロットは時刻がそこに届いたときに1段下へ振り分け直す（カスケード）ので、
+// 1ティックの処理は「期日を迎えた予定の数」にほぼ比例し、予定の総数には依存しない。
+// ホイールの範囲（SLOTS^LEVELS ティック）より先の予定は overflow に置く
+template <typename T>
+class TimingWheel {
+public:
+    static constexpr int SLOT_BITS = 6;
+    static constexpr size_t SLOTS = size_t{1} << SLOT_BITS;
+    static constexpr int LEVELS = 4;
+
+    using Handle = uint64_t;
+
+    // 次に処理するティック
+    int64_t now() const { return current; }
+
+    // 予定の数（取り消し済みを除く）
+    size_t size() const { return live.size(); }
+    bool empty() const { return size() == 0; }
+
+    // due に payload を予定する。処理済みのティックを指定した場合は次の advanceTo で返す
+    Handle schedule(int64_t due, T payload) {
+        const Handle handle = next_sequence++;
+        Entry entry{due, handle, std::move(payload)};
+        live.insert(handle);
+        if (due < current) {
+            late.push_back(std::move(entry));
+        } else {
+            place(std::move(entry));
+        }
+        return handle;
+    }
+
+    // 予定を取り消す（期日になっても返さない）。取り消せたら true
+    // 返却済み・取り消し済み・未発行のハンドルは無視する（取り消した予定はホイールに残り、期日に捨てる）
+    bool cancel(Handle handle) { return live.erase(handle) != 0; }
+
+    // tick までの全ティックを処理し、期日を迎えた予定を (期日, 予定順) の順に返す
+    std::vector<T> advanceTo(int64_t tick) {
+        std::vector<Entry> due;
+        due.swap(late);
+        while (current <= tick) {
+            if (in_wheel == 0) {
+                // ホイールが空なら、次の overflow の区間か tick の先まで空のティックを飛ばす
+                int64_t next = tick + 1;
+                if (!overflow.empty()) {
+                    const int64_t block = static_cast<int64_t>(
+                        static_cast<uint64_t>(overflow.begin()->first) & ~levelMask(LEVELS));
+                    next = std::min(next, block);
+                }
+                if (next > current) {
+                    current = next;
+                    continue;
+                }
+            }
+            processTick(due);
+        }
+        std::sort(due.begin(), due.end(), [](const Entry& a, const Entry& b) {
+            return a.due != b.due ? a.due < b.due : a.sequence < b.sequence;
+        });
+
+        std::vector<T> result;
+        result.reserve(due.size());
+        for (auto& entry : due) {
+            if (live.erase(entry.sequence) == 0) continue;  // 取り消し済み
+            result.push_back(std::move(entry.payload));
+        }
+        return result;
+    }
+
+private:
+    struct Entry {
+        int64_t due;
+        Handle sequence;
+        T payload;
+    };
+
+    std::array<std::array<std::vector<Entry>, SLOTS>, LEVELS> wheel;
+    std::multimap<int64_t, Entry> overflow;
+    std::vector<Entry> late;
+    std::unordered_set<Handle> live;  // 返却も取り消しもされていない予定
+    int64_t current = 0;
+    size_t in_wheel = 0;  // wheel に置かれている予定の数
+    Handle next_sequence = 0;
+
+    static uint64_t levelMask(int level) {
+        return (uint64_t{1} << (SLOT_BITS * level)) - 1;
+    }
+
+    // 期日と現在時刻の最上位の食い違い桁で段を決める
+    void place(Entry&& entry) {
+        const uint64_t diff = static_cast<uint64_t>(entry.due) ^ static_cast<uint64_t>(current);
+        int level = 0;
+        while (level < LEVELS && (diff >> (SLOT_BITS * (level + 1))) != 0) ++level;
+        if (level >= LEVELS) {
+            const int64_t due = entry.due;
+            overflow.emplace(due, std::move(entry));
+            return;
+        }
+        const size_t slot = (static_cast<uint64_t>(entry.due) >> (SLOT_BITS * level)) & (SLOTS - 1);
+        wheel[level][slot].push_back(std::move(entry));
+        ++in_wheel;
+    }
+
+    void processTick(std::vector<Entry>& due) {
+        const uint64_t t = static_cast<uint64_t>(current);
+        if ((t & levelMask(LEVELS)) == 0) {
+            const int64_t horizon = current + static_cast<int64_t>(levelMask(LEVELS)) + 1;
+            auto end = overflow.lower_bound(horizon);
+            for (auto it = overflow.begin(); it != end; ++it) place(std::move(it->second));
+            overflow.erase(overflow.begin(), end);
+        }
+        for (int level = LEVELS - 1; level >= 1; --level) {
+            if ((t & levelMask(level)) != 0) continue;
+            const size_t slot = (t >> (SLOT_BITS * level)) & (SLOTS - 1);
+            std::vector<Entry> entries;
+            entries.swap(wheel[level][slot]);
+            in_wheel -= entries.size();
+            for (auto& entry : entries) place(std::move(entry));
+        }
+        auto& bucket = wheel[0][t & (SLOTS - 1)];
+        in_wheel -= bucket.size();
+        for (auto& entry : bucket) due.push_back(std::move(entry));
+        bucket.clear();
+        ++current;
+    }
+};
+
+// エージェント単位の予定の種類
+enum class EventKind {
+    LOAN_MATURITY,   // 融資の満期（target は Loan::loan_id）
+};
+
+struct AgentEvent {
+    EventKind kind;
+    uint64_t target;
+};
+
+using EventScheduler = TimingWheel<AgentEvent>;
+
+#endif // EVENT_SCHEDULER_H
@@ -0,0 +1,229 @@
+#pragma once
+#ifndef HOUSEHOLD_DEMAND_H
+#define HOUSEHOLD_DEMAND_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../agent/person.h"
+#include "../market/market.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HOUSEHOLD_AVX2 1
+#else
+#define HOUSEHOLD_AVX2 0
+#endif
+
+// 買い物かごの1品目
+// 予算に占める割合は share + tilt * (満足度 - 50) / 100（満足度の低い世帯ほど主食の割合を増やすなど）
+struct BasketGood {
+    std::string product;
+    double share;
+    double tilt = 0.0;
+};
+
+struct HouseholdBasket {
+    std::vector<BasketGood> goods;
+    double spend_rate = 0.05;  // 手元資金（reserve を超える分）のうち1日に使う割合
+    int64_t reserve = 50;
+
+    // 小麦を中心に、満足度が上がるとパンと道具に予算を移すかご
+    static HouseholdBasket standard() {
+        HouseholdBasket basket;
+        basket.goods = {{"小麦", 0.5, -0.2}, {"パン", 0.3, 0.1}, {"道具", 0.2, 0.1}};
+        return basket;
+    }
+
+    // 割合の合計が1、傾きの合計が0で、どの満足度でも各品目の割合が0以上であることを確認する
+    void validate() const {
+        double shares = 0.0;
+        double tilts = 0.0;
+        for (const auto& good : goods) {
+            if (good.share - std::abs(good.tilt) / 2 < 0.0) {
+                throw std::invalid_argument("Basket share of " + good.product + " can become negative");
+            }
+            shares += good.share;
+            tilts += good.tilt;
+        }
+        if (goods.empty() || std::abs(shares - 1.0) > 1e-9 || std::abs(tilts) > 1e-9) {
+            throw std::invalid_argument("Basket shares must sum to 1 and tilts to 0");
+        }
+        if (spend_rate < 0.0 || spend_rate > 1.0) {
+            throw std::invalid_argument("Spend rate must be within [0, 1]");
+        }
+    }
+};
+
+// 1ティック分の家計需要の結果
+struct HouseholdDemandReport {
+    std::vector<int> demand;   // 品目ごとの総需要（数量）
+    std::vector<int> filled;   // 品目ごとの約定数量
+    int64_t spent = 0;         // 家計から出た金額の合計
+    int64_t households = 0;    // 予算が正だった世帯数
+};
+
+// コブ・ダグラス型の家計需要
+// 世帯 i の予算 b_i を品目に一定の割合（満足度 s_i で線形に傾く）で配分するので、品目 g の総支出は
+//   share_g * Σb_i + tilt_g * Σ(b_i * s'_i)    （s'_i = (s_i - 50) / 100）
+// の2つの総和だけで決まる。総和は住民の列を一定数ずつ連続配列に集めて AVX2（非対応ならスカラー）で求め、
+// 品目ごとの総需要を Market::fillDemand でまとめて約定する。その後、品目ごとの約定率 r_g から
+//   世帯 i の支出 = b_i * (Σ share_g r_g + s'_i Σ tilt_g r_g)
+// を求めて所持金と満足度に反映する。住民ごとの market.buy は呼ばない
+class HouseholdDemand {
+public:
+    static constexpr size_t BATCH = 1024;  // 列に集める住民の数
+
+    // indices が空なら全住民、そうでなければ indices の住民だけが買い物をする
+    static HouseholdDemandReport run(const HouseholdBasket& basket, std::vector<Person>& people, Market& market,
+                                     const std::vector<size_t>* indices = nullptr) {
+        basket.validate();
+        const size_t count = indices ? indices->size() : people.size();
+        auto personAt = [&](size_t k) -> Person& { return people[indices ? (*indices)[k] : k]; };
+
+        // 予算の総和と満足度で重みを付けた総和
+        double budget_sum = 0.0;
+        double tilted_sum = 0.0;
+        HouseholdDemandReport report;
+        Columns columns;
+        for (size_t begin = 0; begin < count; begin += BATCH) {
+            const size_t n = std::min(BATCH, count - begin);
+            columns.gather(personAt, begin, n);
+            double sums[2];
+            budgetSums(columns.money.data(), columns.income.data(), columns.tilt.data(), n,
+                       basket.spend_rate, static_cast<double>(basket.reserve), sums);
+            budget_sum += sums[0];
+            tilted_sum += sums[1];
+        }
+
+        // 品目ごとの総需要と一括約定
+        double base_fill = 0.0;
+        double tilt_fill = 0.0;
+        for (const auto& good : basket.goods) {
+            const int price = market.getPrice(good.product);
+            const double spending = good.share * budget_sum + good.tilt * tilted_sum;
+            const int demand = price > 0 ? static_cast<int>(std::min(spending / price, 1e9)) : 0;
+            const BulkFill fill = market.fillDemand(good.product, demand);
+            report.demand.push_back(demand);
+            report.filled.push_back(fill.filled);
+            const double rate = demand > 0 ? static_cast<double>(fill.filled) / demand : 0.0;
+            base_fill += good.share * rate;
+            tilt_fill += good.tilt * rate;
+        }
+
+        // 世帯ごとの支出と満足度（欲しかった分をどれだけ買えたか）
+        for (size_t k = 0; k < count; ++k) {
+            Person& person = personAt(k);
+            const double budget = budgetOf(static_cast<double>(person.money), person.daily_income,
+                                           basket.spend_rate, static_cast<double>(basket.reserve));
+            const double tilt = (person.satisfaction - 50) / 100.0;
+            // 予算のない世帯は何も買えなかったものとして扱う
+            const double fulfilled =
+                budget > 0.0 ? std::min(1.0, std::max(0.0, base_fill + tilt * tilt_fill)) : 0.0;
+            if (budget > 0.0) ++report.households;
+            const int64_t spent = static_cast<int64_t>(budget * fulfilled);
+            person.money -= spent;
+            report.spent += spent;
+            const int delta = static_cast<int>(std::lround(15.0 * fulfilled)) - 5;
+            person.setSatisfaction(std::min(100, std::max(0, person.satisfaction + delta)));
+        }
+        return report;
+    }
+
+    // 世帯の1日の予算: 日収 + reserve を超える手元資金の spend_rate 分（0 から所持金の範囲）
+    static double budgetOf(double money, double income, double spend_rate, double reserve) {
+        const double budget = income + spend_rate * std::max(money - reserve, 0.0);
+        return std::min(std::max(budget, 0.0), std::max(money, 0.0));
+    }
+
+    // sums[0] = Σb_i, sums[1] = Σ(b_i * tilt_i)
+    static void budgetSums(const double* money, const double* income, const double* tilt, size_t n,
+                           double spend_rate, double reserve, double* sums) {
+#if HOUSEHOLD_AVX2
+        if (householdUsesAvx2()) {
+            budgetSumsAvx2(money, income, tilt, n, spend_rate, reserve, sums);
+            return;
+        }
+#endif
+        budgetSumsScalar(money, income, tilt, n, spend_rate, reserve, sums);
+    }
+
+    static void budgetSumsScalar(const double* money, const double* income, const double* tilt, size_t n,
+                                 double spend_rate, double reserve, double* sums) {
+        double budget_sum = 0.0;
+        double tilted_sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            const double budget = budgetOf(money[i], income[i], spend_rate, reserve);
+            budget_sum += budget;
+            tilted_sum += budget * tilt[i];
+        }
+        sums[0] = budget_sum;
+        sums[1] = tilted_sum;
+    }
+
+#if HOUSEHOLD_AVX2
+    // 4世帯ずつ（演算は budgetOf と同じ順序）
+    __attribute__((target("avx2")))
+    static void budgetSumsAvx2(const double* money, const double* income, const double* tilt, size_t n,
+                               double spend_rate, double reserve, double* sums) {
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d rate = _mm256_set1_pd(spend_rate);
+        const __m256d floor = _mm256_set1_pd(reserve);
+        __m256d budget_acc = zero;
+        __m256d tilted_acc = zero;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m256d m = _mm256_loadu_pd(money + i);
+            const __m256d spare = _mm256_max_pd(_mm256_sub_pd(m, floor), zero);
+            __m256d budget = _mm256_add_pd(_mm256_loadu_pd(income + i), _mm256_mul_pd(rate, spare));
+            budget = _mm256_min_pd(_mm256_max_pd(budget, zero), _mm256_max_pd(m, zero));
+            budget_acc = _mm256_add_pd(budget_acc, budget);
+            tilted_acc = _mm256_add_pd(tilted_acc, _mm256_mul_pd(budget, _mm256_loadu_pd(tilt + i)));
+        }
+        alignas(32) double budget_lanes[4];
+        alignas(32) double tilted_lanes[4];
+        _mm256_store_pd(budget_lanes, budget_acc);
+        _mm256_store_pd(tilted_lanes, tilted_acc);
+        budgetSumsScalar(money + i, income + i, tilt + i, n - i, spend_rate, reserve, sums);
+        for (int lane = 0; lane < 4; ++lane) {
+            sums[0] += budget_lanes[lane];
+            sums[1] += tilted_lanes[lane];
+        }
+    }
+#endif
+
+    static bool householdUsesAvx2() {
+#if HOUSEHOLD_AVX2
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+private:
+    // 住民の列（BATCH 人分の作業領域）
+    struct Columns {
+        std::vector<double> money;
+        std::vector<double> income;
+        std::vector<double> tilt;
+
+        template <typename PersonAt>
+        void gather(PersonAt& person_at, size_t begin, size_t n) {
+            money.resize(n);
+            income.resize(n);
+            tilt.resize(n);
+            for (size_t k = 0; k < n; ++k) {
+                const Person& person = person_at(begin + k);
+                money[k] = static_cast<double>(person.money);
+                income[k] = person.daily_income;
+                tilt[k] = (person.satisfaction - 50) / 100.0;
+            }
+        }
+    };
+};
+
+#endif // HOUSEHOLD_DEMAND_H
@@ -0,0 +1,169 @@
+#pragma once
+#ifndef LEDGER_H
+#define LEDGER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "thread_pool.h"
+
+// 口座間の送金1件（口座は 0 から始まる通し番号）
+struct Transfer {
+    size_t from;
+    size_t to;
+    int64_t amount;
+};
+
+enum class TransferStatus : uint8_t {
+    APPLIED = 0,
+    INSUFFICIENT_FUNDS = 1,  // 送金元の残高不足
+    INVALID = 2,             // 範囲外の口座・自分宛て・0以下の金額
+    OVERFLOW = 3,            // 入金すると送金先の残高があふれる（引き落としは送金元に戻す）
+};
+
+// 一括送金の結果
+struct LedgerReport {
+    size_t applied = 0;
+    size_t rejected = 0;
+    int64_t volume = 0;                  // 実際に動いた金額の合計
+    std::vector<TransferStatus> status;  // バッチと同じ順の各送金の結果
+};
+
+// 一括送金エンジン
+// 送金を口座範囲ごとのシャードに振り分け、2段階で適用する:
+//   1. 引き落とし: 送金元のシャードごとにバッチ順で残高を確認して引き落とす（不足なら却下）
+//   2. 入金: 承認された送金を送金先のシャードごとに入金する（Agent::addMoney と同じくあふれる入金は却下し、
+//      最後にその引き落としを送金元に戻す）
+// 各段階でシャード同士は別々の口座しか触らないので並列に処理でき、残高の確認は
+// 「バッチ開始時の残高からバッチ内の先行する引き落としを引いた額」に対して行うため、
+// 結果はシャード数やスレッド数に関係なく決定的になる（同じバッチ内の入金は引き落としの原資にならない）
+class Ledger {
+public:
+    // shards = 0 なら pool の大きさから決める
+    explicit Ledger(size_t shard_count = 0) : shards(shard_count) {}
+
+    // balance(i) は口座 i の残高への参照を返す関数（例: Agent::money）
+    template <typename BalanceAt>
+    LedgerReport apply(const std::vector<Transfer>& batch, size_t accounts, BalanceAt balance,
+                       ThreadPool* pool = nullptr) {
+        LedgerReport report;
+        report.status.assign(batch.size(), TransferStatus::APPLIED);
+        if (batch.empty()) return report;
+
+        const size_t shard_count = shardCount(accounts, pool);
+        const size_t range = (accounts + shard_count - 1) / shard_count;  // 1シャードあたりの口座数
+        auto shardOf = [range](size_t account) { return account / range; };
+
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const Transfer& transfer = batch[i];
+            if (transfer.from >= accounts || transfer.to >= accounts || transfer.from == transfer.to ||
+                transfer.amount <= 0) {
+                report.status[i] = TransferStatus::INVALID;
+            }
+        }
+
+        // 引き落とし（送金元のシャード単位）
+        std::vector<size_t> offsets;
+        std::vector<size_t> order;
+        bucket(batch, report.status, shard_count, offsets, order,
+               [&](const Transfer& transfer) { return shardOf(transfer.from); });
+        forEachShard(shard_count, pool, [&](size_t shard) {
+            for (size_t k = offsets[shard]; k < offsets[shard + 1]; ++k) {
+                const Transfer& transfer = batch[order[k]];
+                int64_t& from = balance(transfer.from);
+                if (from < transfer.amount) {
+                    report.status[order[k]] = TransferStatus::INSUFFICIENT_FUNDS;
+                    continue;
+                }
+                from -= transfer.amount;
+            }
+        });
+
+        // 入金（送金先のシャード単位）
+        bucket(batch, report.status, shard_count, offsets, order,
+               [&](const Transfer& transfer) { return shardOf(transfer.to); });
+        std::vector<int64_t> shard_volume(shard_count, 0);
+        forEachShard(shard_count, pool, [&](size_t shard) {
+            int64_t volume = 0;
+            for (size_t k = offsets[shard]; k < offsets[shard + 1]; ++k) {
+                const Transfer& transfer = batch[order[k]];
+                int64_t& to = balance(transfer.to);
+                if (to > std::numeric_limits<int64_t>::max() - transfer.amount) {
+                    report.status[order[k]] = TransferStatus::OVERFLOW;
+                    continue;
+                }
+                to += transfer.amount;
+                volume += transfer.amount;
+            }
+            shard_volume[shard] = volume;
+        });
+
+        // あふれて却下した送金の引き落としを戻す（まれなので逐次に処理する）
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (report.status[i] != TransferStatus::OVERFLOW) continue;
+            int64_t& from = balance(batch[i].from);
+            if (from > std::numeric_limits<int64_t>::max() - batch[i].amount) {
+                throw std::overflow_error("Money addition would cause overflow");
+            }
+            from += batch[i].amount;
+        }
+
+        for (int64_t volume : shard_volume) report.volume += volume;
+        for (TransferStatus status : report.status) {
+            if (status == TransferStatus::APPLIED) {
+                ++report.applied;
+            } else {
+                ++report.rejected;
+            }
+        }
+        return report;
+    }
+
+    // 残高の配列に対して適用する
+    LedgerReport apply(const std::vector<Transfer>& batch, std::vector<int64_t>& balances,
+                       ThreadPool* pool = nullptr) {
+        return apply(batch, balances.size(), [&balances](size_t i) -> int64_t& { return balances[i]; },
+                     pool);
+    }
+
+private:
+    size_t shards;
+
+    size_t shardCount(size_t accounts, ThreadPool* pool) const {
+        size_t count = shards;
+        if (count == 0) count = pool ? pool->size() * 4 : 1;
+        return std::max<size_t>(1, std::min(count, accounts));
+    }
+
+    // まだ却下されていない送金の添字を、シャードごとにバッチ順を保って並べる（計数ソート）
+    template <typename ShardOf>
+    static void bucket(const std::vector<Transfer>& batch, const std::vector<TransferStatus>& status,
+                       size_t shard_count, std::vector<size_t>& offsets, std::vector<size_t>& order,
+                       ShardOf shard_of) {
+        offsets.assign(shard_count + 1, 0);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (status[i] == TransferStatus::APPLIED) ++offsets[shard_of(batch[i]) + 1];
+        }
+        for (size_t s = 0; s < shard_count; ++s) offsets[s + 1] += offsets[s];
+        order.resize(offsets[shard_count]);
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (status[i] == TransferStatus::APPLIED) order[cursor[shard_of(batch[i])]++] = i;
+        }
+    }
+
+    template <typename Visit>
+    static void forEachShard(size_t shard_count, ThreadPool* pool, Visit visit) {
+        if (!pool || shard_count == 1) {
+            for (size_t shard = 0; shard < shard_count; ++shard) visit(shard);
+            return;
+        }
+        pool->parallelFor(0, shard_count, [&](size_t lo, size_t hi) {
+            for (size_t shard = lo; shard < hi; ++shard) visit(shard);
+        }, 1);
+    }
+};
+
+#endif // LEDGER_H
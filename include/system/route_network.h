@@ -0,0 +1,313 @@
+#pragma once
+#ifndef ROUTE_NETWORK_H
+#define ROUTE_NETWORK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "thread_pool.h"
+#include "trade_route.h"
+
+// 交易路の有向グラフ（拠点 = location_id）
+// 辺は CSR（offsets / targets / weights）で持ち、同じ拠点の組を結ぶ複数の交易路は開いているものの最短の所要日数を重みにする。
+// 出発地ごとの最短所要日数と経路は問い合わせのたびに必要な行だけ Dijkstra で求めて保持し、
+// warmAll で全拠点分（全点対）を並列にまとめて求めることもできる。
+// 交易路の追加・閉鎖・所要日数の変更では、保持している行を次のように差分で直す:
+//   短くなった（追加を含む）: その辺で改善する行だけ、到着側の拠点から改善を伝播させる
+//   長くなった（閉鎖を含む）: その辺が最短経路に使われうる行（d[u] + w == d[v]）だけ捨て、次の問い合わせで求め直す
+// 問い合わせも保持している行を更新するので、同時に呼べるのは warmAll 済みの cachedTravelTime だけ
+class RouteNetwork {
+public:
+    using RouteId = size_t;
+    static constexpr int64_t UNREACHABLE = std::numeric_limits<int64_t>::max();
+
+    RouteNetwork() = default;
+
+    // まとめて登録してから CSR を1回だけ組む（行はまだないので差分の更新もいらない）
+    explicit RouteNetwork(const std::vector<TradeRoute>& initial) {
+        routes.reserve(initial.size());
+        for (const auto& route : initial) insertRoute(route);
+        rebuildGraph();
+    }
+
+    size_t locationCount() const { return location_ids.size(); }
+    size_t routeCount() const { return routes.size(); }
+    size_t edgeCount() const { return targets.size(); }
+    bool hasLocation(int location_id) const { return node_of.count(location_id) != 0; }
+
+    // 交易路を追加して番号を返す（所要日数は0以上）
+    // 拠点の組が増えたときは CSR を組み直す（多数の交易路はコンストラクタでまとめて渡す）
+    RouteId addRoute(const TradeRoute& route) {
+        const auto [id, new_pair, before] = insertRoute(route);
+        if (new_pair) rebuildGraph();
+        const Route& added = routes[id];
+        applyWeight(added.from, added.to, pairs.at({added.from, added.to}), before);
+        return id;
+    }
+
+    // 交易路を閉じる（以後の経路に使わない）
+    void closeRoute(RouteId id) {
+        Route& route = routes.at(id);
+        if (!route.open) return;
+        Pair& pair = pairs.at({route.from, route.to});
+        const int64_t before = pairWeight(pair);
+        route.open = false;
+        applyWeight(route.from, route.to, pair, before);
+    }
+
+    void reopenRoute(RouteId id) {
+        Route& route = routes.at(id);
+        if (route.open) return;
+        Pair& pair = pairs.at({route.from, route.to});
+        const int64_t before = pairWeight(pair);
+        route.open = true;
+        applyWeight(route.from, route.to, pair, before);
+    }
+
+    void setTravelTime(RouteId id, int travel_time) {
+        if (travel_time < 0) {
+            throw std::invalid_argument("Travel time must be non-negative");
+        }
+        Route& route = routes.at(id);
+        Pair& pair = pairs.at({route.from, route.to});
+        const int64_t before = pairWeight(pair);
+        route.travel_time = travel_time;
+        applyWeight(route.from, route.to, pair, before);
+    }
+
+    // 最短所要日数（到達できなければ UNREACHABLE）
+    int64_t travelTime(int from_id, int to_id) {
+        const uint32_t from = nodeOf(from_id);
+        const uint32_t to = nodeOf(to_id);
+        return row(from).distance[to];
+    }
+
+    // 最短経路の拠点列（出発地と到着地を含む。到達できなければ空）
+    std::vector<int> path(int from_id, int to_id) {
+        const uint32_t from = nodeOf(from_id);
+        uint32_t node = nodeOf(to_id);
+        const Row& tree = row(from);
+        if (tree.distance[node] == UNREACHABLE) return {};
+        std::vector<int> result;
+        while (true) {
+            result.push_back(location_ids[node]);
+            if (node == from) break;
+            node = tree.parent[node];
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    // 全拠点を出発地とする行を求めておく（未計算の行だけを並列に）
+    void warmAll(ThreadPool* pool = nullptr) {
+        rows.resize(locationCount());
+        auto compute = [this](size_t lo, size_t hi) {
+            for (size_t source = lo; source < hi; ++source) {
+                if (!rows[source].valid) rows[source] = dijkstra({static_cast<uint32_t>(source)});
+            }
+        };
+        if (pool) {
+            pool->parallelFor(0, rows.size(), compute, 1);
+        } else {
+            compute(0, rows.size());
+        }
+    }
+
+    // 計算済みの行だけを読む（warmAll の後なら複数スレッドから呼べる）。未計算なら例外
+    int64_t cachedTravelTime(int from_id, int to_id) const {
+        const uint32_t from = nodeOf(from_id);
+        if (from >= rows.size() || !rows[from].valid) {
+            throw std::logic_error("Route row not cached for location " + std::to_string(from_id));
+        }
+        return rows[from].distance[nodeOf(to_id)];
+    }
+
+    // いずれかの出発地から各拠点までの最短所要日数（拠点の登録順）。キャッシュはしない
+    std::vector<int64_t> multiSourceTimes(const std::vector<int>& source_ids) const {
+        std::vector<uint32_t> sources;
+        sources.reserve(source_ids.size());
+        for (int id : source_ids) sources.push_back(nodeOf(id));
+        return dijkstra(sources).distance;
+    }
+
+    const std::vector<int>& locations() const { return location_ids; }
+
+    // 保持している行の数（テスト・計測用）
+    size_t cachedRows() const {
+        size_t count = 0;
+        for (const auto& tree : rows) count += tree.valid ? 1 : 0;
+        return count;
+    }
+
+private:
+    struct Route {
+        uint32_t from;
+        uint32_t to;
+        int travel_time;
+        bool open;
+    };
+
+    // 同じ拠点の組を結ぶ交易路と、CSR 上の辺の位置
+    struct Pair {
+        std::vector<RouteId> routes;
+        size_t edge = 0;
+    };
+
+    // 1つの出発地（または出発地の集合）からの最短路木
+    struct Row {
+        bool valid = false;
+        std::vector<int64_t> distance;
+        std::vector<uint32_t> parent;
+    };
+
+    std::map<int, uint32_t> node_of;
+    std::vector<int> location_ids;
+    std::vector<Route> routes;
+    std::map<std::pair<uint32_t, uint32_t>, Pair> pairs;
+
+    // CSR
+    std::vector<size_t> offsets{0};
+    std::vector<uint32_t> targets;
+    std::vector<int64_t> weights;  // 開いている交易路がなければ UNREACHABLE
+
+    std::vector<Row> rows;  // 出発地ごと（未計算は valid = false）
+
+    // 交易路を routes と pairs に登録する（CSR と行には触れない）
+    // 戻り値は番号、新しい拠点の組か、登録前の組の重み（新しい組なら UNREACHABLE）
+    std::tuple<RouteId, bool, int64_t> insertRoute(const TradeRoute& route) {
+        if (route.travel_time < 0) {
+            throw std::invalid_argument("Travel time must be non-negative");
+        }
+        const uint32_t from = intern(route.from_location_id);
+        const uint32_t to = intern(route.to_location_id);
+        const RouteId id = routes.size();
+        routes.push_back(Route{from, to, route.travel_time, true});
+
+        auto [it, inserted] = pairs.try_emplace({from, to});
+        const int64_t before = inserted ? UNREACHABLE : pairWeight(it->second);
+        it->second.routes.push_back(id);
+        return {id, inserted, before};
+    }
+
+    uint32_t intern(int location_id) {
+        auto [it, inserted] = node_of.try_emplace(location_id, static_cast<uint32_t>(location_ids.size()));
+        if (inserted) {
+            location_ids.push_back(location_id);
+            for (auto& tree : rows) {
+                if (!tree.valid) continue;
+                tree.distance.push_back(UNREACHABLE);
+                tree.parent.push_back(it->second);
+            }
+        }
+        return it->second;
+    }
+
+    uint32_t nodeOf(int location_id) const {
+        auto it = node_of.find(location_id);
+        if (it == node_of.end()) {
+            throw std::out_of_range("Unknown location " + std::to_string(location_id));
+        }
+        return it->second;
+    }
+
+    int64_t pairWeight(const Pair& pair) const {
+        int64_t weight = UNREACHABLE;
+        for (RouteId id : pair.routes) {
+            if (routes[id].open) weight = std::min<int64_t>(weight, routes[id].travel_time);
+        }
+        return weight;
+    }
+
+    // 拠点の組が増えたときだけ CSR を組み直す（重みの変更はその場で書き換える）。O(拠点数 + 組の数)
+    void rebuildGraph() {
+        const size_t nodes = locationCount();
+        offsets.assign(nodes + 1, 0);
+        for (const auto& entry : pairs) ++offsets[entry.first.first + 1];
+        for (size_t n = 0; n < nodes; ++n) offsets[n + 1] += offsets[n];
+        targets.resize(pairs.size());
+        weights.resize(pairs.size());
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (auto& [key, pair] : pairs) {
+            pair.edge = cursor[key.first]++;
+            targets[pair.edge] = key.second;
+            weights[pair.edge] = pairWeight(pair);
+        }
+    }
+
+    // 拠点の組の重みが before から変わったときに CSR と保持している行を直す
+    void applyWeight(uint32_t from, uint32_t to, const Pair& pair, int64_t before) {
+        const int64_t after = pairWeight(pair);
+        weights[pair.edge] = after;
+        if (after == before) return;
+        for (auto& tree : rows) {
+            if (!tree.valid || tree.distance[from] == UNREACHABLE) continue;
+            if (after < before) {
+                const int64_t candidate = tree.distance[from] + after;
+                if (candidate < tree.distance[to]) relaxFrom(tree, to, candidate, from);
+            } else if (before != UNREACHABLE && tree.distance[from] + before == tree.distance[to]) {
+                tree = Row{};
+            }
+        }
+    }
+
+    // node の距離が distance に縮んだことを、縮む拠点だけに伝播させる
+    void relaxFrom(Row& tree, uint32_t node, int64_t distance, uint32_t parent) const {
+        using Item = std::pair<int64_t, uint32_t>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+        tree.distance[node] = distance;
+        tree.parent[node] = parent;
+        queue.push({distance, node});
+        settle(tree, queue);
+    }
+
+    Row dijkstra(const std::vector<uint32_t>& sources) const {
+        using Item = std::pair<int64_t, uint32_t>;
+        Row tree;
+        tree.valid = true;
+        tree.distance.assign(locationCount(), UNREACHABLE);
+        tree.parent.resize(locationCount());
+        for (uint32_t n = 0; n < tree.parent.size(); ++n) tree.parent[n] = n;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+        for (uint32_t source : sources) {
+            tree.distance[source] = 0;
+            queue.push({0, source});
+        }
+        settle(tree, queue);
+        return tree;
+    }
+
+    template <typename Queue>
+    void settle(Row& tree, Queue& queue) const {
+        while (!queue.empty()) {
+            const auto [distance, node] = queue.top();
+            queue.pop();
+            if (distance != tree.distance[node]) continue;
+            for (size_t e = offsets[node]; e < offsets[node + 1]; ++e) {
+                if (weights[e] == UNREACHABLE) continue;
+                const int64_t candidate = distance + weights[e];
+                const uint32_t next = targets[e];
+                if (candidate < tree.distance[next]) {
+                    tree.distance[next] = candidate;
+                    tree.parent[next] = node;
+                    queue.push({candidate, next});
+                }
+            }
+        }
+    }
+
+    const Row& row(uint32_t source) {
+        if (rows.size() < locationCount()) rows.resize(locationCount());
+        if (!rows[source].valid) rows[source] = dijkstra({source});
+        return rows[source];
+    }
+};
+
+#endif // ROUTE_NETWORK_H
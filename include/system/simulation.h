@@ -0,0 +1,680 @@
+#pragma once
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bitmap_index.h"
+#include "calendar.h"
+#include "cohort.h"
+#include "event_scheduler.h"
+#include "household_demand.h"
+#include "ledger.h"
+#include "slot_map.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include "trade_route.h"
+#include "../agent/government.h"
+#include "../agent/loan_provider.h"
+#include "../agent/person.h"
+#include "../market/business.h"
+#include "../market/business_dynamics.h"
+#include "../market/goods_catalog.h"
+#include "../market/labor_market.h"
+#include "../market/market.h"
+#include "../market/production.h"
+#include "../market/seasonal_production.h"
+#include "../market/sector_index.h"
+
+// 世界の生成パラメータ
+struct WorldConfig {
+    size_t people = 1000;
+    size_t businesses = 100;
+    uint64_t seed = 1;
+};
+
+// 1ティック分の集計
+struct TickStats {
+    int64_t trades = 0;       // 市場での購入件数
+    int64_t produced = 0;     // 生産量
+    int64_t taxes = 0;        // 徴税件数
+    int64_t loans = 0;        // 融資件数
+    int64_t events = 0;       // 処理した予定の数
+    int64_t repaid = 0;       // 満期に返済された融資
+    int64_t defaulted = 0;    // 満期に返済されなかった融資
+    int64_t subsidies = 0;    // 補助金の支給件数
+    int64_t calendar_events = 0;  // 期日を迎えた暦の予定の数
+    int64_t hires = 0;        // 労働市場で成立した雇用
+    int64_t payroll = 0;      // 企業が支払った給与の合計
+    int64_t relief = 0;       // 生活支援を受けた住民の数
+    int64_t revenue = 0;      // 企業に入った売上の合計
+    int64_t departed = 0;     // people から取り除いた（despawn 済みの）住民
+};
+
+// 出力を伴わないシミュレーション世界
+// main.cpp の simulateDay と同じ順序（生産・貿易・出品・課税・収入と融資・消費・政策）で1日を進め、
+// 消費の後に企業の価格と市場シェアを更新する。その日の予定と暦の予定（季節の始まりなど）は生産の前に処理する
+// 労働市場モードでは生産の前に雇用、企業の更新の後に給与の支払いを挟む
+class World {
+public:
+    std::vector<Person> people;
+    std::vector<Business> businesses;
+    Market market;
+    Government government;
+    LoanProvider loan_provider;
+    std::vector<TradeRoute> trade_routes;
+    ProductionGraph production;
+    SectorIndex sectors;
+    // 住民の属性（健康状態・犯罪傾向・職業・収入帯）の索引。政策の給付対象をこれで引く
+    // 住民の属性は changePerson で変える（people を直接書き換えたら population.update か sync で反映する）
+    PopulationIndex population;
+    BusinessDynamics business_dynamics;
+    PricingConfig pricing;
+    int64_t day = 0;
+    std::string staple_food = "小麦";
+
+    // 詳細度（LOD）モード。有効な間、休眠中の住民の people 上の値は syncPeople まで更新されない
+    bool level_of_detail = false;
+    CohortSimulator cohorts;
+
+    // 家計の買い物かごモード。有効なら消費フェーズは住民ごとの主食の購入ではなく、
+    // HouseholdDemand で basket の品目の総需要をまとめて約定する
+    bool household_basket = false;
+    HouseholdBasket basket = HouseholdBasket::standard();
+
+    // 融資の満期などエージェント単位の予定。毎日全件を見る代わりに期日を迎えた分だけ処理する
+    EventScheduler events;
+
+    // 住民の世代つきハンドル。dense の位置が people の添字と一致し、値は住民の ID
+    // 住民の出入りは spawnPerson / despawnPerson で行う。despawn した住民はその場で各フェーズの対象から外れ、
+    // compactPeople（ティックの始めと政策の前）で people・集団・属性索引・雇用とまとめて詰め直す
+    // borrowers は融資番号（Loan::loan_id）から借り手のハンドルを引く表で、満期の清算は ID を探さずにこれで引く。
+    // 融資を清算したら融資と一緒に取り除く
+    // どちらも保存しない派生状態で、people や融資を外から入れ替えたら rebuildDerivedState で作り直す
+    SlotMap<int64_t> residents;
+    std::unordered_map<int64_t, SlotHandle> borrowers;
+
+    // 暦の上の予定（季節の始まり・納税日）。day が暦の通し日数
+    Calendar calendar;
+
+    // 住民の税を集める間隔（日）。1なら毎日、2以上なら暦の納税日（通し日数が tax_period の倍数の前日）にだけ集める
+    // setTaxPeriod で変える
+    int32_t tax_period = 1;
+
+    // 季節による生産量の変動。有効なら季節の始まりごとに業種別の倍率を production の産出倍率に設定し直す
+    bool seasons = false;
+    SeasonalProduction seasonal_production = SeasonalProduction::standard();
+
+    // 労働市場モード。有効なら生産の前に無職の住民（職業 = 企業の業種）を求人に結び付け、
+    // 企業フェーズの後に企業から給与を払う。Business::workers は実際に雇っている住民の数になる
+    // 求人の賃金は pricing.wage。住民の留保賃金は日々の支出なので、それを下回る賃金では雇用は成立しない
+    bool labor_market = false;
+    LaborMarket labor;
+    static constexpr int64_t PAYROLL_RESERVE_DAYS = 10;  // 企業はこの日数分の給与を払える人数まで求人を出す
+
+    // 標準のサプライチェーン（小麦 → パン、鉱石 → 鉄 → 道具）
+    static const std::vector<std::pair<std::string, std::string>>& standardProducts() {
+        static const std::vector<std::pair<std::string, std::string>> products = [] {
+            std::vector<std::pair<std::string, std::string>> built;
+            for (const auto& good : GoodsCatalog::BUILTIN) {
+                built.emplace_back(std::string(good.name), std::string(good.sector));
+            }
+            return built;
+        }();
+        return products;
+    }
+
+    void installStandardRecipes() {
+        production.addRecipe(Recipe("小麦", {}, 2));
+        production.addRecipe(Recipe("パン", {{"小麦", 1}}, 1));
+        production.addRecipe(Recipe("鉱石", {}, 2));
+        production.addRecipe(Recipe("鉄", {{"鉱石", 2}}, 1));
+        production.addRecipe(Recipe("道具", {{"鉄", 1}}, 1));
+    }
+
+    // 乱数で人口と企業を生成する（同じ seed なら同じ世界）
+    static World generate(const WorldConfig& config) {
+        World world;
+        std::mt19937_64 rng(config.seed);
+        auto uniform = [&rng](int64_t lo, int64_t hi) {
+            return std::uniform_int_distribution<int64_t>(lo, hi)(rng);
+        };
+        static const char* jobs[] = {"農業", "製造業", "鉱業", "商売"};
+
+        world.people.resize(config.people);
+        for (size_t i = 0; i < config.people; ++i) {
+            Person& person = world.people[i];
+            person.id = static_cast<int64_t>(i + 1);
+            person.name = "住民" + std::to_string(i + 1);
+            person.job = jobs[uniform(0, 3)];
+            person.money = uniform(20, 500);
+            person.setDailyIncome(static_cast<int32_t>(uniform(30, 100)));
+            person.setDailyExpense(static_cast<int32_t>(uniform(20, 60)));
+            person.setRiskTolerance(static_cast<int32_t>(uniform(0, 100)));
+        }
+
+        const auto& products = standardProducts();
+        world.businesses.resize(config.businesses);
+        for (size_t b = 0; b < config.businesses; ++b) {
+            Business& business = world.businesses[b];
+            const auto& product = products[b % products.size()];
+            business.id = static_cast<int64_t>(config.people + b + 1);
+            business.product = product.first;
+            business.sector = product.second;
+            business.workers = static_cast<int32_t>(uniform(1, 10));
+            business.price = 5 + static_cast<int64_t>(b % products.size()) * 5;
+            business.money = uniform(1000, 5000);
+        }
+
+        world.government.id = static_cast<int64_t>(config.people + config.businesses + 1);
+        world.government.money = 1000;
+        for (const auto& product : products) {
+            world.government.setSubsidy(product.second, 50.0f);
+        }
+        world.loan_provider.id = world.government.id + 1;
+        world.loan_provider.money = 100 * static_cast<int64_t>(config.people);
+
+        TradeRoute route;
+        route.from_location_id = 1;
+        route.to_location_id = 2;
+        route.goods["小麦"] = 10;
+        route.travel_time = 3;
+        world.trade_routes.push_back(route);
+
+        world.installStandardRecipes();
+        world.sectors.rebuild(world.businesses);
+        world.population.rebuild(world.people);
+        world.rebuildHandles();
+        return world;
+    }
+
+    // 同じ日課の住民を集団にまとめる。集団に入った住民の数を返す
+    // 給与は住民ごとの賃金で払うので、雇われている住民は通常のエージェントに戻しておく
+    // （以後の雇用は通常のエージェントからしか結ばれないので、従業員が休眠することはない）
+    size_t enableLevelOfDetail() {
+        level_of_detail = true;
+        cohorts.build(people);
+        for (size_t b = 0; b < businesses.size(); ++b) {
+            for (size_t person : labor.employeesOf(b)) cohorts.promote(person, people);
+        }
+        return cohorts.dormantCount();
+    }
+
+    // 季節による生産量の変動を有効にする。今日の季節の倍率をすぐに設定し、以後は季節の始まりごとに設定し直す
+    void enableSeasons() {
+        if (seasons) return;
+        seasons = true;
+        seasonal_production.apply(production, businesses, sectors, Calendar::seasonOf(day));
+        calendar.everySeason(day + 1, CalendarEvent{CalendarEventKind::SEASON_START});
+    }
+
+    // 生活支援のルールを適用し、給付した人数を返す
+    // 候補（病気で、職業の指定があればその職業の住民）は属性索引の集合の積で引き、所持金は Government が住民ごとに見る
+    size_t applyRelief(const PolicyRule& rule) {
+        if (rule.type != PolicyType::RELIEF) return 0;
+        RoaringBitmap targets = population.health(HealthStatus::SICK);
+        if (!rule.sector.empty()) targets &= population.job(rule.sector);
+        return government.grantRelief(rule, people, PopulationIndex::select(targets));
+    }
+
+    // 納税日の間隔を変える。2以上なら今日以降の納税日を暦に置き、課税フェーズは納税日にだけ動く
+    void setTaxPeriod(int32_t period) {
+        if (period < 1) {
+            throw std::invalid_argument("Tax period must be positive");
+        }
+        if (tax_series_active) calendar.stop(tax_series);
+        tax_series_active = false;
+        tax_period = period;
+        scheduleTaxDays();
+    }
+
+    // 労働市場を有効にする。生成時の従業員数は住民と結び付いていないので、全企業を0人から始める
+    // 求人の賃金（pricing.wage）が住民の留保賃金の中央値に届かなければ中央値まで引き上げる。
+    // 既定の賃金は生成される誰の日々の支出にも届かず、そのままでは誰も雇われないため
+    void enableLaborMarket() {
+        if (labor_market) return;
+        labor_market = true;
+        pricing.wage = std::max(pricing.wage, medianReservationWage());
+        for (auto& business : businesses) business.workers = 0;
+    }
+
+    // 住民の留保賃金（日々の支出）の中央値。住民がいなければ0
+    int64_t medianReservationWage() const {
+        if (people.empty()) return 0;
+        std::vector<int32_t> wages;
+        wages.reserve(people.size());
+        for (const auto& person : people) wages.push_back(person.daily_expense);
+        const auto middle = wages.begin() + static_cast<std::ptrdiff_t>(wages.size() / 2);
+        std::nth_element(wages.begin(), middle, wages.end());
+        return *middle;
+    }
+
+    // 休眠中の住民を集団から外して全員を通常のエージェントに戻す
+    void disableLevelOfDetail() {
+        if (!level_of_detail) return;
+        for (size_t id = 0; id < cohorts.getCohorts().size(); ++id) cohorts.promoteCohort(id, people);
+        level_of_detail = false;
+    }
+
+    // 個別のイベント（直接取引・犯罪など）で住民に触れる前に呼ぶ。休眠中なら通常のエージェントに戻す
+    Person& touch(size_t person) {
+        if (level_of_detail) cohorts.promote(person, people);
+        return people.at(person);
+    }
+
+    // 住民の属性（健康状態・犯罪傾向・職業・日収）を変える。休眠中なら通常のエージェントに戻してから edit を呼び、
+    // 変わった属性を属性索引に反映する。亡くなった（DEAD になった）住民は despawn する
+    template <typename Edit>
+    Person& changePerson(size_t person, Edit&& edit) {
+        Person& target = touch(person);
+        edit(target);
+        population.update(person, target);
+        if (target.health_status == HealthStatus::DEAD) despawnPerson(residents.handleAt(person));
+        return target;
+    }
+
+    // 住民を people の末尾に加え、属性索引と（LOD モードなら）通常のエージェントの一覧に登録する
+    // people を添字で走査している最中には呼ばない（ティックの間か、住民を走査しないフェーズで呼ぶ）
+    SlotHandle spawnPerson(Person person) {
+        people.push_back(std::move(person));
+        const size_t index = people.size() - 1;
+        population.update(index, people.back());
+        if (level_of_detail) cohorts.admit(index);
+        return residents.spawn(people.back().id);
+    }
+
+    // 住民を取り除く。休眠中なら集団から外し、雇用も解消する。ハンドルはすぐに無効になり、
+    // 以後の収入・課税・消費・融資・雇用の対象から外れる。people から実際に消えるのは compactPeople の後
+    // 古いハンドルなら何もせず false
+    bool despawnPerson(SlotHandle handle) {
+        if (!residents.contains(handle)) return false;
+        const size_t person = residents.positionOf(handle);
+        touch(person);
+        labor.release(person, businesses);
+        return residents.despawn(handle);
+    }
+
+    // despawn した住民を people から取り除き、生き残りを元の順序のまま詰める。
+    // 集団の構成員・雇用の列・属性索引を新しい添字に合わせ、ハンドルは residents の compact で引き続き有効になる
+    // 取り除いた数を返す（いなければ何もしない）
+    size_t compactPeople() {
+        if (residents.denseSize() == residents.size()) return 0;
+        static constexpr size_t REMOVED = std::numeric_limits<size_t>::max();
+        std::vector<size_t> moved_to(people.size(), REMOVED);
+        size_t write = 0;
+        for (size_t read = 0; read < people.size(); ++read) {
+            if (!residents.isAlive(read)) continue;
+            if (write != read) people[write] = std::move(people[read]);
+            moved_to[read] = write++;
+        }
+        const size_t removed = people.size() - write;
+        people.erase(people.begin() + static_cast<std::ptrdiff_t>(write), people.end());
+        residents.compact();
+
+        cohorts.remap(moved_to, people.size());
+        std::vector<int64_t> employers(people.size(), LaborMarket::NO_EMPLOYER);
+        std::vector<int64_t> wages(people.size(), 0);
+        for (size_t old = 0; old < labor.employers().size(); ++old) {
+            if (moved_to[old] == REMOVED) continue;
+            employers[moved_to[old]] = labor.employers()[old];
+            wages[moved_to[old]] = labor.wages()[old];
+        }
+        labor.restore(std::move(employers), std::move(wages));
+        labor.reindex(businesses.size());
+        population.rebuild(people);
+        return removed;
+    }
+
+    // 休眠中の住民の推定値を people に書き出す（ハッシュ・チェックポイント・集計の前に呼ぶ）
+    void syncPeople() {
+        if (level_of_detail) cohorts.materialize(people);
+    }
+
+    // 保存しない派生状態（レシピ表・業種索引・住民索引・ハンドル・予定）を作り直す。保存形式から復元した後に呼ぶ
+    void rebuildDerivedState() {
+        production = ProductionGraph();
+        installStandardRecipes();
+        sectors.rebuild(businesses);
+        population.rebuild(people);
+        loan_provider.reindexLoans();
+        rebuildHandles();
+        business_dynamics.rebuild(businesses);
+        cohorts.reindex(people.size());
+        labor.reindex(businesses.size());
+        rescheduleEvents();
+        calendar = Calendar();
+        tax_series_active = false;
+        if (seasons) {
+            seasonal_production.apply(production, businesses, sectors, Calendar::seasonOf(day));
+            calendar.everySeason(day + 1, CalendarEvent{CalendarEventKind::SEASON_START});
+        }
+        scheduleTaxDays();
+    }
+
+    // 未清算の融資の満期を予定し直す
+    void rescheduleEvents() {
+        events = EventScheduler();
+        for (const Loan& loan : loan_provider.active_loans) {
+            if (!loan.defaulted && loan.days_remaining > 0) {
+                events.schedule(loan.due_day,
+                                AgentEvent{EventKind::LOAN_MATURITY, static_cast<uint64_t>(loan.loan_id)});
+            }
+        }
+    }
+
+    // 住民のハンドルを people の順に振り直し、融資の借り手を ID からハンドルに引き直す
+    // 借り手がもう people にいない融資は空のハンドルになり、満期に不履行として扱われる
+    void rebuildHandles() {
+        residents = SlotMap<int64_t>();
+        std::unordered_map<int64_t, SlotHandle> by_id;
+        by_id.reserve(people.size());
+        for (const auto& person : people) by_id.emplace(person.id, residents.spawn(person.id));
+        borrowers.clear();
+        borrowers.reserve(loan_provider.active_loans.size());
+        for (const auto& loan : loan_provider.active_loans) {
+            const auto found = by_id.find(loan.borrower_id);
+            borrowers.emplace(loan.loan_id, found == by_id.end() ? SlotHandle{} : found->second);
+        }
+    }
+
+    // 課税フェーズで所持金 money の住民に課す税額（免税額以下なら0）。ColumnarPopulation も同じ規則で列を進める
+    static int64_t personTax(const Government& government, int64_t money) {
+        if (money <= Government::PERSON_TAX_EXEMPTION) return 0;
+        return government.assessTax(money, Government::PERSON_TAX_EXEMPTION);
+    }
+
+    // Ledger 用の口座番号: 住民・企業・政府・融資機関の順の通し番号
+    size_t accountCount() const { return people.size() + businesses.size() + 2; }
+    size_t businessAccount(size_t b) const { return people.size() + b; }
+    size_t governmentAccount() const { return people.size() + businesses.size(); }
+    size_t lenderAccount() const { return governmentAccount() + 1; }
+
+    int64_t& balance(size_t account) {
+        if (account < people.size()) return people[account].money;
+        if (account < governmentAccount()) return businesses[account - people.size()].money;
+        if (account == governmentAccount()) return government.money;
+        if (account == lenderAccount()) return loan_provider.money;
+        throw std::out_of_range("Unknown account " + std::to_string(account));
+    }
+
+    // 1日分進める
+    TickStats step(ThreadPool* pool = nullptr) {
+        TickStats stats;
+        stats.departed += static_cast<int64_t>(compactPeople());
+        bool tax_day = tax_period <= 1;  // 間隔が2日以上なら暦の納税日にだけ課税する
+        {
+            TRACE_ZONE(event_zone, "予定");
+            for (const AgentEvent& event : events.advanceTo(day)) {
+                ++stats.events;
+                if (event.kind == EventKind::LOAN_MATURITY) {
+                    // 返済でも不履行でも、清算した融資は借り手のハンドルと一緒に取り除く
+                    const int64_t loan_id = static_cast<int64_t>(event.target);
+                    Loan* loan = loan_provider.findLoan(loan_id);
+                    if (!loan) continue;
+                    const auto found = borrowers.find(loan_id);
+                    const SlotHandle borrower = found != borrowers.end() ? found->second : SlotHandle{};
+                    if (!residents.contains(borrower)) {
+                        // 借り手がいなくなった融資は回収できない
+                        loan->days_remaining = 0;
+                        loan->defaulted = true;
+                        ++stats.defaulted;
+                    } else if (loan_provider.settleLoan(*loan, touch(residents.positionOf(borrower)))) {
+                        ++stats.repaid;
+                    } else {
+                        ++stats.defaulted;
+                    }
+                    loan_provider.closeLoan(loan_id);
+                    if (found != borrowers.end()) borrowers.erase(found);
+                }
+            }
+            TRACE_COUNT(event_zone, stats.events);
+        }
+        {
+            TRACE_ZONE(calendar_zone, "暦");
+            for (const CalendarEvent& event : calendar.advanceTo(day)) {
+                ++stats.calendar_events;
+                if (event.kind == CalendarEventKind::TAX_DAY) tax_day = true;
+                if (event.kind == CalendarEventKind::SEASON_START && seasons) {
+                    seasonal_production.apply(production, businesses, sectors, Calendar::seasonOf(event.day));
+                }
+            }
+            TRACE_COUNT(calendar_zone, stats.calendar_events);
+        }
+        if (labor_market) {
+            // 給与を払える人数まで求人を出し、無職の住民（LOD モードでは通常のエージェントだけ）を結び付ける
+            TRACE_ZONE(hiring_zone, "雇用");
+            TRACE_COUNT(hiring_zone, businesses.size());
+            if (pricing.wage > 0) {
+                for (size_t b = 0; b < businesses.size(); ++b) {
+                    const Business& business = businesses[b];
+                    if (business.sector.empty()) continue;
+                    const int64_t affordable = std::max<int64_t>(business.money, 0) / (pricing.wage * PAYROLL_RESERVE_DAYS);
+                    const int64_t vacancies = affordable - static_cast<int64_t>(labor.employeesOf(b).size());
+                    if (vacancies <= 0) continue;
+                    labor.postOpening(b, business.sector, pricing.wage,
+                                      static_cast<int32_t>(std::min<int64_t>(vacancies, std::numeric_limits<int32_t>::max())));
+                }
+            }
+            std::vector<size_t> scratch;
+            labor.collectSeekers(people, activeIndices(scratch));
+            stats.hires = static_cast<int64_t>(labor.match(businesses));
+        }
+        {
+            TRACE_ZONE(production_zone, "生産");
+            TRACE_COUNT(production_zone, businesses.size());
+            stats.produced = production.runTick(businesses, pool).total_output;
+        }
+        {
+            // 貿易ルートはまだ商品を動かさない（simulateDay と同じく記録のみ）
+            TRACE_ZONE(trade_zone, "貿易ルート");
+            TRACE_COUNT(trade_zone, trade_routes.size());
+        }
+        // 出品した数量と出品直後の市場在庫（企業フェーズで各社の販売数量を見積もる）
+        business_dynamics.prepare(businesses);
+        std::vector<int64_t> listed(businesses.size(), 0);
+        std::vector<int64_t> shelf(business_dynamics.products().size(), 0);
+        {
+            TRACE_ZONE(listing_zone, "出品");
+            TRACE_COUNT(listing_zone, businesses.size());
+            for (size_t b = 0; b < businesses.size(); ++b) {
+                Business& business = businesses[b];
+                listed[b] = business.stock;
+                market.sell(business.product, business.stock, static_cast<int>(business.price));
+                business.stock = 0;
+            }
+            for (size_t p = 0; p < shelf.size(); ++p) shelf[p] = market.getStock(business_dynamics.products()[p]);
+        }
+        if (tax_day) {
+            TRACE_ZONE(tax_zone, "課税");
+            TRACE_COUNT(tax_zone, people.size());
+            // Government::collectTax(Person*) と同じ規則の税を、住民から政府への送金として一括で動かす
+            // 件数は実際に徴収できた送金の数（残高不足・入金のあふれで却下された分は数えない）
+            std::vector<Transfer> transfers;
+            forEachActive([&](Person& person) {
+                const int64_t tax = personTax(government, person.money);
+                if (tax > 0) {
+                    transfers.push_back({static_cast<size_t>(&person - people.data()), governmentAccount(), tax});
+                }
+            });
+            const LedgerReport report = Ledger().apply(transfers, accountCount(), [this](size_t account) -> int64_t& {
+                return balance(account);
+            }, pool);
+            const int64_t taxed = static_cast<int64_t>(report.applied);
+            government.approval_rating -= static_cast<float>(taxed);
+            stats.taxes += taxed;
+            if (level_of_detail) stats.taxes += cohorts.collectTax(government, people);
+        }
+        std::vector<size_t> loan_applicants;
+        if (level_of_detail) {
+            // 貧しくなった集団は融資の個別審査のために解散させる
+            cohorts.payIncome();
+            for (size_t i : cohorts.activePeople()) {
+                if (isPresent(i)) people[i].money += people[i].daily_income;
+            }
+            cohorts.promoteNeedy(people, 50);
+            for (size_t i : cohorts.activePeople()) {
+                if (isPresent(i) && people[i].money < 50) loan_applicants.push_back(i);
+            }
+        } else {
+            for (size_t i = 0; i < people.size(); ++i) {
+                if (!isPresent(i)) continue;
+                people[i].money += people[i].daily_income;
+                if (people[i].money < 50) loan_applicants.push_back(i);
+            }
+        }
+        {
+            TRACE_ZONE(loan_zone, "融資");
+            TRACE_COUNT(loan_zone, loan_applicants.size());
+            const OriginationReport report = loan_provider.originateLoans(people, loan_applicants, 100);
+            stats.loans = static_cast<int64_t>(report.approved);
+            for (size_t k = 0; k < report.approved_loans.size(); ++k) {
+                const int64_t loan_id = report.approved_loans[k];
+                Loan& loan = *loan_provider.findLoan(loan_id);
+                loan.due_day = day + loan.days_remaining;
+                borrowers.emplace(loan_id, residents.handleAt(report.approved_indices[k]));
+                events.schedule(loan.due_day, AgentEvent{EventKind::LOAN_MATURITY, static_cast<uint64_t>(loan_id)});
+            }
+        }
+        {
+            TRACE_ZONE(consumption_zone, "消費");
+            TRACE_COUNT(consumption_zone, people.size());
+            // 主食が組み込み商品なら GoodId で引き、住民ごとの文字列の比較を避ける
+            auto consume = [&](const auto& food) {
+                forEachActive([&](Person& person) {
+                    bool fed = false;
+                    if (market.getStock(food) > 0 && person.money >= market.getPrice(food)) {
+                        person.money -= market.buy(food, 1);
+                        fed = true;
+                        ++stats.trades;
+                    }
+                    person.setSatisfaction(fed ? std::min(100, person.satisfaction + 10)
+                                               : std::max(0, person.satisfaction - 5));
+                });
+            };
+            const GoodId staple = GoodsCatalog::find(staple_food);
+            if (household_basket) {
+                std::vector<size_t> scratch;
+                const HouseholdDemandReport report =
+                    HouseholdDemand::run(basket, people, market, activeIndices(scratch));
+                for (int filled : report.filled) stats.trades += filled;
+            } else if (staple != GoodsCatalog::NONE) {
+                consume(staple);
+            } else {
+                consume(staple_food);
+            }
+            if (level_of_detail) stats.trades += cohorts.consume(market, staple_food, people);
+        }
+        {
+            // 製品ごとに売れた数量をその日の出品へ安い順に割り当て、約定価格での売上を区分ごとの価格と
+            // 市場シェアの更新に使う。売上は買い手が市場に払った代金を集めた清算口座から各社へ Ledger で送金する
+            // （売れ残りの在庫から出た分の代金はどの企業にも入らない）
+            TRACE_ZONE(business_zone, "企業");
+            TRACE_COUNT(business_zone, businesses.size());
+            const auto& products = business_dynamics.products();
+            std::vector<int64_t> sold(shelf.size(), 0);
+            std::vector<int64_t> clearing_prices(shelf.size(), 0);
+            for (size_t p = 0; p < shelf.size(); ++p) {
+                sold[p] = std::max<int64_t>(0, shelf[p] - market.getStock(products[p]));
+                clearing_prices[p] = market.getPrice(products[p]);
+            }
+            const std::vector<int64_t> units_sold = business_dynamics.allocateSales(businesses, listed, sold);
+            const BusinessTickReport report = business_dynamics.update(
+                businesses, units_sold, production.lastPlannedOutput(), pricing, pool, clearing_prices);
+
+            std::vector<Transfer> transfers;
+            const size_t clearing_account = accountCount();
+            for (size_t b = 0; b < businesses.size(); ++b) {
+                const int64_t revenue = business_dynamics.revenue()[b];
+                if (revenue > 0) transfers.push_back({clearing_account, businessAccount(b), revenue});
+            }
+            int64_t clearing = report.revenue;
+            stats.revenue = Ledger().apply(transfers, accountCount() + 1,
+                                           [this, &clearing, clearing_account](size_t account) -> int64_t& {
+                                               return account == clearing_account ? clearing : balance(account);
+                                           }, pool).volume;
+        }
+        if (labor_market) {
+            // 従業員は通常のエージェントなので（enableLevelOfDetail を参照）、ここで集団から戻す住民はいない
+            TRACE_ZONE(payroll_zone, "給与");
+            TRACE_COUNT(payroll_zone, businesses.size());
+            stats.payroll = labor.runPayroll(people, businesses, pool);
+        }
+        // ティック中に despawn した住民を政策（生活支援は属性索引で対象を引く）の前に取り除く
+        stats.departed += static_cast<int64_t>(compactPeople());
+        {
+            TRACE_ZONE(policy_zone, "政策");
+            TRACE_COUNT(policy_zone, businesses.size());
+            // ルールは補助金・生活支援の設定が変わったときだけコンパイルし直される
+            if (government.money > 500) {
+                for (const PolicyRule& rule : government.subsidyRules()) {
+                    stats.subsidies += static_cast<int64_t>(
+                        government.applyPolicy(rule, businesses, sectors));
+                }
+            }
+            // 病気の住民は集団に入らない（常に通常のエージェント）ので、LOD モードでも people の所持金で選べる
+            if (government.reliefAmount() > 0) {
+                stats.relief = static_cast<int64_t>(applyRelief(government.reliefRule()));
+            }
+        }
+        market.clearDaily();
+        ++day;
+        return stats;
+    }
+
+private:
+    Calendar::SeriesId tax_series = 0;
+    bool tax_series_active = false;
+
+    // tax_period が2以上なら、今日以降の最初の納税日から tax_period 日ごとの納税日を暦に置く
+    // 納税日は通し日数だけで決まるので、復元して置き直しても同じ日になる
+    void scheduleTaxDays() {
+        if (tax_period <= 1) return;
+        const int64_t first = day + (tax_period - 1 - day % tax_period);
+        tax_series = calendar.every(first, tax_period, CalendarEvent{CalendarEventKind::TAX_DAY});
+        tax_series_active = true;
+    }
+
+    // despawn されていない住民か（compact 前の despawn 済みの住民だけ false）
+    bool isPresent(size_t person) const {
+        return residents.denseSize() == residents.size() || residents.isAlive(person);
+    }
+
+    // 各フェーズで処理する住民の添字。LOD モードでは通常のエージェントだけで、despawn 済みの住民は除く
+    // 全住民を添字順にそのまま処理してよければ nullptr
+    const std::vector<size_t>* activeIndices(std::vector<size_t>& scratch) const {
+        if (residents.denseSize() == residents.size()) {
+            return level_of_detail ? &cohorts.activePeople() : nullptr;
+        }
+        scratch.clear();
+        if (level_of_detail) {
+            for (size_t i : cohorts.activePeople()) {
+                if (residents.isAlive(i)) scratch.push_back(i);
+            }
+        } else {
+            for (size_t i = 0; i < people.size(); ++i) {
+                if (residents.isAlive(i)) scratch.push_back(i);
+            }
+        }
+        return &scratch;
+    }
+
+    // LOD モードでは通常のエージェントだけ、そうでなければ全住民を添字順に処理する（despawn 済みは除く）
+    template <typename Visit>
+    void forEachActive(Visit visit) {
+        std::vector<size_t> scratch;
+        const std::vector<size_t>* indices = activeIndices(scratch);
+        if (!indices) {
+            for (auto& person : people) visit(person);
+            return;
+        }
+        for (size_t i : *indices) visit(people[i]);
+    }
+};
+
+#endif // SIMULATION_H
@@ -0,0 +1,144 @@
+#pragma once
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// 世代つきハンドル。スロットが再利用されると generation が変わるので、古いハンドルは無効と判定できる
+struct SlotHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isNull() const { return index == UINT32_MAX; }
+    bool operator==(const SlotHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+// スロットマップ形式のエージェント置き場
+// 値は dense 配列に詰めて持ち、ハンドルはスロット経由で dense の位置を引く。
+// spawn は dense の末尾に追加、despawn は印を付けてハンドルを即座に無効にするだけで、どちらも O(1)。
+// 実際に dense から取り除くのは compact（ティックの終わりに1回）で、生き残りの順序を保ったまま詰め直す。
+// ティックの途中に despawn しても dense の添字はずれないので、走査中に生死が変わっても安全
+template <typename T>
+class SlotMap {
+public:
+    // 生存中の数（despawn 済みで compact 前のものは含まない）
+    size_t size() const { return live; }
+    bool empty() const { return live == 0; }
+
+    // dense 配列の長さ（compact 前は despawn 済みを含む）
+    size_t denseSize() const { return values.size(); }
+
+    SlotHandle spawn(T value) {
+        uint32_t index;
+        if (!free_slots.empty()) {
+            index = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            if (slots.size() >= UINT32_MAX) {
+                throw std::length_error("SlotMap is full");
+            }
+            index = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot{});
+        }
+        slots[index].dense = static_cast<uint32_t>(values.size());
+        values.push_back(std::move(value));
+        owners.push_back(index);
+        alive.push_back(1);
+        ++live;
+        return SlotHandle{index, slots[index].generation};
+    }
+
+    // ハンドルを無効にし、compact で取り除く印を付ける。古いハンドルなら false
+    bool despawn(SlotHandle handle) {
+        if (!contains(handle)) return false;
+        Slot& slot = slots[handle.index];
+        alive[slot.dense] = 0;
+        ++slot.generation;
+        --live;
+        ++dead;
+        return true;
+    }
+
+    bool contains(SlotHandle handle) const {
+        return handle.index < slots.size() && slots[handle.index].generation == handle.generation &&
+               alive[slots[handle.index].dense];
+    }
+
+    // 生存中なら値へのポインタ、古いハンドルなら nullptr
+    T* get(SlotHandle handle) { return contains(handle) ? &values[slots[handle.index].dense] : nullptr; }
+    const T* get(SlotHandle handle) const {
+        return contains(handle) ? &values[slots[handle.index].dense] : nullptr;
+    }
+
+    T& at(SlotHandle handle) {
+        T* value = get(handle);
+        if (!value) throw std::out_of_range("Stale or unknown slot handle");
+        return *value;
+    }
+
+    // dense 配列の直接参照（添字順の走査用）
+    std::vector<T>& dense() { return values; }
+    const std::vector<T>& dense() const { return values; }
+    bool isAlive(size_t position) const { return alive[position] != 0; }
+
+    // 生存中のハンドルが指す dense の位置。古いハンドルなら out_of_range
+    size_t positionOf(SlotHandle handle) const {
+        if (!contains(handle)) throw std::out_of_range("Stale or unknown slot handle");
+        return slots[handle.index].dense;
+    }
+
+    SlotHandle handleAt(size_t position) const {
+        if (!alive.at(position)) return SlotHandle{};
+        const uint32_t index = owners[position];
+        return SlotHandle{index, slots[index].generation};
+    }
+
+    // despawn 済みの値を dense から取り除き、生き残りを元の順序のまま前に詰める
+    // 空いたスロットはここで初めて再利用できるようになる。取り除いた数を返す
+    size_t compact() {
+        if (dead == 0) return 0;
+        size_t write = 0;
+        for (size_t read = 0; read < values.size(); ++read) {
+            if (!alive[read]) {
+                free_slots.push_back(owners[read]);
+                continue;
+            }
+            if (write != read) {
+                values[write] = std::move(values[read]);
+                owners[write] = owners[read];
+            }
+            alive[write] = 1;
+            slots[owners[write]].dense = static_cast<uint32_t>(write);
+            ++write;
+        }
+        const size_t removed = values.size() - write;
+        values.erase(values.begin() + static_cast<std::ptrdiff_t>(write), values.end());
+        owners.resize(write);
+        alive.resize(write);
+        dead = 0;
+        return removed;
+    }
+
+private:
+    struct Slot {
+        uint32_t dense = 0;       // values の位置
+        uint32_t generation = 0;  // despawn のたびに進める
+    };
+
+    std::vector<T> values;
+    std::vector<uint32_t> owners;  // dense の位置 -> スロット
+    std::vector<uint8_t> alive;    // dense の位置ごとの生死
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+    size_t live = 0;
+    size_t dead = 0;  // despawn 済みで compact 前の数
+};
+
+#endif // SLOT_MAP_H
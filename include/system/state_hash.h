@@ -0,0 +1,250 @@
+#pragma once
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "simulation.h"
+#include "thread_pool.h"
+
+// 世界状態のハッシュ（構成要素ごと）
+// 要素ごとのハッシュは添字を含めて混ぜてから加算で畳み込むので、チャンクの分け方や結合順に依存しない
+struct StateHash {
+    int64_t day = 0;
+    uint64_t people = 0;
+    uint64_t businesses = 0;
+    uint64_t market = 0;
+    uint64_t loans = 0;
+    uint64_t government = 0;
+
+    uint64_t combined() const {
+        uint64_t h = StateHash::mix(static_cast<uint64_t>(day));
+        for (uint64_t part : {people, businesses, market, loans, government}) {
+            h = StateHash::mix(h ^ part);
+        }
+        return h;
+    }
+
+    bool operator==(const StateHash& other) const {
+        return day == other.day && people == other.people && businesses == other.businesses &&
+               market == other.market && loans == other.loans && government == other.government;
+    }
+    bool operator!=(const StateHash& other) const { return !(*this == other); }
+
+    // 食い違っている構成要素名（空白区切り）
+    std::string diff(const StateHash& other) const {
+        std::string parts;
+        auto note = [&parts](bool differs, const char* name) {
+            if (!differs) return;
+            if (!parts.empty()) parts += ' ';
+            parts += name;
+        };
+        note(day != other.day, "day");
+        note(people != other.people, "people");
+        note(businesses != other.businesses, "businesses");
+        note(market != other.market, "market");
+        note(loans != other.loans, "loans");
+        note(government != other.government, "government");
+        return parts;
+    }
+
+    // splitmix64 の最終化関数
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    static uint64_t combine(uint64_t seed, uint64_t value) {
+        return mix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+    }
+
+    static uint64_t ofFloat(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    // FNV-1a
+    static uint64_t ofString(const std::string& text) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : text) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+};
+
+// 世界状態のハッシュ計算
+// hashWorld は呼ぶたびに住民・企業・融資・商品の全件をハッシュし直す（差分更新はしない）。
+// 費用は O(住民 + 企業 + 融資 + 商品) で、1ティックの処理と同じ桁になる。
+// World::step は収入のフェーズで毎日全住民の所持金を書き換えるので、
+// 変わった添字だけを数え直す方式にしてもティックごとに全件が変わり、安くはならない。
+// 大きな世界では pool を渡して並列に計算するか、毎ティックではなく間隔を空けて呼ぶ
+class StateHasher {
+public:
+    // 並列時の1チャンクあたりの最小要素数
+    static constexpr size_t MIN_CHUNK = 1 << 14;
+
+    static StateHash hashWorld(const World& world, ThreadPool* pool = nullptr) {
+        StateHash hash;
+        hash.day = world.day;
+        hash.people = sumOver(world.people.size(), pool, [&world](size_t i) {
+            const Person& person = world.people[i];
+            uint64_t h = StateHash::combine(i, static_cast<uint64_t>(person.id));
+            h = StateHash::combine(h, static_cast<uint64_t>(person.money));
+            h = StateHash::combine(h, static_cast<uint32_t>(person.satisfaction));
+            h = StateHash::combine(h, static_cast<uint32_t>(person.daily_income));
+            return StateHash::combine(h, static_cast<uint32_t>(person.daily_expense));
+        });
+        hash.businesses = sumOver(world.businesses.size(), pool, [&world](size_t i) {
+            const Business& business = world.businesses[i];
+            uint64_t h = StateHash::combine(i, static_cast<uint64_t>(business.id));
+            h = StateHash::combine(h, static_cast<uint64_t>(business.money));
+            h = StateHash::combine(h, static_cast<uint32_t>(business.stock));
+            h = StateHash::combine(h, static_cast<uint64_t>(business.price));
+            return StateHash::combine(h, static_cast<uint32_t>(business.workers));
+        });
+        hash.market = hashMarket(world.market);
+        const auto& loans = world.loan_provider.active_loans;
+        hash.loans = sumOver(loans.size(), pool, [&loans](size_t i) {
+            const Loan& loan = loans[i];
+            uint64_t h = StateHash::combine(static_cast<uint64_t>(loan.loan_id),
+                                            static_cast<uint64_t>(loan.borrower_id));
+            h = StateHash::combine(h, static_cast<uint64_t>(loan.lender_id));
+            h = StateHash::combine(h, static_cast<uint64_t>(loan.amount));
+            h = StateHash::combine(h, StateHash::ofFloat(loan.interest_rate));
+            h = StateHash::combine(h, static_cast<uint32_t>(loan.days_remaining));
+            return StateHash::combine(h, loan.defaulted ? 1u : 0u);
+        });
+        hash.loans = StateHash::combine(hash.loans, static_cast<uint64_t>(world.loan_provider.money));
+        hash.government = hashGovernment(world.government);
+        return hash;
+    }
+
+    static uint64_t hashMarket(const Market& market) {
+        uint64_t h = 0;
+        for (const auto& product : market.getProducts()) {
+            h = StateHash::combine(h, StateHash::ofString(product));
+            h = StateHash::combine(h, static_cast<uint32_t>(market.getPrice(product)));
+            h = StateHash::combine(h, static_cast<uint32_t>(market.getStock(product)));
+        }
+        return StateHash::combine(h, StateHash::ofFloat(market.getPriceVolatility()));
+    }
+
+    static uint64_t hashGovernment(const Government& government) {
+        uint64_t h = StateHash::combine(0, static_cast<uint64_t>(government.money));
+        h = StateHash::combine(h, static_cast<uint32_t>(government.tax_rate));
+        h = StateHash::combine(h, StateHash::ofFloat(government.approval_rating));
+        return StateHash::combine(h, static_cast<uint64_t>(government.policy_history.total()));
+    }
+
+private:
+    // 要素ハッシュの総和（2^64 を法とする加算なので順序に依存しない）
+    template <typename ElementHash>
+    static uint64_t sumOver(size_t n, ThreadPool* pool, ElementHash element) {
+        if (!pool) {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < n; ++i) sum += element(i);
+            return sum;
+        }
+        std::atomic<uint64_t> sum{0};
+        pool->parallelFor(0, n, [&](size_t lo, size_t hi) {
+            uint64_t local = 0;
+            for (size_t i = lo; i < hi; ++i) local += element(i);
+            sum.fetch_add(local, std::memory_order_relaxed);
+        }, MIN_CHUNK);
+        return sum.load();
+    }
+};
+
+// ティックごとのハッシュ列をテキストで書き出す（1行1ティック、16進数）
+class HashStreamWriter {
+public:
+    static constexpr const char* HEADER = "# state-hash v1 day combined people businesses market loans government";
+
+    explicit HashStreamWriter(std::ostream& output) : out(output) { out << HEADER << "\n"; }
+
+    void write(const StateHash& hash) {
+        out << hash.day << std::hex << std::setfill('0');
+        for (uint64_t part : {hash.combined(), hash.people, hash.businesses, hash.market, hash.loans,
+                              hash.government}) {
+            out << ' ' << std::setw(16) << part;
+        }
+        out << std::dec << std::setfill(' ') << "\n";
+    }
+
+private:
+    std::ostream& out;
+};
+
+// ハッシュ列の読み込み
+inline std::vector<StateHash> readHashStream(std::istream& in) {
+    std::vector<StateHash> hashes;
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        StateHash hash;
+        uint64_t combined = 0;
+        fields >> hash.day >> std::hex >> combined >> hash.people >> hash.businesses >> hash.market >>
+            hash.loans >> hash.government;
+        if (!fields) {
+            throw std::runtime_error("Malformed hash stream at line " + std::to_string(line_number));
+        }
+        if (combined != hash.combined()) {
+            throw std::runtime_error("Hash stream checksum mismatch at line " +
+                                     std::to_string(line_number));
+        }
+        hashes.push_back(hash);
+    }
+    return hashes;
+}
+
+// 2つの実行の最初の食い違い
+struct Divergence {
+    bool diverged = false;
+    size_t index = 0;            // 食い違った行（0始まり）
+    int64_t day = 0;
+    std::string components;      // 食い違った構成要素
+    bool length_mismatch = false;  // 片方が途中で終わっている
+};
+
+inline Divergence findFirstDivergence(const std::vector<StateHash>& a, const std::vector<StateHash>& b) {
+    Divergence result;
+    const size_t common = std::min(a.size(), b.size());
+    for (size_t i = 0; i < common; ++i) {
+        if (a[i] != b[i]) {
+            result.diverged = true;
+            result.index = i;
+            result.day = a[i].day;
+            result.components = a[i].diff(b[i]);
+            return result;
+        }
+    }
+    if (a.size() != b.size()) {
+        result.diverged = true;
+        result.length_mismatch = true;
+        result.index = common;
+        result.day = common < a.size() ? a[common].day : b[common].day;
+    }
+    return result;
+}
+
+#endif // STATE_HASH_H
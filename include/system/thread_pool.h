@@ -0,0 +1,135 @@
+#pragma once
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 常駐ワーカースレッドによる簡易スレッドプール
+// parallelFor は範囲をチャンクに分割し、全チャンクの完了まで呼び出し元をブロックする
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency())
+        : stopping(false), generation(0), pending(0) {
+        if (num_threads == 0) num_threads = 1;
+        // 呼び出し元スレッドも作業に参加するため、ワーカーは1つ少なく起動する
+        for (size_t i = 1; i < num_threads; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size() + 1; }
+
+    // [begin, end) を min_chunk 以上のチャンクに分割して fn(chunk_begin, chunk_end) を並列実行する
+    // いずれかのチャンクで例外が発生した場合、全チャンク終了後に最初の例外を再送出する
+    void parallelFor(size_t begin, size_t end,
+                     const std::function<void(size_t, size_t)>& fn,
+                     size_t min_chunk = 1024) {
+        if (begin >= end) return;
+        const size_t total = end - begin;
+        const size_t max_chunks = (total + min_chunk - 1) / std::max<size_t>(min_chunk, 1);
+        const size_t num_chunks = std::min(size(), std::max<size_t>(max_chunks, 1));
+        if (num_chunks <= 1) {
+            fn(begin, end);
+            return;
+        }
+
+        const size_t chunk = (total + num_chunks - 1) / num_chunks;
+        std::vector<std::function<void()>> tasks;
+        tasks.reserve(num_chunks);
+        for (size_t lo = begin; lo < end; lo += chunk) {
+            const size_t hi = std::min(end, lo + chunk);
+            tasks.emplace_back([&fn, lo, hi] { fn(lo, hi); });
+        }
+        run(tasks);
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool stopping;
+    size_t generation;
+    size_t pending;
+    std::vector<std::function<void()>>* batch = nullptr;
+    size_t next_task = 0;
+    std::exception_ptr first_error;
+
+    // 1バッチ分のタスクを全スレッドで消化する（呼び出し元も参加）
+    void run(std::vector<std::function<void()>>& tasks) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch = &tasks;
+            next_task = 0;
+            pending = tasks.size();
+            first_error = nullptr;
+            ++generation;
+        }
+        wake.notify_all();
+        drain();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        batch = nullptr;
+        if (first_error) {
+            std::exception_ptr error = first_error;
+            first_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    void drain() {
+        for (;;) {
+            std::function<void()>* task = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!batch || next_task >= batch->size()) return;
+                task = &(*batch)[next_task++];
+            }
+            try {
+                (*task)();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!first_error) first_error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) done.notify_all();
+        }
+    }
+
+    void workerLoop() {
+        size_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            drain();
+        }
+    }
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,270 @@
+#pragma once
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+// ホットパス計測
+// TraceZone（RAII）の区間をスレッドごとのリングバッファに TSC で記録し、
+// Chrome/Perfetto のトレースイベントJSONと、フェーズごとの所要時間ヒストグラムを出力する。
+// ENABLE_TRACING が未定義のとき TRACE_ZONE 系マクロは空になり、計測コストはゼロになる
+
+// 1区間の記録
+struct TraceEvent {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+    int64_t count;
+};
+
+// フェーズ（区間名）ごとの集計
+struct PhaseStats {
+    static constexpr size_t NUM_BUCKETS = 48;
+
+    std::string name;
+    uint64_t calls = 0;
+    uint64_t total_ticks = 0;
+    uint64_t max_ticks = 0;
+    int64_t items = 0;
+    std::array<uint64_t, NUM_BUCKETS> histogram{};  // log2(ticks) ごとの回数
+
+    void add(uint64_t ticks, int64_t count) {
+        ++calls;
+        total_ticks += ticks;
+        max_ticks = std::max(max_ticks, ticks);
+        items += count;
+        size_t bucket = 0;
+        while ((ticks >> bucket) > 1 && bucket + 1 < NUM_BUCKETS) ++bucket;
+        ++histogram[bucket];
+    }
+
+    void merge(const PhaseStats& other) {
+        calls += other.calls;
+        total_ticks += other.total_ticks;
+        max_ticks = std::max(max_ticks, other.max_ticks);
+        items += other.items;
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) histogram[i] += other.histogram[i];
+    }
+};
+
+class Tracer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    // 各スレッドが専有するバッファ。書き込みは所有スレッドのみが行う
+    struct ThreadBuffer {
+        uint32_t thread_index = 0;
+        std::vector<TraceEvent> ring;
+        size_t written = 0;
+        std::vector<std::pair<const char*, PhaseStats>> phases;
+
+        void record(const char* name, uint64_t begin, uint64_t end, int64_t count) {
+            if (!ring.empty()) {
+                ring[written % ring.size()] = {name, begin, end, count};
+            }
+            ++written;
+            const uint64_t ticks = end >= begin ? end - begin : 0;
+            for (auto& phase : phases) {
+                if (phase.first == name) {
+                    phase.second.add(ticks, count);
+                    return;
+                }
+            }
+            phases.emplace_back(name, PhaseStats{});
+            phases.back().second.name = name;
+            phases.back().second.add(ticks, count);
+        }
+    };
+
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    ThreadBuffer& local() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer = buffers.back().get();
+            buffer->thread_index = static_cast<uint32_t>(buffers.size() - 1);
+            buffer->ring.resize(capacity);
+        }
+        return *buffer;
+    }
+
+    void record(const char* name, uint64_t begin, uint64_t end, int64_t count) {
+        local().record(name, begin, end, count);
+    }
+
+    // 以下は計測中のスレッドがない時点（ティックの合間や実行終了時）に呼ぶこと
+
+    // 記録を破棄し、時刻の基準点を取り直す
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& buffer : buffers) {
+            buffer->written = 0;
+            buffer->phases.clear();
+        }
+        calibrate();
+    }
+
+    // 1 tick あたりのナノ秒（TSC 周波数を基準点からの経過で推定）
+    double nsPerTick() const {
+        const uint64_t ticks = now() - origin_ticks;
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - origin_time).count();
+        if (ticks == 0 || ns <= 0) return 1.0;
+        return static_cast<double>(ns) / static_cast<double>(ticks);
+    }
+
+    // フェーズごとの集計を全スレッド分結合して返す（名前順）
+    std::vector<PhaseStats> collectStats() const {
+        std::map<std::string, PhaseStats> merged;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& buffer : buffers) {
+            for (const auto& phase : buffer->phases) {
+                auto it = merged.find(phase.second.name);
+                if (it == merged.end()) {
+                    merged.emplace(phase.second.name, phase.second);
+                } else {
+                    it->second.merge(phase.second);
+                }
+            }
+        }
+        std::vector<PhaseStats> result;
+        for (auto& entry : merged) result.push_back(entry.second);
+        return result;
+    }
+
+    // Chrome / Perfetto で読めるトレースイベントJSONを書き出す
+    void writeChromeTrace(std::ostream& out) const {
+        const double ns_per_tick = nsPerTick();
+        std::lock_guard<std::mutex> lock(mutex);
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto& buffer : buffers) {
+            const size_t size = std::min(buffer->written, buffer->ring.size());
+            const size_t start = buffer->written - size;
+            for (size_t i = start; i < buffer->written; ++i) {
+                const TraceEvent& event = buffer->ring[i % buffer->ring.size()];
+                const double ts = (static_cast<double>(event.begin - origin_ticks) * ns_per_tick) / 1000.0;
+                const double dur = (static_cast<double>(event.end - event.begin) * ns_per_tick) / 1000.0;
+                out << (first ? "" : ",") << "\n{\"name\":\"";
+                writeEscaped(out, event.name);
+                out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_index
+                    << std::fixed << std::setprecision(3)
+                    << ",\"ts\":" << ts << ",\"dur\":" << dur
+                    << ",\"args\":{\"count\":" << event.count << "}}";
+                first = false;
+            }
+        }
+        out << "\n]}\n";
+        out.unsetf(std::ios::floatfield);
+    }
+
+    // フェーズごとの所要時間・件数・ヒストグラムを表示する
+    void printSummary(std::ostream& out) const {
+        const double ns_per_tick = nsPerTick();
+        out << "=== フェーズ別計測 ===\n";
+        for (const auto& phase : collectStats()) {
+            const double total_us = phase.total_ticks * ns_per_tick / 1000.0;
+            const double mean_us = phase.calls ? total_us / phase.calls : 0.0;
+            out << phase.name << ": " << phase.calls << "回, 合計 "
+                << std::fixed << std::setprecision(1) << total_us << "us, 平均 "
+                << mean_us << "us, 最大 " << phase.max_ticks * ns_per_tick / 1000.0
+                << "us, 件数 " << phase.items << "\n";
+            for (size_t b = 0; b < PhaseStats::NUM_BUCKETS; ++b) {
+                if (phase.histogram[b] == 0) continue;
+                out << "  >= " << std::setprecision(0) << ((uint64_t{1} << b) * ns_per_tick)
+                    << "ns: " << phase.histogram[b] << "\n";
+            }
+        }
+        out.unsetf(std::ios::floatfield);
+        out << std::setprecision(6);
+    }
+
+    // 新しく生成されるスレッドバッファのリング容量（イベント数）
+    void setCapacity(size_t events) { capacity = events; }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    size_t capacity = DEFAULT_CAPACITY;
+    uint64_t origin_ticks = 0;
+    std::chrono::steady_clock::time_point origin_time;
+
+    Tracer() { calibrate(); }
+
+    void calibrate() {
+        origin_time = std::chrono::steady_clock::now();
+        origin_ticks = now();
+    }
+
+    static void writeEscaped(std::ostream& out, const char* text) {
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                out << '\\' << *c;
+            } else if (static_cast<unsigned char>(*c) < 0x20) {
+                out << ' ';
+            } else {
+                out << *c;
+            }
+        }
+    }
+};
+
+// スコープの開始から終了までを1区間として記録する
+class TraceZone {
+public:
+    explicit TraceZone(const char* zone_name, int64_t items = 0)
+        : name(zone_name), count(items), begin(Tracer::now()) {}
+
+    ~TraceZone() { Tracer::instance().record(name, begin, Tracer::now(), count); }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+
+    // 区間内で処理した件数を設定する
+    void setCount(int64_t items) { count = items; }
+
+private:
+    const char* name;
+    int64_t count;
+    uint64_t begin;
+};
+
+#ifdef ENABLE_TRACING
+#define TRACE_ZONE(var, name) TraceZone var(name)
+#define TRACE_COUNT(var, items) var.setCount(static_cast<int64_t>(items))
+#else
+#define TRACE_ZONE(var, name) ((void)0)
+#define TRACE_COUNT(var, items) ((void)0)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,189 @@
+#pragma once
+#ifndef WEALTH_SKETCH_H
+#define WEALTH_SKETCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "thread_pool.h"
+
+// 富の分布の要約
+struct WealthSummary {
+    uint64_t count = 0;
+    double mean = 0.0;
+    double gini = 0.0;
+    double p10 = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double top1_share = 0.0;  // 上位1%が保有する富の割合（0.0 - 1.0）
+};
+
+// 所持金の分布を対数バケットで数えるストリーミングスケッチ（DDSketch 方式）
+// 分位点は相対誤差 RELATIVE_ACCURACY 以内。バケットごとの件数と合計を足し合わせるだけで結合でき、
+// スレッドごとに集計して最後に merge すれば全件ソートなしで Gini 係数と上位シェアも求まる
+class WealthSketch {
+public:
+    static constexpr double RELATIVE_ACCURACY = 0.01;
+
+    WealthSketch()
+        : gamma((1.0 + RELATIVE_ACCURACY) / (1.0 - RELATIVE_ACCURACY)),
+          log_gamma(std::log(gamma)) {}
+
+    void add(int64_t money) {
+        ++total_count;
+        if (money < 0) {
+            ++negative_count;
+            negative_sum += static_cast<double>(money);
+            return;
+        }
+        if (money == 0) {
+            ++zero_count;
+            return;
+        }
+        const size_t index = bucketIndex(money);
+        if (index >= counts.size()) {
+            counts.resize(index + 1, 0);
+            sums.resize(index + 1, 0.0);
+        }
+        ++counts[index];
+        sums[index] += static_cast<double>(money);
+    }
+
+    void merge(const WealthSketch& other) {
+        if (other.counts.size() > counts.size()) {
+            counts.resize(other.counts.size(), 0);
+            sums.resize(other.counts.size(), 0.0);
+        }
+        for (size_t i = 0; i < other.counts.size(); ++i) {
+            counts[i] += other.counts[i];
+            sums[i] += other.sums[i];
+        }
+        total_count += other.total_count;
+        zero_count += other.zero_count;
+        negative_count += other.negative_count;
+        negative_sum += other.negative_sum;
+    }
+
+    uint64_t count() const { return total_count; }
+
+    // q 分位点（0.0 - 1.0）の推定値
+    double quantile(double q) const {
+        if (q < 0.0 || q > 1.0) {
+            throw std::out_of_range("Quantile must be between 0.0 and 1.0");
+        }
+        if (total_count == 0) return 0.0;
+        const uint64_t rank = static_cast<uint64_t>(q * (total_count - 1));
+        uint64_t seen = negative_count;
+        if (rank < seen) return negative_sum / negative_count;
+        seen += zero_count;
+        if (rank < seen) return 0.0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (rank < seen) return representative(i);
+        }
+        return representative(counts.size() - 1);
+    }
+
+    // Gini 係数（負の所持金は0として扱う）。バケット内は均等と見なしたローレンツ曲線から求める
+    double gini() const {
+        const double wealth = positiveWealth();
+        if (total_count == 0 || wealth <= 0.0) return 0.0;
+        const double population = static_cast<double>(total_count);
+        double area = 0.0;
+        double cumulative = 0.0;
+        // 負・0のグループは富0なのでローレンツ曲線に寄与しない
+        for (size_t i = 0; i < counts.size(); ++i) {
+            if (counts[i] == 0) continue;
+            const double previous = cumulative;
+            cumulative += sums[i] / wealth;
+            area += (counts[i] / population) * (previous + cumulative);
+        }
+        return std::max(0.0, 1.0 - area);
+    }
+
+    // 上位 fraction（例: 0.01）が保有する富の割合
+    double topShare(double fraction) const {
+        const double wealth = positiveWealth();
+        if (total_count == 0 || wealth <= 0.0) return 0.0;
+        double remaining = fraction * total_count;
+        double top = 0.0;
+        for (size_t i = counts.size(); i-- > 0 && remaining > 0.0;) {
+            if (counts[i] == 0) continue;
+            const double take = std::min<double>(remaining, counts[i]);
+            top += take * (sums[i] / counts[i]);
+            remaining -= take;
+        }
+        return top / wealth;
+    }
+
+    double mean() const {
+        if (total_count == 0) return 0.0;
+        return (positiveWealth() + negative_sum) / total_count;
+    }
+
+    WealthSummary summarize() const {
+        WealthSummary summary;
+        summary.count = total_count;
+        summary.mean = mean();
+        summary.gini = gini();
+        summary.p10 = quantile(0.10);
+        summary.p50 = quantile(0.50);
+        summary.p90 = quantile(0.90);
+        summary.p99 = quantile(0.99);
+        summary.top1_share = topShare(0.01);
+        return summary;
+    }
+
+    // 集団全体のスケッチをスレッドごとに作って結合する（結合はチャンク順で決定的）
+    template <typename Agents>
+    static WealthSketch fromAgents(const Agents& agents, ThreadPool* pool = nullptr) {
+        std::mutex mutex;
+        std::map<size_t, WealthSketch> partials;
+        auto build = [&](size_t lo, size_t hi) {
+            WealthSketch local;
+            for (size_t i = lo; i < hi; ++i) local.add(agents[i].money);
+            std::lock_guard<std::mutex> lock(mutex);
+            partials.emplace(lo, std::move(local));
+        };
+        if (pool) {
+            pool->parallelFor(0, agents.size(), build, 1 << 14);
+        } else {
+            build(0, agents.size());
+        }
+        WealthSketch sketch;
+        for (const auto& entry : partials) sketch.merge(entry.second);
+        return sketch;
+    }
+
+private:
+    double gamma;
+    double log_gamma;
+    std::vector<uint64_t> counts;
+    std::vector<double> sums;
+    uint64_t total_count = 0;
+    uint64_t zero_count = 0;
+    uint64_t negative_count = 0;
+    double negative_sum = 0.0;
+
+    size_t bucketIndex(int64_t money) const {
+        return static_cast<size_t>(std::ceil(std::log(static_cast<double>(money)) / log_gamma));
+    }
+
+    // バケット i の代表値（区間 (gamma^(i-1), gamma^i] の相対誤差最小点）
+    double representative(size_t i) const {
+        return 2.0 * std::pow(gamma, static_cast<double>(i)) / (gamma + 1.0);
+    }
+
+    double positiveWealth() const {
+        double total = 0.0;
+        for (double s : sums) total += s;
+        return total;
+    }
+};
+
+#endif // WEALTH_SKETCH_H
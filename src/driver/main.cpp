@@ -0,0 +1,441 @@
+// ヘッドレス実行用ドライバ
+// 規模・スレッド数・出力先をコマンドラインで受け取り、標準出力へは進捗ログのみを出して走らせる
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "system/agent_columns.h"
+#include "system/async_checkpoint.h"
+#include "system/checkpoint.h"
+#include "system/ensemble.h"
+#include "system/simulation.h"
+#include "system/state_hash.h"
+#include "system/thread_pool.h"
+#include "system/trace.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+enum class LogLevel { ERROR = 0, WARN = 1, INFO = 2, DEBUG = 3 };
+
+struct DriverOptions {
+    WorldConfig world;
+    int64_t ticks = 100;
+    size_t threads = 0;  // 0 ならハードウェアスレッド数
+    LogLevel log_level = LogLevel::WARN;
+    int64_t checkpoint_interval = 0;  // 0 ならチェックポイントを書かない
+    std::string checkpoint_dir = ".";
+    bool columnar_checkpoint = false;  // true なら AgentColumns 形式（属性ごとのカラムを mmap で読む）
+    bool async_checkpoint = false;     // true なら AsyncCheckpoint 形式（裏のスレッドで圧縮して書く）
+    std::string metrics_out;
+    std::string trace_out;
+    std::string hash_out;  // 空でなければティックごとの状態ハッシュを書き出す
+    bool level_of_detail = false;
+    bool household_basket = false;
+    bool seasons = false;
+    bool labor_market = false;
+    int64_t tax_period = 1;  // 住民の税を集める間隔（日）
+    std::vector<int> ensemble_tax;           // 空でなければアンサンブル実行の税率の一覧
+    std::vector<float> ensemble_volatility;  // 空でなければアンサンブル実行の価格変動性の一覧
+};
+
+static void printUsage(std::ostream& out) {
+    out << "使い方: economy_driver [オプション]\n"
+        << "  --people N               住民数（既定 1000）\n"
+        << "  --businesses N           企業数（既定 100）\n"
+        << "  --ticks N                シミュレーション日数（既定 100）\n"
+        << "  --threads N              ワーカースレッド数（0 = ハードウェアスレッド数）\n"
+        << "  --seed N                 乱数シード（既定 1）\n"
+        << "  --log-level LEVEL        error | warn | info | debug（既定 warn）\n"
+        << "  --checkpoint-interval N  N日ごとにチェックポイントを書く（0 = 無効）\n"
+        << "  --checkpoint-dir DIR     チェックポイントの出力先（既定 .）\n"
+        << "  --checkpoint-format FMT  binary | columns | async（既定 binary）\n"
+        << "  --metrics-out PATH       終了時の計測値を JSON で書き出す\n"
+        << "  --trace-out PATH         フェーズ計測を Chrome trace 形式で書き出す\n"
+        << "  --hash-out PATH          ティックごとの状態ハッシュを書き出す（state_hash_diff で比較）\n"
+        << "  --lod                    同じ日課の住民を集団にまとめて集計で進める\n"
+        << "  --basket                 消費を家計の買い物かご（品目ごとの総需要の一括約定）で進める\n"
+        << "  --seasons                季節ごとに業種別の倍率を生産量に掛ける\n"
+        << "  --labor-market           住民を求人に結び付けて雇い、企業から給与を払う\n"
+        << "  --tax-period N           住民の税を N 日ごとの納税日にだけ集める（既定 1 = 毎日）\n"
+        << "  --ensemble-tax LIST      税率の一覧（例 5,10,15）ごとに同じ初期世界を進めて要約統計を出す\n"
+        << "  --ensemble-volatility LIST  価格変動性の一覧（例 0.05,0.1）。--ensemble-tax との全組み合わせを実行する\n"
+        << "  --help                   この説明を表示\n";
+}
+
+static LogLevel parseLogLevel(const std::string& value) {
+    if (value == "error") return LogLevel::ERROR;
+    if (value == "warn") return LogLevel::WARN;
+    if (value == "info") return LogLevel::INFO;
+    if (value == "debug") return LogLevel::DEBUG;
+    throw std::invalid_argument("Unknown log level: " + value);
+}
+
+static int64_t parseCount(const std::string& flag, const std::string& value) {
+    size_t used = 0;
+    long long parsed = 0;
+    try {
+        parsed = std::stoll(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used != value.size() || parsed < 0) {
+        throw std::invalid_argument(flag + " expects a non-negative integer, got '" + value + "'");
+    }
+    return parsed;
+}
+
+// カンマ区切りの一覧を parse で1つずつ読む
+template <typename Parse>
+static auto parseList(const std::string& flag, const std::string& value, Parse parse) {
+    std::vector<decltype(parse(std::string()))> items;
+    size_t begin = 0;
+    while (begin <= value.size()) {
+        const size_t end = std::min(value.find(',', begin), value.size());
+        if (end == begin) {
+            throw std::invalid_argument(flag + " expects a comma-separated list, got '" + value + "'");
+        }
+        items.push_back(parse(value.substr(begin, end - begin)));
+        begin = end + 1;
+    }
+    return items;
+}
+
+static float parseVolatility(const std::string& flag, const std::string& value) {
+    size_t used = 0;
+    float parsed = -1.0f;
+    try {
+        parsed = std::stof(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used != value.size() || !(parsed >= 0.0f && parsed <= 1.0f)) {
+        throw std::invalid_argument(flag + " expects values within [0, 1], got '" + value + "'");
+    }
+    return parsed;
+}
+
+// 戻り値が false なら --help で終了する
+static bool parseOptions(int argc, char** argv, DriverOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h") {
+            printUsage(std::cout);
+            return false;
+        }
+        if (flag == "--lod") {
+            options.level_of_detail = true;
+            continue;
+        }
+        if (flag == "--basket") {
+            options.household_basket = true;
+            continue;
+        }
+        if (flag == "--seasons") {
+            options.seasons = true;
+            continue;
+        }
+        if (flag == "--labor-market") {
+            options.labor_market = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + flag);
+        }
+        const std::string value = argv[++i];
+        if (flag == "--people") {
+            options.world.people = static_cast<size_t>(parseCount(flag, value));
+        } else if (flag == "--businesses") {
+            options.world.businesses = static_cast<size_t>(parseCount(flag, value));
+        } else if (flag == "--ticks") {
+            options.ticks = parseCount(flag, value);
+        } else if (flag == "--threads") {
+            options.threads = static_cast<size_t>(parseCount(flag, value));
+        } else if (flag == "--seed") {
+            options.world.seed = static_cast<uint64_t>(parseCount(flag, value));
+        } else if (flag == "--log-level") {
+            options.log_level = parseLogLevel(value);
+        } else if (flag == "--checkpoint-interval") {
+            options.checkpoint_interval = parseCount(flag, value);
+        } else if (flag == "--checkpoint-dir") {
+            options.checkpoint_dir = value;
+        } else if (flag == "--checkpoint-format") {
+            if (value != "binary" && value != "columns" && value != "async") {
+                throw std::invalid_argument("Unknown checkpoint format: " + value);
+            }
+            options.columnar_checkpoint = value == "columns";
+            options.async_checkpoint = value == "async";
+        } else if (flag == "--metrics-out") {
+            options.metrics_out = value;
+        } else if (flag == "--trace-out") {
+            options.trace_out = value;
+        } else if (flag == "--hash-out") {
+            options.hash_out = value;
+        } else if (flag == "--tax-period") {
+            options.tax_period = parseCount(flag, value);
+            if (options.tax_period < 1 || options.tax_period > std::numeric_limits<int32_t>::max()) {
+                throw std::invalid_argument("--tax-period must be a positive number of days");
+            }
+        } else if (flag == "--ensemble-tax") {
+            options.ensemble_tax = parseList(flag, value, [&flag](const std::string& item) {
+                const int64_t rate = parseCount(flag, item);
+                if (rate > 100) throw std::invalid_argument(flag + " expects rates within [0, 100]");
+                return static_cast<int>(rate);
+            });
+        } else if (flag == "--ensemble-volatility") {
+            options.ensemble_volatility = parseList(
+                flag, value, [&flag](const std::string& item) { return parseVolatility(flag, item); });
+        } else {
+            throw std::invalid_argument("Unknown option: " + flag);
+        }
+    }
+    if (options.world.businesses == 0) {
+        throw std::invalid_argument("--businesses must be at least 1");
+    }
+    return true;
+}
+
+// プロセスの最大常駐メモリ（KiB）。取得できない環境では0
+static int64_t peakRssKiB() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+        return static_cast<int64_t>(usage.ru_maxrss) / 1024;  // macOS はバイト単位
+#else
+        return static_cast<int64_t>(usage.ru_maxrss);
+#endif
+    }
+#endif
+    return 0;
+}
+
+static void writeMetrics(const std::string& path, const DriverOptions& options, size_t threads,
+                         double seconds, const TickStats& totals, int64_t peak_rss) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Cannot open metrics file: " + path);
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "{\n"
+        << "  \"people\": " << options.world.people << ",\n"
+        << "  \"businesses\": " << options.world.businesses << ",\n"
+        << "  \"ticks\": " << options.ticks << ",\n"
+        << "  \"threads\": " << threads << ",\n"
+        << "  \"seed\": " << options.world.seed << ",\n"
+        << "  \"elapsed_seconds\": " << seconds << ",\n"
+        << "  \"ticks_per_second\": " << (seconds > 0 ? options.ticks / seconds : 0.0) << ",\n"
+        << "  \"trades\": " << totals.trades << ",\n"
+        << "  \"trades_per_second\": " << (seconds > 0 ? totals.trades / seconds : 0.0) << ",\n"
+        << "  \"produced\": " << totals.produced << ",\n"
+        << "  \"loans\": " << totals.loans << ",\n"
+        << "  \"peak_rss_kib\": " << peak_rss << ",\n"
+        << "  \"phases\": [";
+    const double ns_per_tick = Tracer::instance().nsPerTick();
+    bool first = true;
+    for (const auto& phase : Tracer::instance().collectStats()) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "    {\"name\": \"" << phase.name << "\", \"calls\": " << phase.calls
+            << ", \"total_ms\": " << phase.total_ticks * ns_per_tick / 1e6
+            << ", \"max_ms\": " << phase.max_ticks * ns_per_tick / 1e6
+            << ", \"items\": " << phase.items << "}";
+    }
+    out << (first ? "]\n" : "\n  ]\n") << "}\n";
+}
+
+// チェックポイントを書き、書いたファイルのパスを返す
+static std::string writeCheckpoint(const World& world, const DriverOptions& options) {
+    const std::string stem = options.checkpoint_dir + "/checkpoint_" + std::to_string(world.day);
+    if (options.columnar_checkpoint) {
+        const std::string path = stem + ".cols";
+        AgentColumns::save(world, path);
+        return path;
+    }
+    const std::string path = stem + ".bin";
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    Checkpoint::save(world, out);
+    return path;
+}
+
+// 税率 × 価格変動性の組ごとに同じ初期世界を --ticks 日進め、最終状態の要約統計を標準出力に書く
+// 初期世界は1つだけ用意して全実行で共有し（EnsembleBase）、実行はスレッドプールに分配する
+static void runEnsembleMode(World world, const DriverOptions& options, ThreadPool* pool) {
+    if (options.ticks > std::numeric_limits<int>::max()) {
+        throw std::invalid_argument("--ticks is too large for an ensemble");
+    }
+    std::vector<int> taxes = options.ensemble_tax;
+    if (taxes.empty()) taxes.push_back(world.government.tax_rate);
+    std::vector<float> volatilities = options.ensemble_volatility;
+    if (volatilities.empty()) volatilities.push_back(world.market.getPriceVolatility());
+    std::vector<EnsembleParams> params;
+    for (int tax : taxes) {
+        for (float volatility : volatilities) {
+            EnsembleParams run;
+            run.tax_rate = tax;
+            run.price_volatility = volatility;
+            params.push_back(run);
+        }
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    const EnsembleSummary summary =
+        runEnsemble(EnsembleBase::build(std::move(world)), params, static_cast<int>(options.ticks), pool);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout << std::fixed << std::setprecision(2) << "runs: " << summary.runs << "\n"
+              << "elapsed: " << seconds << " s\n";
+    auto print = [](const char* name, const RunningStats& stats) {
+        std::cout << name << ": mean " << stats.mean << ", stddev " << stats.stddev() << ", min " << stats.min
+                  << ", max " << stats.max << "\n";
+    };
+    print("total_person_money", summary.total_person_money);
+    print("government_money", summary.government_money);
+    print("approval_rating", summary.approval_rating);
+    print("mean_satisfaction", summary.mean_satisfaction);
+    print("staple_price", summary.staple_price);
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+int main(int argc, char** argv) {
+    DriverOptions options;
+    try {
+        if (!parseOptions(argc, argv, options)) return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "エラー: " << e.what() << "\n";
+        printUsage(std::cerr);
+        return 64;
+    }
+
+    try {
+        const size_t threads = options.threads > 0
+                                   ? options.threads
+                                   : std::max<size_t>(1, std::thread::hardware_concurrency());
+        std::unique_ptr<ThreadPool> pool;
+        if (threads > 1) pool = std::make_unique<ThreadPool>(threads);
+
+        World world = World::generate(options.world);
+        world.household_basket = options.household_basket;
+        if (options.seasons) world.enableSeasons();
+        if (options.labor_market) world.enableLaborMarket();
+        world.setTaxPeriod(static_cast<int32_t>(options.tax_period));
+        const size_t dormant = options.level_of_detail ? world.enableLevelOfDetail() : 0;
+        if (options.log_level >= LogLevel::INFO) {
+            std::cerr << "住民 " << world.people.size() << "人, 企業 " << world.businesses.size()
+                      << "社, " << options.ticks << "日, " << threads << "スレッド\n";
+            if (options.level_of_detail) {
+                std::cerr << "LOD: " << world.cohorts.getCohorts().size() << "集団に " << dormant
+                          << "人を集約\n";
+            }
+        }
+        if (!options.ensemble_tax.empty() || !options.ensemble_volatility.empty()) {
+            runEnsembleMode(std::move(world), options, pool.get());
+            return 0;
+        }
+
+        std::ofstream hash_file;
+        std::unique_ptr<HashStreamWriter> hash_stream;
+        if (!options.hash_out.empty()) {
+            hash_file.open(options.hash_out);
+            if (!hash_file) {
+                throw std::runtime_error("Cannot open hash file: " + options.hash_out);
+            }
+            hash_stream = std::make_unique<HashStreamWriter>(hash_file);
+        }
+
+        // 非同期チェックポイントの完了はコールバックで知らせる（裏のスレッドから呼ばれる）
+        AsyncCheckpoint async_checkpoint;
+        const LogLevel log_level = options.log_level;
+        auto reportCheckpoint = [log_level](const AsyncCheckpointResult& result) {
+            if (result.ok && log_level >= LogLevel::INFO) {
+                std::cerr << "チェックポイント: " << result.path << "（取り込み " << result.capture_ms << " ms, 書き込み "
+                          << result.write_ms << " ms, " << result.bytes << " バイト）\n";
+            } else if (!result.ok && log_level >= LogLevel::WARN) {
+                std::cerr << "警告: チェックポイントを書けません: " << result.error << "\n";
+            }
+        };
+
+        TickStats totals;
+        const auto started = std::chrono::steady_clock::now();
+        for (int64_t tick = 1; tick <= options.ticks; ++tick) {
+            const TickStats stats = world.step(pool.get());
+            totals.trades += stats.trades;
+            totals.produced += stats.produced;
+            totals.taxes += stats.taxes;
+            totals.loans += stats.loans;
+            totals.subsidies += stats.subsidies;
+            if (hash_stream) {
+                TRACE_ZONE(hash_zone, "状態ハッシュ");
+                world.syncPeople();
+                hash_stream->write(StateHasher::hashWorld(world, pool.get()));
+            }
+            if (options.log_level >= LogLevel::DEBUG) {
+                std::cerr << "Day " << world.day << "（" << Calendar::format(world.day - 1) << "）: 取引 "
+                          << stats.trades << ", 生産 " << stats.produced << ", 融資 " << stats.loans << "\n";
+            }
+
+            if (options.checkpoint_interval > 0 && tick % options.checkpoint_interval == 0) {
+                TRACE_ZONE(checkpoint_zone, "チェックポイント");
+                world.syncPeople();
+                if (options.async_checkpoint) {
+                    const std::string path =
+                        options.checkpoint_dir + "/checkpoint_" + std::to_string(world.day) + ".ackp";
+                    async_checkpoint.start(world, path, reportCheckpoint, pool.get());
+                } else {
+                    try {
+                        const std::string path = writeCheckpoint(world, options);
+                        if (options.log_level >= LogLevel::INFO) {
+                            std::cerr << "チェックポイント: " << path << "\n";
+                        }
+                    } catch (const std::runtime_error& e) {
+                        if (options.log_level >= LogLevel::WARN) {
+                            std::cerr << "警告: チェックポイントを書けません: " << e.what() << "\n";
+                        }
+                    }
+                }
+            }
+        }
+        async_checkpoint.wait();
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        const int64_t peak_rss = peakRssKiB();
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "ticks/sec: " << (seconds > 0 ? options.ticks / seconds : 0.0) << "\n"
+                  << "trades/sec: " << (seconds > 0 ? totals.trades / seconds : 0.0) << "\n"
+                  << "peak RSS: " << peak_rss << " KiB\n"
+                  << "elapsed: " << seconds << " s\n";
+        std::cout.unsetf(std::ios::floatfield);
+#ifdef ENABLE_TRACING
+        Tracer::instance().printSummary(std::cout);
+#endif
+
+        if (!options.metrics_out.empty()) {
+            writeMetrics(options.metrics_out, options, threads, seconds, totals, peak_rss);
+        }
+        if (!options.trace_out.empty()) {
+            std::ofstream trace(options.trace_out);
+            if (!trace) {
+                throw std::runtime_error("Cannot open trace file: " + options.trace_out);
+            }
+            Tracer::instance().writeChromeTrace(trace);
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "エラー: " << e.what() << "\n";
+        return 1;
+    }
+}
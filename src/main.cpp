@@ -2,13 +2,21 @@
 #include <vector>
 #include "agent/person.h"
 #include "market/business.h"
+#include "market/goods_catalog.h"
 #include "market/market.h"
+#include "market/production.h"
+#include "market/seasonal_production.h"
+#include "market/sector_index.h"
+#include "system/calendar.h"
+#include "system/trace.h"
+#include "system/wealth_sketch.h"
 #include "system/trade_route.h"
 #include "agent/government.h"
 #include "agent/loan_provider.h"
 
 void simulateDay(std::vector<Person>& people, std::vector<Business>& businesses, Market& market, 
-                Government& government, LoanProvider& loan_provider, std::vector<TradeRoute>& trade_routes) {
+                Government& government, LoanProvider& loan_provider, std::vector<TradeRoute>& trade_routes,
+                ProductionGraph& production, const SectorIndex& sectors) {
     std::cout << "=== 1日の経済活動をシミュレート ===\n";
     
     // 安全性チェック
@@ -18,121 +26,144 @@ void simulateDay(std::vector<Person>& people, std::vector<Business>& businesses,
     }
     
     try {
-        // 生産活動
-        for (auto& business : businesses) {
-            if (business.daily_production < 0) {
-                std::cerr << "警告: " << business.product << "の日次生産量が負の値です。\n";
-                continue;
+        // 生産活動（サプライチェーンの上流から順に生産）
+        {
+            TRACE_ZONE(production_zone, "生産");
+            TRACE_COUNT(production_zone, businesses.size());
+            auto production_report = production.runTick(businesses);
+            for (const auto& [product, amount] : production_report.produced) {
+                std::cout << product << "が" << amount << "個生産されました。\n";
+            }
+            for (const auto& [product, amount] : production_report.consumed) {
+                std::cout << product << "が原料として" << amount << "個消費されました。\n";
             }
-            int production = business.daily_production;
-            business.stock += production;
-            std::cout << business.product << "の生産者が" << production << "個生産しました。在庫: " << business.stock << "\n";
         }
         
         // 貿易ルートによる商品移動
-        for (auto& route : trade_routes) {
-            if (route.travel_time > 0 && !route.goods.empty()) {
-                std::cout << "=== 貿易ルート活動 ===\n";
-                std::cout << "拠点" << route.from_location_id << " から 拠点" << route.to_location_id << " への貿易が実行されました\n";
-                std::cout << "輸送品目: ";
-                for (const auto& item : route.goods) {
-                    if (item.second > 0) {
-                        std::cout << item.first << "(" << item.second << "個) ";
+        {
+            TRACE_ZONE(trade_zone, "貿易ルート");
+            TRACE_COUNT(trade_zone, trade_routes.size());
+            for (auto& route : trade_routes) {
+                if (route.travel_time > 0 && !route.goods.empty()) {
+                    std::cout << "=== 貿易ルート活動 ===\n";
+                    std::cout << "拠点" << route.from_location_id << " から 拠点" << route.to_location_id << " への貿易が実行されました\n";
+                    std::cout << "輸送品目: ";
+                    for (const auto& item : route.goods) {
+                        if (item.second > 0) {
+                            std::cout << item.first << "(" << item.second << "個) ";
+                        }
                     }
+                    std::cout << " (移動時間: " << route.travel_time << "日)\n";
                 }
-                std::cout << " (移動時間: " << route.travel_time << "日)\n";
             }
         }
     
     // 市場への出品
-    for (auto& business : businesses) {
-        try {
-            // 商品が登録されていなければ登録
+    {
+        TRACE_ZONE(listing_zone, "出品");
+        TRACE_COUNT(listing_zone, businesses.size());
+        for (auto& business : businesses) {
             try {
-                market.getPrice(business.product);
-            } catch (const std::invalid_argument&) {
-                market.registerProduct(business.product, business.price);
-            }
+                // 商品が登録されていなければ登録
+                try {
+                    market.getPrice(business.product);
+                } catch (const std::invalid_argument&) {
+                    market.registerProduct(business.product, business.price);
+                }
             
-            // 在庫を市場に追加
-            market.sell(business.product, business.stock, business.price);
-            std::cout << business.product << "が" << business.stock << "個、" 
-                     << market.getPrice(business.product) << "コインで市場に出品されました。\n";
-            business.stock = 0;
-        } catch (const std::exception& e) {
-            std::cerr << "商品の出品中にエラーが発生: " << e.what() << "\n";
+                // 在庫を市場に追加
+                market.sell(business.product, business.stock, business.price);
+                std::cout << business.product << "が" << business.stock << "個、" 
+                         << market.getPrice(business.product) << "コインで市場に出品されました。\n";
+                business.stock = 0;
+            } catch (const std::exception& e) {
+                std::cerr << "商品の出品中にエラーが発生: " << e.what() << "\n";
+            }
         }
     }
     
     // 政府による税収
-    std::cout << "\n=== 政府活動 ===\n";
-    for (auto& person : people) {
-        if (person.money > 100) {  // 所持金が100以上の場合のみ課税
-            bool tax_collected = government.collectTax(&person);
-            if (tax_collected) {
-                std::cout << person.name << "から税金を徴収しました。\n";
+    {
+        TRACE_ZONE(tax_zone, "課税");
+        TRACE_COUNT(tax_zone, people.size());
+        std::cout << "\n=== 政府活動 ===\n";
+        for (auto& person : people) {
+            if (person.money > 100) {  // 所持金が100以上の場合のみ課税
+                bool tax_collected = government.collectTax(&person);
+                if (tax_collected) {
+                    std::cout << person.name << "から税金を徴収しました。\n";
+                }
             }
         }
     }
     
-    // 個人の消費活動
-    for (auto& person : people) {
-        // 収入を得る
+    // 収入と融資の申し込み（所持金が少ない場合）
+    std::vector<size_t> loan_applicants;
+    for (size_t i = 0; i < people.size(); ++i) {
+        Person& person = people[i];
         person.money += person.daily_income;
         std::cout << person.name << "が" << person.daily_income << "コインの収入を得ました。所持金: " << person.money << "\n";
-        
-        // 融資の検討（所持金が少ない場合）
         if (person.money < 50) {
-            bool loan_granted = loan_provider.provideLoan(&person, 100);
-            if (loan_granted) {
-                std::cout << person.name << "が100コインの融資を受けました。\n";
-            }
+            loan_applicants.push_back(i);
         }
-        
-        // 消費活動（例：食料を購入）
-        const std::string food = "小麦";
-        try {
-            if (market.getStock(food) > 0 && person.money >= market.getPrice(food)) {
-                int64_t cost = market.buy(food, 1);
-                person.money -= cost;
-                person.inventory.push_back(food);
-                std::cout << person.name << "が" << food << "を" << cost << "コインで購入しました。\n";
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "商品の購入中にエラーが発生: " << e.what() << "\n";
+    }
+    
+    // 融資の一括審査
+    {
+        TRACE_ZONE(loan_zone, "融資");
+        TRACE_COUNT(loan_zone, loan_applicants.size());
+        auto origination = loan_provider.originateLoans(people, loan_applicants, 100);
+        for (size_t i : origination.approved_indices) {
+            std::cout << people[i].name << "が100コインの融資を受けました。\n";
         }
+    }
+    
+    // 個人の消費活動
+    {
+        TRACE_ZONE(consumption_zone, "消費");
+        TRACE_COUNT(consumption_zone, people.size());
+        for (auto& person : people) {
+            // 消費活動（例：食料を購入）
+            constexpr GoodId food = Goods::WHEAT;
+            try {
+                if (market.getStock(food) > 0 && person.money >= market.getPrice(food)) {
+                    int64_t cost = market.buy(food, 1);
+                    person.money -= cost;
+                    person.inventory.push_back(GoodsCatalog::key(food));
+                    std::cout << person.name << "が" << GoodsCatalog::name(food) << "を" << cost << "コインで購入しました。\n";
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "商品の購入中にエラーが発生: " << e.what() << "\n";
+            }
         
-        // 満足度の更新（簡易版）
-        if (!person.inventory.empty()) {
-            int satisfaction_increase = 10;
-            person.setSatisfaction(std::min(100, person.satisfaction + satisfaction_increase));
-            std::cout << person.name << "の満足度が" << satisfaction_increase << "ポイント上昇し、" 
-                     << person.satisfaction << "になりました。\n";
-        } else {
-            int satisfaction_decrease = 5;
-            person.setSatisfaction(std::max(0, person.satisfaction - satisfaction_decrease));
-            std::cout << person.name << "の満足度が" << satisfaction_decrease << "ポイント低下し、" 
-                     << person.satisfaction << "になりました。\n";
+            // 満足度の更新（簡易版）
+            if (!person.inventory.empty()) {
+                int satisfaction_increase = 10;
+                person.setSatisfaction(std::min(100, person.satisfaction + satisfaction_increase));
+                std::cout << person.name << "の満足度が" << satisfaction_increase << "ポイント上昇し、" 
+                         << person.satisfaction << "になりました。\n";
+            } else {
+                int satisfaction_decrease = 5;
+                person.setSatisfaction(std::max(0, person.satisfaction - satisfaction_decrease));
+                std::cout << person.name << "の満足度が" << satisfaction_decrease << "ポイント低下し、" 
+                         << person.satisfaction << "になりました。\n";
+            }
+            person.inventory.clear();
         }
-        person.inventory.clear();
     }
     
     // 政府の政策実施
-    if (government.money > 500) {
-        std::cout << "\n=== 政府政策 ===\n";
-        // 補助金政策の例（各業者の业种に基づいて）
-        for (auto& business : businesses) {
-            if (business.product == "小麦") {
-                business.sector = "農業";
-            } else if (business.product == "パン") {
-                business.sector = "製造業";
-            }
-            
-            // 補助金制度を設定
-            government.sector_subsidies[business.sector] = 50.0f;
-            bool policy_implemented = government.implementPolicy("subsidy", &business);
-            if (policy_implemented) {
-                std::cout << business.product << "生産者(" << business.sector << ")に補助金を支給しました。\n";
+    {
+        TRACE_ZONE(policy_zone, "政策");
+        TRACE_COUNT(policy_zone, businesses.size());
+        if (government.money > 500) {
+            std::cout << "\n=== 政府政策 ===\n";
+            // 補助金政策（設定が変わったときだけコンパイルし直したルールを、業種索引で対象企業に一括適用）
+            for (const PolicyRule& rule : government.subsidyRules()) {
+                size_t applied = government.applyPolicy(rule, businesses, sectors);
+                if (applied > 0) {
+                    std::cout << rule.sector << "の" << applied << "社に補助金を支給しました。\n";
+                }
             }
         }
     }
@@ -152,6 +183,15 @@ void simulateDay(std::vector<Person>& people, std::vector<Business>& businesses,
     std::cout << "政府の資金: " << government.money << "コイン\n";
     std::cout << "政府の支持率: " << government.approval_rating << "%\n";
     
+    // 富の分布（全件ソートなしのスケッチで集計）
+    {
+        TRACE_ZONE(wealth_zone, "富の分布");
+        TRACE_COUNT(wealth_zone, people.size());
+        WealthSummary wealth = WealthSketch::fromAgents(people).summarize();
+        std::cout << "富の分布: Gini " << wealth.gini << ", 中央値 " << wealth.p50
+                 << ", p90 " << wealth.p90 << ", 上位1%のシェア " << wealth.top1_share * 100.0 << "%\n";
+    }
+    
     // 市場の日次更新
     market.clearDaily();
     
@@ -207,21 +247,46 @@ int main() {
     farm.product = "小麦";
     farm.daily_production = 10;
     farm.price = 5;
+    farm.workers = 5;
+    farm.sector = "農業";
     businesses.push_back(farm);
     
     Business bakery;
     bakery.product = "パン";
     bakery.daily_production = 5;
     bakery.price = 10;
+    bakery.workers = 5;
+    bakery.sector = "製造業";
     businesses.push_back(bakery);
     
+    // 業種索引と業種別の補助金制度
+    SectorIndex sectors;
+    sectors.rebuild(businesses);
+    government.setSubsidy("農業", 50.0f);
+    government.setSubsidy("製造業", 50.0f);
+    
+    // 生産レシピ（小麦 → パン）
+    ProductionGraph production;
+    production.addRecipe(Recipe("小麦", {}, 2));
+    production.addRecipe(Recipe("パン", {{"小麦", 1}}, 1));
+    
     std::cout << "=== 中世経済シミュレーション開始 ===\n";
     std::cout << "統合システム: 市場・政府・融資・貿易ルート\n\n";
     
-    // シミュレーション実行
+    // 暦と季節による生産量の変動（季節の始まりごとに業種別の倍率を生産に設定し直す）
+    Calendar calendar;
+    SeasonalProduction seasonal = SeasonalProduction::standard();
+    calendar.every(0, Calendar::DAYS_PER_SEASON, CalendarEvent{CalendarEventKind::SEASON_START});
+    
+    // シミュレーション実行（Day 1 = 暦の通し日数 0）
     for (int day = 1; day <= 5; ++day) {
-        std::cout << "\n=== Day " << day << " ===\n";
-        simulateDay(people, businesses, market, government, loan_provider, trade_routes);
+        for (const CalendarEvent& event : calendar.advanceTo(day - 1)) {
+            if (event.kind == CalendarEventKind::SEASON_START) {
+                seasonal.apply(production, businesses, sectors, Calendar::seasonOf(event.day));
+            }
+        }
+        std::cout << "\n=== Day " << day << "（" << Calendar::format(day - 1) << "）===\n";
+        simulateDay(people, businesses, market, government, loan_provider, trade_routes, production, sectors);
     }
     
     // エージェント間の直接取引の実例
@@ -295,6 +360,10 @@ int main() {
     std::cout << "政府最終資金: " << government.money << "コイン\n";
     std::cout << "政府最終支持率: " << government.approval_rating << "%\n";
     
+#ifdef ENABLE_TRACING
+    Tracer::instance().printSummary(std::cout);
+#endif
+    
     return 0;
     
     } catch (const std::exception& e) {
@@ -0,0 +1,42 @@
+// 2つの実行のハッシュ列（economy_driver --hash-out）を比べ、最初に食い違ったティックを報告する
+// 終了コード: 0 = 一致, 1 = 食い違いあり, 2 = 入力エラー
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "system/state_hash.h"
+
+static std::vector<StateHash> load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    return readHashStream(in);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "使い方: state_hash_diff <run_a.hash> <run_b.hash>\n";
+        return 2;
+    }
+    try {
+        const auto a = load(argv[1]);
+        const auto b = load(argv[2]);
+        const Divergence divergence = findFirstDivergence(a, b);
+        if (!divergence.diverged) {
+            std::cout << a.size() << "ティック一致しました。\n";
+            return 0;
+        }
+        if (divergence.length_mismatch) {
+            std::cout << "Day " << divergence.day << " 以降は片方にしか記録がありません（"
+                      << a.size() << " 行 / " << b.size() << " 行）。\n";
+        } else {
+            std::cout << "Day " << divergence.day << " で最初に食い違いました: "
+                      << divergence.components << "\n";
+        }
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "エラー: " << e.what() << "\n";
+        return 2;
+    }
+}
@@ -13,7 +13,7 @@ protected:
         // 基本設定
         government->tax_rate = 10; // 10%
         government->money = 1000;  // treasuryの代わりにmoneyを使用
-        government->sector_subsidies["agriculture"] = 100.0f; // 補助金額を設定
+        government->setSubsidy("agriculture", 100.0f); // 補助金額を設定
         
         citizen->money = 1000;
         
@@ -93,4 +93,128 @@ TEST_F(GovernmentTest, UpdateApprovalRating) {
     government->tax_rate = 20; // 税率を上げる
     government->updateApprovalRating();
     EXPECT_LT(government->approval_rating, after_subsidy); // 増税で承認率低下
-}
\ No newline at end of file
+}
+
+class PolicyEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        government.money = 1000;
+        government.approval_rating = 50.0f;
+        government.setSubsidy("農業", 100.0f);
+        for (int i = 0; i < 6; ++i) {
+            Business business;
+            business.sector = (i % 2 == 0) ? "農業" : "製造業";
+            business.price = 100;
+            businesses.push_back(business);
+        }
+        index.rebuild(businesses);
+    }
+
+    Government government;
+    std::vector<Business> businesses;
+    SectorIndex index;
+};
+
+TEST_F(PolicyEngineTest, CompilePolicy) {
+    PolicyRule subsidy = government.compilePolicy("subsidy", "農業");
+    EXPECT_EQ(subsidy.type, PolicyType::SUBSIDY);
+    EXPECT_EQ(subsidy.subsidy_amount, 100);
+
+    PolicyRule control = government.compilePolicy("price_control");
+    EXPECT_EQ(control.type, PolicyType::PRICE_CONTROL);
+    EXPECT_FLOAT_EQ(control.price_factor, 0.9f);
+
+    EXPECT_THROW(government.compilePolicy("unknown"), std::invalid_argument);
+    EXPECT_THROW(government.compilePolicy("subsidy", "鉱業"), std::invalid_argument);
+}
+
+TEST_F(PolicyEngineTest, CompiledRulesAreReusedUntilSettingsChange) {
+    const std::vector<PolicyRule>* rules = &government.subsidyRules();
+    ASSERT_EQ(rules->size(), 1u);
+    EXPECT_EQ((*rules)[0].sector, "農業");
+    EXPECT_EQ((*rules)[0].subsidy_amount, 100);
+    EXPECT_EQ(&government.subsidyRules(), rules);
+
+    government.setSubsidy("製造業", 40.0f);
+    government.setSubsidy("農業", 70.0f);
+    rules = &government.subsidyRules();
+    ASSERT_EQ(rules->size(), 2u);
+    EXPECT_EQ((*rules)[0].subsidy_amount, 40);   // 製造業
+    EXPECT_EQ((*rules)[1].subsidy_amount, 70);   // 農業
+    EXPECT_EQ(government.subsidies().at("農業"), 70.0f);
+
+    EXPECT_EQ(government.reliefRule().subsidy_amount, 0);
+    government.setRelief(25, 80);
+    EXPECT_EQ(government.reliefRule().type, PolicyType::RELIEF);
+    EXPECT_EQ(government.reliefRule().subsidy_amount, 25);
+    EXPECT_EQ(government.reliefRule().money_limit, 80);
+}
+
+TEST_F(PolicyEngineTest, BulkSubsidyTouchesOnlySector) {
+    PolicyRule rule = government.compilePolicy("subsidy", "農業");
+    size_t applied = government.applyPolicy(rule, businesses, index);
+
+    EXPECT_EQ(applied, 3);
+    EXPECT_EQ(government.money, 700);
+    for (size_t i = 0; i < businesses.size(); ++i) {
+        EXPECT_EQ(businesses[i].money, i % 2 == 0 ? 100 : 0);
+    }
+    EXPECT_EQ(government.policy_history.count(PolicyType::SUBSIDY), 3);
+    EXPECT_FLOAT_EQ(government.approval_rating, 65.0f);
+}
+
+TEST_F(PolicyEngineTest, BulkSubsidyStopsWhenFundsRunOut) {
+    government.money = 250;
+    PolicyRule rule = government.compilePolicy("subsidy", "農業");
+    EXPECT_EQ(government.applyPolicy(rule, businesses, index), 2);
+    EXPECT_EQ(government.money, 50);
+}
+
+TEST_F(PolicyEngineTest, PriceControlWithoutSectorAppliesToAll) {
+    PolicyRule rule = government.compilePolicy("price_control");
+    EXPECT_EQ(government.applyPolicy(rule, businesses, index), 6);
+    for (const auto& business : businesses) {
+        EXPECT_EQ(business.price, 90);
+    }
+    EXPECT_EQ(government.policy_history.count(PolicyType::PRICE_CONTROL), 6);
+}
+
+TEST_F(PolicyEngineTest, HistoryIsCompact) {
+    Business target;
+    target.sector = "農業";
+    for (int i = 0; i < 5; ++i) {
+        government.implementPolicy("subsidy", &target);
+    }
+    EXPECT_EQ(government.policy_history.total(), 5);
+    EXPECT_FALSE(government.implementPolicy("unknown", &target));
+    EXPECT_EQ(government.policy_history.total(), 5);
+}
+
+TEST_F(PolicyEngineTest, ReliefTargetsSickPoorCitizens) {
+    std::vector<Person> people(8);
+    for (size_t i = 0; i < people.size(); ++i) {
+        people[i].job = i < 4 ? "農業" : "鉱業";
+        people[i].money = i % 2 == 0 ? 50 : 500;
+        if (i != 0 && i != 4) people[i].setHealthStatus(HealthStatus::SICK);
+    }
+    const std::vector<size_t> everyone = {0, 1, 2, 3, 4, 5, 6, 7};
+    government.setRelief(30, 100);
+
+    // 病気で所持金が100未満なのは 2 と 6 だけ
+    PolicyRule rule = government.compilePolicy("relief");
+    EXPECT_EQ(rule.type, PolicyType::RELIEF);
+    EXPECT_EQ(government.grantRelief(rule, people, everyone), 2u);
+    EXPECT_EQ(people[2].money, 80);
+    EXPECT_EQ(people[6].money, 80);
+    EXPECT_EQ(people[0].money, 50);
+    EXPECT_EQ(government.money, 940);
+    EXPECT_EQ(government.policy_history.count(PolicyType::RELIEF), 2);
+
+    // 職業を指定すると、その職業の住民だけが対象になる
+    people[2].money = 10;
+    people[6].money = 10;
+    rule.sector = "鉱業";
+    EXPECT_EQ(government.grantRelief(rule, people, everyone), 1u);
+    EXPECT_EQ(people[2].money, 10);
+    EXPECT_EQ(people[6].money, 40);
+}
@@ -78,4 +78,134 @@ TEST_F(LoanProviderTest, ProvideLoan_NullBorrower) {
     EXPECT_FALSE(result);
     EXPECT_EQ(lender->money, 1000); // 変化なし
     EXPECT_TRUE(lender->active_loans.empty());
-}
\ No newline at end of file
+}
+
+class LoanOriginationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        lender.id = 1;
+        lender.money = 250;
+
+        // 0: 手元資金も純収入もある堅実な借り手
+        people.push_back(makePerson(10, 80, 100, 20, 20));
+        // 1: 純収入はあるが資金ゼロ
+        people.push_back(makePerson(11, 0, 30, 20, 50));
+        // 2: 収支が赤字でリスク選好が高い
+        people.push_back(makePerson(12, 0, 10, 40, 100));
+        // 3: 中程度
+        people.push_back(makePerson(13, 30, 25, 20, 50));
+    }
+
+    Person makePerson(int64_t id, int64_t money, int32_t income, int32_t expense, int32_t risk) {
+        Person person;
+        person.id = id;
+        person.money = money;
+        person.setDailyIncome(income);
+        person.setDailyExpense(expense);
+        person.setRiskTolerance(risk);
+        return person;
+    }
+
+    LoanProvider lender;
+    std::vector<Person> people;
+};
+
+TEST_F(LoanOriginationTest, ScoresRankCreditworthiness) {
+    auto score = lender.scoreApplicants(people, {0, 1, 2, 3}, 100);
+    ASSERT_EQ(score.size(), 4);
+    EXPECT_GT(score[0], score[3]);
+    EXPECT_GT(score[3], score[2]);
+    EXPECT_GT(score[1], score[2]);
+    for (float s : score) {
+        EXPECT_GE(s, 0.0f);
+        EXPECT_LE(s, 1.0f);
+    }
+}
+
+TEST_F(LoanOriginationTest, RiskAdjustedRates) {
+    EXPECT_FLOAT_EQ(lender.priceRisk(1.0f), lender.base_interest_rate);
+    EXPECT_FLOAT_EQ(lender.priceRisk(0.0f), lender.base_interest_rate + lender.max_risk_premium);
+    EXPECT_GT(lender.priceRisk(0.3f), lender.priceRisk(0.8f));
+}
+
+TEST_F(LoanOriginationTest, CapitalAllocatedByScore) {
+    auto report = lender.originateLoans(people, {0, 1, 2, 3}, 100);
+
+    // 資金250では2件のみ。スコア上位の0と3が選ばれ、赤字の2は審査落ち
+    EXPECT_EQ(report.approved, 2);
+    EXPECT_EQ(report.rejected, 2);
+    EXPECT_EQ(report.capital_lent, 200);
+    EXPECT_EQ(lender.money, 50);
+    ASSERT_EQ(report.approved_indices.size(), 2);
+    EXPECT_EQ(report.approved_indices[0], 0);
+    EXPECT_EQ(report.approved_indices[1], 3);
+    EXPECT_EQ(people[0].money, 180);
+    EXPECT_EQ(people[2].money, 0);
+
+    ASSERT_EQ(lender.active_loans.size(), 2);
+    EXPECT_EQ(lender.active_loans[0].borrower_id, 10);
+    EXPECT_EQ(lender.active_loans[0].days_remaining, lender.loan_term_days);
+    EXPECT_LT(lender.active_loans[0].interest_rate, lender.active_loans[1].interest_rate);
+}
+
+TEST_F(LoanOriginationTest, LoanIdsSurviveClosingOtherLoans) {
+    lender.money = 10000;
+    auto report = lender.originateLoans(people, {0, 1, 3}, 100);
+    ASSERT_EQ(report.approved_loans.size(), 3);
+    EXPECT_EQ(report.approved_loans, (std::vector<int64_t>{1, 2, 3}));
+
+    // 先頭の融資を取り除いても、残りの融資は同じ番号で引ける
+    const int64_t last_borrower = lender.findLoan(3)->borrower_id;
+    EXPECT_TRUE(lender.closeLoan(1));
+    EXPECT_FALSE(lender.closeLoan(1));
+    EXPECT_EQ(lender.findLoan(1), nullptr);
+    ASSERT_EQ(lender.active_loans.size(), 2);
+    ASSERT_NE(lender.findLoan(3), nullptr);
+    EXPECT_EQ(lender.findLoan(3)->borrower_id, last_borrower);
+
+    // 番号は再利用しない
+    EXPECT_EQ(lender.originateLoans(people, {0}, 100).approved_loans, (std::vector<int64_t>{4}));
+    lender.reindexLoans();
+    EXPECT_EQ(lender.findLoan(4)->loan_id, 4);
+    lender.active_loans.push_back(lender.active_loans[0]);
+    EXPECT_THROW(lender.reindexLoans(), std::runtime_error);
+}
+
+TEST_F(LoanOriginationTest, MinimumScoreRejects) {
+    lender.money = 10000;
+    lender.min_credit_score = 0.99f;
+    auto report = lender.originateLoans(people, {0, 1, 2, 3}, 100);
+    EXPECT_EQ(report.approved, 0);
+    EXPECT_EQ(report.rejected, 4);
+    EXPECT_EQ(lender.money, 10000);
+}
+
+TEST_F(LoanOriginationTest, InvalidAmountRejectsAll) {
+    auto report = lender.originateLoans(people, {0, 1}, 0);
+    EXPECT_EQ(report.approved, 0);
+    EXPECT_EQ(report.rejected, 2);
+    EXPECT_TRUE(lender.active_loans.empty());
+}
+
+TEST(LoanSettlementTest, RepaysPrincipalWithInterestOrDefaults) {
+    LoanProvider provider;
+    provider.money = 0;
+    Person borrower;
+    borrower.money = 200;
+
+    Loan loan;
+    loan.amount = 100;
+    loan.interest_rate = 0.1f;
+    loan.days_remaining = 30;
+    EXPECT_TRUE(provider.settleLoan(loan, borrower));
+    EXPECT_EQ(borrower.money, 90);
+    EXPECT_EQ(provider.money, 110);
+    EXPECT_EQ(loan.days_remaining, 0);
+    EXPECT_FALSE(provider.settleLoan(loan, borrower));  // 清算済み
+
+    Loan unpaid = loan;
+    unpaid.days_remaining = 30;
+    EXPECT_FALSE(provider.settleLoan(unpaid, borrower));
+    EXPECT_TRUE(unpaid.defaulted);
+    EXPECT_EQ(borrower.money, 90);
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "agent/message_bus.h"
+#include "agent/person.h"
+#include "system/thread_pool.h"
+
+class MessageBusTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        buyer.id = 1;
+        buyer.money = 300;
+        seller.id = 2;
+        seller.money = 200;
+    }
+
+    Person buyer;
+    Person seller;
+    MessageBus bus;
+};
+
+TEST_F(MessageBusTest, ProposalsDoNotMutateUntilSettled) {
+    bus.proposeTrade(&buyer, &seller, "道具", 2, 25);
+    EXPECT_EQ(bus.pending(), 1);
+    EXPECT_EQ(buyer.money, 300);
+    EXPECT_EQ(seller.money, 200);
+
+    SettlementReport report = bus.settle();
+
+    EXPECT_EQ(report.accepted, 1);
+    EXPECT_EQ(report.volume, 50);
+    EXPECT_EQ(buyer.money, 250);
+    EXPECT_EQ(seller.money, 250);
+    EXPECT_EQ(bus.pending(), 0);
+}
+
+TEST_F(MessageBusTest, LoanAndServiceDirections) {
+    bus.proposeLoan(&buyer, &seller, 100, 5.0f);       // seller が buyer に貸す
+    bus.proposeService(&seller, &buyer, "相談", 75);    // buyer が seller に支払う
+    bus.settle();
+
+    EXPECT_EQ(buyer.money, 300 + 100 - 75);
+    EXPECT_EQ(seller.money, 200 - 100 + 75);
+}
+
+TEST_F(MessageBusTest, InvalidProposalsRejected) {
+    bus.proposeTrade(&buyer, &seller, "道具", 1, 1000);  // 資金不足
+    bus.proposeTrade(&buyer, &buyer, "道具", 1, 1);      // 自己取引
+    bus.proposeTrade(&buyer, nullptr, "道具", 1, 1);
+    bus.proposeLoan(&buyer, &seller, -5, 1.0f);
+
+    SettlementReport report = bus.settle();
+
+    EXPECT_EQ(report.accepted, 0);
+    EXPECT_EQ(report.rejected, 4);
+    EXPECT_EQ(buyer.money, 300);
+    EXPECT_EQ(seller.money, 200);
+}
+
+TEST_F(MessageBusTest, SettlementOrderIsDeterministic) {
+    // 資金が足りるのは先に適用される1件のみ
+    Person poor;
+    poor.id = 3;
+    poor.money = 60;
+    Person late_seller;
+    late_seller.id = 5;
+    Person early_seller;
+    early_seller.id = 4;
+
+    bus.proposeTrade(&poor, &late_seller, "布", 1, 50);
+    bus.proposeTrade(&poor, &early_seller, "布", 1, 50);
+    bus.settle();
+
+    // 相手ID順（4 → 5）で適用される
+    EXPECT_EQ(early_seller.money, 50);
+    EXPECT_EQ(late_seller.money, 0);
+    EXPECT_EQ(poor.money, 10);
+}
+
+TEST_F(MessageBusTest, SamePairOrderDoesNotDependOnPostingThread) {
+    // 同じ相手と送信者の申し込みが別々のスレッドから届いても、中身で並べて適用する
+    auto settleFrom = [](bool cheap_first) {
+        Person poor;
+        poor.id = 3;
+        poor.money = 60;
+        Person seller;
+        seller.id = 4;
+        MessageBus bus;
+        auto propose = [&](int64_t price) { bus.proposeTrade(&poor, &seller, "布", 1, price); };
+        std::thread first(propose, cheap_first ? 30 : 50);
+        first.join();
+        std::thread second(propose, cheap_first ? 50 : 30);
+        second.join();
+        bus.settle();
+        return poor.money;
+    };
+    EXPECT_EQ(settleFrom(true), 30);   // 金額の小さい申し込みから適用される
+    EXPECT_EQ(settleFrom(false), 30);
+}
+
+TEST_F(MessageBusTest, ParallelPostingMatchesSerial) {
+    auto makePeople = [] {
+        std::vector<Person> people(64);
+        for (size_t i = 0; i < people.size(); ++i) {
+            people[i].id = static_cast<int64_t>(i + 1);
+            people[i].money = 100 + static_cast<int64_t>(i);
+        }
+        return people;
+    };
+    auto propose = [](MessageBus& bus, std::vector<Person>& people, size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            Person& counterparty = people[(i * 7 + 3) % people.size()];
+            bus.proposeTrade(&people[i], &counterparty, "麦", 1, 40 + static_cast<int64_t>(i % 30));
+            bus.proposeService(&people[i], &people[(i + 1) % people.size()], "運搬", 15);
+        }
+    };
+
+    std::vector<Person> serial = makePeople();
+    MessageBus serial_bus;
+    propose(serial_bus, serial, 0, serial.size());
+    SettlementReport serial_report = serial_bus.settle();
+
+    std::vector<Person> parallel = makePeople();
+    MessageBus parallel_bus;
+    ThreadPool pool(4);
+    pool.parallelFor(0, parallel.size(), [&](size_t lo, size_t hi) {
+        propose(parallel_bus, parallel, lo, hi);
+    }, 8);
+    SettlementReport parallel_report = parallel_bus.settle();
+
+    EXPECT_EQ(serial_report.accepted, parallel_report.accepted);
+    EXPECT_EQ(serial_report.volume, parallel_report.volume);
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i].money, parallel[i].money);
+    }
+}
+
+TEST_F(MessageBusTest, ThreadSwitchesBetweenBusesAndOutlivesThem) {
+    // 1つのスレッドが複数のバスに交互に投稿しても、それぞれのバスのレーンに積まれる
+    MessageBus other;
+    bus.proposeTrade(&buyer, &seller, "道具", 1, 10);
+    other.proposeTrade(&buyer, &seller, "道具", 1, 20);
+    bus.proposeTrade(&buyer, &seller, "道具", 1, 30);
+    EXPECT_EQ(bus.pending(), 2);
+    EXPECT_EQ(other.pending(), 1);
+    EXPECT_EQ(bus.settle().volume, 40);
+    EXPECT_EQ(other.settle().volume, 20);
+
+    // 破棄されたバスのレーンを覚えていても、次に作ったバスには新しいレーンが割り当てられる
+    for (int i = 0; i < 100; ++i) {
+        MessageBus temporary;
+        temporary.proposeService(&seller, &buyer, "相談", 1);
+        EXPECT_EQ(temporary.pending(), 1);
+        EXPECT_EQ(temporary.settle().accepted, 1);
+    }
+    EXPECT_EQ(buyer.money, 300 - 60 - 100);
+    EXPECT_EQ(seller.money, 200 + 60 + 100);
+}
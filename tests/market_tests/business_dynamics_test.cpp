@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <vector>
+#include "market/business_dynamics.h"
+#include "market/production.h"
+#include "system/thread_pool.h"
+
+namespace {
+Business makeBusiness(const std::string& sector, const std::string& product, int64_t price, int32_t workers) {
+    Business business;
+    business.sector = sector;
+    business.product = product;
+    business.price = price;
+    business.workers = workers;
+    business.daily_production = workers;
+    return business;
+}
+
+std::vector<Business> randomFirms(size_t count, uint64_t seed) {
+    const char* sectors[] = {"農業", "製造業", "鉱業"};
+    const char* products[] = {"小麦", "パン", "鉄", "道具"};
+    std::mt19937_64 rng(seed);
+    std::vector<Business> firms;
+    for (size_t i = 0; i < count; ++i) {
+        firms.push_back(makeBusiness(sectors[rng() % 3], products[rng() % 4], 5 + static_cast<int64_t>(rng() % 30),
+                                     1 + static_cast<int32_t>(rng() % 10)));
+    }
+    return firms;
+}
+}  // namespace
+
+TEST(BusinessDynamicsTest, SegmentsBySectorAndProduct) {
+    std::vector<Business> firms = {makeBusiness("農業", "小麦", 10, 1), makeBusiness("製造業", "パン", 10, 1),
+                                   makeBusiness("農業", "小麦", 10, 1), makeBusiness("農業", "パン", 10, 1)};
+    BusinessDynamics dynamics;
+    dynamics.rebuild(firms);
+
+    ASSERT_EQ(dynamics.segmentCount(), 3u);
+    std::set<std::vector<uint32_t>> segments;
+    for (size_t s = 0; s < dynamics.segmentCount(); ++s) segments.insert(dynamics.segment(s));
+    EXPECT_TRUE(segments.count({0, 2}));
+    EXPECT_TRUE(segments.count({1}));
+    EXPECT_TRUE(segments.count({3}));
+    EXPECT_EQ(dynamics.products(), (std::vector<std::string>{"パン", "小麦"}));
+    EXPECT_EQ(dynamics.productOf(0), 1);
+}
+
+TEST(BusinessDynamicsTest, ComputesRevenueShareAndMargin) {
+    std::vector<Business> firms = {makeBusiness("農業", "小麦", 20, 2), makeBusiness("農業", "小麦", 10, 2),
+                                   makeBusiness("鉱業", "鉄", 50, 1)};
+    BusinessDynamics dynamics;
+    PricingConfig config;
+    config.adjust_rate = 0.0f;
+    config.competition = 0.0f;
+    const BusinessTickReport report = dynamics.update(firms, {30, 40, 0}, {}, config);
+
+    EXPECT_EQ(report.segments, 2u);
+    EXPECT_EQ(report.revenue, 1000);
+    EXPECT_EQ(dynamics.revenue(), (std::vector<int64_t>{600, 400, 0}));
+    EXPECT_EQ(firms[0].market_share, 60);
+    EXPECT_EQ(firms[1].market_share, 40);
+    EXPECT_EQ(firms[2].market_share, 100);  // 売上がなければ均等割り
+    // 単位費用は wage（1人1単位）なので利益率は (価格 - 10) / 価格
+    EXPECT_FLOAT_EQ(firms[0].profit_margin, 0.5f);
+    EXPECT_FLOAT_EQ(firms[1].profit_margin, 0.0f);
+    EXPECT_FLOAT_EQ(firms[2].profit_margin, 0.8f);
+    EXPECT_EQ(firms[0].price, 20);
+}
+
+TEST(BusinessDynamicsTest, AllocatesSalesCheapestFirst) {
+    // 小麦は安い順（10 → 12 の2社 → 20）に売れ、同じ売値の2社は出品数量に比例して分ける
+    std::vector<Business> firms = {makeBusiness("農業", "小麦", 20, 1), makeBusiness("農業", "小麦", 10, 1),
+                                   makeBusiness("農業", "小麦", 12, 1), makeBusiness("農業", "小麦", 12, 1),
+                                   makeBusiness("鉱業", "鉄", 50, 1)};
+    BusinessDynamics dynamics;
+    dynamics.rebuild(firms);
+    ASSERT_EQ(dynamics.products(), (std::vector<std::string>{"小麦", "鉄"}));
+    const std::vector<int64_t> listed = {10, 10, 10, 20, 5};
+    EXPECT_EQ(dynamics.allocateSales(firms, listed, {25, 9}), (std::vector<int64_t>{0, 10, 5, 10, 5}));
+    EXPECT_EQ(dynamics.allocateSales(firms, listed, {24, 0}), (std::vector<int64_t>{0, 10, 5, 9, 0}));
+
+    // 約定価格での売上から市場シェアを決めるので、高い売値の企業は売れないぶんシェアを失う
+    PricingConfig config;
+    config.adjust_rate = 0.0f;
+    config.competition = 0.0f;
+    const auto units = dynamics.allocateSales(firms, listed, {40, 5});
+    const BusinessTickReport report = dynamics.update(firms, units, {}, config, nullptr, {15, 40});
+    EXPECT_EQ(report.revenue, 40 * 15 + 5 * 40);
+    EXPECT_EQ(dynamics.revenue(), (std::vector<int64_t>{0, 150, 150, 300, 200}));
+    EXPECT_EQ(firms[0].market_share, 0);
+    EXPECT_EQ(firms[3].market_share, 50);
+    EXPECT_THROW(dynamics.allocateSales(firms, {1}, {0, 0}), std::invalid_argument);
+    EXPECT_THROW(dynamics.update(firms, units, {}, config, nullptr, {15}), std::invalid_argument);
+}
+
+TEST(BusinessDynamicsTest, UnitCostUsesProductionGraphOutput) {
+    // 小麦は1人2単位なので、2人の農場の産出量は daily_production の2単位ではなく4単位
+    // レシピのない鉄は daily_production（0）がそのまま産出量になる
+    std::vector<Business> firms = {makeBusiness("農業", "小麦", 20, 2), makeBusiness("鉱業", "鉄", 50, 2)};
+    firms[1].daily_production = 0;
+    ProductionGraph graph;
+    graph.addRecipe(Recipe("小麦", {}, 2));
+    const std::vector<int32_t> output = graph.plannedOutput(firms);
+    ASSERT_EQ(output, (std::vector<int32_t>{4, 0}));
+
+    BusinessDynamics dynamics;
+    PricingConfig config;
+    config.adjust_rate = 0.0f;
+    config.competition = 0.0f;
+    dynamics.update(firms, {}, output, config);
+    EXPECT_FLOAT_EQ(firms[0].profit_margin, 0.75f);  // 単位費用 10 * 2 / 4 = 5
+    EXPECT_FLOAT_EQ(firms[1].profit_margin, 0.6f);   // 産出がなければ1単位とみなす: 10 * 2 / 1 = 20
+    EXPECT_THROW(dynamics.update(firms, {}, {1}), std::invalid_argument);
+}
+
+TEST(BusinessDynamicsTest, PricesConvergeTowardTargetAndSegmentMean) {
+    std::vector<Business> firms = {makeBusiness("農業", "小麦", 40, 1), makeBusiness("農業", "小麦", 5, 1)};
+    BusinessDynamics dynamics;
+    for (int day = 0; day < 200; ++day) dynamics.update(firms, {10, 10}, {});
+    // 目標価格は 10 / (1 - 0.2) = 12.5
+    EXPECT_NEAR(static_cast<double>(firms[0].price), 12.5, 1.0);
+    EXPECT_NEAR(static_cast<double>(firms[1].price), 12.5, 1.0);
+    EXPECT_NEAR(firms[0].profit_margin, 0.2f, 0.1f);
+    EXPECT_THROW(dynamics.update(firms, {1}, {}), std::invalid_argument);
+    PricingConfig bad;
+    bad.target_margin = 1.0f;
+    EXPECT_THROW(dynamics.update(firms, {}, {}, bad), std::invalid_argument);
+}
+
+TEST(BusinessDynamicsTest, ParallelMatchesSequential) {
+    std::vector<Business> sequential = randomFirms(20000, 8);
+    std::vector<Business> parallel = sequential;
+    std::vector<int64_t> sold(sequential.size());
+    std::mt19937_64 rng(2);
+    for (auto& units : sold) units = static_cast<int64_t>(rng() % 50);
+
+    BusinessDynamics a;
+    BusinessDynamics b;
+    ThreadPool pool(4);
+    for (int day = 0; day < 3; ++day) {
+        const auto expected = a.update(sequential, sold, {});
+        const auto actual = b.update(parallel, sold, {}, {}, &pool);
+        EXPECT_EQ(actual.revenue, expected.revenue);
+    }
+    for (size_t i = 0; i < sequential.size(); ++i) {
+        ASSERT_EQ(parallel[i].price, sequential[i].price);
+        ASSERT_EQ(parallel[i].market_share, sequential[i].market_share);
+        ASSERT_EQ(parallel[i].profit_margin, sequential[i].profit_margin);
+    }
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "market/goods_catalog.h"
+#include "market/market.h"
+
+// 定数式で解決できること（実行時の文字列処理なし）
+static_assert(Goods::WHEAT == 0, "小麦 is the first built-in good");
+static_assert(GoodsCatalog::find("道具") == Goods::TOOL, "find resolves at compile time");
+static_assert(GoodsCatalog::find("石炭") == GoodsCatalog::NONE, "unknown goods are not built in");
+static_assert(GoodsCatalog::sector(Goods::ORE) == "鉱業", "sector is part of the catalog");
+
+TEST(GoodsCatalogTest, EveryBuiltinRoundTrips) {
+    for (size_t i = 0; i < GoodsCatalog::BUILTIN_COUNT; ++i) {
+        const GoodId id = static_cast<GoodId>(i);
+        EXPECT_EQ(GoodsCatalog::find(GoodsCatalog::name(id)), id);
+        EXPECT_EQ(GoodsCatalog::key(id), std::string(GoodsCatalog::name(id)));
+    }
+    EXPECT_THROW(GoodsCatalog::id("石炭"), std::invalid_argument);
+    EXPECT_EQ(GoodsCatalog::find(""), GoodsCatalog::NONE);
+    EXPECT_EQ(GoodsCatalog::find("小麦粉"), GoodsCatalog::NONE);
+}
+
+TEST(GoodsCatalogTest, RegistryAssignsCustomIdsAfterBuiltins) {
+    GoodsRegistry registry;
+    EXPECT_EQ(registry.intern("パン"), Goods::BREAD);
+    const GoodId coal = registry.intern("石炭");
+    const GoodId salt = registry.intern("塩");
+
+    EXPECT_EQ(coal, GoodsCatalog::BUILTIN_COUNT);
+    EXPECT_EQ(salt, GoodsCatalog::BUILTIN_COUNT + 1);
+    EXPECT_EQ(registry.intern("石炭"), coal);
+    EXPECT_EQ(registry.find("塩"), salt);
+    EXPECT_EQ(registry.find("絹"), GoodsCatalog::NONE);
+    EXPECT_EQ(registry.name(coal), "石炭");
+    EXPECT_EQ(registry.name(Goods::IRON), "鉄");
+    EXPECT_EQ(registry.size(), GoodsCatalog::BUILTIN_COUNT + 2);
+    EXPECT_THROW(registry.name(static_cast<GoodId>(registry.size())), std::out_of_range);
+}
+
+TEST(GoodsCatalogTest, MarketIdPathMatchesStringPath) {
+    Market by_name;
+    Market by_id;
+    for (Market* market : {&by_name, &by_id}) {
+        market->sell("小麦", 50, 8);
+        market->sell("パン", 5, 20);
+    }
+    EXPECT_EQ(by_id.getPrice(Goods::WHEAT), by_name.getPrice("小麦"));
+    EXPECT_EQ(by_id.getStock(Goods::BREAD), 5);
+    EXPECT_EQ(by_id.getPrice(Goods::TOOL), 0);
+    EXPECT_THROW(by_id.buy(Goods::TOOL, 1), std::invalid_argument);
+    EXPECT_THROW(by_id.buy(Goods::BREAD, 6), std::invalid_argument);
+
+    for (int i = 0; i < 30; ++i) {
+        EXPECT_EQ(by_id.buy(Goods::WHEAT, 1), by_name.buy("小麦", 1));
+    }
+    EXPECT_EQ(by_id.getStock("小麦"), by_name.getStock("小麦"));
+    EXPECT_EQ(by_id.getPrice(Goods::WHEAT), by_name.getPrice("小麦"));
+    EXPECT_FLOAT_EQ(by_id.getPriceVolatility(), by_name.getPriceVolatility());
+
+    // コピーは自分のマップを指す
+    Market copy = by_id;
+    copy.buy(Goods::WHEAT, 1);
+    EXPECT_EQ(copy.getStock(Goods::WHEAT), by_id.getStock(Goods::WHEAT) - 1);
+}
+
+TEST(GoodsCatalogTest, BuiltinLookupIsReadOnly) {
+    Market market;
+    market.sell("道具", 3, 40);
+    Market copy = market;
+    copy.sell("鉄", 7, 25);
+
+    // const の参照からは状態を書き換えずに引けるので、複数のスレッドから同時に読んでよい
+    const Market& shared = copy;
+    std::vector<std::thread> readers;
+    std::vector<int> seen(4, 0);
+    for (size_t t = 0; t < seen.size(); ++t) {
+        readers.emplace_back([&shared, &seen, t] {
+            for (int i = 0; i < 1000; ++i) seen[t] = shared.getStock(Goods::IRON) + shared.getPrice(Goods::TOOL);
+        });
+    }
+    for (auto& reader : readers) reader.join();
+    for (int value : seen) EXPECT_EQ(value, 7 + 40);
+    EXPECT_EQ(market.getStock(Goods::IRON), 0);
+}
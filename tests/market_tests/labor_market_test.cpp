@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "market/labor_market.h"
+#include "system/thread_pool.h"
+
+class LaborMarketTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (int i = 0; i < 4; ++i) {
+            Person person;
+            person.job = "農業";
+            person.setDailyExpense(10 + i * 10);  // 留保賃金 10, 20, 30, 40
+            people.push_back(person);
+        }
+        Business farm;
+        farm.product = "小麦";
+        farm.money = 1000;
+        businesses.push_back(farm);
+
+        Business mill;
+        mill.product = "小麦粉";
+        mill.money = 1000;
+        businesses.push_back(mill);
+    }
+
+    std::vector<Person> people;
+    std::vector<Business> businesses;
+    LaborMarket labor;
+};
+
+TEST_F(LaborMarketTest, Match_HighestWageGetsCheapestSeekers) {
+    labor.collectSeekers(people);
+    labor.postOpening(0, "農業", 25, 1);
+    labor.postOpening(1, "農業", 35, 2);
+
+    size_t hires = labor.match(businesses);
+
+    EXPECT_EQ(hires, 2);
+    // 賃金35の求人に留保賃金10と20の二人、賃金25の求人に留保賃金30は不成立
+    EXPECT_EQ(labor.employerOf(0), 1);
+    EXPECT_EQ(labor.employerOf(1), 1);
+    EXPECT_EQ(labor.employerOf(2), LaborMarket::NO_EMPLOYER);
+    EXPECT_EQ(labor.employerOf(3), LaborMarket::NO_EMPLOYER);
+    EXPECT_EQ(businesses[1].workers, 2);
+    EXPECT_EQ(labor.wageOf(0), 35);
+}
+
+TEST_F(LaborMarketTest, Match_OccupationsAreSeparate) {
+    labor.seekJob(0, "鍛冶", 0);
+    labor.postOpening(0, "農業", 100, 5);
+
+    EXPECT_EQ(labor.match(businesses), 0);
+    EXPECT_EQ(labor.employerOf(0), LaborMarket::NO_EMPLOYER);
+}
+
+TEST_F(LaborMarketTest, Match_EmployedPeopleDoNotSeek) {
+    labor.collectSeekers(people);
+    labor.postOpening(0, "農業", 100, 4);
+    labor.match(businesses);
+
+    labor.collectSeekers(people);
+    labor.postOpening(1, "農業", 200, 4);
+    EXPECT_EQ(labor.match(businesses), 0);
+    EXPECT_EQ(businesses[0].workers, 4);
+}
+
+TEST_F(LaborMarketTest, Release_UpdatesIndex) {
+    labor.collectSeekers(people);
+    labor.postOpening(0, "農業", 100, 4);
+    labor.match(businesses);
+
+    labor.release(1, businesses);
+
+    EXPECT_EQ(labor.employerOf(1), LaborMarket::NO_EMPLOYER);
+    EXPECT_EQ(labor.employeesOf(0).size(), 3);
+    EXPECT_EQ(businesses[0].workers, 3);
+    for (size_t p : labor.employeesOf(0)) EXPECT_NE(p, 1);
+}
+
+TEST_F(LaborMarketTest, Payroll_TransfersWages) {
+    labor.collectSeekers(people);
+    labor.postOpening(0, "農業", 50, 2);
+    labor.match(businesses);
+
+    ThreadPool pool(2);
+    int64_t paid = labor.runPayroll(people, businesses, &pool);
+
+    EXPECT_EQ(paid, 100);
+    EXPECT_EQ(businesses[0].money, 900);
+    EXPECT_EQ(people[0].money, 50);
+    EXPECT_EQ(people[1].money, 50);
+    EXPECT_EQ(people[2].money, 0);
+}
+
+TEST_F(LaborMarketTest, PostPayroll_QueuesWagesUntilSettled) {
+    labor.collectSeekers(people);
+    labor.postOpening(0, "農業", 50, 2);
+    labor.match(businesses);
+
+    MessageBus bus;
+    labor.postPayroll(bus, people, businesses);
+    EXPECT_EQ(bus.pending(), 2);
+    EXPECT_EQ(businesses[0].money, 1000);
+    EXPECT_EQ(people[0].money, 0);
+
+    const SettlementReport report = bus.settle();
+    EXPECT_EQ(report.accepted, 2);
+    EXPECT_EQ(report.volume, 100);
+    EXPECT_EQ(businesses[0].money, 900);
+    EXPECT_EQ(people[0].money, 50);
+}
+
+TEST_F(LaborMarketTest, Payroll_InsolventBusinessLaysOff) {
+    labor.collectSeekers(people);
+    labor.postOpening(0, "農業", 600, 2);
+    labor.match(businesses);
+
+    int64_t paid = labor.runPayroll(people, businesses);
+
+    EXPECT_EQ(paid, 0);
+    EXPECT_EQ(businesses[0].money, 1000);
+    EXPECT_EQ(people[0].money, 0);
+    EXPECT_EQ(businesses[0].workers, 0);
+    EXPECT_EQ(labor.employerOf(0), LaborMarket::NO_EMPLOYER);
+}
+
+TEST_F(LaborMarketTest, CollectSeekers_OnlyListedPeople) {
+    const std::vector<size_t> listed = {1, 3};
+    labor.collectSeekers(people, &listed);
+    labor.postOpening(0, "農業", 100, 4);
+
+    EXPECT_EQ(labor.match(businesses), 2);
+    EXPECT_EQ(labor.employerOf(0), LaborMarket::NO_EMPLOYER);
+    EXPECT_EQ(labor.employerOf(1), 0);
+    EXPECT_EQ(labor.employerOf(3), 0);
+}
+
+TEST_F(LaborMarketTest, Restore_RebuildsEmployeeIndex) {
+    labor.collectSeekers(people);
+    labor.postOpening(0, "農業", 50, 2);
+    labor.postOpening(1, "農業", 35, 1);
+    labor.match(businesses);
+
+    LaborMarket restored;
+    restored.restore(labor.employers(), labor.wages());
+    restored.reindex(businesses.size());
+    for (size_t p = 0; p < people.size(); ++p) {
+        EXPECT_EQ(restored.employerOf(p), labor.employerOf(p));
+        EXPECT_EQ(restored.wageOf(p), labor.wageOf(p));
+    }
+    EXPECT_EQ(restored.employeesOf(0).size(), 2);
+    EXPECT_EQ(restored.employeesOf(1).size(), 1);
+
+    restored.release(0, businesses);
+    EXPECT_EQ(restored.employeesOf(0).size(), 1);
+    EXPECT_EQ(businesses[0].workers, 1);
+
+    EXPECT_THROW(restored.reindex(1), std::runtime_error);
+    EXPECT_THROW(restored.restore({0}, {}), std::runtime_error);
+}
+
+TEST_F(LaborMarketTest, InvalidArguments_Throw) {
+    EXPECT_THROW(labor.postOpening(0, "農業", 0, 1), std::invalid_argument);
+    EXPECT_THROW(labor.seekJob(0, "農業", -1), std::invalid_argument);
+    EXPECT_THROW(labor.seekJob(0, "", 10), std::invalid_argument);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "market/market.h"
+#include "market/price_history.h"
+
+namespace {
+
+// 全サンプルを直接走査する参照実装
+OhlcBar naiveQuery(const std::vector<PriceHistory::Sample>& samples, int64_t from, int64_t to) {
+    OhlcBar bar;
+    for (const auto& sample : samples) {
+        if (sample.day >= from && sample.day <= to) bar.add(sample.price, sample.quantity);
+    }
+    return bar;
+}
+
+}  // namespace
+
+TEST(OhlcBarTest, AddAndMerge) {
+    OhlcBar first;
+    first.add(10, 1);
+    first.add(15, 2);
+    first.add(8, 3);
+    EXPECT_EQ(first.open, 10);
+    EXPECT_EQ(first.high, 15);
+    EXPECT_EQ(first.low, 8);
+    EXPECT_EQ(first.close, 8);
+    EXPECT_EQ(first.volume, 6);
+
+    OhlcBar second;
+    second.add(20, 1);
+    first.merge(second);
+    EXPECT_EQ(first.open, 10);
+    EXPECT_EQ(first.high, 20);
+    EXPECT_EQ(first.close, 20);
+    EXPECT_DOUBLE_EQ(first.average(), (10 + 15 + 8 + 20) / 4.0);
+}
+
+TEST(GorillaCodecTest, RoundTrip) {
+    std::vector<OhlcBar> bars;
+    std::mt19937_64 rng(5);
+    int64_t price = 100;
+    for (int day = 0; day < 200; ++day) {
+        OhlcBar bar;
+        bar.start_day = day * 7 + (day % 5 == 0 ? 3 : 0);
+        price += static_cast<int64_t>(rng() % 7) - 3;
+        bar.add(price, static_cast<int64_t>(rng() % 1000));
+        bar.add(price + 2, 5);
+        bars.push_back(bar);
+    }
+    bars[50].high = -123456789;  // 負値や大きな変化も扱える
+
+    CompressedBars block = CompressedBars::encode(bars);
+    std::vector<OhlcBar> decoded = block.decode();
+
+    ASSERT_EQ(decoded.size(), bars.size());
+    for (size_t i = 0; i < bars.size(); ++i) {
+        EXPECT_EQ(decoded[i].start_day, bars[i].start_day);
+        EXPECT_EQ(decoded[i].open, bars[i].open);
+        EXPECT_EQ(decoded[i].high, bars[i].high);
+        EXPECT_EQ(decoded[i].low, bars[i].low);
+        EXPECT_EQ(decoded[i].close, bars[i].close);
+        EXPECT_EQ(decoded[i].volume, bars[i].volume);
+        EXPECT_EQ(decoded[i].price_sum, bars[i].price_sum);
+        EXPECT_EQ(decoded[i].samples, bars[i].samples);
+    }
+    EXPECT_LT(block.data.size(), bars.size() * sizeof(OhlcBar) / 4);
+}
+
+TEST(PriceHistoryTest, RangeQueriesMatchNaiveScan) {
+    PriceHistory history;
+    std::vector<PriceHistory::Sample> samples;
+    std::mt19937_64 rng(11);
+    int64_t price = 50;
+    for (int64_t day = 0; day < 3 * 365; ++day) {
+        for (int i = 0; i < 3; ++i) {
+            price = std::max<int64_t>(1, price + static_cast<int64_t>(rng() % 5) - 2);
+            const int64_t quantity = static_cast<int64_t>(rng() % 20);
+            history.record(day, price, quantity);
+            samples.push_back({day, price, quantity});
+        }
+    }
+
+    const std::pair<int64_t, int64_t> ranges[] = {
+        {0, 0}, {5, 20}, {30, 59}, {90, 179}, {13, 400}, {100, 1000}, {0, 3 * 365}, {1000, 1094}, {500, 400}};
+    for (const auto& range : ranges) {
+        OhlcBar expected = naiveQuery(samples, range.first, range.second);
+        OhlcBar actual = history.query(range.first, range.second);
+        EXPECT_EQ(actual.samples, expected.samples) << range.first << "-" << range.second;
+        EXPECT_EQ(actual.open, expected.open);
+        EXPECT_EQ(actual.high, expected.high);
+        EXPECT_EQ(actual.low, expected.low);
+        EXPECT_EQ(actual.close, expected.close);
+        EXPECT_EQ(actual.volume, expected.volume);
+        EXPECT_DOUBLE_EQ(actual.average(), expected.average());
+    }
+
+    EXPECT_EQ(history.recentSamples().size(), PriceHistory::RAW_WINDOW);
+    EXPECT_EQ(history.barCount(PriceHistory::DAY), 3 * 365);
+    EXPECT_GT(history.compressedBytes(), 0);
+}
+
+TEST(PriceHistoryTest, SeasonBarsFollowCalendarSeasons) {
+    PriceHistory history;
+    for (int64_t day = 0; day < Calendar::DAYS_PER_YEAR; ++day) history.record(day, 10 + day);
+
+    EXPECT_EQ(history.barCount(PriceHistory::SEASON), static_cast<size_t>(Calendar::SEASONS));
+    const int64_t summer = Calendar::dayOf(1, Season::SUMMER);
+    const OhlcBar bar = history.query(summer, summer + Calendar::DAYS_PER_SEASON - 1);
+    EXPECT_EQ(bar.open, 10 + summer);
+    EXPECT_EQ(bar.close, 10 + summer + Calendar::DAYS_PER_SEASON - 1);
+    EXPECT_EQ(bar.samples, Calendar::DAYS_PER_SEASON);
+}
+
+TEST(PriceHistoryTest, OutOfOrderSampleThrows) {
+    PriceHistory history;
+    history.record(10, 5);
+    EXPECT_THROW(history.record(9, 5), std::invalid_argument);
+}
+
+TEST(PriceHistoryTest, MarketArchivesDailyClose) {
+    Market market;
+    market.registerProduct("小麦", 10);
+    market.sell("小麦", 100, 10);
+    for (int day = 0; day < 30; ++day) {
+        market.buy("小麦", 2);
+        market.clearDaily();
+    }
+
+    const PriceHistory* history = market.getPriceHistory("小麦");
+    ASSERT_NE(history, nullptr);
+    EXPECT_EQ(market.getCurrentDay(), 30);
+    OhlcBar month = history->query(0, 29);
+    EXPECT_EQ(month.samples, 30);
+    EXPECT_EQ(month.volume, 60);
+    EXPECT_EQ(month.close, market.getPrice("小麦"));
+    EXPECT_EQ(market.getPriceHistory("パン"), nullptr);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "market/production.h"
+#include "market/business.h"
+#include "system/thread_pool.h"
+
+class ProductionGraphTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // 鉱石 → 鉄 → 道具 の3段のチェーン
+        graph.addRecipe(Recipe("鉱石", {}, 4));
+        graph.addRecipe(Recipe("鉄", {{"鉱石", 2}}, 1));
+        graph.addRecipe(Recipe("道具", {{"鉄", 1}}, 1));
+    }
+
+    Business makeBusiness(const std::string& product, int32_t workers, int32_t stock = 0) {
+        Business business;
+        business.product = product;
+        business.workers = workers;
+        business.stock = stock;
+        return business;
+    }
+
+    ProductionGraph graph;
+};
+
+TEST_F(ProductionGraphTest, Levels_TopologicalOrder) {
+    const auto& levels = graph.getLevels();
+    ASSERT_EQ(levels.size(), 3);
+    EXPECT_EQ(levels[0], std::vector<std::string>{"鉱石"});
+    EXPECT_EQ(levels[1], std::vector<std::string>{"鉄"});
+    EXPECT_EQ(levels[2], std::vector<std::string>{"道具"});
+}
+
+TEST_F(ProductionGraphTest, Cycle_Throws) {
+    graph.addRecipe(Recipe("鉱石", {{"道具", 1}}, 1));
+    EXPECT_THROW(graph.getLevels(), std::runtime_error);
+}
+
+TEST_F(ProductionGraphTest, InvalidRecipe_Throws) {
+    EXPECT_THROW(Recipe("", {}, 1), std::invalid_argument);
+    EXPECT_THROW(Recipe("鉄", {{"鉄", 1}}, 1), std::invalid_argument);
+    EXPECT_THROW(Recipe("鉄", {{"鉱石", 0}}, 1), std::invalid_argument);
+}
+
+TEST_F(ProductionGraphTest, RunTick_ChainConsumesInputs) {
+    std::vector<Business> businesses = {
+        makeBusiness("鉱石", 5),   // 20個産出
+        makeBusiness("鉄", 4),     // 4個産出、鉱石8個消費
+        makeBusiness("道具", 3),   // 3個産出、鉄3個消費
+    };
+
+    auto report = graph.runTick(businesses);
+
+    EXPECT_EQ(businesses[0].stock, 12);
+    EXPECT_EQ(businesses[1].stock, 1);
+    EXPECT_EQ(businesses[2].stock, 3);
+    EXPECT_EQ(report.produced["鉱石"], 20);
+    EXPECT_EQ(report.consumed["鉱石"], 8);
+    EXPECT_EQ(report.consumed["鉄"], 3);
+    EXPECT_EQ(report.total_output, 27);
+}
+
+TEST_F(ProductionGraphTest, RunTick_ScarceInputRationedAcrossConsumers) {
+    std::vector<Business> businesses = {
+        makeBusiness("鉱石", 1),       // 4個産出
+        makeBusiness("鉄", 2),         // 需要: 鉱石4個
+        makeBusiness("鉄", 2),         // 需要: 鉱石4個
+    };
+
+    graph.runTick(businesses);
+
+    // 鉱石4個を需要8個に対して按分（稼働率50%）
+    EXPECT_EQ(businesses[0].stock, 0);
+    EXPECT_EQ(businesses[1].stock, 1);
+    EXPECT_EQ(businesses[2].stock, 1);
+}
+
+TEST_F(ProductionGraphTest, RunTick_ProductWithoutRecipeUsesDailyProduction) {
+    Business bakery = makeBusiness("パン", 0);
+    bakery.daily_production = 7;
+    std::vector<Business> businesses = {bakery};
+
+    graph.runTick(businesses);
+    graph.runTick(businesses);
+
+    EXPECT_EQ(businesses[0].stock, 14);
+}
+
+TEST_F(ProductionGraphTest, RunTick_ParallelMatchesSerial) {
+    std::vector<Business> serial;
+    for (int i = 0; i < 200; ++i) {
+        serial.push_back(makeBusiness("鉱石", 1 + i % 3));
+        serial.push_back(makeBusiness("鉄", 1 + i % 5));
+        serial.push_back(makeBusiness("道具", 2));
+    }
+    std::vector<Business> parallel = serial;
+
+    ThreadPool pool(4);
+    for (int day = 0; day < 5; ++day) {
+        graph.runTick(serial);
+        graph.runTick(parallel, &pool);
+    }
+
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i].stock, parallel[i].stock);
+    }
+}
+
+TEST_F(ProductionGraphTest, OutputScaleLimitsInputDemand) {
+    // 鉄の産出を半分にすると、鉱石の消費も半分で済む
+    std::vector<Business> businesses = {makeBusiness("鉱石", 2), makeBusiness("鉄", 4), makeBusiness("道具", 0)};
+    graph.setOutputScale({1.0f, 0.5f});
+    EXPECT_EQ(graph.plannedOutput(businesses), (std::vector<int32_t>{8, 2, 0}));
+    auto report = graph.runTick(businesses);
+    EXPECT_EQ(report.produced["鉄"], 2);
+    EXPECT_EQ(report.consumed["鉱石"], 4);
+    EXPECT_EQ(businesses[0].stock, 4);
+    EXPECT_THROW(graph.setOutputScale({-1.0f}), std::invalid_argument);
+}
+
+TEST(ProductionScaleTest, VectorKernelMatchesScalar) {
+    std::mt19937 rng(5);
+    const size_t n = 1003;
+    std::vector<int32_t> base(n);
+    std::vector<float> scale(n);
+    for (size_t i = 0; i < n; ++i) {
+        base[i] = static_cast<int32_t>(rng() % 100000);
+        scale[i] = static_cast<float>(rng() % 3000) / 1000.0f;
+    }
+    base[0] = 2000000000;
+    scale[0] = 900.0f;  // 上限で頭打ち
+    std::vector<int32_t> expected(n);
+    std::vector<int32_t> actual(n);
+    ProductionGraph::scaleOutputScalar(base.data(), scale.data(), expected.data(), n);
+    ProductionGraph::scaleOutput(base.data(), scale.data(), actual.data(), n);
+    EXPECT_EQ(actual, expected);
+    EXPECT_GT(expected[0], 2000000000);
+}
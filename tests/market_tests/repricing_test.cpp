@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "market/market.h"
+#include "market/repricing.h"
+
+TEST(RepricingTest, ScalarMatchesUpdatePriceRules) {
+    std::vector<int> demand = {200, 50, 10, 0, 100};
+    std::vector<int> supply = {100, 100, 0, 100, 100};
+    std::vector<int> price = {100, 100, 100, 1, 37};
+
+    repriceScalar(demand.data(), supply.data(), price.data(), price.size(), 0.1f);
+
+    EXPECT_EQ(price[0], 110);  // 需要超過で上昇
+    EXPECT_EQ(price[1], 95);   // 供給超過で下落
+    EXPECT_EQ(price[2], 100);  // 供給0は据え置き
+    EXPECT_EQ(price[3], 1);    // 最低価格
+    EXPECT_EQ(price[4], 37);   // 需給均衡
+}
+
+TEST(RepricingTest, BatchMatchesScalarOnRandomCatalog) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> quantity(0, 5000);
+    std::uniform_int_distribution<int> initial_price(1, 100000);
+
+    const size_t n = 1003;  // 8の倍数でない端数も含める
+    std::vector<int> demand(n), supply(n), price(n);
+    for (size_t i = 0; i < n; ++i) {
+        demand[i] = quantity(rng);
+        supply[i] = (i % 11 == 0) ? 0 : quantity(rng);
+        price[i] = initial_price(rng);
+    }
+    std::vector<int> expected = price;
+
+    for (float volatility : {0.0f, 0.1f, 0.75f, 2.0f}) {
+        repriceScalar(demand.data(), supply.data(), expected.data(), n, volatility);
+        repriceBatch(demand.data(), supply.data(), price.data(), n, volatility);
+        ASSERT_EQ(price, expected) << "volatility=" << volatility;
+    }
+}
+
+TEST(RepricingTest, MarketRepriceAllMatchesUpdatePrice) {
+    Market batch;
+    Market reference;
+    const std::vector<std::string> products = {"小麦", "パン", "道具", "布", "塩",
+                                               "鉄", "木材", "羊毛", "酒"};
+    for (size_t i = 0; i < products.size(); ++i) {
+        for (Market* market : {&batch, &reference}) {
+            market->registerProduct(products[i], 10 + static_cast<int>(i) * 7);
+            market->sell(products[i], 50 + static_cast<int>(i) * 13, 0);
+            if (i % 3 != 0) {
+                market->buy(products[i], 20 + static_cast<int>(i) * 5);
+            }
+        }
+    }
+    ASSERT_FLOAT_EQ(batch.getPriceVolatility(), reference.getPriceVolatility());
+
+    batch.repriceAll();
+    for (const auto& product : products) {
+        reference.updatePrice(product);
+    }
+
+    for (const auto& product : products) {
+        EXPECT_EQ(batch.getPrice(product), reference.getPrice(product)) << product;
+    }
+}
+
+TEST(RepricingTest, PricesMoveOnlyAtClearDaily) {
+    Market market;
+    market.registerProduct("小麦", 100);
+    market.sell("小麦", 50, 100);
+    market.buy("小麦", 30);
+    market.buy(GoodsCatalog::id("小麦"), 20);
+    market.fillDemand("小麦", 50);
+    EXPECT_EQ(market.getPrice("小麦"), 100);
+    EXPECT_EQ(market.getDailyDemand("小麦"), 100);
+    EXPECT_EQ(market.getDailySupply("小麦"), 50);
+
+    // 需要 100 / 供給 50 なので (2 - 1) * 変動性 だけ上がる
+    const float volatility = market.getPriceVolatility();
+    market.clearDaily();
+    EXPECT_EQ(market.getPrice("小麦"), static_cast<int>(100 * (1.0f + volatility)));
+    EXPECT_EQ(market.getDailyDemand("小麦"), 0);
+    ASSERT_NE(market.getPriceHistory("小麦"), nullptr);
+
+    // 供給のない日は据え置く
+    const int settled = market.getPrice("小麦");
+    market.clearDaily();
+    EXPECT_EQ(market.getPrice("小麦"), settled);
+}
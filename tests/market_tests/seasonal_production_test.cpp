@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "market/seasonal_production.h"
+
+namespace {
+
+Business makeBusiness(const std::string& sector, int32_t production) {
+    Business business;
+    business.product = sector + "の品";
+    business.sector = sector;
+    business.daily_production = production;
+    return business;
+}
+
+}  // namespace
+
+TEST(SeasonalProductionTest, ScalesProductionBySectorAndSeason) {
+    std::vector<Business> businesses = {makeBusiness("農業", 10), makeBusiness("鉱業", 10),
+                                        makeBusiness("製造業", 7), makeBusiness("", 4)};
+    SectorIndex sectors;
+    sectors.rebuild(businesses);
+    SeasonalProduction seasonal = SeasonalProduction::standard();
+    ProductionGraph production;
+
+    seasonal.apply(production, businesses, sectors, Season::AUTUMN);
+    EXPECT_EQ(production.plannedOutput(businesses), (std::vector<int32_t>{15, 10, 7, 4}));  // 業種なしは1倍
+    // daily_production そのものは変えない
+    EXPECT_EQ(businesses[0].daily_production, 10);
+
+    // 倍率は毎回設定し直す（積み重ならない）
+    seasonal.apply(production, businesses, sectors, Season::WINTER);
+    EXPECT_EQ(production.plannedOutput(businesses), (std::vector<int32_t>{3, 8, 7, 4}));
+    seasonal.apply(production, businesses, sectors, Season::SPRING);
+    EXPECT_EQ(production.runTick(businesses).total_output, 31);
+
+    seasonal.setMultiplier("製造業", Season::SPRING, 0.5f);
+    seasonal.apply(production, businesses, sectors, Season::SPRING);
+    EXPECT_EQ(production.plannedOutput(businesses)[2], 4);  // 3.5 は四捨五入
+    EXPECT_FLOAT_EQ(seasonal.multiplier("漁業", Season::SUMMER), 1.0f);
+    EXPECT_THROW(seasonal.setMultiplier("農業", Season::SPRING, -1.0f), std::invalid_argument);
+}
+
+TEST(SeasonalProductionTest, ScalesRecipeOutput) {
+    // レシピのある製品は workers * output_per_worker に倍率が掛かる
+    Business farm = makeBusiness("農業", 0);
+    farm.product = "小麦";
+    farm.workers = 5;
+    std::vector<Business> businesses = {farm};
+    SectorIndex sectors;
+    sectors.rebuild(businesses);
+    ProductionGraph production;
+    production.addRecipe(Recipe("小麦", {}, 2));
+
+    SeasonalProduction::standard().apply(production, businesses, sectors, Season::AUTUMN);
+    EXPECT_EQ(production.runTick(businesses).total_output, 15);
+    SeasonalProduction::standard().apply(production, businesses, sectors, Season::WINTER);
+    EXPECT_EQ(production.runTick(businesses).total_output, 3);
+}
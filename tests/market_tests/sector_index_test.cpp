@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "market/sector_index.h"
+
+class SectorIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const char* sectors[] = {"農業", "製造業", "農業", "", "商業"};
+        for (const char* sector : sectors) {
+            Business business;
+            business.sector = sector;
+            businesses.push_back(business);
+        }
+        index.rebuild(businesses);
+    }
+
+    std::vector<size_t> sorted(std::vector<size_t> values) {
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    std::vector<Business> businesses;
+    SectorIndex index;
+};
+
+TEST_F(SectorIndexTest, Rebuild) {
+    EXPECT_EQ(index.sectorCount(), 3);
+    EXPECT_EQ(sorted(index.businessesIn("農業")), (std::vector<size_t>{0, 2}));
+    EXPECT_EQ(index.businessesIn("製造業"), std::vector<size_t>{1});
+    EXPECT_TRUE(index.businessesIn("鉱業").empty());
+    EXPECT_EQ(index.sectorOf(3), SectorIndex::NO_SECTOR);
+    EXPECT_EQ(index.sectorName(index.sectorOf(4)), "商業");
+}
+
+TEST_F(SectorIndexTest, AssignMovesBusiness) {
+    index.assign(0, "商業", businesses);
+
+    EXPECT_EQ(businesses[0].sector, "商業");
+    EXPECT_EQ(index.businessesIn("農業"), std::vector<size_t>{2});
+    EXPECT_EQ(sorted(index.businessesIn("商業")), (std::vector<size_t>{0, 4}));
+
+    index.assign(3, "農業", businesses);
+    EXPECT_EQ(sorted(index.businessesIn("農業")), (std::vector<size_t>{2, 3}));
+
+    index.assign(2, "", businesses);
+    EXPECT_EQ(index.businessesIn("農業"), std::vector<size_t>{3});
+    EXPECT_EQ(index.sectorOf(2), SectorIndex::NO_SECTOR);
+}
+
+TEST_F(SectorIndexTest, AssignUnknownBusinessThrows) {
+    EXPECT_THROW(index.assign(10, "農業", businesses), std::out_of_range);
+}
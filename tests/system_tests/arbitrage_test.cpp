@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <tuple>
+#include <vector>
+#include "system/arbitrage.h"
+#include "system/thread_pool.h"
+
+namespace {
+MarketSnapshot randomSnapshot(size_t markets, size_t products, uint64_t seed) {
+    MarketSnapshot snapshot(markets, products);
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int32_t> price(0, 100);
+    std::uniform_int_distribution<int32_t> stock(0, 60);
+    for (auto& value : snapshot.price) value = price(rng);
+    for (auto& value : snapshot.stock) value = stock(rng);
+    return snapshot;
+}
+}  // namespace
+
+TEST(ArbitrageTest, FindsBestSpreadAfterTransport) {
+    MarketSnapshot snapshot(3, 3);
+    // 市場0で安く、市場1・2で高い
+    snapshot.priceRow(0)[0] = 10;
+    snapshot.priceRow(0)[1] = 10;
+    snapshot.priceRow(0)[2] = 10;
+    snapshot.priceRow(1)[0] = 30;
+    snapshot.priceRow(1)[1] = 12;
+    snapshot.priceRow(2)[0] = 25;
+    snapshot.priceRow(2)[2] = 40;  // 利ざやは大きいが在庫不足
+    for (int p = 0; p < 3; ++p) snapshot.stockRow(0)[p] = 30;
+    snapshot.stockRow(0)[2] = 5;
+
+    ArbitrageConfig config;
+    auto opportunities = ArbitrageScanner::scan(snapshot, {{0, 1, 2}, {0, 2, 1}}, config);
+
+    ASSERT_EQ(opportunities.size(), 3u);
+    ASSERT_EQ(opportunities[0].size(), 2u);
+    // 0->1 の商品0: 30 - 10 - 2 = 18、0->2 の商品0: 25 - 10 - 1 = 14、商品1は 12 - 10 - 2 = 0 で除外
+    EXPECT_EQ(opportunities[0][0].to, 1u);
+    EXPECT_EQ(opportunities[0][0].product, 0u);
+    EXPECT_EQ(opportunities[0][0].margin, 18);
+    EXPECT_EQ(opportunities[0][0].capacity, 3);
+    EXPECT_EQ(opportunities[0][1].to, 2u);
+    EXPECT_EQ(opportunities[0][1].margin, 14);
+    EXPECT_TRUE(opportunities[1].empty());
+}
+
+TEST(ArbitrageTest, AssignmentRespectsCapacity) {
+    MarketSnapshot snapshot(2, 2);
+    snapshot.priceRow(0)[0] = 10;
+    snapshot.priceRow(0)[1] = 10;
+    snapshot.priceRow(1)[0] = 50;
+    snapshot.priceRow(1)[1] = 20;
+    snapshot.stockRow(0)[0] = 20;  // 2人分
+    snapshot.stockRow(0)[1] = 10;  // 1人分
+
+    ArbitrageConfig config;
+    auto opportunities = ArbitrageScanner::scan(snapshot, {{0, 1, 1}}, config);
+    auto assignments = ArbitrageScanner::assign(opportunities, {0, 0, 1, 0, 0}, config);
+
+    ASSERT_EQ(assignments.size(), 3u);
+    EXPECT_EQ(assignments[0].merchant, 0u);
+    EXPECT_EQ(assignments[0].product, 0u);
+    EXPECT_EQ(assignments[0].profit, 390);
+    EXPECT_EQ(assignments[1].merchant, 1u);
+    EXPECT_EQ(assignments[1].product, 0u);
+    EXPECT_EQ(assignments[2].merchant, 3u);
+    EXPECT_EQ(assignments[2].product, 1u);
+    EXPECT_EQ(assignments[2].profit, 90);
+}
+
+TEST(ArbitrageTest, AssignmentSharesSourceStockAcrossLinks) {
+    // 市場0の商品0は2人分の在庫しかないので、行き先が2つあっても2人までしか割り当てない
+    MarketSnapshot snapshot(3, 2);
+    snapshot.priceRow(0)[0] = 10;
+    snapshot.priceRow(0)[1] = 10;
+    snapshot.priceRow(1)[0] = 50;
+    snapshot.priceRow(2)[0] = 40;
+    snapshot.priceRow(2)[1] = 15;
+    snapshot.stockRow(0)[0] = 20;
+    snapshot.stockRow(0)[1] = 10;
+
+    ArbitrageConfig config;
+    auto opportunities = ArbitrageScanner::scan(snapshot, {{0, 1, 1}, {0, 2, 1}}, config);
+    ASSERT_EQ(opportunities[0].size(), 3u);
+    auto assignments = ArbitrageScanner::assign(opportunities, {0, 0, 0, 0, 0}, config);
+
+    ASSERT_EQ(assignments.size(), 3u);
+    EXPECT_EQ(assignments[0].to, 1u);
+    EXPECT_EQ(assignments[0].product, 0u);
+    EXPECT_EQ(assignments[1].to, 1u);
+    EXPECT_EQ(assignments[1].product, 0u);
+    // 0->2 の商品0は在庫が尽きているので、次に良い商品1に回る
+    EXPECT_EQ(assignments[2].to, 2u);
+    EXPECT_EQ(assignments[2].product, 1u);
+    EXPECT_EQ(assignments[2].profit, 40);
+}
+
+TEST(ArbitrageTest, ParallelScanMatchesSequential) {
+    const size_t markets = 200;
+    const MarketSnapshot snapshot = randomSnapshot(markets, 1000, 5);
+    std::vector<MarketLink> links;
+    for (uint32_t m = 0; m < markets; ++m) {
+        for (uint32_t d = 1; d <= 4; ++d) {
+            links.push_back({m, static_cast<uint32_t>((m + d * 7) % markets), static_cast<int32_t>(d)});
+        }
+    }
+    ArbitrageConfig config;
+    auto sequential = ArbitrageScanner::scan(snapshot, links, config);
+    ThreadPool pool(4);
+    auto parallel = ArbitrageScanner::scan(snapshot, links, config, &pool);
+
+    ASSERT_EQ(parallel.size(), sequential.size());
+    for (size_t m = 0; m < markets; ++m) {
+        ASSERT_EQ(parallel[m].size(), sequential[m].size());
+        EXPECT_LE(sequential[m].size(), 4 * config.per_route);
+        for (size_t k = 0; k < sequential[m].size(); ++k) {
+            EXPECT_EQ(parallel[m][k].to, sequential[m][k].to);
+            EXPECT_EQ(parallel[m][k].product, sequential[m][k].product);
+            if (k > 0) {
+                EXPECT_GE(sequential[m][k - 1].margin, sequential[m][k].margin);
+            }
+            const auto& opportunity = sequential[m][k];
+            EXPECT_EQ(opportunity.margin, snapshot.priceRow(opportunity.to)[opportunity.product] -
+                                              snapshot.priceRow(m)[opportunity.product] -
+                                              config.cost_per_day * opportunity.travel_time);
+        }
+    }
+}
+
+TEST(ArbitrageTest, LinksFromRouteNetwork) {
+    RouteNetwork network;
+    TradeRoute route;
+    for (auto [from, to, time] : {std::tuple<int, int, int>{10, 20, 2}, {20, 30, 2}, {10, 40, 9}}) {
+        route.from_location_id = from;
+        route.to_location_id = to;
+        route.travel_time = time;
+        network.addRoute(route);
+    }
+    auto links = ArbitrageScanner::linksFrom(network, {10, 20, 30, 40}, 5, 8);
+    ASSERT_EQ(links.size(), 3u);
+    EXPECT_EQ(links[0].from, 0u);
+    EXPECT_EQ(links[0].to, 1u);
+    EXPECT_EQ(links[1].to, 2u);
+    EXPECT_EQ(links[1].travel_time, 4);
+    EXPECT_EQ(links[2].from, 1u);
+    EXPECT_EQ(ArbitrageScanner::linksFrom(network, {10, 20, 30, 40}, 5, 1).size(), 2u);
+}
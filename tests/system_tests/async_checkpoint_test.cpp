@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "system/async_checkpoint.h"
+#include "system/checkpoint.h"
+#include "system/simulation.h"
+#include "system/state_hash.h"
+#include "system/thread_pool.h"
+
+class AsyncCheckpointTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = ::testing::TempDir() + "async_checkpoint_test_" +
+               ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".ackp";
+    }
+    void TearDown() override {
+        std::remove(path.c_str());
+        std::remove((path + ".tmp").c_str());
+    }
+
+    static std::string binary(const World& world) {
+        std::ostringstream out;
+        Checkpoint::save(world, out);
+        return out.str();
+    }
+
+    std::string path;
+};
+
+TEST(ChunkCodecTest, RoundTripsColumns) {
+    ChunkCodec::Columns columns;
+    columns.rows = 4;
+    columns.ints = {{1, 2, 3, 4}, {-5, INT64_MAX, INT64_MIN, 0}};
+    columns.texts.resize(1);
+    for (const char* text : {"住民1", "住民2", "", "農業"}) columns.texts[0].push(text);
+
+    const std::string blob = ChunkCodec::encode(columns);
+    const ChunkCodec::Columns decoded = ChunkCodec::decode(blob);
+    EXPECT_EQ(decoded.rows, 4u);
+    EXPECT_EQ(decoded.ints, columns.ints);
+    EXPECT_EQ(decoded.texts[0].bytes, columns.texts[0].bytes);
+    EXPECT_EQ(decoded.texts[0].ends, columns.texts[0].ends);
+    EXPECT_THROW(ChunkCodec::decode(blob.substr(0, blob.size() - 1)), std::runtime_error);
+}
+
+TEST_F(AsyncCheckpointTest, SnapshotIsTakenAtStartWhileSimulationContinues) {
+    WorldConfig config;
+    config.people = 5000;
+    config.businesses = 40;
+    World world = World::generate(config);
+    world.people[10].setHealthStatus(HealthStatus::SICK);
+    world.people[11].addInventoryItem("道具");
+    world.enableSeasons();
+    world.enableLevelOfDetail();
+    for (int i = 0; i < 3; ++i) world.step();
+    const std::string expected = binary(world);
+    const StateHash expected_hash = StateHasher::hashWorld(world);
+
+    AsyncCheckpointConfig small;
+    small.chunk_agents = 700;  // 端数のあるチャンクと複数の書き込みスレッド
+    small.writers = 3;
+    AsyncCheckpoint checkpoint(small);
+    std::atomic<int> callbacks{0};
+    AsyncCheckpointResult reported;
+    ThreadPool pool(2);
+    checkpoint.start(world, path, [&](const AsyncCheckpointResult& result) {
+        reported = result;
+        ++callbacks;
+    }, &pool);
+
+    // 書き込み中も世界は進めてよい
+    for (int i = 0; i < 2; ++i) world.step();
+    const AsyncCheckpointResult result = checkpoint.wait();
+    ASSERT_TRUE(result.ok) << result.error;
+    EXPECT_FALSE(checkpoint.busy());
+    EXPECT_EQ(callbacks.load(), 1);
+    EXPECT_EQ(reported.path, path);
+    EXPECT_EQ(result.day, 3);
+    EXPECT_EQ(result.chunks, 8u + 1u);
+    EXPECT_LT(result.bytes, result.raw_bytes);
+
+    World restored = AsyncCheckpoint::load(path, &pool);
+    EXPECT_EQ(binary(restored), expected);
+    EXPECT_EQ(StateHasher::hashWorld(restored), expected_hash);
+    EXPECT_EQ(restored.people[4321].name, "住民4322");
+
+    // 再開後も元の世界と同じように進む
+    std::istringstream saved(expected);
+    World original = Checkpoint::load(saved);
+    for (int i = 0; i < 2; ++i) {
+        original.step();
+        restored.step();
+    }
+    EXPECT_EQ(StateHasher::hashWorld(restored), StateHasher::hashWorld(original));
+}
+
+TEST_F(AsyncCheckpointTest, SecondStartWaitsAndTryStartSkips) {
+    WorldConfig config;
+    config.people = 2000;
+    config.businesses = 10;
+    World world = World::generate(config);
+
+    AsyncCheckpoint checkpoint;
+    checkpoint.start(world, path);
+    world.step();
+    checkpoint.start(world, path);  // 前の書き込みの完了を待ってから取り込む
+    if (checkpoint.busy()) {
+        EXPECT_FALSE(checkpoint.tryStart(world, path));
+    }
+    EXPECT_TRUE(checkpoint.wait().ok);
+    EXPECT_EQ(AsyncCheckpoint::load(path).day, 1);
+
+    const AsyncCheckpointResult saved = AsyncCheckpoint::save(world, path);
+    EXPECT_TRUE(saved.ok);
+    EXPECT_EQ(binary(AsyncCheckpoint::load(path)), binary(world));
+}
+
+TEST_F(AsyncCheckpointTest, ReportsFailuresAndRejectsCorruptFiles) {
+    WorldConfig config;
+    config.people = 100;
+    config.businesses = 5;
+    World world = World::generate(config);
+
+    AsyncCheckpoint checkpoint;
+    bool failed = false;
+    checkpoint.start(world, ::testing::TempDir() + "no_such_dir/x.ackp",
+                     [&](const AsyncCheckpointResult& result) { failed = !result.ok; });
+    const AsyncCheckpointResult result = checkpoint.wait();
+    EXPECT_FALSE(result.ok);
+    EXPECT_FALSE(result.error.empty());
+    EXPECT_TRUE(failed);
+    EXPECT_THROW(AsyncCheckpoint::save(world, ::testing::TempDir() + "no_such_dir/x.ackp"), std::runtime_error);
+
+    AsyncCheckpoint::save(world, path);
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(file.data(), static_cast<std::streamsize>(file.size() - 3));
+    }
+    EXPECT_THROW(AsyncCheckpoint::load(path), std::runtime_error);
+    EXPECT_THROW(AsyncCheckpoint::load(path + ".missing"), std::runtime_error);
+}
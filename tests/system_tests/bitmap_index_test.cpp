@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+#include "agent/person.h"
+#include "system/bitmap_index.h"
+#include "system/simulation.h"
+
+namespace {
+
+std::vector<uint32_t> sorted(const std::set<uint32_t>& values) {
+    return std::vector<uint32_t>(values.begin(), values.end());
+}
+
+}  // namespace
+
+TEST(RoaringBitmapTest, AddRemoveAndContainerSwitch) {
+    RoaringBitmap bitmap;
+    EXPECT_TRUE(bitmap.empty());
+    EXPECT_TRUE(bitmap.add(7));
+    EXPECT_FALSE(bitmap.add(7));
+    EXPECT_TRUE(bitmap.add(70000));
+    EXPECT_TRUE(bitmap.contains(7));
+    EXPECT_TRUE(bitmap.contains(70000));
+    EXPECT_FALSE(bitmap.contains(8));
+    EXPECT_EQ(bitmap.cardinality(), 2u);
+
+    // 1つの区切りに ARRAY_LIMIT を超えて入れるとビット列になり、減ると配列に戻る
+    for (uint32_t v = 0; v <= RoaringBitmap::ARRAY_LIMIT; ++v) bitmap.add(v * 2);
+    EXPECT_EQ(bitmap.bitmapContainers(), 1u);
+    EXPECT_TRUE(bitmap.contains(8000));
+    EXPECT_FALSE(bitmap.contains(8001));
+    EXPECT_TRUE(bitmap.remove(7));
+    EXPECT_EQ(bitmap.bitmapContainers(), 1u);
+    EXPECT_TRUE(bitmap.remove(8000));
+    EXPECT_EQ(bitmap.bitmapContainers(), 0u);
+    EXPECT_FALSE(bitmap.contains(8000));
+    EXPECT_FALSE(bitmap.remove(8000));
+
+    EXPECT_TRUE(bitmap.remove(70000));
+    EXPECT_FALSE(bitmap.contains(70000));
+}
+
+TEST(RoaringBitmapTest, SetOperationsMatchStdSet) {
+    std::mt19937 rng(11);
+    for (int round = 0; round < 6; ++round) {
+        // 疎な区切りと密な区切りが混ざるように値を選ぶ
+        RoaringBitmap a, b;
+        std::set<uint32_t> sa, sb;
+        const uint32_t dense = round % 2 == 0 ? 60000 : 500;
+        for (int i = 0; i < 20000; ++i) {
+            const uint32_t x = rng() % 3 == 0 ? rng() % 300000 : rng() % dense;
+            const uint32_t y = rng() % 3 == 0 ? rng() % 300000 : rng() % (dense + 1000);
+            a.add(x);
+            sa.insert(x);
+            b.add(y);
+            sb.insert(y);
+        }
+        std::set<uint32_t> both, either, only;
+        for (uint32_t v : sa) (sb.count(v) ? both : only).insert(v);
+        either = sa;
+        either.insert(sb.begin(), sb.end());
+
+        EXPECT_EQ(a.toVector(), sorted(sa));
+        EXPECT_EQ((a & b).toVector(), sorted(both));
+        EXPECT_EQ((a | b).toVector(), sorted(either));
+        EXPECT_EQ((a - b).toVector(), sorted(only));
+        EXPECT_EQ((a & b).cardinality(), both.size());
+        EXPECT_EQ((a | b) - b, a - b);
+
+        RoaringBitmap c = a;
+        c &= b;
+        EXPECT_EQ(c, a & b);
+    }
+}
+
+TEST(RoaringBitmapTest, CompressesDenseRuns) {
+    RoaringBitmap bitmap;
+    for (uint32_t v = 0; v < 1000000; ++v) bitmap.add(v);
+    EXPECT_EQ(bitmap.cardinality(), 1000000u);
+    // 1人4バイトの添字配列よりずっと小さい
+    EXPECT_LT(bitmap.bytes(), 1000000u * sizeof(uint32_t) / 10);
+}
+
+TEST(PopulationIndexTest, QueriesCombinePredicates) {
+    std::vector<Person> people(6);
+    const char* jobs[] = {"農業", "農業", "鉱業", "農業", "商売", "鉱業"};
+    for (size_t i = 0; i < people.size(); ++i) {
+        people[i].job = jobs[i];
+        people[i].setDailyIncome(static_cast<int32_t>(10 * i + 5));
+        people[i].money = static_cast<int64_t>(50 * i);
+    }
+    people[0].setCrimeTendency(CrimeTendency::HIGH);
+    people[2].setCrimeTendency(CrimeTendency::HIGH);
+    people[3].setCrimeTendency(CrimeTendency::HIGH);
+    people[1].setHealthStatus(HealthStatus::SICK);
+    people[4].setHealthStatus(HealthStatus::SICK);
+
+    PopulationIndex index;
+    index.rebuild(people);
+    EXPECT_EQ(index.size(), 6u);
+    EXPECT_EQ(index.all().cardinality(), 6u);
+
+    // 犯罪傾向が高い農業従事者
+    EXPECT_EQ(PopulationIndex::select(index.crime(CrimeTendency::HIGH) & index.job("農業")),
+              (std::vector<size_t>{0, 3}));
+    // 病気で所持金 100 未満
+    auto poor_sick = PopulationIndex::select(index.health(HealthStatus::SICK),
+                                             [&](size_t i) { return people[i].money < 100; });
+    EXPECT_EQ(poor_sick, (std::vector<size_t>{1}));
+    // 健康で農業以外
+    EXPECT_EQ(PopulationIndex::select(index.health(HealthStatus::HEALTHY) - index.job("農業")),
+              (std::vector<size_t>{2, 5}));
+    // 日収 20〜39 の帯
+    EXPECT_EQ(PopulationIndex::select(index.incomeBands(20, 39)), (std::vector<size_t>{2, 3}));
+    EXPECT_TRUE(index.job("漁業").empty());
+    EXPECT_TRUE(index.incomeBand(99).empty());
+}
+
+TEST(PopulationIndexTest, UpdateAndSyncApplyOnlyChanges) {
+    std::vector<Person> people(4);
+    for (auto& person : people) person.job = "農業";
+    PopulationIndex index;
+    index.rebuild(people);
+
+    people[2].setHealthStatus(HealthStatus::SICK);
+    people[2].job = "鉱業";
+    EXPECT_EQ(index.update(2, people[2]), 2u);
+    EXPECT_TRUE(index.health(HealthStatus::SICK).contains(2));
+    EXPECT_FALSE(index.health(HealthStatus::HEALTHY).contains(2));
+    EXPECT_FALSE(index.job("農業").contains(2));
+    EXPECT_EQ(index.update(2, people[2]), 0u);
+
+    // sync は前回の値との差分だけ数える。人数の増減にも追従する
+    people[0].setDailyIncome(45);
+    people.push_back(Person());
+    EXPECT_EQ(index.sync(people), 2u);
+    EXPECT_EQ(index.size(), 5u);
+    EXPECT_TRUE(index.incomeBand(4).contains(0));
+    EXPECT_TRUE(index.job("").contains(4));
+
+    people.pop_back();
+    people.pop_back();
+    EXPECT_EQ(index.sync(people), 2u);
+    EXPECT_EQ(index.all().toVector(), (std::vector<uint32_t>{0, 1, 2}));
+    EXPECT_FALSE(index.health(HealthStatus::HEALTHY).contains(3));
+    EXPECT_THROW(index.update(10, people[0]), std::out_of_range);
+
+    PopulationIndex fresh;
+    fresh.rebuild(people);
+    EXPECT_EQ(fresh.health(HealthStatus::SICK), index.health(HealthStatus::SICK));
+    EXPECT_EQ(fresh.job("農業"), index.job("農業"));
+    EXPECT_EQ(fresh.incomeBand(0), index.incomeBand(0));
+}
+
+TEST(PopulationIndexTest, WorldKeepsIndexBuilt) {
+    WorldConfig config;
+    config.people = 300;
+    config.businesses = 10;
+    World world = World::generate(config);
+    EXPECT_EQ(world.population.size(), 300u);
+    uint64_t by_job = 0;
+    for (const auto& job : world.population.jobs()) by_job += world.population.job(job).cardinality();
+    EXPECT_EQ(by_job, 300u);
+
+    size_t farmers = 0;
+    for (const auto& person : world.people) farmers += person.job == "農業" ? 1 : 0;
+    EXPECT_EQ(world.population.job("農業").cardinality(), farmers);
+}
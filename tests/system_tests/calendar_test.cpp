@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+#include "system/calendar.h"
+#include "system/checkpoint.h"
+#include "system/simulation.h"
+
+TEST(CalendarTest, ConvertsDaysToDates) {
+    CalendarDate date = Calendar::dateOf(0);
+    EXPECT_EQ(date.year, 1);
+    EXPECT_EQ(date.season, Season::SPRING);
+    EXPECT_EQ(date.day_of_season, 1);
+
+    date = Calendar::dateOf(Calendar::DAYS_PER_YEAR + 2 * Calendar::DAYS_PER_SEASON + 4);
+    EXPECT_EQ(date.year, 2);
+    EXPECT_EQ(date.season, Season::AUTUMN);
+    EXPECT_EQ(date.day_of_season, 5);
+    EXPECT_EQ(date.day_of_year, 2 * Calendar::DAYS_PER_SEASON + 5);
+    EXPECT_EQ(Calendar::dayOf(2, Season::AUTUMN, 5), Calendar::DAYS_PER_YEAR + 2 * Calendar::DAYS_PER_SEASON + 4);
+
+    EXPECT_EQ(Calendar::format(0), "1年目 春 1日");
+    EXPECT_EQ(Calendar::format(Calendar::dayOf(3, Season::WINTER, 30)), "3年目 冬 30日");
+    EXPECT_EQ(Calendar::nextSeasonStart(0), 0);
+    EXPECT_EQ(Calendar::nextSeasonStart(1), Calendar::DAYS_PER_SEASON);
+    EXPECT_THROW(Calendar::dateOf(-1), std::invalid_argument);
+    EXPECT_THROW(Calendar::dayOf(1, Season::SPRING, 0), std::invalid_argument);
+}
+
+TEST(CalendarTest, RecurringEventsRearmAndCatchUp) {
+    Calendar calendar;
+    const Calendar::SeriesId tax = calendar.every(2, 7, CalendarEvent{CalendarEventKind::TAX_DAY, 3});
+    calendar.schedule(4, CalendarEvent{CalendarEventKind::SEASON_START});
+    const Calendar::Handle cancelled = calendar.schedule(5, CalendarEvent{CalendarEventKind::SEASON_START});
+    calendar.cancel(cancelled);
+
+    EXPECT_TRUE(calendar.advanceTo(1).empty());
+    std::vector<CalendarEvent> due = calendar.advanceTo(2);
+    ASSERT_EQ(due.size(), 1u);
+    EXPECT_EQ(due[0].kind, CalendarEventKind::TAX_DAY);
+    EXPECT_EQ(due[0].target, 3u);
+    EXPECT_EQ(due[0].day, 2);
+
+    // 数日分まとめて進めても、周期的な予定は期日ごとに返る
+    due = calendar.advanceTo(20);
+    ASSERT_EQ(due.size(), 3u);
+    EXPECT_EQ(due[0].kind, CalendarEventKind::SEASON_START);
+    EXPECT_EQ(due[1].day, 9);
+    EXPECT_EQ(due[2].day, 16);
+    EXPECT_EQ(calendar.pending(), 1u);
+
+    calendar.stop(tax);
+    EXPECT_TRUE(calendar.advanceTo(100).empty());
+    EXPECT_EQ(calendar.pending(), 0u);
+    EXPECT_THROW(calendar.every(0, 0, CalendarEvent{CalendarEventKind::TAX_DAY}), std::invalid_argument);
+}
+
+TEST(CalendarTest, WorldProductionFollowsSeasons) {
+    WorldConfig config;
+    config.people = 50;
+    config.businesses = 10;
+    World plain = World::generate(config);
+    World seasonal = World::generate(config);
+    seasonal.enableSeasons();
+
+    // 季節ごとの生産量の合計（季節なしの世界と同じ日を比べる）
+    std::vector<int64_t> with(Calendar::SEASONS, 0);
+    std::vector<int64_t> without(Calendar::SEASONS, 0);
+    int64_t calendar_events = 0;
+    while (seasonal.day < Calendar::DAYS_PER_YEAR) {
+        const size_t season = static_cast<size_t>(Calendar::seasonOf(seasonal.day));
+        const TickStats stats = seasonal.step();
+        calendar_events += stats.calendar_events;
+        with[season] += stats.produced;
+        without[season] += plain.step().produced;
+    }
+    EXPECT_EQ(calendar_events, 3);  // 夏・秋・冬の始まり
+    EXPECT_EQ(with[static_cast<size_t>(Season::SPRING)], without[static_cast<size_t>(Season::SPRING)]);
+    EXPECT_GT(with[static_cast<size_t>(Season::AUTUMN)], without[static_cast<size_t>(Season::AUTUMN)]);
+    EXPECT_LT(with[static_cast<size_t>(Season::WINTER)], without[static_cast<size_t>(Season::WINTER)]);
+    EXPECT_GT(with[static_cast<size_t>(Season::AUTUMN)], with[static_cast<size_t>(Season::SPRING)]);
+}
+
+TEST(CalendarTest, TaxIsCollectedOnlyOnTaxDays) {
+    WorldConfig config;
+    config.people = 100;
+    config.businesses = 10;
+    World world = World::generate(config);
+    EXPECT_THROW(world.setTaxPeriod(0), std::invalid_argument);
+    world.setTaxPeriod(30);
+
+    int64_t tax_days = 0;
+    int64_t calendar_events = 0;
+    while (world.day < 90) {
+        const int64_t today = world.day;
+        const TickStats stats = world.step();
+        calendar_events += stats.calendar_events;
+        if (today % 30 == 29) {
+            EXPECT_GT(stats.taxes, 0) << "day " << today;
+            ++tax_days;
+        } else {
+            EXPECT_EQ(stats.taxes, 0) << "day " << today;
+        }
+    }
+    EXPECT_EQ(tax_days, 3);
+    EXPECT_EQ(calendar_events, 3);
+
+    // 保存して復元しても同じ納税日が暦に置き直される
+    std::stringstream buffer;
+    Checkpoint::save(world, buffer);
+    World restored = Checkpoint::load(buffer);
+    EXPECT_EQ(restored.tax_period, 30);
+    while (restored.day < 120) {
+        const int64_t today = restored.day;
+        EXPECT_EQ(restored.step().taxes > 0, today % 30 == 29) << "day " << today;
+    }
+}
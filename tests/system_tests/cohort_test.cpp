@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "system/cohort.h"
+#include "system/simulation.h"
+
+class CohortTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // 同じ日課の農民40人と、個別に扱う住民3人
+        for (int i = 0; i < 40; ++i) {
+            Person person;
+            person.job = "農業";
+            person.setDailyIncome(50 + i % 5);
+            person.setDailyExpense(30);
+            person.setSatisfaction(50);
+            person.money = 200 + i;
+            people.push_back(person);
+        }
+        Person thief;
+        thief.job = "農業";
+        thief.setDailyIncome(50);
+        thief.setCrimeTendency(CrimeTendency::HIGH);
+        thief.money = 200;
+        people.push_back(thief);
+        for (int i = 0; i < 2; ++i) {
+            Person merchant;
+            merchant.job = "商売";
+            merchant.setDailyIncome(80);
+            merchant.money = 300;
+            people.push_back(merchant);
+        }
+    }
+
+    int64_t totalMoney() const {
+        int64_t total = 0;
+        for (const auto& person : people) total += person.money;
+        return total;
+    }
+
+    std::vector<Person> people;
+};
+
+TEST_F(CohortTest, GroupsIdenticalAgentsOnly) {
+    CohortSimulator lod;
+    EXPECT_EQ(lod.build(people), 40u);
+    ASSERT_EQ(lod.getCohorts().size(), 1u);
+    EXPECT_EQ(lod.getCohorts()[0].job, "農業");
+    EXPECT_EQ(lod.activePeople(), (std::vector<size_t>{40, 41, 42}));
+    EXPECT_FALSE(lod.isActive(0));
+    EXPECT_TRUE(lod.isActive(40));  // 犯罪傾向が高い住民は集団に入れない
+}
+
+TEST_F(CohortTest, IncomeIsConservedThroughPromotion) {
+    CohortSimulator lod;
+    lod.build(people);
+    const int64_t before = totalMoney();
+    int64_t income = 0;
+    for (int i = 0; i < 40; ++i) income += people[i].daily_income;
+
+    lod.payIncome();
+    lod.payIncome();
+    lod.materialize(people);
+    EXPECT_NEAR(static_cast<double>(totalMoney()), static_cast<double>(before + 2 * income), 40.0);
+
+    // 昇格した住民は集団化前の所持金に1人あたりの増分を足した額になる
+    lod.promote(3, people);
+    EXPECT_TRUE(lod.isActive(3));
+    EXPECT_EQ(lod.getCohorts()[0].size(), 39u);
+    EXPECT_NEAR(static_cast<double>(people[3].money), 203.0 + 2.0 * income / 40.0, 1.0);
+    EXPECT_EQ(lod.activePeople().front(), 3u);
+}
+
+TEST_F(CohortTest, TaxAndConsumptionAreAggregated) {
+    CohortSimulator lod;
+    lod.build(people);
+    Government government;
+    government.money = 0;
+    EXPECT_EQ(lod.collectTax(government, people), 40);
+    EXPECT_GT(government.money, 0);
+
+    Market market;
+    market.sell("小麦", 25, 5);
+    EXPECT_EQ(lod.consume(market, "小麦", people), 25);
+    EXPECT_EQ(market.getStock("小麦"), 0);
+    EXPECT_EQ(lod.getCohorts()[0].satisfaction, 60);
+}
+
+TEST_F(CohortTest, NeedyCohortsAreDissolved) {
+    CohortSimulator lod;
+    lod.build(people);
+    EXPECT_TRUE(lod.promoteNeedy(people, 50).empty());
+    EXPECT_EQ(lod.promoteNeedy(people, 1000).size(), 40u);
+    EXPECT_EQ(lod.dormantCount(), 0u);
+    std::vector<size_t> everyone(people.size());
+    for (size_t i = 0; i < everyone.size(); ++i) everyone[i] = i;
+    EXPECT_EQ(lod.activePeople(), everyone);  // まとめて戻しても昇順のまま
+}
+
+TEST(WorldLevelOfDetailTest, TracksFullSimulationClosely) {
+    WorldConfig config;
+    config.people = 5000;
+    config.businesses = 50;
+    World full = World::generate(config);
+    World lod = World::generate(config);
+    EXPECT_GT(lod.enableLevelOfDetail(), 0u);
+    EXPECT_LT(lod.cohorts.activePeople().size(), lod.people.size());
+
+    for (int i = 0; i < 10; ++i) {
+        full.step();
+        lod.step();
+    }
+    lod.syncPeople();
+    int64_t full_money = 0;
+    int64_t lod_money = 0;
+    for (const auto& person : full.people) full_money += person.money;
+    for (const auto& person : lod.people) lod_money += person.money;
+    EXPECT_NEAR(static_cast<double>(lod_money), static_cast<double>(full_money), full_money * 0.05);
+
+    Person& touched = lod.touch(0);
+    EXPECT_TRUE(lod.cohorts.isActive(0));
+    EXPECT_EQ(&touched, &lod.people[0]);
+
+    lod.disableLevelOfDetail();
+    EXPECT_EQ(lod.cohorts.dormantCount(), 0u);
+}
+
+TEST_F(CohortTest, PoorMembersAreSplitInsteadOfGoingNegative) {
+    // 平均は課税ラインを大きく超えるが、1人だけ税も主食も払えない構成員がいる
+    for (int i = 0; i < 40; ++i) people[i].money = 2000;
+    people[7].money = 3;
+    CohortSimulator lod;
+    ASSERT_EQ(lod.build(people), 40u);
+
+    Government government;
+    government.money = 0;
+    EXPECT_EQ(lod.collectTax(government, people), 39);
+    EXPECT_TRUE(lod.isActive(7));
+    EXPECT_EQ(people[7].money, 3);  // 個別の規則では免税
+    EXPECT_EQ(lod.getCohorts()[0].size(), 39u);
+
+    lod.materialize(people);
+    for (const auto& person : people) EXPECT_GE(person.money, 0);
+
+    // 税を払った後の所持金では主食を買えない構成員は、在庫があれば集団から外れて個別に満足度が下がる
+    Market market;
+    market.sell("小麦", 100, 1900);
+    EXPECT_EQ(lod.consume(market, "小麦", people), 0);
+    EXPECT_EQ(lod.dormantCount(), 0u);
+    for (int i = 0; i < 40; ++i) {
+        EXPECT_GE(people[i].money, 0);
+        if (i != 7) {
+            EXPECT_EQ(people[i].satisfaction, 45);  // 7 は課税のときに外れている
+        }
+    }
+}
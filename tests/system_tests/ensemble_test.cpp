@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+#include "system/ensemble.h"
+#include "system/state_hash.h"
+#include "system/thread_pool.h"
+
+class EnsembleTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config.people = 60;
+        config.businesses = 10;
+        config.seed = 3;
+        base = EnsembleBase::build(World::generate(config));
+    }
+
+    WorldConfig config;
+    std::shared_ptr<const EnsembleBase> base;
+};
+
+TEST(RunningStatsTest, MergeMatchesSequential) {
+    RunningStats all, left, right;
+    for (int i = 1; i <= 10; ++i) {
+        all.add(i);
+        (i <= 4 ? left : right).add(i);
+    }
+    left.merge(right);
+    EXPECT_EQ(left.count, 10);
+    EXPECT_DOUBLE_EQ(left.mean, all.mean);
+    EXPECT_NEAR(left.variance(), all.variance(), 1e-9);
+    EXPECT_DOUBLE_EQ(left.min, 1.0);
+    EXPECT_DOUBLE_EQ(left.max, 10.0);
+}
+
+TEST_F(EnsembleTest, RunStepsTheWorldSimulation) {
+    // 既定のパラメータの実行は、同じ世界を World::step で進めたものと一致する
+    World direct = World::generate(config);
+    EnsembleParams params;
+    params.tax_rate = direct.government.tax_rate;
+    params.price_volatility = direct.market.getPriceVolatility();
+    EnsembleRun run(base, params);
+    for (int day = 0; day < 10; ++day) {
+        const TickStats a = run.step();
+        const TickStats b = direct.step();
+        EXPECT_EQ(a.produced, b.produced);
+        EXPECT_EQ(a.trades, b.trades);
+    }
+    EXPECT_EQ(StateHasher::hashWorld(run.assembleWorld()), StateHasher::hashWorld(direct));
+    EXPECT_EQ(base->state.day, 0);  // 共有の初期状態は変化しない
+}
+
+TEST_F(EnsembleTest, RunsShareNamesAndRoutes) {
+    // 住民名と貿易ルートは共有の初期状態に1つだけあり、各実行の World には写さない
+    EnsembleRun a(base, EnsembleParams{});
+    EnsembleRun b(base, EnsembleParams{});
+    EXPECT_EQ(&a.shared(), &b.shared());
+    ASSERT_EQ(base->person_names.size(), config.people);
+    EXPECT_EQ(base->person_names[0], "住民1");
+    EXPECT_TRUE(a.getWorld().people[0].name.empty());
+    EXPECT_TRUE(a.getWorld().trade_routes.empty());
+    EXPECT_EQ(a.assembleWorld().people[0].name, "住民1");
+    EXPECT_EQ(a.assembleWorld().trade_routes.size(), base->trade_routes.size());
+}
+
+TEST_F(EnsembleTest, TaxRateAffectsGovernmentRevenue) {
+    EnsembleParams low, high;
+    low.tax_rate = 5;
+    high.tax_rate = 30;
+    EnsembleRun a(base, low);
+    EnsembleRun b(base, high);
+    for (int day = 0; day < 5; ++day) {
+        a.step();
+        b.step();
+    }
+    EXPECT_GT(b.getWorld().government.money, a.getWorld().government.money);
+}
+
+TEST_F(EnsembleTest, RunEnsemble_ParallelMatchesSerial) {
+    std::vector<EnsembleParams> params;
+    for (int r = 0; r < 16; ++r) {
+        EnsembleParams p;
+        p.tax_rate = 5 + (r / 4) * 5;  // 4通りの税率 × 4通りの価格変動性
+        p.price_volatility = 0.05f * static_cast<float>(1 + r % 4);
+        params.push_back(p);
+    }
+
+    ThreadPool pool(4);
+    EnsembleSummary serial = runEnsemble(config, params, 10);
+    EnsembleSummary parallel = runEnsemble(config, params, 10, &pool);
+
+    EXPECT_EQ(serial.runs, 16);
+    EXPECT_EQ(parallel.runs, 16);
+    EXPECT_NEAR(serial.government_money.mean, parallel.government_money.mean, 1e-6);
+    EXPECT_DOUBLE_EQ(serial.government_money.max, parallel.government_money.max);
+    EXPECT_NEAR(serial.total_person_money.mean, parallel.total_person_money.mean, 1e-6);
+    EXPECT_GT(serial.government_money.stddev(), 0.0);
+    EXPECT_GT(serial.total_person_money.stddev(), 0.0);
+}
+
+TEST_F(EnsembleTest, RunEnsemble_InvalidArguments) {
+    EXPECT_THROW(EnsembleRun(nullptr, EnsembleParams{}), std::invalid_argument);
+    EXPECT_THROW(runEnsemble(config, {}, -1), std::invalid_argument);
+}
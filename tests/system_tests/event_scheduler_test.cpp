@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <vector>
+#include "system/event_scheduler.h"
+#include "system/simulation.h"
+
+TEST(TimingWheelTest, ReturnsEventsOnTheirDueTick) {
+    TimingWheel<int> wheel;
+    wheel.schedule(3, 30);
+    wheel.schedule(1, 10);
+    wheel.schedule(3, 31);
+    EXPECT_EQ(wheel.size(), 3u);
+
+    EXPECT_TRUE(wheel.advanceTo(0).empty());
+    EXPECT_EQ(wheel.advanceTo(1), (std::vector<int>{10}));
+    EXPECT_TRUE(wheel.advanceTo(2).empty());
+    EXPECT_EQ(wheel.advanceTo(3), (std::vector<int>{30, 31}));  // 同じ期日は予定順
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_EQ(wheel.now(), 4);
+}
+
+TEST(TimingWheelTest, CascadesAcrossLevelsAndOverflow) {
+    TimingWheel<int64_t> wheel;
+    const std::vector<int64_t> dues = {63, 64, 65, 4095, 4096, 300000, int64_t{1} << 24,
+                                       (int64_t{1} << 24) + 5, int64_t{1} << 30};
+    for (int64_t due : dues) wheel.schedule(due, due);
+
+    std::vector<int64_t> seen;
+    for (int64_t due : dues) {
+        auto fired = wheel.advanceTo(due);
+        ASSERT_EQ(fired.size(), 1u) << "due " << due;
+        EXPECT_EQ(fired[0], due);
+        seen.push_back(fired[0]);
+    }
+    EXPECT_EQ(seen, dues);
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimingWheelTest, MatchesReferenceQueueUnderRandomLoad) {
+    std::mt19937_64 rng(11);
+    TimingWheel<int> wheel;
+    std::multimap<int64_t, int> reference;
+    int next_id = 0;
+    for (int64_t tick = 0; tick < 20000; ++tick) {
+        const int inserts = static_cast<int>(rng() % 4);
+        for (int i = 0; i < inserts; ++i) {
+            // 近い予定から遠い予定まで混ぜる
+            const int64_t horizon = (rng() % 3 == 0) ? 100000 : 200;
+            const int64_t due = tick + static_cast<int64_t>(rng() % horizon);
+            wheel.schedule(due, next_id);
+            reference.emplace(due, next_id);
+            ++next_id;
+        }
+        std::vector<int> expected;
+        auto end = reference.upper_bound(tick);
+        for (auto it = reference.begin(); it != end; ++it) expected.push_back(it->second);
+        reference.erase(reference.begin(), end);
+        ASSERT_EQ(wheel.advanceTo(tick), expected) << "tick " << tick;
+    }
+    EXPECT_EQ(wheel.size(), reference.size());
+}
+
+TEST(TimingWheelTest, CancelledAndLateEvents) {
+    TimingWheel<int> wheel;
+    auto keep = wheel.schedule(5, 1);
+    auto drop = wheel.schedule(5, 2);
+    (void)keep;
+    wheel.cancel(drop);
+    EXPECT_EQ(wheel.size(), 1u);
+    EXPECT_EQ(wheel.advanceTo(10), (std::vector<int>{1}));
+
+    // 処理済みの日付への予定は次の advanceTo で返る
+    wheel.schedule(3, 7);
+    EXPECT_EQ(wheel.advanceTo(11), (std::vector<int>{7}));
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimingWheelTest, UnknownOrFiredCancelsAreIgnored) {
+    TimingWheel<int> wheel;
+    auto fired = wheel.schedule(2, 1);
+    auto pending = wheel.schedule(8, 2);
+    EXPECT_EQ(wheel.advanceTo(4), (std::vector<int>{1}));
+    EXPECT_EQ(wheel.size(), 1u);
+
+    // 返却済み・未発行・二重の取り消しでは数が変わらない
+    EXPECT_FALSE(wheel.cancel(fired));
+    EXPECT_FALSE(wheel.cancel(pending + 100));
+    EXPECT_EQ(wheel.size(), 1u);
+    EXPECT_TRUE(wheel.cancel(pending));
+    EXPECT_FALSE(wheel.cancel(pending));
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_TRUE(wheel.advanceTo(10).empty());
+
+    wheel.schedule(12, 3);
+    EXPECT_EQ(wheel.size(), 1u);
+    EXPECT_EQ(wheel.advanceTo(12), (std::vector<int>{3}));
+}
+
+TEST(TimingWheelTest, SkipsEmptyStretches) {
+    TimingWheel<int> wheel;
+    wheel.schedule(int64_t{1} << 40, 1);
+    EXPECT_TRUE(wheel.advanceTo((int64_t{1} << 40) - 1).empty());
+    EXPECT_EQ(wheel.advanceTo(int64_t{1} << 40), (std::vector<int>{1}));
+}
+
+TEST(WorldEventTest, LoansMatureOnSchedule) {
+    WorldConfig config;
+    config.people = 2000;
+    config.businesses = 20;
+    World world = World::generate(config);
+    for (auto& person : world.people) person.money = 0;  // 全員が融資を申し込む
+    world.loan_provider.loan_term_days = 5;
+
+    TickStats first = world.step();
+    ASSERT_GT(first.loans, 0);
+    EXPECT_EQ(world.events.size(), static_cast<size_t>(first.loans));
+    EXPECT_EQ(world.loan_provider.active_loans[0].due_day, 5);
+    std::vector<int64_t> first_loans;
+    for (const Loan& loan : world.loan_provider.active_loans) first_loans.push_back(loan.loan_id);
+
+    int64_t settled = 0;
+    for (int i = 0; i < 5; ++i) {
+        const int64_t today = world.day;
+        TickStats stats = world.step();
+        settled += stats.repaid + stats.defaulted;
+        if (today < 5) {
+            EXPECT_EQ(stats.events, 0);
+        }
+    }
+    EXPECT_GE(settled, first.loans);
+    // 清算した融資は借り手のハンドルと一緒に取り除かれる
+    for (int64_t loan_id : first_loans) {
+        EXPECT_EQ(world.loan_provider.findLoan(loan_id), nullptr);
+        EXPECT_EQ(world.borrowers.count(loan_id), 0u);
+    }
+    EXPECT_EQ(world.borrowers.size(), world.loan_provider.active_loans.size());
+}
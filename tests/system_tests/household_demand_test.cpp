@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "system/household_demand.h"
+#include "system/simulation.h"
+
+namespace {
+std::vector<Person> makePeople(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<Person> people(count);
+    for (size_t i = 0; i < count; ++i) {
+        people[i].id = static_cast<int64_t>(i + 1);
+        people[i].money = static_cast<int64_t>(rng() % 2000);
+        people[i].setDailyIncome(static_cast<int>(rng() % 40));
+        people[i].setSatisfaction(static_cast<int>(rng() % 101));
+    }
+    return people;
+}
+
+Market stockedMarket(int stock) {
+    Market market;
+    market.sell("小麦", stock, 5);
+    market.sell("パン", stock, 10);
+    market.sell("道具", stock, 20);
+    return market;
+}
+}  // namespace
+
+TEST(HouseholdDemandTest, ValidatesBasket) {
+    HouseholdBasket basket = HouseholdBasket::standard();
+    EXPECT_NO_THROW(basket.validate());
+    basket.goods[0].share = 0.6;
+    EXPECT_THROW(basket.validate(), std::invalid_argument);
+    basket = HouseholdBasket::standard();
+    basket.goods[2].tilt = 0.5;
+    basket.goods[0].tilt = -0.6;
+    EXPECT_THROW(basket.validate(), std::invalid_argument);
+}
+
+TEST(HouseholdDemandTest, BudgetSumsMatchScalar) {
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> money(-100.0, 5000.0);
+    std::uniform_real_distribution<double> unit(-0.5, 0.5);
+    const size_t n = 1027;
+    std::vector<double> m(n), income(n), tilt(n);
+    for (size_t i = 0; i < n; ++i) {
+        m[i] = money(rng);
+        income[i] = std::floor(money(rng) / 100.0);
+        tilt[i] = unit(rng);
+    }
+    double scalar[2];
+    double dispatched[2];
+    HouseholdDemand::budgetSumsScalar(m.data(), income.data(), tilt.data(), n, 0.05, 50.0, scalar);
+    HouseholdDemand::budgetSums(m.data(), income.data(), tilt.data(), n, 0.05, 50.0, dispatched);
+    EXPECT_NEAR(dispatched[0], scalar[0], 1e-6 * scalar[0]);
+    EXPECT_NEAR(dispatched[1], scalar[1], 1e-6 * std::abs(scalar[0]));
+}
+
+TEST(HouseholdDemandTest, AggregateDemandMatchesPerPersonAllocation) {
+    std::vector<Person> people = makePeople(5000, 9);
+    Market market = stockedMarket(1000000);
+    const HouseholdBasket basket = HouseholdBasket::standard();
+
+    // 個別に配分した場合の品目ごとの支出
+    std::vector<double> expected(basket.goods.size(), 0.0);
+    for (const auto& person : people) {
+        const double budget = HouseholdDemand::budgetOf(static_cast<double>(person.money), person.daily_income,
+                                                        basket.spend_rate, static_cast<double>(basket.reserve));
+        for (size_t g = 0; g < basket.goods.size(); ++g) {
+            expected[g] += budget * (basket.goods[g].share + basket.goods[g].tilt * (person.satisfaction - 50) / 100.0);
+        }
+    }
+
+    const HouseholdDemandReport report = HouseholdDemand::run(basket, people, market);
+    ASSERT_EQ(report.demand.size(), 3u);
+    EXPECT_EQ(report.demand[0], static_cast<int>(expected[0] / 5));
+    EXPECT_EQ(report.demand[1], static_cast<int>(expected[1] / 10));
+    EXPECT_EQ(report.demand[2], static_cast<int>(expected[2] / 20));
+    // 在庫が十分なら全量約定
+    EXPECT_EQ(report.filled, report.demand);
+    EXPECT_GT(report.spent, 0);
+}
+
+TEST(HouseholdDemandTest, ShortageLimitsSpendingAndSatisfaction) {
+    std::vector<Person> plenty = makePeople(2000, 4);
+    std::vector<Person> scarce = plenty;
+    Market full = stockedMarket(1000000);
+    Market empty = stockedMarket(10);
+    const HouseholdBasket basket = HouseholdBasket::standard();
+
+    const auto full_report = HouseholdDemand::run(basket, plenty, full);
+    const auto scarce_report = HouseholdDemand::run(basket, scarce, empty);
+    EXPECT_LE(scarce_report.filled[0], 10);
+    EXPECT_LT(scarce_report.spent, full_report.spent);
+
+    int64_t plenty_satisfaction = 0;
+    int64_t scarce_satisfaction = 0;
+    for (size_t i = 0; i < plenty.size(); ++i) {
+        EXPECT_GE(scarce[i].money, plenty[i].money);
+        EXPECT_GE(scarce[i].money, 0);
+        plenty_satisfaction += plenty[i].satisfaction;
+        scarce_satisfaction += scarce[i].satisfaction;
+    }
+    EXPECT_GT(plenty_satisfaction, scarce_satisfaction);
+}
+
+TEST(HouseholdDemandTest, ZeroBudgetHouseholdIsUnfulfilled) {
+    std::vector<Person> people(2);
+    people[0].money = 1000;
+    people[0].setDailyIncome(30);
+    people[0].setSatisfaction(50);
+    people[1].money = 0;
+    people[1].setDailyIncome(30);
+    people[1].setSatisfaction(50);
+    Market market = stockedMarket(1000000);
+
+    const auto report = HouseholdDemand::run(HouseholdBasket::standard(), people, market);
+    EXPECT_EQ(report.households, 1);
+    EXPECT_GT(people[0].satisfaction, 50);
+    EXPECT_EQ(people[1].money, 0);
+    EXPECT_EQ(people[1].satisfaction, 45);
+}
+
+TEST(HouseholdDemandTest, WorldStepUsesBasket) {
+    WorldConfig config;
+    config.people = 500;
+    config.businesses = 30;
+    World world = World::generate(config);
+    world.household_basket = true;
+    int64_t trades = 0;
+    for (int day = 0; day < 5; ++day) trades += world.step().trades;
+    EXPECT_GT(trades, 0);
+    for (const auto& person : world.people) EXPECT_GE(person.money, 0);
+
+    // LOD モードでも通常のエージェントだけがかごで買い物をする
+    World lod = World::generate(config);
+    lod.household_basket = true;
+    lod.enableLevelOfDetail();
+    EXPECT_NO_THROW(lod.step());
+}
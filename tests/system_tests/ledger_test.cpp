@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "system/ledger.h"
+#include "system/simulation.h"
+#include "system/thread_pool.h"
+
+namespace {
+std::vector<Transfer> randomBatch(size_t accounts, size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> account(0, accounts - 1);
+    std::uniform_int_distribution<int64_t> amount(1, 80);
+    std::vector<Transfer> batch;
+    for (size_t i = 0; i < count; ++i) batch.push_back({account(rng), account(rng), amount(rng)});
+    return batch;
+}
+}  // namespace
+
+TEST(LedgerTest, AppliesDebitsAndCredits) {
+    std::vector<int64_t> balances = {100, 50, 0};
+    LedgerReport report = Ledger().apply({{0, 1, 30}, {1, 2, 40}, {0, 2, 70}}, balances);
+
+    EXPECT_EQ(report.applied, 3u);
+    EXPECT_EQ(report.rejected, 0u);
+    EXPECT_EQ(report.volume, 140);
+    EXPECT_EQ(balances, (std::vector<int64_t>{0, 40, 110}));
+}
+
+TEST(LedgerTest, RejectsInsufficientFundsInBatchOrder) {
+    // 同じバッチ内の入金は引き落としの原資にならない
+    std::vector<int64_t> balances = {100, 0};
+    LedgerReport report = Ledger().apply({{0, 1, 60}, {0, 1, 60}, {1, 0, 10}, {0, 1, 40}}, balances);
+
+    ASSERT_EQ(report.status.size(), 4u);
+    EXPECT_EQ(report.status[0], TransferStatus::APPLIED);
+    EXPECT_EQ(report.status[1], TransferStatus::INSUFFICIENT_FUNDS);
+    EXPECT_EQ(report.status[2], TransferStatus::INSUFFICIENT_FUNDS);
+    EXPECT_EQ(report.status[3], TransferStatus::APPLIED);
+    EXPECT_EQ(report.rejected, 2u);
+    EXPECT_EQ(report.volume, 100);
+    EXPECT_EQ(balances, (std::vector<int64_t>{0, 100}));
+}
+
+TEST(LedgerTest, RejectsInvalidTransfers) {
+    std::vector<int64_t> balances = {100, 100};
+    LedgerReport report = Ledger().apply({{0, 0, 10}, {0, 2, 10}, {1, 0, 0}, {1, 0, -5}}, balances);
+
+    EXPECT_EQ(report.applied, 0u);
+    for (TransferStatus status : report.status) EXPECT_EQ(status, TransferStatus::INVALID);
+    EXPECT_EQ(balances, (std::vector<int64_t>{100, 100}));
+}
+
+TEST(LedgerTest, RejectsOverflowingCreditsAndRefunds) {
+    const int64_t max = std::numeric_limits<int64_t>::max();
+    std::vector<int64_t> balances = {100, max - 20, 0};
+    ThreadPool pool(2);
+    LedgerReport report = Ledger(3).apply({{0, 1, 15}, {0, 1, 10}, {0, 2, 30}}, balances, &pool);
+
+    EXPECT_EQ(report.status[0], TransferStatus::APPLIED);
+    EXPECT_EQ(report.status[1], TransferStatus::OVERFLOW);
+    EXPECT_EQ(report.status[2], TransferStatus::APPLIED);
+    EXPECT_EQ(report.applied, 2u);
+    EXPECT_EQ(report.rejected, 1u);
+    EXPECT_EQ(report.volume, 45);
+    EXPECT_EQ(balances, (std::vector<int64_t>{55, max - 5, 30}));
+}
+
+TEST(LedgerTest, ParallelResultMatchesSequential) {
+    const size_t accounts = 5000;
+    const std::vector<Transfer> batch = randomBatch(accounts, 200000, 3);
+    std::vector<int64_t> initial(accounts);
+    for (size_t i = 0; i < accounts; ++i) initial[i] = static_cast<int64_t>(i % 200);
+
+    std::vector<int64_t> sequential = initial;
+    LedgerReport expected = Ledger(1).apply(batch, sequential);
+
+    ThreadPool pool(4);
+    for (size_t shards : {size_t{0}, size_t{7}, size_t{64}}) {
+        std::vector<int64_t> parallel = initial;
+        LedgerReport report = Ledger(shards).apply(batch, parallel, &pool);
+        EXPECT_EQ(parallel, sequential);
+        EXPECT_EQ(report.status, expected.status);
+        EXPECT_EQ(report.applied, expected.applied);
+        EXPECT_EQ(report.volume, expected.volume);
+    }
+
+    // 送金はお金を生まない
+    EXPECT_EQ(std::accumulate(sequential.begin(), sequential.end(), int64_t{0}),
+              std::accumulate(initial.begin(), initial.end(), int64_t{0}));
+    for (int64_t balance : sequential) EXPECT_GE(balance, 0);
+}
+
+TEST(LedgerTest, WorldAccountsCoverAllAgents) {
+    WorldConfig config;
+    config.people = 10;
+    config.businesses = 3;
+    World world = World::generate(config);
+
+    ASSERT_EQ(world.accountCount(), 15u);
+    EXPECT_EQ(&world.balance(0), &world.people[0].money);
+    EXPECT_EQ(&world.balance(world.businessAccount(2)), &world.businesses[2].money);
+    EXPECT_EQ(&world.balance(world.governmentAccount()), &world.government.money);
+    EXPECT_EQ(&world.balance(world.lenderAccount()), &world.loan_provider.money);
+    EXPECT_THROW(world.balance(world.accountCount()), std::out_of_range);
+
+    const int64_t government = world.government.money;
+    const int64_t person = world.people[0].money;
+    LedgerReport report = Ledger().apply({{0, world.governmentAccount(), person}}, world.accountCount(),
+                                         [&world](size_t account) -> int64_t& { return world.balance(account); });
+    EXPECT_EQ(report.applied, 1u);
+    EXPECT_EQ(world.people[0].money, 0);
+    EXPECT_EQ(world.government.money, government + person);
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "system/route_network.h"
+#include "system/thread_pool.h"
+
+namespace {
+TradeRoute makeRoute(int from, int to, int travel_time) {
+    TradeRoute route;
+    route.from_location_id = from;
+    route.to_location_id = to;
+    route.travel_time = travel_time;
+    return route;
+}
+
+// 開いている交易路だけで Floyd-Warshall（location_id は 0..n-1）
+struct ReferenceRoute {
+    int from;
+    int to;
+    int travel_time;
+    bool open;
+};
+
+std::vector<std::vector<int64_t>> allPairs(const std::vector<ReferenceRoute>& routes, int n) {
+    std::vector<std::vector<int64_t>> d(n, std::vector<int64_t>(n, RouteNetwork::UNREACHABLE));
+    for (int i = 0; i < n; ++i) d[i][i] = 0;
+    for (const auto& route : routes) {
+        if (route.open) d[route.from][route.to] = std::min<int64_t>(d[route.from][route.to], route.travel_time);
+    }
+    for (int k = 0; k < n; ++k) {
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                if (d[i][k] == RouteNetwork::UNREACHABLE || d[k][j] == RouteNetwork::UNREACHABLE) continue;
+                d[i][j] = std::min(d[i][j], d[i][k] + d[k][j]);
+            }
+        }
+    }
+    return d;
+}
+}  // namespace
+
+TEST(RouteNetworkTest, ShortestTravelTimeAndPath) {
+    RouteNetwork network({makeRoute(1, 2, 4), makeRoute(2, 3, 1), makeRoute(1, 3, 7), makeRoute(3, 4, 2)});
+
+    EXPECT_EQ(network.locationCount(), 4u);
+    EXPECT_EQ(network.travelTime(1, 3), 5);
+    EXPECT_EQ(network.travelTime(1, 4), 7);
+    EXPECT_EQ(network.travelTime(4, 1), RouteNetwork::UNREACHABLE);
+    EXPECT_EQ(network.path(1, 4), (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_TRUE(network.path(4, 1).empty());
+    EXPECT_THROW(network.travelTime(1, 99), std::out_of_range);
+}
+
+TEST(RouteNetworkTest, UpdatesCachedPathsIncrementally) {
+    RouteNetwork network;
+    const auto slow = network.addRoute(makeRoute(1, 2, 10));
+    network.addRoute(makeRoute(2, 3, 1));
+    EXPECT_EQ(network.travelTime(1, 3), 11);
+    EXPECT_EQ(network.cachedRows(), 1u);
+
+    // 近道の追加は保持している行に伝播する
+    network.addRoute(makeRoute(1, 4, 1));
+    network.addRoute(makeRoute(4, 2, 1));
+    EXPECT_EQ(network.cachedRows(), 1u);
+    EXPECT_EQ(network.travelTime(1, 3), 3);
+    EXPECT_EQ(network.path(1, 3), (std::vector<int>{1, 4, 2, 3}));
+
+    // 最短経路に使われていない辺が長くなっても行は捨てない
+    network.setTravelTime(slow, 20);
+    EXPECT_EQ(network.cachedRows(), 1u);
+
+    // 使われている辺を閉じると行を求め直す
+    network.closeRoute(network.routeCount() - 1);
+    EXPECT_EQ(network.travelTime(1, 3), 21);
+    network.setTravelTime(slow, 2);
+    EXPECT_EQ(network.travelTime(1, 3), 3);
+}
+
+TEST(RouteNetworkTest, MultiSourceTimes) {
+    RouteNetwork network({makeRoute(1, 2, 5), makeRoute(3, 2, 1), makeRoute(2, 4, 1)});
+    const std::vector<int64_t> times = network.multiSourceTimes({1, 3});
+    const auto& locations = network.locations();
+    ASSERT_EQ(times.size(), locations.size());
+    for (size_t n = 0; n < locations.size(); ++n) {
+        const int64_t expected = locations[n] == 1 || locations[n] == 3 ? 0 : locations[n] == 2 ? 1 : 2;
+        EXPECT_EQ(times[n], expected);
+    }
+}
+
+TEST(RouteNetworkTest, RandomUpdatesMatchFloydWarshall) {
+    const int n = 24;
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> node(0, n - 1);
+    std::uniform_int_distribution<int> time(0, 20);
+    std::uniform_int_distribution<int> op(0, 3);
+
+    RouteNetwork network;
+    std::vector<ReferenceRoute> reference;
+    for (int i = 0; i < n; ++i) {
+        network.addRoute(makeRoute(i, (i + 1) % n, 50));
+        reference.push_back({i, (i + 1) % n, 50, true});
+    }
+    ThreadPool pool(4);
+    network.warmAll(&pool);
+
+    for (int round = 0; round < 300; ++round) {
+        const int kind = op(rng);
+        if (kind == 0 || reference.empty()) {
+            const int from = node(rng);
+            const int to = node(rng);
+            const int t = time(rng);
+            network.addRoute(makeRoute(from, to, t));
+            reference.push_back({from, to, t, true});
+        } else {
+            const size_t id = std::uniform_int_distribution<size_t>(0, reference.size() - 1)(rng);
+            if (kind == 1) {
+                network.closeRoute(id);
+                reference[id].open = false;
+            } else if (kind == 2) {
+                network.reopenRoute(id);
+                reference[id].open = true;
+            } else {
+                const int t = time(rng);
+                network.setTravelTime(id, t);
+                reference[id].travel_time = t;
+            }
+        }
+        if (round % 25 != 0) continue;
+        const auto expected = allPairs(reference, n);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                ASSERT_EQ(network.travelTime(i, j), expected[i][j]) << "round " << round << " " << i << "->" << j;
+            }
+        }
+        network.warmAll(&pool);
+        EXPECT_EQ(network.cachedTravelTime(0, n - 1), expected[0][n - 1]);
+    }
+}
+
+TEST(RouteNetworkTest, BulkConstructionMatchesIncrementalAdds) {
+    const int n = 30;
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> node(0, n - 1);
+    std::uniform_int_distribution<int> time(0, 20);
+
+    // 同じ拠点の組を結ぶ交易路も混ぜる
+    std::vector<TradeRoute> routes;
+    std::vector<ReferenceRoute> reference;
+    for (int i = 0; i < 200; ++i) {
+        const int from = node(rng);
+        const int to = node(rng);
+        const int t = time(rng);
+        routes.push_back(makeRoute(from, to, t));
+        reference.push_back({from, to, t, true});
+    }
+    for (int i = 0; i < n; ++i) {
+        routes.push_back(makeRoute(i, (i + 1) % n, 50));
+        reference.push_back({i, (i + 1) % n, 50, true});
+    }
+    RouteNetwork bulk(routes);
+    RouteNetwork incremental;
+    for (const auto& route : routes) incremental.addRoute(route);
+    EXPECT_EQ(bulk.routeCount(), routes.size());
+    EXPECT_EQ(bulk.edgeCount(), incremental.edgeCount());
+    EXPECT_EQ(bulk.locations(), incremental.locations());
+
+    auto expected = allPairs(reference, n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) ASSERT_EQ(bulk.travelTime(i, j), expected[i][j]) << i << "->" << j;
+    }
+
+    // 組み上げた後の追加は差分で直す
+    bulk.addRoute(makeRoute(0, n - 1, 0));
+    bulk.closeRoute(3);
+    reference.push_back({0, n - 1, 0, true});
+    reference[3].open = false;
+    expected = allPairs(reference, n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) ASSERT_EQ(bulk.travelTime(i, j), expected[i][j]) << i << "->" << j;
+    }
+    EXPECT_THROW(RouteNetwork({makeRoute(0, 1, -1)}), std::invalid_argument);
+}
@@ -0,0 +1,334 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include "system/checkpoint.h"
+#include "system/simulation.h"
+#include "system/state_hash.h"
+#include "system/thread_pool.h"
+
+namespace {
+WorldConfig smallConfig(uint64_t seed = 7) {
+    WorldConfig config;
+    config.people = 200;
+    config.businesses = 20;
+    config.seed = seed;
+    return config;
+}
+
+int64_t totalMoney(const World& world) {
+    int64_t total = 0;
+    for (const auto& person : world.people) total += person.money;
+    return total;
+}
+
+std::string binary(const World& world) {
+    std::ostringstream out;
+    Checkpoint::save(world, out);
+    return out.str();
+}
+
+// 既定値から設定を変え、モードをすべて有効にして何日か進めた世界（保存漏れがあると再開後にずれる）
+World configuredWorld() {
+    World world = World::generate(smallConfig());
+    world.pricing.target_margin = 0.3f;
+    world.pricing.competition = 0.1f;
+    world.basket.spend_rate = 0.08;
+    world.household_basket = true;
+    world.seasonal_production.setMultipliers("製造業", {0.9f, 1.1f, 1.3f, 0.7f});
+    world.market.setPriceVolatility(0.25f);
+    world.loan_provider.min_credit_score = 0.1f;
+    world.loan_provider.loan_term_days = 12;
+    world.trade_routes[0].goods["鉄"] = 3;
+    world.government.setRelief(20, 100);
+    world.changePerson(3, [](Person& person) { person.setHealthStatus(HealthStatus::SICK); });
+    world.changePerson(4, [](Person& person) { person.setCrimeTendency(CrimeTendency::HIGH); });
+    world.people[5].addInventoryItem("道具");
+    world.people[5].addInventoryItem("パン");
+    world.pricing.wage = 60;
+    world.enableLaborMarket();
+    world.enableSeasons();
+    world.enableLevelOfDetail();
+    for (int i = 0; i < 25; ++i) world.step();
+    return world;
+}
+}  // namespace
+
+TEST(SimulationTest, GenerateIsDeterministicForSeed) {
+    World a = World::generate(smallConfig());
+    World b = World::generate(smallConfig());
+    World c = World::generate(smallConfig(8));
+
+    ASSERT_EQ(a.people.size(), 200u);
+    ASSERT_EQ(a.businesses.size(), 20u);
+    EXPECT_EQ(totalMoney(a), totalMoney(b));
+    EXPECT_NE(totalMoney(a), totalMoney(c));
+    EXPECT_EQ(a.sectors.businessesIn("農業").size(), 4u);
+}
+
+TEST(SimulationTest, StepProducesAndTrades) {
+    World world = World::generate(smallConfig());
+    TickStats first = world.step();
+    EXPECT_GT(first.produced, 0);
+    EXPECT_EQ(world.day, 1);
+    EXPECT_EQ(world.market.getCurrentDay(), 1);
+
+    int64_t trades = first.trades;
+    for (int i = 0; i < 4; ++i) trades += world.step().trades;
+    EXPECT_GT(trades, 0);
+}
+
+TEST(SimulationTest, SalesRevenueIsCreditedToFirms) {
+    World world = World::generate(smallConfig());
+    std::vector<int64_t> before;
+    for (const auto& business : world.businesses) before.push_back(business.money);
+
+    const TickStats stats = world.step();
+    ASSERT_GT(stats.trades, 0);
+    EXPECT_GT(stats.revenue, 0);
+    int64_t credited = 0;
+    for (size_t b = 0; b < world.businesses.size(); ++b) {
+        const int64_t revenue = world.business_dynamics.revenue()[b];
+        // 補助金は加算だけなので、売上の分は少なくとも増えている
+        EXPECT_GE(world.businesses[b].money, before[b] + revenue);
+        credited += revenue;
+    }
+    EXPECT_EQ(stats.revenue, credited);
+}
+
+TEST(SimulationTest, ThreadPoolDoesNotChangeOutcome) {
+    World serial = World::generate(smallConfig());
+    World parallel = World::generate(smallConfig());
+    ThreadPool pool(4);
+    for (int i = 0; i < 5; ++i) {
+        serial.step();
+        parallel.step(&pool);
+    }
+    EXPECT_EQ(totalMoney(serial), totalMoney(parallel));
+    EXPECT_EQ(serial.market.getStock("小麦"), parallel.market.getStock("小麦"));
+}
+
+TEST(SimulationTest, LaborMarketHiresAndPaysWages) {
+    // 既定の賃金は留保賃金の中央値まで引き上げられ、そのままでも雇用が起きる
+    World derived = World::generate(smallConfig());
+    const int64_t median = derived.medianReservationWage();
+    derived.enableLaborMarket();
+    EXPECT_EQ(derived.pricing.wage, std::max<int64_t>(10, median));
+    const TickStats opening = derived.step();
+    EXPECT_GT(opening.hires, 0);
+    EXPECT_GT(opening.payroll, 0);
+    int64_t produced = opening.produced;
+    for (int i = 0; i < 20; ++i) produced += derived.step().produced;
+    EXPECT_GT(produced, 0);
+
+    World world = World::generate(smallConfig());
+    world.pricing.wage = 70;
+    world.enableLaborMarket();
+    const TickStats first = world.step();
+    EXPECT_GT(first.hires, 0);
+    EXPECT_GT(first.payroll, 0);
+    EXPECT_GT(first.produced, 0);
+
+    int64_t employed = 0;
+    for (size_t b = 0; b < world.businesses.size(); ++b) {
+        const auto& staff = world.labor.employeesOf(b);
+        EXPECT_EQ(world.businesses[b].workers, static_cast<int32_t>(staff.size()));
+        for (size_t person : staff) {
+            EXPECT_EQ(world.people[person].job, world.businesses[b].sector);
+            EXPECT_LE(world.people[person].daily_expense, 70);
+        }
+        employed += static_cast<int64_t>(staff.size());
+    }
+    EXPECT_LE(employed, first.hires);
+}
+
+TEST(SimulationTest, EmployeesStayIndividualUnderLevelOfDetail) {
+    // 先に雇われていた住民は集団化のときに戻され、以後の雇用も通常のエージェントからしか結ばれない
+    WorldConfig config = smallConfig();
+    config.people = 2000;
+    World world = World::generate(config);
+    world.pricing.wage = 70;
+    world.enableLaborMarket();
+    world.step();
+    EXPECT_GT(world.enableLevelOfDetail(), 0u);
+    for (int day = 0; day < 10; ++day) {
+        world.step();
+        for (size_t b = 0; b < world.businesses.size(); ++b) {
+            for (size_t person : world.labor.employeesOf(b)) EXPECT_TRUE(world.cohorts.isActive(person));
+        }
+    }
+}
+
+TEST(SimulationTest, LoanMaturitySettlesThroughBorrowerHandles) {
+    // 並びを逆にして ID と添字の対応を崩しても、満期の清算は借り手のハンドルで正しい住民を引く
+    World world = World::generate(smallConfig());
+    std::reverse(world.people.begin(), world.people.end());
+    world.rebuildDerivedState();
+    world.loan_provider.min_credit_score = 0.1f;
+    world.loan_provider.loan_term_days = 5;
+    for (size_t i = 0; i < 20; ++i) {
+        world.people[i].money = 0;
+        world.people[i].setDailyIncome(30);
+        world.people[i].setDailyExpense(20);
+    }
+
+    const int64_t originated = world.step().loans;
+    ASSERT_GT(originated, 0);
+    ASSERT_EQ(world.borrowers.size(), world.loan_provider.active_loans.size());
+    for (const Loan& loan : world.loan_provider.active_loans) {
+        const size_t person = world.residents.positionOf(world.borrowers.at(loan.loan_id));
+        EXPECT_EQ(world.people[person].id, loan.borrower_id);
+    }
+
+    // 借り手がいなくなった融資は満期に不履行になり、清算した融資は一覧から取り除かれる
+    const int64_t orphaned = world.loan_provider.active_loans[0].loan_id;
+    world.despawnPerson(world.borrowers.at(orphaned));
+    int64_t settled = 0;
+    int64_t defaulted = 0;
+    for (int i = 0; i < 6; ++i) {
+        const TickStats stats = world.step();
+        settled += stats.repaid + stats.defaulted;
+        defaulted += stats.defaulted;
+    }
+    EXPECT_GE(settled, originated);
+    EXPECT_GE(defaulted, 1);
+    EXPECT_EQ(world.loan_provider.findLoan(orphaned), nullptr);
+    EXPECT_EQ(world.borrowers.count(orphaned), 0u);
+    for (const Loan& loan : world.loan_provider.active_loans) EXPECT_GT(loan.due_day, world.day - 1);
+}
+
+TEST(SimulationTest, SpawnAndDespawnKeepIndicesInSync) {
+    WorldConfig config = smallConfig();
+    config.people = 2000;
+    World world = World::generate(config);
+    world.pricing.wage = 70;
+    world.enableLaborMarket();
+    world.enableLevelOfDetail();
+    world.step();
+
+    // 雇われている住民と休眠中の住民を1人ずつ取り除き、亡くなった住民も取り除かれる
+    size_t employed = world.people.size();
+    size_t dormant = world.people.size();
+    for (size_t i = 0; i < world.people.size(); ++i) {
+        if (employed == world.people.size() && world.labor.employerOf(i) != LaborMarket::NO_EMPLOYER) employed = i;
+        if (dormant == world.people.size() && !world.cohorts.isActive(i)) dormant = i;
+    }
+    ASSERT_LT(employed, world.people.size());
+    ASSERT_LT(dormant, world.people.size());
+    const SlotHandle employee = world.residents.handleAt(employed);
+    const SlotHandle sleeper = world.residents.handleAt(dormant);
+    const int64_t gone_id = world.people[dormant].id;
+    EXPECT_TRUE(world.despawnPerson(employee));
+    EXPECT_TRUE(world.despawnPerson(sleeper));
+    EXPECT_FALSE(world.despawnPerson(sleeper));
+    EXPECT_EQ(world.labor.employerOf(employed), LaborMarket::NO_EMPLOYER);
+    EXPECT_TRUE(world.cohorts.isActive(dormant));
+    world.changePerson(world.cohorts.activePeople().back(),
+                       [](Person& person) { person.setHealthStatus(HealthStatus::DEAD); });
+    EXPECT_EQ(world.residents.size(), 1997u);
+
+    Person newcomer;
+    newcomer.id = 9999;
+    newcomer.job = "農業";
+    newcomer.money = 100;
+    newcomer.setDailyIncome(40);
+    newcomer.setDailyExpense(20);
+    const SlotHandle arrival = world.spawnPerson(newcomer);
+    EXPECT_EQ(world.residents.at(arrival), 9999);
+    EXPECT_TRUE(world.cohorts.isActive(world.people.size() - 1));
+
+    const TickStats stats = world.step();
+    EXPECT_EQ(stats.departed, 3);
+    ASSERT_EQ(world.people.size(), 1998u);
+    ASSERT_EQ(world.residents.denseSize(), world.people.size());
+    EXPECT_EQ(world.population.size(), world.people.size());
+    for (size_t i = 0; i < world.people.size(); ++i) {
+        EXPECT_EQ(world.residents.dense()[i], world.people[i].id);
+        EXPECT_NE(world.people[i].id, gone_id);
+    }
+    EXPECT_EQ(world.people[world.residents.positionOf(arrival)].id, 9999);
+    for (size_t b = 0; b < world.businesses.size(); ++b) {
+        const auto& staff = world.labor.employeesOf(b);
+        EXPECT_EQ(world.businesses[b].workers, static_cast<int32_t>(staff.size()));
+        for (size_t person : staff) {
+            ASSERT_LT(person, world.people.size());
+            EXPECT_EQ(world.labor.employerOf(person), static_cast<int64_t>(b));
+        }
+    }
+    size_t members = 0;
+    for (const auto& cohort : world.cohorts.getCohorts()) {
+        for (size_t person : cohort.members) {
+            ASSERT_LT(person, world.people.size());
+            EXPECT_FALSE(world.cohorts.isActive(person));
+        }
+        members += cohort.size();
+    }
+    EXPECT_EQ(members + world.cohorts.activePeople().size(), world.people.size());
+}
+
+TEST(SimulationTest, ReliefFollowsAttributeChanges) {
+    World world = World::generate(smallConfig());
+    world.government.money = 100000;
+    world.government.setRelief(25, 1000000);
+    EXPECT_EQ(world.step().relief, 0);
+
+    // changePerson で病気にした住民だけが、属性索引を通じて給付の対象になる（LOD の休眠中でも）
+    world.enableLevelOfDetail();
+    world.changePerson(10, [](Person& person) { person.setHealthStatus(HealthStatus::SICK); });
+    world.changePerson(11, [](Person& person) { person.setHealthStatus(HealthStatus::SICK); });
+    EXPECT_EQ(world.population.health(HealthStatus::SICK).cardinality(), 2u);
+    EXPECT_EQ(world.step().relief, 2);
+
+    world.changePerson(11, [](Person& person) { person.setHealthStatus(HealthStatus::HEALTHY); });
+    EXPECT_EQ(world.step().relief, 1);
+    EXPECT_EQ(world.government.policy_history.count(PolicyType::RELIEF), 3);
+
+    // 職業を指定したルールは属性索引の職業の集合との積だけが候補になる
+    PolicyRule rule = world.government.compilePolicy("relief");
+    rule.sector = world.people[10].job == "農業" ? "鉱業" : "農業";
+    EXPECT_EQ(world.applyRelief(rule), 0u);
+    rule.sector = world.people[10].job;
+    EXPECT_EQ(world.applyRelief(rule), 1u);
+}
+
+TEST(CheckpointTest, RoundTripResumesIdentically) {
+    World original = configuredWorld();
+
+    std::stringstream buffer;
+    Checkpoint::save(original, buffer);
+    World restored = Checkpoint::load(buffer);
+
+    EXPECT_EQ(binary(restored), binary(original));
+    EXPECT_TRUE(restored.seasons);
+    EXPECT_TRUE(restored.level_of_detail);
+    EXPECT_TRUE(restored.household_basket);
+    EXPECT_TRUE(restored.labor_market);
+    EXPECT_EQ(restored.labor.employers(), original.labor.employers());
+    EXPECT_EQ(restored.people[3].health_status, HealthStatus::SICK);
+    EXPECT_EQ(restored.people[4].crime_tendency, CrimeTendency::HIGH);
+    EXPECT_EQ(restored.people[5].inventory, original.people[5].inventory);
+    EXPECT_EQ(restored.cohorts.activePeople(), original.cohorts.activePeople());
+    EXPECT_EQ(restored.market.getDemandHistory("小麦"), original.market.getDemandHistory("小麦"));
+    EXPECT_EQ(restored.market.getPriceVolatility(), original.market.getPriceVolatility());
+
+    // 季節の変わり目をまたいで、毎ティック保存しなかった世界と同じ状態になる
+    for (int i = 0; i < 40; ++i) {
+        original.step();
+        restored.step();
+        original.syncPeople();
+        restored.syncPeople();
+        ASSERT_EQ(StateHasher::hashWorld(restored), StateHasher::hashWorld(original)) << "day " << original.day;
+    }
+}
+
+TEST(CheckpointTest, RejectsForeignOrTruncatedData) {
+    std::stringstream garbage("not a checkpoint");
+    EXPECT_THROW(Checkpoint::load(garbage), std::runtime_error);
+
+    World world = World::generate(smallConfig());
+    std::stringstream buffer;
+    Checkpoint::save(world, buffer);
+    std::string bytes = buffer.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+    EXPECT_THROW(Checkpoint::load(truncated), std::runtime_error);
+}
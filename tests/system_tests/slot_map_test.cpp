@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "agent/person.h"
+#include "system/slot_map.h"
+
+TEST(SlotMapTest, SpawnAndGet) {
+    SlotMap<std::string> map;
+    SlotHandle a = map.spawn("a");
+    SlotHandle b = map.spawn("b");
+
+    EXPECT_EQ(map.size(), 2u);
+    EXPECT_NE(a, b);
+    ASSERT_NE(map.get(a), nullptr);
+    EXPECT_EQ(*map.get(a), "a");
+    EXPECT_EQ(map.at(b), "b");
+    EXPECT_EQ(map.get(SlotHandle{}), nullptr);
+}
+
+TEST(SlotMapTest, DespawnInvalidatesHandleImmediately) {
+    SlotMap<int> map;
+    SlotHandle a = map.spawn(1);
+    SlotHandle b = map.spawn(2);
+
+    EXPECT_TRUE(map.despawn(a));
+    EXPECT_FALSE(map.despawn(a));
+    EXPECT_FALSE(map.contains(a));
+    EXPECT_EQ(map.get(a), nullptr);
+    EXPECT_THROW(map.at(a), std::out_of_range);
+    EXPECT_EQ(map.size(), 1u);
+
+    // compact までは dense の添字がずれない
+    EXPECT_EQ(map.denseSize(), 2u);
+    EXPECT_FALSE(map.isAlive(0));
+    EXPECT_EQ(map.at(b), 2);
+}
+
+TEST(SlotMapTest, CompactKeepsOrderAndHandles) {
+    SlotMap<int> map;
+    std::vector<SlotHandle> handles;
+    for (int i = 0; i < 10; ++i) handles.push_back(map.spawn(i));
+    for (int i : {0, 3, 4, 9}) map.despawn(handles[i]);
+
+    EXPECT_EQ(map.compact(), 4u);
+    EXPECT_EQ(map.compact(), 0u);
+    EXPECT_EQ(map.dense(), (std::vector<int>{1, 2, 5, 6, 7, 8}));
+    for (int i : {1, 2, 5, 6, 7, 8}) EXPECT_EQ(map.at(handles[i]), i);
+    for (size_t position = 0; position < map.denseSize(); ++position) {
+        EXPECT_EQ(map.at(map.handleAt(position)), map.dense()[position]);
+        EXPECT_EQ(map.positionOf(map.handleAt(position)), position);
+    }
+    EXPECT_THROW(map.positionOf(handles[0]), std::out_of_range);
+}
+
+TEST(SlotMapTest, ReusedSlotRejectsStaleHandle) {
+    SlotMap<int> map;
+    SlotHandle old_handle = map.spawn(1);
+    map.despawn(old_handle);
+    map.compact();
+
+    SlotHandle reused = map.spawn(2);
+    EXPECT_EQ(reused.index, old_handle.index);
+    EXPECT_NE(reused.generation, old_handle.generation);
+    EXPECT_EQ(map.get(old_handle), nullptr);
+    EXPECT_EQ(map.at(reused), 2);
+}
+
+TEST(SlotMapTest, ChurnWithPeople) {
+    // 出生と死亡を繰り返しても、生存中の住民は dense に詰まったまま
+    SlotMap<Person> population;
+    std::vector<SlotHandle> handles;
+    for (int64_t day = 0; day < 50; ++day) {
+        for (int i = 0; i < 20; ++i) {
+            Person person;
+            person.id = day * 100 + i;
+            handles.push_back(population.spawn(person));
+        }
+        for (size_t i = static_cast<size_t>(day) % 3; i < handles.size(); i += 3) population.despawn(handles[i]);
+        population.compact();
+        EXPECT_EQ(population.denseSize(), population.size());
+    }
+    size_t live = 0;
+    for (const SlotHandle& handle : handles) {
+        if (const Person* person = population.get(handle)) {
+            ++live;
+            EXPECT_EQ(population.handleAt(static_cast<size_t>(person - population.dense().data())), handle);
+        }
+    }
+    EXPECT_EQ(live, population.size());
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "system/simulation.h"
+#include "system/state_hash.h"
+#include "system/thread_pool.h"
+
+class StateHashTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        WorldConfig config;
+        config.people = 50000;
+        config.businesses = 50;
+        config.seed = 3;
+        world = World::generate(config);
+    }
+
+    World world;
+};
+
+TEST_F(StateHashTest, ParallelHashMatchesSerial) {
+    world.step();
+    ThreadPool pool(4);
+    StateHash serial = StateHasher::hashWorld(world);
+    StateHash parallel = StateHasher::hashWorld(world, &pool);
+    EXPECT_EQ(serial, parallel);
+    EXPECT_EQ(serial.combined(), parallel.combined());
+}
+
+TEST_F(StateHashTest, DetectsChangedComponent) {
+    StateHash before = StateHasher::hashWorld(world);
+    world.people[123].money += 1;
+    StateHash after = StateHasher::hashWorld(world);
+    EXPECT_NE(before, after);
+    EXPECT_EQ(before.diff(after), "people");
+}
+
+TEST_F(StateHashTest, SwappedAgentsChangeHash) {
+    StateHash before = StateHasher::hashWorld(world);
+    std::swap(world.people[0].money, world.people[1].money);
+    if (world.people[0].money != world.people[1].money) {
+        EXPECT_NE(before.people, StateHasher::hashWorld(world).people);
+    }
+}
+
+TEST_F(StateHashTest, StreamRoundTripAndDivergence) {
+    World other = world;
+    std::stringstream a_stream;
+    std::stringstream b_stream;
+    HashStreamWriter a_writer(a_stream);
+    HashStreamWriter b_writer(b_stream);
+    for (int tick = 1; tick <= 5; ++tick) {
+        world.step();
+        other.step();
+        if (tick == 3) other.government.money += 10;
+        a_writer.write(StateHasher::hashWorld(world));
+        b_writer.write(StateHasher::hashWorld(other));
+    }
+
+    auto a = readHashStream(a_stream);
+    auto b = readHashStream(b_stream);
+    ASSERT_EQ(a.size(), 5u);
+    Divergence divergence = findFirstDivergence(a, b);
+    EXPECT_TRUE(divergence.diverged);
+    EXPECT_EQ(divergence.day, 3);
+    EXPECT_EQ(divergence.index, 2u);
+    EXPECT_NE(divergence.components.find("government"), std::string::npos);
+
+    EXPECT_FALSE(findFirstDivergence(a, a).diverged);
+    auto shorter = a;
+    shorter.pop_back();
+    Divergence truncated = findFirstDivergence(a, shorter);
+    EXPECT_TRUE(truncated.length_mismatch);
+    EXPECT_EQ(truncated.day, 5);
+}
+
+TEST(HashStreamTest, RejectsCorruptedLine) {
+    std::stringstream corrupted("1 0000000000000000 1 2 3 4 5\n");
+    EXPECT_THROW(readHashStream(corrupted), std::runtime_error);
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "system/thread_pool.h"
+
+TEST(ThreadPoolTest, ParallelForCoversRangeOnce) {
+    ThreadPool pool(4);
+    std::vector<int> hits(10000, 0);
+    pool.parallelFor(0, hits.size(), [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) hits[i]++;
+    }, 16);
+
+    EXPECT_EQ(std::accumulate(hits.begin(), hits.end(), 0), 10000);
+    for (int h : hits) EXPECT_EQ(h, 1);
+}
+
+TEST(ThreadPoolTest, RepeatedBatches) {
+    ThreadPool pool(3);
+    std::atomic<int64_t> total{0};
+    for (int round = 0; round < 50; ++round) {
+        pool.parallelFor(0, 1000, [&](size_t lo, size_t hi) {
+            total += static_cast<int64_t>(hi - lo);
+        }, 10);
+    }
+    EXPECT_EQ(total.load(), 50000);
+}
+
+TEST(ThreadPoolTest, ExceptionPropagates) {
+    ThreadPool pool(2);
+    EXPECT_THROW(pool.parallelFor(0, 100, [](size_t lo, size_t) {
+        if (lo == 0) throw std::runtime_error("boom");
+    }, 1), std::runtime_error);
+
+    // 例外後もプールは再利用可能
+    int count = 0;
+    pool.parallelFor(0, 5, [&](size_t lo, size_t hi) { count += static_cast<int>(hi - lo); }, 100);
+    EXPECT_EQ(count, 5);
+}
+
+TEST(ThreadPoolTest, EmptyRange) {
+    ThreadPool pool(2);
+    bool called = false;
+    pool.parallelFor(5, 5, [&](size_t, size_t) { called = true; });
+    EXPECT_FALSE(called);
+}
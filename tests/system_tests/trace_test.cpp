@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include "system/trace.h"
+
+class TraceTest : public ::testing::Test {
+protected:
+    void SetUp() override { Tracer::instance().reset(); }
+    void TearDown() override { Tracer::instance().reset(); }
+
+    const PhaseStats* findPhase(const std::vector<PhaseStats>& stats, const std::string& name) {
+        for (const auto& phase : stats) {
+            if (phase.name == name) return &phase;
+        }
+        return nullptr;
+    }
+};
+
+TEST_F(TraceTest, ZoneRecordsCallsAndItems) {
+    for (int i = 0; i < 3; ++i) {
+        TraceZone zone("phase_a");
+        zone.setCount(10);
+    }
+    { TraceZone zone("phase_b", 5); }
+
+    auto stats = Tracer::instance().collectStats();
+    const PhaseStats* a = findPhase(stats, "phase_a");
+    const PhaseStats* b = findPhase(stats, "phase_b");
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(a->calls, 3);
+    EXPECT_EQ(a->items, 30);
+    EXPECT_EQ(b->calls, 1);
+    EXPECT_EQ(b->items, 5);
+
+    uint64_t histogram_total = 0;
+    for (uint64_t h : a->histogram) histogram_total += h;
+    EXPECT_EQ(histogram_total, 3);
+}
+
+TEST_F(TraceTest, StatsMergeAcrossThreads) {
+    std::thread worker([] {
+        for (int i = 0; i < 4; ++i) {
+            TraceZone zone("shared_phase", 1);
+        }
+    });
+    worker.join();
+    { TraceZone zone("shared_phase", 1); }
+
+    auto stats = Tracer::instance().collectStats();
+    const PhaseStats* phase = findPhase(stats, "shared_phase");
+    ASSERT_NE(phase, nullptr);
+    EXPECT_EQ(phase->calls, 5);
+    EXPECT_EQ(phase->items, 5);
+}
+
+TEST_F(TraceTest, ChromeTraceExport) {
+    { TraceZone zone("quote\"zone", 7); }
+
+    std::ostringstream out;
+    Tracer::instance().writeChromeTrace(out);
+    const std::string json = out.str();
+
+    EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0);
+    EXPECT_NE(json.find("\"name\":\"quote\\\"zone\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"count\":7"), std::string::npos);
+}
+
+TEST_F(TraceTest, ResetClearsRecords) {
+    { TraceZone zone("temporary"); }
+    Tracer::instance().reset();
+    EXPECT_TRUE(Tracer::instance().collectStats().empty());
+}
+
+TEST_F(TraceTest, SummaryListsPhases) {
+    { TraceZone zone("summary_phase", 3); }
+    std::ostringstream out;
+    Tracer::instance().printSummary(out);
+    EXPECT_NE(out.str().find("summary_phase: 1回"), std::string::npos);
+}
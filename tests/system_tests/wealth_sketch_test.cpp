@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "agent/person.h"
+#include "system/thread_pool.h"
+#include "system/wealth_sketch.h"
+
+namespace {
+
+// 全件ソートによる厳密な Gini 係数
+double exactGini(std::vector<int64_t> values) {
+    std::sort(values.begin(), values.end());
+    double weighted = 0.0;
+    double total = 0.0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        weighted += static_cast<double>(i + 1) * values[i];
+        total += values[i];
+    }
+    const double n = static_cast<double>(values.size());
+    return (2.0 * weighted) / (n * total) - (n + 1.0) / n;
+}
+
+}  // namespace
+
+TEST(WealthSketchTest, QuantilesWithinRelativeError) {
+    WealthSketch sketch;
+    for (int64_t m = 1; m <= 100000; ++m) sketch.add(m);
+
+    EXPECT_NEAR(sketch.quantile(0.5), 50000.0, 50000.0 * 0.02);
+    EXPECT_NEAR(sketch.quantile(0.9), 90000.0, 90000.0 * 0.02);
+    EXPECT_NEAR(sketch.quantile(0.99), 99000.0, 99000.0 * 0.02);
+    EXPECT_THROW(sketch.quantile(1.5), std::out_of_range);
+}
+
+TEST(WealthSketchTest, GiniAndTopShareMatchExact) {
+    std::mt19937_64 rng(3);
+    std::lognormal_distribution<double> wealth(6.0, 1.2);
+    std::vector<int64_t> values;
+    WealthSketch sketch;
+    for (int i = 0; i < 50000; ++i) {
+        const int64_t m = 1 + static_cast<int64_t>(wealth(rng));
+        values.push_back(m);
+        sketch.add(m);
+    }
+
+    EXPECT_NEAR(sketch.gini(), exactGini(values), 0.01);
+
+    std::sort(values.rbegin(), values.rend());
+    double top = 0.0, total = 0.0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i < values.size() / 100) top += values[i];
+        total += values[i];
+    }
+    EXPECT_NEAR(sketch.topShare(0.01), top / total, 0.01);
+}
+
+TEST(WealthSketchTest, EqualWealthHasZeroGini) {
+    WealthSketch sketch;
+    for (int i = 0; i < 1000; ++i) sketch.add(500);
+    EXPECT_NEAR(sketch.gini(), 0.0, 1e-9);
+    EXPECT_NEAR(sketch.topShare(0.01), 0.01, 1e-9);
+}
+
+TEST(WealthSketchTest, NegativeAndZeroMoney) {
+    WealthSketch sketch;
+    sketch.add(-100);
+    sketch.add(0);
+    sketch.add(0);
+    sketch.add(1000);
+
+    EXPECT_EQ(sketch.count(), 4);
+    EXPECT_DOUBLE_EQ(sketch.quantile(0.0), -100.0);
+    EXPECT_DOUBLE_EQ(sketch.quantile(0.5), 0.0);
+    EXPECT_NEAR(sketch.mean(), 225.0, 1e-9);
+    // 富はすべて1人に集中
+    EXPECT_NEAR(sketch.gini(), 0.75, 1e-9);
+}
+
+TEST(WealthSketchTest, ParallelBuildMatchesSerial) {
+    std::vector<Person> people(100000);
+    for (size_t i = 0; i < people.size(); ++i) {
+        people[i].money = static_cast<int64_t>((i * 7919) % 20000) - 100;
+    }
+
+    ThreadPool pool(4);
+    WealthSummary serial = WealthSketch::fromAgents(people).summarize();
+    WealthSummary parallel = WealthSketch::fromAgents(people, &pool).summarize();
+
+    EXPECT_EQ(serial.count, parallel.count);
+    EXPECT_DOUBLE_EQ(serial.p50, parallel.p50);
+    EXPECT_DOUBLE_EQ(serial.p99, parallel.p99);
+    EXPECT_NEAR(serial.gini, parallel.gini, 1e-9);
+    EXPECT_NEAR(serial.top1_share, parallel.top1_share, 1e-9);
+}